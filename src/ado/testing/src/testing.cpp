@@ -699,6 +699,223 @@ namespace
     return rc;
   }
 
+  /* keys created or opened by the table op tests */
+  std::string table_op_key(unsigned i)
+  {
+    std::stringstream ss;
+    ss << "table-op-key-" << i;
+    return ss.str();
+  }
+
+  status_t tableOps(
+    IADO_plugin *ap_
+    , uint64_t work_key_
+    , const std::vector<string_view> & // args_
+    , const string_view key_
+    , value_space_t & // values_
+    , response_buffer_vector_t & // response_buffers_
+  )
+  {
+    using table_op_t = IADO_plugin::table_op_t;
+    PLOG("ADO_testing_plugin: running (key=%.*s)", int(key_.size()), key_.begin());
+
+    /* create a set of keys in one batch */
+    const unsigned count = 64;
+    IADO_plugin::table_op_vector_t ops;
+    for(unsigned i = 0; i != count; i++)
+      ops.push_back(table_op_t::create(work_key_, table_op_key(i), 32 + i));
+
+    IADO_plugin::table_op_result_vector_t results;
+    ASSERT_OK(ap_->cb_table_ops(ops, results), "TableOps: cb_table_ops failed");
+    ASSERT_TRUE(results.size() == count, "TableOps: wrong result count");
+    for(unsigned i = 0; i != count; i++) {
+      ASSERT_OK(results[i].status, "TableOps: create failed");
+      ASSERT_TRUE(results[i].value_addr != nullptr, "TableOps: create returned no value");
+      ASSERT_TRUE(results[i].value_len == 32 + i, "TableOps: create returned wrong length");
+      std::memset(results[i].value_addr, int(i), results[i].value_len);
+    }
+
+    /* a failed operation does not stop the ones after it */
+    ops.clear();
+    ops.push_back(table_op_t::allocate_pool_memory(4096));
+    ops.push_back(table_op_t::create(work_key_, table_op_key(0), 32, component::IKVStore::FLAGS_CREATE_ONLY));
+    ops.push_back(table_op_t::allocate_pool_memory(4096));
+    ASSERT_OK(ap_->cb_table_ops(ops, results), "TableOps: cb_table_ops failed");
+    ASSERT_TRUE(results.size() == 3, "TableOps: wrong result count");
+    ASSERT_OK(results[0].status, "TableOps: allocate_pool_memory failed");
+    ASSERT_TRUE(results[1].status == E_ALREADY_EXISTS, "TableOps: create-only of existing key succeeded");
+    ASSERT_OK(results[2].status, "TableOps: allocate_pool_memory after a failure failed");
+
+    ops.clear();
+    ops.push_back(table_op_t::free_pool_memory(4096, results[0].value_addr));
+    ops.push_back(table_op_t::free_pool_memory(4096, results[2].value_addr));
+    ASSERT_OK(ap_->cb_table_ops(ops, results), "TableOps: cb_table_ops failed");
+    ASSERT_TRUE(results.size() == 2, "TableOps: wrong result count");
+    ASSERT_OK(results[0].status, "TableOps: free_pool_memory failed");
+    ASSERT_OK(results[1].status, "TableOps: free_pool_memory failed");
+
+    /* an empty batch has no results */
+    ops.clear();
+    ASSERT_OK(ap_->cb_table_ops(ops, results), "TableOps: empty cb_table_ops failed");
+    ASSERT_TRUE(results.empty(), "TableOps: empty batch returned results");
+
+    return S_OK;
+  }
+
+  status_t tableOpsAsync(
+    IADO_plugin *ap_
+    , uint64_t work_key_
+    , const std::vector<string_view> & // args_
+    , const string_view key_
+    , value_space_t & // values_
+    , response_buffer_vector_t & // response_buffers_
+  )
+  {
+    using table_op_t = IADO_plugin::table_op_t;
+    PLOG("ADO_testing_plugin: running (key=%.*s)", int(key_.size()), key_.begin());
+
+    /* open the keys created by TableOps in several posted batches */
+    const unsigned batches = 8;
+    const unsigned per_batch = 8;
+    std::vector<unsigned> order;
+    unsigned bad = 0;
+    for(unsigned b = 0; b != batches; b++) {
+      IADO_plugin::table_op_vector_t ops;
+      for(unsigned i = 0; i != per_batch; i++)
+        ops.push_back(table_op_t::open(work_key_, table_op_key(b * per_batch + i)));
+
+      ASSERT_OK(ap_->cb_table_ops_async(ops, [b, &order, &bad] (const IADO_plugin::table_op_result_vector_t& results) {
+            order.push_back(b);
+            if(results.size() != per_batch) {
+              bad++;
+              return;
+            }
+            for(unsigned i = 0; i != per_batch; i++) {
+              const auto& r = results[i];
+              const auto k = b * per_batch + i;
+              if(r.status != S_OK || r.value_len != 32 + k ||
+                 static_cast<const unsigned char *>(r.value_addr)[0] != (k & 0xff))
+                bad++;
+            }
+          }),
+        "TableOpsAsync: cb_table_ops_async failed");
+    }
+
+    /* a synchronous callback first completes the posted batches, in order */
+    void * value = nullptr;
+    ASSERT_OK(ap_->cb_allocate_pool_memory(4096, 0, value), "TableOpsAsync: allocate_pool_memory failed");
+    ASSERT_TRUE(order.size() == batches, "TableOpsAsync: batches not completed by synchronous callback");
+    for(unsigned b = 0; b != batches; b++)
+      ASSERT_TRUE(order[b] == b, "TableOpsAsync: batches completed out of order");
+    ASSERT_TRUE(bad == 0, "TableOpsAsync: bad results");
+    ASSERT_OK(ap_->cb_free_pool_memory(4096, value), "TableOpsAsync: free_pool_memory failed");
+
+    /* an empty batch completes at once */
+    bool empty_done = false;
+    ASSERT_OK(ap_->cb_table_ops_async(IADO_plugin::table_op_vector_t(),
+                                      [&empty_done] (const IADO_plugin::table_op_result_vector_t& results) {
+                                        empty_done = results.empty();
+                                      }),
+              "TableOpsAsync: empty cb_table_ops_async failed");
+    ASSERT_TRUE(empty_done, "TableOpsAsync: empty batch not completed");
+
+    return S_OK;
+  }
+
+  status_t tableOpsWait(
+    IADO_plugin *ap_
+    , uint64_t // work_key_
+    , const std::vector<string_view> & // args_
+    , const string_view key_
+    , value_space_t & // values_
+    , response_buffer_vector_t & // response_buffers_
+  )
+  {
+    using table_op_t = IADO_plugin::table_op_t;
+    PLOG("ADO_testing_plugin: running (key=%.*s)", int(key_.size()), key_.begin());
+
+    /* allocate in posted batches, and free in a batch posted by a completion */
+    const unsigned batches = 4;
+    const unsigned per_batch = 16;
+    unsigned completed = 0;
+    unsigned freed = 0;
+    unsigned bad = 0;
+    for(unsigned b = 0; b != batches; b++) {
+      IADO_plugin::table_op_vector_t ops(per_batch, table_op_t::allocate_pool_memory(256));
+      ASSERT_OK(ap_->cb_table_ops_async(ops, [ap_, &completed, &freed, &bad] (const IADO_plugin::table_op_result_vector_t& results) {
+            completed++;
+            IADO_plugin::table_op_vector_t frees;
+            for(const auto& r : results) {
+              if(r.status != S_OK || r.value_addr == nullptr) {
+                bad++;
+                continue;
+              }
+              frees.push_back(table_op_t::free_pool_memory(256, r.value_addr));
+            }
+            ap_->cb_table_ops_async(frees, [&freed, &bad] (const IADO_plugin::table_op_result_vector_t& results) {
+                for(const auto& r : results) {
+                  if(r.status == S_OK) freed++;
+                  else bad++;
+                }
+              });
+          }),
+        "TableOpsWait: cb_table_ops_async failed");
+    }
+
+    /* waiting completes every posted batch, including those posted while waiting */
+    ASSERT_OK(ap_->cb_table_ops_wait(), "TableOpsWait: cb_table_ops_wait failed");
+    ASSERT_TRUE(completed == batches, "TableOpsWait: batches not completed");
+    ASSERT_TRUE(freed == batches * per_batch, "TableOpsWait: frees not completed");
+    ASSERT_TRUE(bad == 0, "TableOpsWait: bad results");
+
+    /* waiting with nothing posted returns at once */
+    ASSERT_OK(ap_->cb_table_ops_wait(), "TableOpsWait: idle cb_table_ops_wait failed");
+
+    return S_OK;
+  }
+
+  /* hold the invocation's key locked for the number of milliseconds in args_[1] */
+  status_t holdKey(
+    IADO_plugin * // ap_
+    , uint64_t // work_key_
+    , const std::vector<string_view> & args_
+    , const string_view key_
+    , value_space_t & // values_
+    , response_buffer_vector_t & // response_buffers_
+  )
+  {
+    ASSERT_TRUE(args_.size() == 2, "HoldKey: expected a time in milliseconds");
+    const auto ms = std::stoul(std::string(args_[1].begin(), args_[1].size()));
+    PLOG("ADO_testing_plugin: holding (key=%.*s) for %lums", int(key_.size()), key_.begin(), ms);
+    usleep(useconds_t(ms * 1000));
+    return S_OK;
+  }
+
+  /* after the number of milliseconds in args_[1], respond with args_[2] */
+  status_t echo(
+    IADO_plugin * // ap_
+    , uint64_t // work_key_
+    , const std::vector<string_view> & args_
+    , const string_view // key_
+    , value_space_t & // values_
+    , response_buffer_vector_t & response_buffers_
+  )
+  {
+    ASSERT_TRUE(args_.size() == 3, "Echo: expected a time in milliseconds and a token");
+    const auto ms = std::stoul(std::string(args_[1].begin(), args_[1].size()));
+    usleep(useconds_t(ms * 1000));
+
+    const auto token = args_[2];
+    void * rb = malloc(token.size());
+    if ( rb == nullptr )
+    {
+      throw std::bad_alloc();
+    }
+    std::copy(token.begin(), token.end(), static_cast<char *>(rb));
+    response_buffers_.emplace_back(rb, token.size(), IADO_plugin::response_buffer_t::alloc_type_malloc{});
+    return S_OK;
+  }
+
   /* this gets run for ado-perf performance test */
   status_t other(
     IADO_plugin * // ap_
@@ -787,6 +1004,11 @@ status_t ADO_testing_plugin::do_work(uint64_t                     work_key,
     { "RUN!TEST-RepeatInvokeAdo", repeatInvokeAdo },
     { "RUN!TEST-BaseAddr", baseAddr },
     { "RUN!TEST-StressCallbacks", stressCallbacks },
+    { "RUN!TEST-TableOps", tableOps },
+    { "RUN!TEST-TableOpsAsync", tableOpsAsync },
+    { "RUN!TEST-TableOpsWait", tableOpsWait },
+    { "RUN!TEST-HoldKey", holdKey },
+    { "RUN!TEST-Echo", echo },
     { "ADO::Signal::post-erase", adoSignal },
     { "ADO::Signal::post-put", adoSignal },
     { "ADO::Signal::post-get", adoSignal },
@@ -44,6 +44,12 @@ boost::optional<std::string> Experiment::_log_file;
 
 namespace
 {
+  /* --shared_pool: the number of workers using each shared pool. The first
+   * to arrive replaces any existing pool; the others open it.
+   */
+  std::mutex shared_pool_lock;
+  std::map<std::string, unsigned> shared_pool_users;
+
   /* copied from nd_utils.h, which is not accessible to the build */
   std::size_t get_dax_device_size(const std::string& dax_path)
   {
@@ -123,6 +129,7 @@ Experiment::Experiment(std::string name_, const ProgramOptions &options)
   , _pool_path(options.path ? *options.path : "./data/")
   , _pool_name(options.pool_name)
   , _pool_name_local()
+  , _shared_pool(options.shared_pool)
   , _owner(options.owner)
   , _pool_size(options.size)
   , _pool_flags(options.flags)
@@ -414,11 +421,19 @@ try
 
   // initialize experiment
   auto core_index = _get_core_index(core);
-  std::string poolname = _pool_name + "." + std::to_string(core_index);
+  std::string poolname = _shared_pool ? _pool_name : _pool_name + "." + std::to_string(core_index);
   _pool_name_local = std::string(poolname);
   auto path = _pool_path + poolname;
 
-  if ( ! component_is("mcas") && boost::filesystem::exists(path)) {
+  std::unique_lock<std::mutex> shared_guard(shared_pool_lock, std::defer_lock);
+  bool first_user = true;
+  if ( _shared_pool )
+  {
+    shared_guard.lock();
+    first_user = shared_pool_users[poolname]++ == 0;
+  }
+
+  if ( first_user && ! component_is("mcas") && boost::filesystem::exists(path)) {
     bool might_be_dax = boost::filesystem::exists(path);
     try
     {
@@ -459,10 +474,14 @@ try
     }
   }
 
-  PLOG("Creating pool %s for worker %u ...", _pool_name_local.c_str(), core);
+  PLOG("%s pool %s for worker %u ...", first_user ? "Creating" : "Opening", _pool_name_local.c_str(), core);
   try
   {
-    _pool = _store->create_pool(_pool_path + _pool_name_local, _pool_size, _pool_flags, _pool_num_objects * HT_SIZE_FACTOR);
+    _pool =
+      first_user
+      ? _store->create_pool(_pool_path + _pool_name_local, _pool_size, _pool_flags, _pool_num_objects * HT_SIZE_FACTOR)
+      : _store->open_pool(_pool_path + _pool_name_local)
+      ;
     if ( _pool == component::IKVStore::POOL_ERROR )
     {
       PERR(PREFIX "create_pool failed");
@@ -486,6 +505,10 @@ try
   }
 
   PLOG("Created pool for worker %u...OK!", core);
+  if ( shared_guard.owns_lock() )
+  {
+    shared_guard.unlock();
+  }
 
   {
     std::lock_guard<std::mutex> g(g_write_lock);
@@ -643,6 +666,12 @@ try
         PERR(PREFIX "close_pool returned error code %d", rc);
         throw std::runtime_error("close_pool returned error code " + std::to_string(rc));
       }
+
+      if ( _shared_pool )
+      {
+        std::lock_guard<std::mutex> g(shared_pool_lock);
+        --shared_pool_users[_pool_name_local];
+      }
     }
     catch(...)
     {
@@ -35,6 +35,7 @@ private:
   std::string _pool_path;
   std::string _pool_name;
   std::string _pool_name_local;  // full pool name, e.g. "Exp.pool.0" for core 0
+  bool _shared_pool;  // one pool for all workers, named _pool_name
   std::string _owner;
   unsigned long long int _pool_size;
   std::uint32_t _pool_flags;
@@ -90,12 +90,21 @@ ProgramOptions::ProgramOptions(const boost::program_options::variables_map &vm_)
     , src_addr(vm_.count("src_addr") ? vm_["src_addr"].as<std::string>() : boost::optional<std::string>())
     , pci_addr(vm_.count("pci_addr") ? vm_["pci_addr"].as<std::string>() : boost::optional<std::string>())
     , log_file(vm_.count("log") ? vm_["log"].as<std::string>() : boost::optional<std::string>())
-    , random(vm_.count("random")) {
+    , random(vm_.count("random"))
+    , shared_pool(vm_.count("shared_pool")) {
   if ((component_is("pmstore") || component_is("hstore")) && !path) {
     auto e = "component '" + component + "' requires --path argument for persistent memory store";
     throw std::runtime_error(e);
   }
 
+  if (shared_pool && component_is("hstore")) {
+    throw std::runtime_error("--shared_pool is not supported by hstore, whose devices are per core");
+  }
+
+  if (shared_pool && insert_erase_pct != 0) {
+    throw std::runtime_error("--shared_pool requires --insert_erase_pct 0: workers would erase each other's keys");
+  }
+
   if (component_is("nvmestore") && !pci_addr) {
     auto e = "component '" + component + "' requires --pci_addr argument";
     throw std::runtime_error(e);
@@ -191,5 +200,7 @@ void ProgramOptions::add_program_options(boost::program_options::options_descrip
       ("duration", po::value<unsigned>(), "Throughput test duration, in seconds")
       ("report_interval", po::value<unsigned>()->default_value(5),
         "Throughput test report interval, in seconds. Default: 5")
-      ("random", "Generate random size of value up from 8 bytes to --value_length");
+      ("random", "Generate random size of value up from 8 bytes to --value_length")
+      ("shared_pool", "All workers use one pool, named by pool_name without a core suffix, to measure "
+        "scaling of a single pool across threads. Not for hstore.");
 }
@@ -54,6 +54,7 @@ class ProgramOptions {
   boost::optional<std::string>                           pci_addr;
   boost::optional<std::string>                           log_file;
   bool                                                   random;
+  bool                                                   shared_pool;
 
   ProgramOptions(const boost::program_options::variables_map &);
 
@@ -101,7 +101,6 @@ ADO_proxy::ADO_proxy(const uint64_t              auth_id,
   _ipc(std::make_unique<ADO_protocol_builder>(debug_level, _channel_name, ADO_protocol_builder::Role::CONNECT)),
   _core_number(cpu_num), _memory(memory), _numa(numa_zone), _deferred_unlocks(), _life_unlocks()
 {
-  (void) _core_number;  // unused
   (void) _memory;       // unused
   (void) _numa;         // unused
   assert(pool_id);
@@ -188,6 +187,11 @@ status_t ADO_proxy::send_table_op_response(const status_t             s,
   return _ipc->send_table_op_response(s, value_addr, value_len, key_ptr, key_handle);
 }
 
+status_t ADO_proxy::send_table_op_batch_response(const component::IADO_plugin::table_op_result_vector_t &results)
+{
+  return _ipc->send_table_op_batch_response(results);
+}
+
 status_t ADO_proxy::send_find_index_response(const status_t     status,
                                              const offset_t     matched_position,
                                              const std::string &matched_key)
@@ -241,6 +245,11 @@ bool ADO_proxy::check_table_ops(const void *       buffer,
                                      align_or_flags, addr);
 }
 
+bool ADO_proxy::check_table_op_batch(const void *buffer, component::IADO_plugin::table_op_vector_t &ops)
+{
+  return _ipc->recv_table_op_batch_request(static_cast<const Buffer_header *>(buffer), ops);
+}
+
 bool ADO_proxy::check_index_ops(const void * buffer,
                                 std::string &key_expression,
                                 offset_t &   begin_pos,
@@ -299,6 +308,11 @@ void ADO_proxy::free_callback_buffer(void *buffer)
   _ipc->free_ipc_buffer(buffer);
 }
 
+status_t ADO_proxy::wait_for_messages(unsigned timeout_us)
+{
+  return _ipc->wait_for_ado(timeout_us);
+}
+
 void ADO_proxy::child_exit(int, siginfo_t *, void *)
 {
   ADO_proxy::_exited = 1;
@@ -118,6 +118,8 @@ public:
 
   void free_callback_buffer(void * buffer) override;
 
+  status_t wait_for_messages(unsigned timeout_us) override;
+
   bool check_table_ops(const void * buffer,
                        uint64_t &work_request_id,
                        component::ADO_op &op,
@@ -126,6 +128,9 @@ public:
                        size_t &value_alignment,
                        void *& addr) override;
 
+  bool check_table_op_batch(const void * buffer,
+                            component::IADO_plugin::table_op_vector_t& ops) override;
+
   bool check_index_ops(const void * buffer,
                        std::string& key_expression,
                        offset_t& begin_pos,
@@ -157,6 +162,8 @@ public:
                                   const char * key_ptr = nullptr,
                                   component::IKVStore::key_t out_key_handle = nullptr) override;
 
+  status_t send_table_op_batch_response(const component::IADO_plugin::table_op_result_vector_t& results) override;
+
   status_t send_find_index_response(const status_t status,
                                     const offset_t matched_position,
                                     const std::string& matched_key) override;
@@ -440,6 +440,65 @@ public:
     size_t          _value_memory_size;
   } __attribute__((packed));
 
+  /**
+   * One operation of a table-op batch (see Callback_table::table_ops).
+   * Fields follow the corresponding single-operation callback.
+   */
+  struct table_op_t {
+    ADO_op      op;             /* CREATE, OPEN, ERASE, VALUE_RESIZE, ALLOCATE_POOL_MEMORY or FREE_POOL_MEMORY */
+    uint64_t    work_id;        /* CREATE, OPEN and VALUE_RESIZE */
+    std::string key;            /* empty for pool memory operations */
+    size_t      value_len;      /* value size, new value size or memory size */
+    uint64_t    align_or_flags; /* create/open flags, or alignment hint */
+    const void* addr;           /* FREE_POOL_MEMORY */
+
+    static table_op_t create(uint64_t work_id, const std::string& key, size_t value_size, int flags = 0)
+    {
+      return table_op_t{ADO_op::CREATE, work_id, key, value_size, uint64_t(flags), nullptr};
+    }
+
+    static table_op_t open(uint64_t work_id, const std::string& key, int flags = 0)
+    {
+      return table_op_t{ADO_op::OPEN, work_id, key, 0, uint64_t(flags), nullptr};
+    }
+
+    static table_op_t erase(const std::string& key)
+    {
+      return table_op_t{ADO_op::ERASE, 0, key, 0, 0, nullptr};
+    }
+
+    static table_op_t resize_value(uint64_t work_id, const std::string& key, size_t new_value_size)
+    {
+      return table_op_t{ADO_op::VALUE_RESIZE, work_id, key, new_value_size, 0, nullptr};
+    }
+
+    static table_op_t allocate_pool_memory(size_t size, size_t alignment_hint = 0)
+    {
+      return table_op_t{ADO_op::ALLOCATE_POOL_MEMORY, 0, std::string(), size, alignment_hint, nullptr};
+    }
+
+    static table_op_t free_pool_memory(size_t size, const void* addr)
+    {
+      return table_op_t{ADO_op::FREE_POOL_MEMORY, 0, std::string(), size, 0, addr};
+    }
+  };
+
+  /**
+   * Result of one table-op batch operation. Fields not produced by the
+   * operation are null or zero.
+   */
+  struct table_op_result_t {
+    status_t                   status;
+    void*                      value_addr; /* value, or allocated memory */
+    size_t                     value_len;
+    const char*                key_ptr;
+    component::IKVStore::key_t key_handle;
+  };
+
+  using table_op_vector_t        = std::vector<table_op_t>;
+  using table_op_result_vector_t = std::vector<table_op_result_t>;
+  using table_op_completion_t    = std::function<void(const table_op_result_vector_t& results)>;
+
   struct Callback_table {
     /**
      * Create a new key-value pair. Implicitly take a lock (default releases at
@@ -634,6 +693,44 @@ public:
      */
     std::function<status_t(const uint64_t option)>
     configure;
+
+    /**
+     * Perform a batch of table operations with a single round trip to
+     * the shard. Operations are performed in order; a failed operation
+     * does not stop the ones after it.
+     *
+     * @param ops Operations
+     * @param out_results [out] One result per operation, in order
+     *
+     * @return S_OK (per-operation status is in out_results)
+     */
+    std::function<status_t(const table_op_vector_t& ops,
+                           table_op_result_vector_t& out_results)>
+    table_ops;
+
+    /**
+     * Post a batch of table operations without waiting for the
+     * result. The completion is called, on the thread which made
+     * the callback, when the results arrive: at the latest by the next
+     * synchronous callback, call to table_ops_wait, or end of the
+     * current do_work. Batches complete in the order posted.
+     *
+     * @param ops Operations
+     * @param completion Function called with the results
+     *
+     * @return S_OK
+     */
+    std::function<status_t(const table_op_vector_t& ops,
+                           table_op_completion_t completion)>
+    table_ops_async;
+
+    /**
+     * Wait for all batches posted with table_ops_async to complete
+     *
+     * @return S_OK
+     */
+    std::function<status_t()>
+    table_ops_wait;
   };
 
   /**------------------------------------------------------------------------------
@@ -734,6 +831,21 @@ public:
     return _cb.configure(options);
   }
 
+  inline status_t cb_table_ops(const table_op_vector_t& ops, table_op_result_vector_t& out_results)
+  {
+    return _cb.table_ops(ops, out_results);
+  }
+
+  inline status_t cb_table_ops_async(const table_op_vector_t& ops, table_op_completion_t completion)
+  {
+    return _cb.table_ops_async(ops, completion);
+  }
+
+  inline status_t cb_table_ops_wait()
+  {
+    return _cb.table_ops_wait();
+  }
+
   /**
    * Register callbacks, so the plugin can perform KV-pair operations (sent to
    * shard to perform)
@@ -878,6 +990,15 @@ public:
    */
   virtual status_t recv_callback_buffer(Buffer_header*& out_buffer) = 0;
 
+  /**
+   * Block until the ADO process sends a work completion or callback
+   *
+   * @param timeout_us Time limit in microseconds
+   *
+   * @return S_OK if a message is waiting, E_TIMEOUT otherwise
+   */
+  virtual status_t wait_for_messages(unsigned timeout_us) = 0;
+
   /**
    * Free callback buffer
    *
@@ -905,6 +1026,16 @@ public:
                                size_t&            value_alignment,
                                void*&             addr) = 0;
 
+  /**
+   * Check for a batch of table operations
+   *
+   * @param buffer Message buffer
+   * @param ops [out] Operations, in order
+   *
+   * @return True if message interpreted as a table op batch
+   */
+  virtual bool check_table_op_batch(const void* buffer, IADO_plugin::table_op_vector_t& ops) = 0;
+
   /**
    * Check for index operations (e.g., find)
    *
@@ -1023,6 +1154,15 @@ public:
                                           const char*                key_ptr        = nullptr,
                                           component::IKVStore::key_t out_key_handle = nullptr) = 0;
 
+  /**
+   * Send response to ADO for a batch of table operations
+   *
+   * @param results One result per operation, in order
+   *
+   * @return S_OK or E_FULL
+   */
+  virtual status_t send_table_op_batch_response(const IADO_plugin::table_op_result_vector_t& results) = 0;
+
   /**
    * Send response to ADO for index operation
    *
@@ -666,6 +666,30 @@ class IFabric_server_factory : public IFabric_passive_endpoint {
    * @throw std::system_error : failure to listen for connections
    */
 	virtual IFabric_endpoint_unconnected_server *get_new_endpoint_unconnected() = 0;
+
+  /**
+   * Block until a new connection is pending or the timeout expires. Lets
+   * an idle server wait for clients without polling.
+   *
+   * @param timeout Maximum time to wait
+   *
+   * @throw std::system_error, e.g. for locking
+   */
+  virtual void wait_for_new_endpoint(std::chrono::milliseconds timeout) = 0;
+
+  /**
+   * Block until one of the connections has a new completion, a new
+   * connection is pending, or the timeout expires. Lets a server with
+   * several idle connections block on all of them at once. Completions
+   * already polled, and deferred, do not end the wait.
+   *
+   * @param connections Connections opened by this factory
+   * @param timeout Maximum time to wait
+   *
+   * @throw std::system_error, e.g. for locking or polling
+   */
+  virtual void wait_for_activity(const std::vector<IFabric_server *> &connections, std::chrono::milliseconds timeout) = 0;
+
 	virtual IFabric_server *open_connection(IFabric_endpoint_unconnected_server *) = 0;
 
   /**
@@ -716,6 +740,16 @@ class IFabric_server_grouped_factory : public IFabric_passive_endpoint {
    * @throw std::system_error : read error on event pipe
    */
 	virtual IFabric_endpoint_unconnected_server *get_new_endpoint_unconnected() = 0;
+
+  /**
+   * Block until a new connection is pending or the timeout expires.
+   *
+   * @param timeout Maximum time to wait
+   *
+   * @throw std::system_error, e.g. for locking
+   */
+  virtual void wait_for_new_endpoint(std::chrono::milliseconds timeout) = 0;
+
 	virtual IFabric_server_grouped *open_connection(IFabric_endpoint_unconnected_server *) = 0;
 
   /**
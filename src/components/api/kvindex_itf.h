@@ -39,14 +39,15 @@ class IKVIndex : public component::IBase {
     FIND_TYPE_NEXT   = 0x1, /*< just get the next key in order */
     FIND_TYPE_EXACT  = 0x2, /*< perform exact match comparison on key */
     FIND_TYPE_REGEX  = 0x3, /*< apply as regular expression */
-    FIND_TYPE_PREFIX = 0x4, /*< match prefix only */
+    FIND_TYPE_PREFIX = 0x4, /*< match prefix only (ordered range scan) */
+    FIND_TYPE_SUBSTRING = 0x5, /*< match substring anywhere in key (full scan) */
   } find_t;
 
   inline static find_t convert_find_type(int i)
   {
-    static const find_t array[] = {FIND_TYPE_NONE, FIND_TYPE_NEXT, FIND_TYPE_EXACT, FIND_TYPE_REGEX, FIND_TYPE_PREFIX};
+    static const find_t array[] = {FIND_TYPE_NONE, FIND_TYPE_NEXT, FIND_TYPE_EXACT, FIND_TYPE_REGEX, FIND_TYPE_PREFIX, FIND_TYPE_SUBSTRING};
     assert(i > 0);
-    if (i > 4) throw API_exception("out of enum bounds");
+    if (i > 5) throw API_exception("out of enum bounds");
     return array[i];
   }
 
@@ -107,7 +108,7 @@ class IKVIndex : public component::IBase {
    *
    * @param key_expression Key expression to match on
    * @param begin_position Position from which to start from. Counting from 0.
-   * @param find_type FIND_TYPE_NEXT, ..EXACT, ..REGEX, ..PREFIX
+   * @param find_type FIND_TYPE_NEXT, ..EXACT, ..REGEX, ..PREFIX, ..SUBSTRING
    * @param out_matched_position [out] Position of the match
    * @param out_matched_key Matching key result
    * @param max_comparisons Maximum number of comparisons
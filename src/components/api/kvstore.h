@@ -130,6 +130,8 @@ protected:
                                      written or locked with STORE_LOCK_WRITE */
     MEMORY_TYPE              = 7, /* type of memory */
     MEMORY_SIZE              = 8, /* size of pool or store in bytes */
+    WRITE_TIME_INDEX         = 9, /* set non-zero to keep a time-ordered index of writes,
+                                     so that time-range map() visits only matching entries */
   };
 
   enum {
@@ -686,6 +688,11 @@ protected:
   /**
    * Apply functor to all objects in the pool
    *
+   * The functor may run while the store holds locks on the pool's index,
+   * so it must not modify the pool (put, erase, resize, or take a write
+   * lock); such calls may deadlock. The key and value pointers are valid
+   * only for the duration of the call.
+   *
    * @param pool Pool handle
    * @param function Functor to apply
    *
@@ -706,7 +713,8 @@ protected:
    *
    * @param pool Pool handle
    * @param function Functor to apply (not in time order). If
-   *                 functor returns < 0, then map aborts
+   *                 functor returns < 0, then map aborts. As for the
+   *                 untimed map, it must not modify the pool.
    * @param t_begin Time must be after or equal. If set to zero, no constraint.
    * @param t_end Time must be before or equal. If set to zero, no constraint.
    *
@@ -726,6 +734,8 @@ protected:
 
   /**
    * Apply functor to all keys only. Useful for file_store (now deprecated)
+   * The restriction on modifying the pool from map applies here too,
+   * unless the implementation says otherwise.
    *
    * @param pool Pool handle
    * @param function Functor
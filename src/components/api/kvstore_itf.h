@@ -84,6 +84,12 @@ class IKVStore_factory : public component::IBase {
   static constexpr const char *k_mm_plugin_path = "mm_plugin_path";
   static constexpr const char *k_dax_base = "dax_base";
   static constexpr const char *k_dax_size = "dax_size";
+  /* hstore: senior hash buckets migrated per update in an incremental resize (0: resize at once) */
+  static constexpr const char *k_resize_step = "resize_step";
+  /* hstore: threads which scan the table for allocations at pool open (default 1) */
+  static constexpr const char *k_reconstitute_threads = "reconstitute_threads";
+  /* hstore: if nonzero, reconstitute allocations at pool open in the background */
+  static constexpr const char *k_reconstitute_lazy = "reconstitute_lazy";
 
   /* this is the preferred create method - the others will be deprecated */
   virtual IKVStore* create(unsigned debug_level, const map_create& params)
@@ -26,6 +26,9 @@
 #include <array>
 #include <cstdint> /* uint16_t */
 #include <memory>
+#include <string>
+#include <utility> /* pair */
+#include <vector>
 
 #define DECLARE_OPAQUE_TYPE(NAME)               \
   struct Opaque_##NAME {                        \
@@ -48,8 +51,10 @@ public:
 
 public:
   DECLARE_OPAQUE_TYPE(async_handle);
+  DECLARE_OPAQUE_TYPE(borrowed_value);
 
   using async_handle_t  = Opaque_async_handle*;
+  using borrowed_value_t = Opaque_borrowed_value*;
   using pool_t          = component::KVStore::pool_t;
   using key_t           = KVStore::key_t;
   using Attribute       = KVStore::Attribute;
@@ -160,6 +165,61 @@ public:
    */
   virtual status_t configure_pool(const pool_t pool, const std::string& setting) = 0;
 
+  /**
+   * Asynchronous create_pool.  Use check_async_completion or
+   * poll_completions to check for completion.
+   *
+   * @param name Name of pool
+   * @param size Size of pool in bytes
+   * @param flags Creation flags
+   * @param expected_obj_count Expected maximum object count
+   * @param out_pool Out pool handle, set on completion (must outlive the operation)
+   * @param out_handle Async work handle
+   *
+   * @return S_OK or other error code
+   */
+  virtual status_t async_create_pool(const std::string& name,
+                                     const size_t       size,
+                                     const flags_t      flags,
+                                     const uint64_t     expected_obj_count,
+                                     pool_t&            out_pool,
+                                     async_handle_t&    out_handle) = 0;
+
+  /**
+   * Asynchronous open_pool.
+   *
+   * @param name Name of pool
+   * @param flags Open flags
+   * @param out_pool Out pool handle, set on completion (must outlive the operation)
+   * @param out_handle Async work handle
+   *
+   * @return S_OK or other error code
+   */
+  virtual status_t async_open_pool(const std::string& name,
+                                   const flags_t      flags,
+                                   pool_t&            out_pool,
+                                   async_handle_t&    out_handle) = 0;
+
+  /**
+   * Asynchronous close_pool.
+   *
+   * @param pool Pool handle
+   * @param out_handle Async work handle
+   *
+   * @return S_OK or other error code
+   */
+  virtual status_t async_close_pool(const pool_t pool, async_handle_t& out_handle) = 0;
+
+  /**
+   * Asynchronous delete_pool (by name).
+   *
+   * @param name Name of pool
+   * @param out_handle Async work handle
+   *
+   * @return S_OK or other error code
+   */
+  virtual status_t async_delete_pool(const std::string& name, async_handle_t& out_handle) = 0;
+
   using KVStore::put;
 
   virtual status_t put(const pool_t pool,
@@ -277,6 +337,107 @@ public:
     return s;
   }
 
+  /**
+   * Read a value which fits in a single message into client-provided
+   * memory. The response is received straight into the buffer, so the
+   * value is neither allocated nor copied on the client.
+   *
+   * @param pool Pool handle
+   * @param key Object key
+   * @param out_value Client provided buffer for value
+   * @param inout_value_len [in] size of buffer [out] size of value
+   * @param handle Memory registration handle for out_value
+   *
+   * @return S_OK, E_INSUFFICIENT_SPACE if the buffer is too small
+   * (inout_value_len is set to the value size), E_TOO_LARGE if the value
+   * needs get_direct, or other error code
+   */
+  virtual status_t get(const IMCAS::pool_t          pool,
+                       const std::string&           key,
+                       void*                        out_value,
+                       size_t&                      inout_value_len,
+                       const IMCAS::memory_handle_t handle) = 0;
+
+  /**
+   * Read a value which fits in a single message, leaving it in the
+   * receive buffer. The value remains valid until release_borrowed is
+   * called. Each outstanding borrow holds one of the connection's
+   * receive buffers, so borrows should be short-lived, and all must be
+   * released before the client is destroyed.
+   *
+   * @param pool Pool handle
+   * @param key Object key
+   * @param out_value Out pointer to value
+   * @param out_value_len Out size of value
+   * @param out_borrow Out borrow handle, set only on success
+   *
+   * @return S_OK or other error code
+   */
+  virtual status_t get_borrowed(const IMCAS::pool_t pool,
+                                const std::string&  key,
+                                const void*&        out_value,
+                                size_t&             out_value_len,
+                                borrowed_value_t&   out_borrow) = 0;
+
+  /**
+   * Release a value obtained with get_borrowed
+   *
+   * @param borrow Borrow handle
+   *
+   * @return S_OK or E_INVAL
+   */
+  virtual status_t release_borrowed(borrowed_value_t borrow) = 0;
+
+  /**
+   * Asynchronous get of a value which fits in a single message; use
+   * async_get_direct for larger values.
+   *
+   * @param pool Pool handle
+   * @param key Object key
+   * @param out_value Out value, set on completion (must outlive the operation)
+   * @param out_handle Async work handle
+   *
+   * @return S_OK or other error code
+   */
+  virtual status_t async_get(const IMCAS::pool_t pool,
+                             const std::string&  key,
+                             std::string&        out_value,
+                             async_handle_t&     out_handle) = 0;
+
+  /**
+   * Read many (small) values, packing the keys into as few messages as
+   * possible. Values too large to share a message are fetched with get.
+   *
+   * @param pool Pool handle
+   * @param keys Object keys
+   * @param out_values Out values, one per key
+   * @param out_status Out per-key status (S_OK, E_KEY_NOT_FOUND etc.)
+   *
+   * @return S_OK if all requests were issued, otherwise an error code
+   */
+  virtual status_t get_many(const IMCAS::pool_t             pool,
+                            const std::vector<std::string>& keys,
+                            std::vector<std::string>&       out_values,
+                            std::vector<status_t>&          out_status) = 0;
+
+  /**
+   * Write many (small) key-value pairs, packing them into as few
+   * messages as possible.
+   *
+   * @param pool Pool handle
+   * @param keys Object keys
+   * @param values Values, one per key
+   * @param out_status Out per-key status
+   * @param flags Optional flags (applied to every pair)
+   *
+   * @return S_OK if all requests were issued, otherwise an error code
+   */
+  virtual status_t put_many(const IMCAS::pool_t             pool,
+                            const std::vector<std::string>& keys,
+                            const std::vector<std::string>& values,
+                            std::vector<status_t>&          out_status,
+                            const unsigned int              flags = IMCAS::FLAGS_NONE) = 0;
+
   /**
    * Asynchronously read an object value directly into client-provided memory.
    *
@@ -357,10 +518,38 @@ public:
   virtual status_t check_async_completion(async_handle_t& handle) = 0;
 
   /**
-   * Perform key search based on regex or prefix
+   * Collect completed asynchronous operations. Only operations for which
+   * the network has reported progress are examined, so the cost follows
+   * the number of completions rather than the number of outstanding
+   * handles. Collected handles are released, as by
+   * check_async_completion, and serve only to identify the operation.
+   *
+   * @param max Maximum number of completions to collect
+   * @param out_handles Out handles of completed operations (at least max entries)
+   * @param out_status Out status of each completed operation (at least max entries)
+   *
+   * @return Number of completions collected
+   */
+  virtual size_t poll_completions(const size_t max, async_handle_t out_handles[], status_t out_status[]) = 0;
+
+  /**
+   * Get an eventfd which becomes readable when poll_completions has
+   * completions to collect, for use in epoll or io_uring event loops.
+   * Read the eventfd to reset it before calling poll_completions. The
+   * first call starts a thread which watches for completions. The
+   * descriptor belongs to the client and must not be closed.
+   *
+   * @return File descriptor, or -1 on error
+   */
+  virtual int async_completion_fd() = 0;
+
+  /**
+   * Perform key search based on regex, prefix or substring
    *
    * @param pool Pool handle
-   * @param key_expression Regular expression or prefix (e.g. "prefix:carKey")
+   * @param key_expression Expression, one of "next:", "exact:<key>", "regex:<re>",
+   *                       "prefix:<prefix>" (ordered range scan) or
+   *                       "substr:<str>" (full scan), e.g. "prefix:carKey"
    * @param offset Offset from which to search
    * @param out_matched_offset Out offset of match
    * @param out_keys Out vector of matching keys
@@ -373,6 +562,45 @@ public:
                         offset_t&           out_matched_offset,
                         std::string&        out_matched_key) = 0;
 
+  /**
+   * Asynchronous find.
+   *
+   * @param pool Pool handle
+   * @param key_expression Expression (see find)
+   * @param offset Offset from which to search
+   * @param out_matched_offset Out offset of match, set on completion
+   * @param out_matched_key Out matching key, set on completion
+   * @param out_handle Async work handle
+   *
+   * @return S_OK or other error code
+   */
+  virtual status_t async_find(const IMCAS::pool_t pool,
+                              const std::string&  key_expression,
+                              const offset_t      offset,
+                              offset_t&           out_matched_offset,
+                              std::string&        out_matched_key,
+                              async_handle_t&     out_handle) = 0;
+
+  /**
+   * Perform batched key search, returning as many matches as fit in a
+   * single response
+   *
+   * @param pool Pool handle
+   * @param key_expression Expression (see find)
+   * @param offset Offset from which to search
+   * @param max_count Maximum number of matches to return
+   * @param out_next_offset Out offset from which to resume the search
+   * @param out_matches Out vector of (offset, key) matches
+   *
+   * @return S_OK on success, E_FAIL if there are no (more) matches
+   */
+  virtual status_t find_keys(const IMCAS::pool_t                             pool,
+                             const std::string&                              key_expression,
+                             const offset_t                                  offset,
+                             const size_t                                    max_count,
+                             offset_t&                                       out_next_offset,
+                             std::vector<std::pair<offset_t, std::string>>& out_matches) = 0;
+
   /**
    * Erase an object asynchronously
    *
@@ -393,6 +621,23 @@ public:
    */
   virtual status_t get_statistics(Shard_stats& out_stats) = 0;
 
+  /**
+   * Asynchronous get_attribute.
+   *
+   * @param pool Pool handle
+   * @param attr Attribute to retrieve
+   * @param out_value Out vector of attribute values, set on completion
+   * @param key Optional key (must outlive the call only)
+   * @param out_handle Async work handle
+   *
+   * @return S_OK or other error code
+   */
+  virtual status_t async_get_attribute(const IMCAS::pool_t    pool,
+                                       const Attribute        attr,
+                                       std::vector<uint64_t>& out_value,
+                                       const std::string*     key,
+                                       async_handle_t&        out_handle) = 0;
+
   /**
    * ADO_response data structure manages response data sent back from the ADO
    * invocations.  The free function is so we can eventually support zero-copy.
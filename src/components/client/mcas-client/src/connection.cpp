@@ -20,12 +20,14 @@
 #include <common/cycles.h>
 #include <common/delete_copy.h>
 #include <common/utils.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 
+#include <algorithm> /* sort, unique */
 #include <cstdlib>
 #include <iostream>
 #include <memory>
-#include <numeric> /* accumulate */
+#include <numeric> /* accumulate, iota */
 
 
 #include <rapidjson/error/en.h>
@@ -40,6 +42,10 @@
 
 static constexpr const unsigned TLS_DEBUG_LEVEL = 3;
 
+/* longest wait for a completion by the async_completion_fd notifier: a
+   nudge or exit which arrives just before its wait begins is seen late */
+static constexpr const unsigned NOTIFY_WAIT_MS = 1000;
+
 /* environment variables */
 static constexpr const char* ENVIRONMENT_VARIABLE_CERT = "CERT";
 static constexpr const char* ENVIRONMENT_VARIABLE_KEY = "KEY";
@@ -93,6 +99,7 @@ private:
 public:
   iob_free(Connection_handler *h_) : _h(h_) {}
   void operator()(Connection_handler::buffer_t *iob) { _h->free_buffer(iob); }
+  Connection_handler *owner() const { return _h; }
 };
 
 struct memory_registered {
@@ -168,12 +175,22 @@ protected:
   iob_ptr        iobs;
   iob_ptr        iobr;
 
-  async_buffer_set_t(unsigned debug_level_, iob_ptr &&iobs_, iob_ptr &&iobr_) noexcept
+private:
+  Connection_handler *      _owner;   /* keeps the completion queue */
+  std::vector<const void *> _watched; /* contexts registered by watch */
+
+protected:
+  async_buffer_set_t(unsigned debug_level_, iob_ptr &&iobs_, iob_ptr &&iobr_)
     : component::IMCAS::Opaque_async_handle{},
       common::log_source(debug_level_),
       iobs(std::move(iobs_)),
-      iobr(std::move(iobr_))
+      iobr(std::move(iobr_)),
+      _owner(iobr.get_deleter().owner()),
+      _watched()
   {
+    _owner->async_handle_opened(this);
+    watch(iobs);
+    watch(iobr);
     CPLOG(2, "%s iobs %p iobr %p"
           , __func__
           , common::p_fmt(&*iobs)
@@ -181,17 +198,31 @@ protected:
           );
   }
 
+  /* direct completions of postings with this buffer as context to this
+     handle; see Connection_handler::poll_completions */
+  void watch(const iob_ptr &iob)
+  {
+    if (iob) {
+      _owner->async_watch(&*iob, this);
+      _watched.push_back(&*iob);
+    }
+  }
+
   async_buffer_set_t()                           = delete;
   DELETE_COPY(async_buffer_set_t);
 
 public:
-  virtual ~async_buffer_set_t() {}
+  virtual ~async_buffer_set_t()
+  {
+    for (auto w : _watched) _owner->async_unwatch(w, this);
+    _owner->async_handle_closed(this);
+  }
   virtual int move_along(Connection_handler *c) = 0;
 };
 
 /* Nothing more than the two buffers. Used for async erase */
 struct async_buffer_set_simple : public async_buffer_set_t {
-  async_buffer_set_simple(unsigned debug_level_, iob_ptr &&iobs_, iob_ptr &&iobr_) noexcept
+  async_buffer_set_simple(unsigned debug_level_, iob_ptr &&iobs_, iob_ptr &&iobr_)
     : async_buffer_set_t(debug_level_, std::move(iobs_), std::move(iobr_))
   {
   }
@@ -221,6 +252,42 @@ struct async_buffer_set_simple : public async_buffer_set_t {
   }
 };
 
+/* Two buffers and a function to unpack the response. Used for async get,
+   find, get_attribute and pool operations */
+struct async_buffer_set_decode : public async_buffer_set_t {
+private:
+  Connection_handler::async_decode_t _decode;
+
+public:
+  async_buffer_set_decode(unsigned debug_level_, iob_ptr &&iobs_, iob_ptr &&iobr_, Connection_handler::async_decode_t &&decode_)
+    : async_buffer_set_t(debug_level_, std::move(iobs_), std::move(iobr_)),
+      _decode(std::move(decode_))
+  {
+  }
+  DELETE_COPY(async_buffer_set_decode);
+  int move_along(Connection_handler *c) override
+  {
+    if (iobs) { /* check submission, clear and free on completion */
+      if (c->test_completion(&*iobs) == false) {
+        return E_BUSY;
+      }
+      iobs.reset(nullptr);
+    }
+
+    if (iobr) { /* check recv, clear and free on completion */
+      if (c->test_completion(&*iobr) == false) {
+        return E_BUSY;
+      }
+      auto status = _decode(c, &*iobr);
+      iobr.reset(nullptr);
+      return status;
+    }
+    else {
+      throw API_exception("invalid async handle, task already completed?");
+    }
+  }
+};
+
 struct async_buffer_set_get_locate
   : public async_buffer_set_t
   , public memory_registered {
@@ -264,6 +331,7 @@ public:
     _v{::iovec{_value, _value_len}},
     _addr(addr_)
   {
+    watch(_iobrd);
     TM_SCOPE()
     CPLOG(2, "%s: iobrd %p iobs2 %p iobr2 %p"
           , __func__
@@ -391,6 +459,8 @@ public:
 	, _v()
     , _addr{}
   {
+    watch(_iobrd);
+    watch(_iobr2);
     _v.reserve(values_.size());
     _desc.reserve(values_.size());
     CPLOG(2, "%s: iobrd %p iobs2 %p iobr2 %p"
@@ -580,6 +650,7 @@ public:
     _addr_list{},
     _addr_cursor{}
   {
+    watch(_iobr2);
     CPLOG(2, "%s iobs2 %p iobr2 %p"
           , __func__
           , common::p_fmt(&*_iobs2)
@@ -646,6 +717,7 @@ public:
       }
 
       _iobrd = c->make_iob_ptr_read();
+      watch(_iobrd);
       CPLOG(2, "%s iobrd %p"
             , __func__
             , common::p_fmt(&*_iobrd)
@@ -764,6 +836,7 @@ public:
     _addr_list{},
     _addr_cursor{}
   {
+    watch(_iobr2);
     CPLOG(2, "%s iobs2 %p iobr2 %p"
           , __func__
           , common::p_fmt(&*_iobs2)
@@ -832,6 +905,7 @@ public:
       }
 
       _iobrd = c->make_iob_ptr_write();
+      watch(_iobrd);
       CPLOG(2, "%s iobrd %p"
             , __func__
             , common::p_fmt(&*_iobrd)
@@ -906,8 +980,24 @@ Connection_handler::Connection_handler(const unsigned              debug_level,
 #ifdef THREAD_SAFE_CLIENT
     _api_lock{},
 #endif
+    _window_lock{},
+    _window_cv{},
+    _in_flight{0},
+    _async_outstanding{0},
+    _transport_lock{},
+    _routed{},
+    _arrived{},
     _exit{false},
     _request_id{0},
+    _async_handles{},
+    _async_watch{},
+    _completion_fd(-1),
+    _notify_lock{},
+    _notify_cv{},
+    _notify_armed(true),
+    _notify_exit(false),
+    _notify_nudged(false),
+    _notifier{},
     _max_message_size{0},
     _max_inject_size(connection->max_inject_size()),
     _options()
@@ -943,6 +1033,12 @@ Connection_handler::Connection_handler(const unsigned              debug_level,
           _options.tls = true;
         }
       }
+
+      /* pipeline: several threads may have requests in flight at once */
+      auto pipeline = doc.FindMember("pipeline");
+      if(pipeline != doc.MemberEnd() && pipeline->value.IsBool()) {
+        _options.pipeline = pipeline->value.GetBool();
+      }
     }
     catch (...) {
       throw API_exception("extra configuration string parse failed");
@@ -954,6 +1050,148 @@ Connection_handler::Connection_handler(const unsigned              debug_level,
 Connection_handler::~Connection_handler()
 {
   PLOG("%s: (%p)", __func__, common::p_fmt(this));
+  if (_notifier.joinable()) {
+    {
+      std::lock_guard<std::mutex> g(_notify_lock);
+      _notify_exit = true;
+    }
+    _notify_cv.notify_one();
+    _transport->unblock_completions();
+    _notifier.join();
+  }
+  if (_completion_fd != -1) ::close(_completion_fd);
+
+  /* left behind by pipelined requests which failed */
+  for (auto iob : _routed) free_buffer(iob);
+  for (auto &a : _arrived) free_buffer(a.second);
+}
+
+#ifdef THREAD_SAFE_CLIENT
+Connection_handler::pipeline_slot::pipeline_slot(Connection_handler *h_, const bool pipelined_)
+  : _h(h_),
+    _exclusive(!(pipelined_ && h_->_options.pipeline))
+{
+  if (!_exclusive) {
+    _h->_api_lock.lock_shared();
+    /* handles are opened under the exclusive lock, so the count is stable while shared */
+    if (_h->_async_outstanding == 0) {
+      std::unique_lock<std::mutex> g(_h->_window_lock);
+      _h->_window_cv.wait(g, [this] { return _h->_in_flight < PIPELINE_WINDOW; });
+      ++_h->_in_flight;
+      return;
+    }
+    _h->_api_lock.unlock_shared();
+    _exclusive = true;
+  }
+  _h->_api_lock.lock();
+}
+
+Connection_handler::pipeline_slot::~pipeline_slot()
+{
+  if (_exclusive) {
+    _h->api_unlock();
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> g(_h->_window_lock);
+    --_h->_in_flight;
+  }
+  _h->_window_cv.notify_one();
+  _h->_api_lock.unlock_shared();
+}
+
+void Connection_handler::api_unlock()
+{
+  /* the async handle set, and so the count, is stable under the lock */
+  if (_completion_fd != -1 && _async_outstanding != 0) {
+    bool nudge;
+    {
+      std::lock_guard<std::mutex> g(_notify_lock);
+      /* once signalled, the notifier waits for poll_completions */
+      nudge = _notify_armed;
+      _notify_nudged = true;
+    }
+    if (nudge) {
+      try {
+        _transport->unblock_completions();
+      }
+      catch (const std::exception &e) {
+        PWRN("%s: %s", __func__, e.what());
+      }
+    }
+  }
+  _api_lock.unlock();
+}
+#endif
+
+component::IFabric_op_completer::cb_acceptance Connection_handler::route_completion(void *        context,
+                                                                                   status_t      st,
+                                                                                   std::uint64_t completion_flags,
+                                                                                   std::size_t,  // len
+                                                                                   void *,       // error_data
+                                                                                   void *        param)
+{
+  const auto h   = static_cast<Connection_handler *>(param);
+  const auto iob = static_cast<buffer_t *>(context);
+
+  /* not a pipelined receive: leave it for its owner */
+  if (h->_routed.erase(iob) == 0) return component::IFabric_op_completer::cb_acceptance::DEFER;
+
+  if (UNLIKELY(st != S_OK)) {
+    PWRN("%s: receive failed (context=%p) (st=%d) (cf=%lx)", __func__, context, st, completion_flags);
+    h->free_buffer(iob);
+    return component::IFabric_op_completer::cb_acceptance::ACCEPT;
+  }
+
+  const auto msg = mcas::protocol::message_cast(iob->base());
+  switch (msg->type_id()) {
+  case mcas::protocol::MSG_TYPE::IO_RESPONSE:
+    h->_arrived.emplace(msg->ptr_cast<mcas::protocol::Message_IO_response>()->request_id(), iob);
+    break;
+  case mcas::protocol::MSG_TYPE::ADO_RESPONSE:
+    h->_arrived.emplace(msg->ptr_cast<mcas::protocol::Message_ado_response>()->request_id(), iob);
+    break;
+  default:
+    PWRN("%s: unexpected message type 0x%x", __func__, int(msg->type_id()));
+    h->free_buffer(iob);
+    break;
+  }
+  return component::IFabric_op_completer::cb_acceptance::ACCEPT;
+}
+
+template <typename MT>
+auto Connection_handler::sync_exchange(buffer_t *iobs_, const MT *msg_, const char *desc_) -> iob_ptr
+{
+  const auto request_id = msg_->request_id();
+
+  {
+    auto iobr = make_iob_ptr_recv();
+    std::lock_guard<std::mutex> g(_transport_lock);
+    post_recv(&*iobr);
+    _routed.insert(iobr.release());
+    sync_inject_send(iobs_, msg_, iobs_->length(), desc_);
+  }
+
+  const auto start_time = rdtsc();
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> g(_transport_lock);
+      const auto it = _arrived.find(request_id);
+      if (it != _arrived.end()) {
+        iob_ptr iobr(it->second, this);
+        _arrived.erase(it);
+        return iobr;
+      }
+      _transport->poll_completions_tentative(route_completion, this);
+    }
+
+    if (_patience < static_cast<double>(rdtsc() - start_time) / cycles_per_second) {
+      /* the receive stays posted and would take the next response: stop using the connection */
+      set_failed();
+      throw Program_exception("time out: waited %u seconds for response to request %" PRIu64, _patience, request_id);
+    }
+  }
 }
 
 void Connection_handler::send_complete(void *param, buffer_t *iob)
@@ -1253,10 +1491,9 @@ status_t Connection_handler::put(const pool_t       pool,
                                  const unsigned int flags)
 {
   TM_ROOT();
-  API_LOCK();
+  PIPELINE_LOCK();
 
   const auto iobs = make_iob_ptr_send();
-  const auto iobr = make_iob_ptr_recv();
 
   if (debug_level() > 1)
     PINF("put: %.*s (key_len=%lu) (value_len=%lu)", int(key_len), static_cast<const char *>(key), key_len, value_len);
@@ -1279,11 +1516,10 @@ status_t Connection_handler::put(const pool_t       pool,
 
     iobs->set_length(msg->msg_len());
 
-    post_recv(&*iobr);
-    sync_send(&*iobs, msg, __func__); /* this will clean up iobs */
+    iob_ptr iobr(nullptr, this);
     {
       TM_SCOPE(wait_recv)
-      wait_for_completion(&*iobr);
+      iobr = sync_exchange(&*iobs, msg, __func__);
     }
 
     const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
@@ -1767,10 +2003,188 @@ status_t Connection_handler::check_async_completion(IMCAS::async_handle_t &handl
   return status;
 }
 
+void Connection_handler::async_handle_opened(async_buffer_set_t *h)
+{
+  _async_handles.insert(h);
+  ++_async_outstanding;
+  if (_completion_fd != -1) {
+    { std::lock_guard<std::mutex> g(_notify_lock); }
+    _notify_cv.notify_one();
+  }
+}
+
+void Connection_handler::async_handle_closed(async_buffer_set_t *h)
+{
+  _async_handles.erase(h);
+  --_async_outstanding;
+}
+
+namespace
+{
+struct completion_notes {
+  Connection_handler *               h;
+  std::vector<async_buffer_set_t *> ready;
+  bool                               unknown;
+};
+}  // namespace
+
+component::IFabric_op_completer::cb_acceptance Connection_handler::note_completion(void *context,
+                                                                                  status_t,     // st
+                                                                                  std::uint64_t,  // completion_flags
+                                                                                  std::size_t,  // len
+                                                                                  void *,       // error_data
+                                                                                  void *param)
+{
+  const auto notes = static_cast<completion_notes *>(param);
+  const auto it    = notes->h->_async_watch.find(context);
+  if (it == notes->h->_async_watch.end())
+    notes->unknown = true;
+  else
+    notes->ready.push_back(it->second);
+
+  /* leave the completion for the handle's move_along */
+  return component::IFabric_op_completer::cb_acceptance::DEFER;
+}
+
+auto Connection_handler::ready_async_handles() -> std::vector<async_buffer_set_t *>
+{
+  completion_notes notes{this, {}, false};
+  _transport->poll_completions_tentative(note_completion, &notes);
+
+  if (notes.unknown) {
+    /* a posting which no handle watches: examine every handle */
+    return std::vector<async_buffer_set_t *>(_async_handles.begin(), _async_handles.end());
+  }
+
+  std::sort(notes.ready.begin(), notes.ready.end());
+  notes.ready.erase(std::unique(notes.ready.begin(), notes.ready.end()), notes.ready.end());
+  return notes.ready;
+}
+
+std::size_t Connection_handler::poll_completions(const std::size_t     max,
+                                                 IMCAS::async_handle_t out_handles[],
+                                                 status_t              out_status[])
+{
+  API_LOCK();
+
+  std::size_t count   = 0;
+  bool        pending = false;
+
+  if (max != 0 && !_async_handles.empty()) {
+    for (auto bptrs : ready_async_handles()) {
+      if (count == max) {
+        pending = true;
+        break;
+      }
+
+      int status;
+      try {
+        status = bptrs->move_along(this);
+      }
+      catch (const Exception &e) {
+        PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+        status = E_FAIL;
+      }
+      catch (const std::exception &e) {
+        PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+        status = E_FAIL;
+      }
+
+      if (status != E_BUSY) {
+        out_handles[count] = bptrs;
+        out_status[count]  = status;
+        ++count;
+        delete bptrs;
+      }
+    }
+  }
+
+  if (_completion_fd != -1) {
+    std::lock_guard<std::mutex> g(_notify_lock);
+    /* completions left behind are already in hand: signal at once */
+    if (pending)
+      ::eventfd_write(_completion_fd, 1);
+    else
+      _notify_armed = true;
+    _notify_cv.notify_one();
+  }
+
+  return count;
+}
+
+int Connection_handler::async_completion_fd()
+{
+  API_LOCK();
+
+  if (_completion_fd == -1) {
+    const auto fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd == -1) {
+      PWRN("%s: eventfd failed (%s)", __func__, ::strerror(errno));
+      return -1;
+    }
+
+    _completion_fd = fd;
+    try {
+      _notifier = std::thread(&Connection_handler::notify_completions, this);
+    }
+    catch (const std::system_error &e) {
+      PWRN("%s: notifier thread failed (%s)", __func__, e.what());
+      ::close(fd);
+      _completion_fd = -1;
+    }
+  }
+
+  return _completion_fd;
+}
+
+void Connection_handler::notify_completions()
+{
+  std::unique_lock<std::mutex> g(_notify_lock);
+  while (!_notify_exit) {
+    /* after a signal, wait for poll_completions to re-arm */
+    if (!_notify_armed || _async_outstanding == 0) {
+      _notify_cv.wait(g);
+      continue;
+    }
+    _notify_nudged = false;
+    g.unlock();
+
+    bool ready = false;
+    try {
+      /* not API_LOCK, whose release would nudge this thread */
+      std::lock_guard<std::shared_timed_mutex> a(_api_lock);
+      ready = !ready_async_handles().empty();
+    }
+    catch (const std::exception &e) {
+      PWRN("%s: %s", __func__, e.what());
+    }
+
+    g.lock();
+    if (ready) {
+      if (_notify_armed) {
+        _notify_armed = false;
+        ::eventfd_write(_completion_fd, 1);
+      }
+      continue;
+    }
+    /* a nudge since the look above means completions may have been polled away */
+    if (_notify_nudged || _notify_exit) continue;
+    g.unlock();
+
+    try {
+      _transport->wait_for_next_completion(std::chrono::milliseconds(NOTIFY_WAIT_MS));
+    }
+    catch (const std::exception &e) {
+      PWRN("%s: %s", __func__, e.what());
+    }
+    g.lock();
+  }
+}
+
 status_t Connection_handler::get(const pool_t pool, const std::string &key, std::string &value)
 {
   TM_ROOT()
-  API_LOCK();
+  PIPELINE_LOCK();
 
   if (debug_level() > 1) {
     auto key_len = key.length();
@@ -1778,9 +2192,7 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
   }
 
   const auto iobs = make_iob_ptr_send();
-  const auto iobr = make_iob_ptr_recv();
   assert(iobs);
-  assert(iobr);
 
   status_t status;
 
@@ -1792,9 +2204,8 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
 
     if (_options.short_circuit_backend) msg->add_scbe();
 
-    post_recv(&*iobr);
-    sync_inject_send(&*iobs, msg, __func__);
-    wait_for_completion(&*iobr);
+    iobs->set_length(msg->msg_len());
+    const auto iobr = sync_exchange(&*iobs, msg, __func__);
 
     const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
 #if 0
@@ -1805,8 +2216,7 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     msg_recv_log(response_msg, __func__ + std::string(" ") + std::string(response_msg->data(), response_msg->data_length()));
 #endif
                  status = response_msg->get_status();
-                 value.reserve(response_msg->data_length() + 1);
-                 value.insert(0, response_msg->cdata(), response_msg->data_length());
+                 value.assign(response_msg->cdata(), response_msg->data_length());
                  assert(response_msg->data());
   }
   catch (const Exception &e) {
@@ -1912,66 +2322,371 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     return status;
   }
 
-  status_t Connection_handler::get_direct(const pool_t                              pool_,
-                                          const void *const                         key_,
-                                          const size_t                              key_len_,
-                                          void *const                               value_,
-                                          size_t &                                  value_len_,
-                                          component::Registrar_memory_direct *const rmd_,
-                                          const IMCAS::memory_handle_t              mem_handle_)
+  status_t Connection_handler::get(const pool_t                         pool,
+                                   const std::string &                  key,
+                                   void *                               value,
+                                   size_t &                             value_len,
+                                   component::Registrar_memory_direct * rmd,
+                                   component::IKVStore::memory_handle_t handle)
   {
     TM_ROOT()
-    component::IMCAS::async_handle_t async_handle = component::IMCAS::ASYNC_HANDLE_INIT;
+    API_LOCK();
 
-    auto status = async_get_direct(TM_REF pool_, key_, key_len_, value_, value_len_, async_handle, rmd_, mem_handle_, 0);
-    if (status == S_OK) {
-      TM_SCOPE(spin)
-      do {
-        status = check_async_completion(async_handle);
-      } while (status == E_BUSY);
+    if (!value || value_len == 0) {
+      PWRN("%s: bad parameter value=%p value_len=%zu", __func__, value, value_len);
+      return E_BAD_PARAM;
     }
-    return status;
-  }
 
-  status_t Connection_handler::get_direct_offset(const pool_t                              pool_,
-                                                 const std::size_t                         offset_,
-                                                 std::size_t &                             length_,
-                                                 void *const                               buffer_,
-                                                 component::Registrar_memory_direct *const rmd_,
-                                                 const component::IMCAS::memory_handle_t   mem_handle_)
-  {
-    TM_ROOT()
-    component::IMCAS::async_handle_t async_handle = component::IMCAS::ASYNC_HANDLE_INIT;
+    const auto iobs = make_iob_ptr_send();
+    const auto iobr = make_iob_ptr_recv();
+    assert(iobs);
+    assert(iobr);
 
-    auto status = async_get_direct_offset(pool_, offset_, length_, buffer_, async_handle, rmd_, mem_handle_);
-    if (status == S_OK) {
-      TM_SCOPE(spin)
-      do {
-        status = check_async_completion(async_handle);
-      } while (status == E_BUSY);
+    status_t status;
+
+    try {
+      const auto msg =
+        new (iobs->base()) mcas::protocol::Message_IO_request(iobs->length(), auth_id(), request_id(), pool,
+                                                              mcas::protocol::OP_GET,  // op
+                                                              key.c_str(), key.length(), 0);
+
+      msg->set_availabe_val_len_from_iob_len(iobs->original_length());
+
+      if (_options.short_circuit_backend) msg->add_scbe();
+
+      memory_registered mr(rmd,
+                           mcas::range<char *>(static_cast<char *>(value), static_cast<char *>(value) + value_len)
+                           .round_inclusive(4096),
+                           handle == IKVStore::HANDLE_NONE ? nullptr : static_cast<buffer_base *>(handle)->get_desc());
+
+      /* Scatter the response: the header lands in the iob and an inline
+       * value in the caller's buffer. A value too large for the caller's
+       * buffer spills over into the rest of the iob.
+       */
+      const auto header_len = sizeof(mcas::protocol::Message_IO_response);
+      const auto iob_base   = static_cast<char *>(iobr->base().get());
+      const auto spill_len  = iobr->length() - header_len;
+
+      ::iovec iov[]{{iob_base, header_len}, {value, value_len}, {iob_base + header_len, spill_len}};
+      void *  desc[] = {iobr->get_desc(), mr.desc(), iobr->get_desc()};
+
+      post_recv(std::begin(iov), value_len < spill_len ? std::end(iov) : std::end(iov) - 1, std::begin(desc), &*iobr);
+      sync_inject_send(&*iobs, msg, __func__);
+      {
+        TM_SCOPE(wait_recv)
+        wait_for_completion(&*iobr);
+      }
+
+      const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
+
+      status = response_msg->get_status();
+      if (status == S_OK) {
+        if (value_len < response_msg->data_length()) {
+          status = E_INSUFFICIENT_SPACE;
+        }
+        value_len = response_msg->data_length();
+      }
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      status = E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      status = E_FAIL;
     }
+
     return status;
   }
 
-  status_t Connection_handler::put_direct_offset(const pool_t                              pool_,
-                                                 const std::size_t                         offset_,
-                                                 std::size_t &                             size_,
-                                                 const void *const                         buffer_,
-                                                 component::Registrar_memory_direct *const rmd_,
-                                                 const component::IMCAS::memory_handle_t   mem_handle_)
+  namespace
+  {
+    /* a value left in its receive buffer */
+    struct borrowed_iob : public component::IMCAS::Opaque_borrowed_value {
+      std::unique_ptr<Connection_handler::buffer_t, iob_free> iob;
+      explicit borrowed_iob(std::unique_ptr<Connection_handler::buffer_t, iob_free> &&iob_) : iob(std::move(iob_)) {}
+    };
+  }  // namespace
+
+  status_t Connection_handler::get_borrowed(const pool_t                         pool,
+                                            const std::string &                  key,
+                                            const void *&                        out_value,
+                                            size_t &                             out_value_len,
+                                            component::IMCAS::borrowed_value_t & out_borrow)
   {
     TM_ROOT()
-    component::IMCAS::async_handle_t async_handle = component::IMCAS::ASYNC_HANDLE_INIT;
+    PIPELINE_LOCK();
 
-    auto status = async_put_direct_offset(pool_, offset_, size_, buffer_, async_handle, rmd_, mem_handle_);
-    if (status == S_OK) {
-      TM_SCOPE(spin)
-      do {
-        status = check_async_completion(async_handle);
-      } while (status == E_BUSY);
-    }
-    return status;
-  }
+    const auto iobs = make_iob_ptr_send();
+    assert(iobs);
+
+    try {
+      const auto msg =
+        new (iobs->base()) mcas::protocol::Message_IO_request(iobs->length(), auth_id(), request_id(), pool,
+                                                              mcas::protocol::OP_GET,  // op
+                                                              key, "", 0);
+
+      /* the value is left in a receive buffer, which is as large as the send buffer */
+      msg->set_availabe_val_len_from_iob_len(iobs->original_length());
+
+      if (_options.short_circuit_backend) msg->add_scbe();
+
+      iobs->set_length(msg->msg_len());
+      auto iobr = sync_exchange(&*iobs, msg, __func__);
+
+      const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
+      const auto status       = response_msg->get_status();
+      if (status == S_OK) {
+        out_value     = response_msg->data();
+        out_value_len = response_msg->data_length();
+        out_borrow    = new borrowed_iob(std::move(iobr));
+      }
+      return status;
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      return E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      return E_FAIL;
+    }
+  }
+
+  status_t Connection_handler::release_borrowed(component::IMCAS::borrowed_value_t borrow)
+  {
+    if (!borrow) return E_INVAL;
+    delete borrow; /* returns the receive buffer */
+    return S_OK;
+  }
+
+  status_t Connection_handler::get_many(const pool_t                    pool,
+                                        const std::vector<std::string> &keys,
+                                        std::vector<std::string> &      out_values,
+                                        std::vector<status_t> &         out_status)
+  {
+    TM_ROOT()
+
+    out_values.assign(keys.size(), std::string());
+    out_status.assign(keys.size(), E_FAIL);
+
+    /* indices of keys still to be fetched, and of values too large to
+       share a response with any other value */
+    std::vector<std::size_t> pending(keys.size());
+    std::iota(pending.begin(), pending.end(), std::size_t(0));
+    std::vector<std::size_t> oversize;
+
+    status_t status = S_OK;
+
+    try {
+      while (!pending.empty()) {
+        API_LOCK();
+
+        const auto iobs = make_iob_ptr_send();
+        const auto iobr = make_iob_ptr_recv();
+        assert(iobs);
+        assert(iobr);
+
+        const auto msg =
+          new (iobs->base()) mcas::protocol::Message_IO_request(iobs->length(), auth_id(), request_id(), pool,
+                                                                mcas::protocol::OP_MULTI_GET,  // op
+                                                                "", 0, 0, 0);
+        std::size_t sent = 0;
+        while (sent < pending.size() &&
+               msg->append_multi_record(iobs->length(), keys[pending[sent]].data(), keys[pending[sent]].size(), nullptr, 0))
+          sent++;
+
+        if (sent == 0) { /* key alone does not fit in a message */
+          out_status[pending.front()] = IKVStore::E_TOO_LARGE;
+          pending.erase(pending.begin());
+          continue;
+        }
+
+        post_recv(&*iobr);
+        sync_inject_send(&*iobs, msg, __func__);
+        wait_for_completion(&*iobr);
+
+        const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
+
+        if (response_msg->get_status() != S_OK) {
+          status = response_msg->get_status();
+          break;
+        }
+
+        std::vector<std::size_t> requeue;
+        std::size_t              i = 0;
+        response_msg->for_each_multi_result([&](status_t s, const void *value, size_t value_len) {
+          auto ix = pending[i];
+          if (s == E_INSUFFICIENT_BUFFER) {
+            /* the first value had the whole response to itself */
+            (i == 0 ? oversize : requeue).push_back(ix);
+          }
+          else {
+            out_status[ix] = s;
+            if (s == S_OK) out_values[ix].assign(static_cast<const char *>(value), value_len);
+          }
+          i++;
+        });
+
+        if (i == 0) { /* no result at all: treat first key as oversize */
+          oversize.push_back(pending[0]);
+          i = 1;
+        }
+
+        /* keys beyond the last result did not fit in the response */
+        requeue.insert(requeue.end(), pending.begin() + long(i), pending.end());
+        pending.swap(requeue);
+      }
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      status = E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      status = E_FAIL;
+    }
+
+    /* large values use the (possibly two-stage) single get */
+    for (auto ix : oversize) {
+      void * value     = nullptr;
+      size_t value_len = 0;
+      out_status[ix]   = get(pool, keys[ix], value, value_len);
+      if (out_status[ix] == S_OK) {
+        out_values[ix].assign(static_cast<const char *>(value), value_len);
+      }
+      ::free(value);
+    }
+
+    return status;
+  }
+
+  status_t Connection_handler::put_many(const pool_t                    pool,
+                                        const std::vector<std::string> &keys,
+                                        const std::vector<std::string> &values,
+                                        std::vector<status_t> &         out_status,
+                                        const unsigned int              flags)
+  {
+    TM_ROOT()
+
+    if (keys.size() != values.size()) return E_INVAL;
+
+    out_status.assign(keys.size(), E_FAIL);
+
+    status_t    status = S_OK;
+    std::size_t next   = 0;
+
+    try {
+      while (next < keys.size()) {
+        API_LOCK();
+
+        const auto iobs = make_iob_ptr_send();
+        const auto iobr = make_iob_ptr_recv();
+        assert(iobs);
+        assert(iobr);
+
+        const auto msg =
+          new (iobs->base()) mcas::protocol::Message_IO_request(iobs->length(), auth_id(), request_id(), pool,
+                                                                mcas::protocol::OP_MULTI_PUT,  // op
+                                                                "", 0, 0, flags);
+        const std::size_t first = next;
+        while (next < keys.size() && msg->append_multi_record(iobs->length(), keys[next].data(), keys[next].size(),
+                                                               values[next].data(), values[next].size()))
+          next++;
+
+        if (next == first) { /* pair alone does not fit in a message */
+          PWRN("mcas_client::%s value length (%lu) too long. Use put_direct.", __func__, values[next].size());
+          out_status[next++] = IKVStore::E_TOO_LARGE;
+          continue;
+        }
+
+        post_recv(&*iobr);
+        sync_inject_send(&*iobs, msg, __func__);
+        wait_for_completion(&*iobr);
+
+        const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
+
+        if (response_msg->get_status() != S_OK) {
+          status = response_msg->get_status();
+          break;
+        }
+
+        std::size_t ix = first;
+        response_msg->for_each_multi_result([&](status_t s, const void *, size_t) { out_status[ix++] = s; });
+      }
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      status = E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      status = E_FAIL;
+    }
+
+    return status;
+  }
+
+  status_t Connection_handler::get_direct(const pool_t                              pool_,
+                                          const void *const                         key_,
+                                          const size_t                              key_len_,
+                                          void *const                               value_,
+                                          size_t &                                  value_len_,
+                                          component::Registrar_memory_direct *const rmd_,
+                                          const IMCAS::memory_handle_t              mem_handle_)
+  {
+    TM_ROOT()
+    component::IMCAS::async_handle_t async_handle = component::IMCAS::ASYNC_HANDLE_INIT;
+
+    auto status = async_get_direct(TM_REF pool_, key_, key_len_, value_, value_len_, async_handle, rmd_, mem_handle_, 0);
+    if (status == S_OK) {
+      TM_SCOPE(spin)
+      do {
+        status = check_async_completion(async_handle);
+      } while (status == E_BUSY);
+    }
+    return status;
+  }
+
+  status_t Connection_handler::get_direct_offset(const pool_t                              pool_,
+                                                 const std::size_t                         offset_,
+                                                 std::size_t &                             length_,
+                                                 void *const                               buffer_,
+                                                 component::Registrar_memory_direct *const rmd_,
+                                                 const component::IMCAS::memory_handle_t   mem_handle_)
+  {
+    TM_ROOT()
+    component::IMCAS::async_handle_t async_handle = component::IMCAS::ASYNC_HANDLE_INIT;
+
+    auto status = async_get_direct_offset(pool_, offset_, length_, buffer_, async_handle, rmd_, mem_handle_);
+    if (status == S_OK) {
+      TM_SCOPE(spin)
+      do {
+        status = check_async_completion(async_handle);
+      } while (status == E_BUSY);
+    }
+    return status;
+  }
+
+  status_t Connection_handler::put_direct_offset(const pool_t                              pool_,
+                                                 const std::size_t                         offset_,
+                                                 std::size_t &                             size_,
+                                                 const void *const                         buffer_,
+                                                 component::Registrar_memory_direct *const rmd_,
+                                                 const component::IMCAS::memory_handle_t   mem_handle_)
+  {
+    TM_ROOT()
+    component::IMCAS::async_handle_t async_handle = component::IMCAS::ASYNC_HANDLE_INIT;
+
+    auto status = async_put_direct_offset(pool_, offset_, size_, buffer_, async_handle, rmd_, mem_handle_);
+    if (status == S_OK) {
+      TM_SCOPE(spin)
+      do {
+        status = check_async_completion(async_handle);
+      } while (status == E_BUSY);
+    }
+    return status;
+  }
 
   status_t Connection_handler::async_get_direct_offset(const pool_t                              pool_,
                                                        const std::size_t                         offset_,
@@ -2046,21 +2761,18 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
 
   status_t Connection_handler::erase(const pool_t pool, const std::string &key)
   {
-    API_LOCK();
+    PIPELINE_LOCK();
 
     const auto iobs = make_iob_ptr_send();
-    const auto iobr = make_iob_ptr_recv();
     assert(iobs);
-    assert(iobr);
 
     status_t status;
 
     try {
       const auto msg = new (iobs->base()) mcas::protocol::Message_IO_request(iobs->length(), auth_id(), request_id(), pool, mcas::protocol::OP_ERASE, key.c_str(), key.length(), 0);
 
-      post_recv(&*iobr);
-      sync_inject_send(&*iobs, msg, __func__);
-      wait_for_completion(&*iobr);
+      iobs->set_length(msg->msg_len());
+      const auto iobr = sync_exchange(&*iobs, msg, __func__);
 
       const auto response_msg = msg_recv<const mcas::protocol::Message_IO_response>(&*iobr, __func__);
 
@@ -2078,6 +2790,214 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     return status;
   }
 
+  template <typename MT>
+  auto Connection_handler::post_async_exchange(iob_ptr &&iobs_, const MT *msg_, async_decode_t decode_, const char *desc_)
+    -> IMCAS::async_handle_t
+  {
+    auto iobr = make_iob_ptr_recv();
+    assert(iobr);
+
+    /* post both send and receive */
+    post_recv(&*iobr);
+    post_send(iobs_->iov, iobs_->iov + 1, iobs_->desc, &*iobs_, msg_, desc_);
+
+    return new async_buffer_set_decode(debug_level(), std::move(iobs_), std::move(iobr), std::move(decode_));
+  }
+
+  status_t Connection_handler::async_get(const pool_t           pool,
+                                         const std::string &    key,
+                                         std::string &          out_value,
+                                         IMCAS::async_handle_t &out_handle)
+  {
+    API_LOCK();
+
+    auto iobs = make_iob_ptr_send();
+    assert(iobs);
+
+    try {
+      const auto msg =
+        new (iobs->base()) mcas::protocol::Message_IO_request(iobs->length(), auth_id(), request_id(), pool,
+                                                              mcas::protocol::OP_GET,  // op
+                                                              key, "", 0);
+
+      if (_options.short_circuit_backend) msg->add_scbe();
+
+      iobs->set_length(msg->msg_len());
+
+      out_handle = post_async_exchange(std::move(iobs), msg,
+                                       [&out_value] (Connection_handler *c, const buffer_t *iob) {
+                                         const auto response_msg = c->msg_recv<const mcas::protocol::Message_IO_response>(iob, "ASYNC GET");
+                                         const auto status = response_msg->get_status();
+                                         if (status == S_OK) out_value.assign(response_msg->cdata(), response_msg->data_length());
+                                         return status;
+                                       },
+                                       __func__);
+      return S_OK;
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      return E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      return E_FAIL;
+    }
+  }
+
+  namespace
+  {
+    /* unpacks a pool response, which carries a pool handle */
+    Connection_handler::async_decode_t decode_pool_response(IMCAS::pool_t &out_pool_, const char *desc_)
+    {
+      return [&out_pool_, desc_] (Connection_handler *c, const Connection_handler::buffer_t *iob) {
+        const auto response_msg = c->msg_recv<const mcas::protocol::Message_pool_response>(iob, desc_);
+        const auto status = response_msg->get_status();
+        out_pool_ = status == S_OK ? response_msg->pool_id : IKVStore::POOL_ERROR;
+        return status;
+      };
+    }
+
+    /* unpacks a pool response, which carries only status */
+    status_t decode_pool_status(Connection_handler *c, const Connection_handler::buffer_t *iob)
+    {
+      return c->msg_recv<const mcas::protocol::Message_pool_response>(iob, "ASYNC POOL")->get_status();
+    }
+  }  // namespace
+
+  status_t Connection_handler::async_create_pool(const std::string &    name,
+                                                 const size_t           size,
+                                                 const unsigned int     flags,
+                                                 const uint64_t         expected_obj_count,
+                                                 IMCAS::pool_t &        out_pool,
+                                                 IMCAS::async_handle_t &out_handle)
+  {
+    API_LOCK();
+
+    auto iobs = make_iob_ptr_send();
+    assert(iobs);
+
+    try {
+      const auto msg = new (iobs->base())
+        protocol::Message_pool_request(iobs->length(),
+                                       auth_id(),
+                                       request_id(),
+                                       size,
+                                       expected_obj_count,
+                                       mcas::protocol::OP_CREATE,
+                                       name,
+                                       flags,
+                                       0 /* base */);
+      iobs->set_length(msg->msg_len());
+
+      out_handle = post_async_exchange(std::move(iobs), msg, decode_pool_response(out_pool, "ASYNC CREATE_POOL"), __func__);
+      return S_OK;
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      return E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      return E_FAIL;
+    }
+  }
+
+  status_t Connection_handler::async_open_pool(const std::string &    name,
+                                               const unsigned int     flags,
+                                               IMCAS::pool_t &        out_pool,
+                                               IMCAS::async_handle_t &out_handle)
+  {
+    API_LOCK();
+
+    auto iobs = make_iob_ptr_send();
+    assert(iobs);
+
+    try {
+      const auto msg = new (iobs->base())
+        protocol::Message_pool_request(iobs->length(),
+                                       auth_id(),
+                                       request_id(),
+                                       0, /* size */
+                                       0, /* expected obj cnt */
+                                       mcas::protocol::OP_OPEN,
+                                       name,
+                                       flags,
+                                       0 /* base */);
+      iobs->set_length(msg->msg_len());
+
+      out_handle = post_async_exchange(std::move(iobs), msg, decode_pool_response(out_pool, "ASYNC OPEN_POOL"), __func__);
+      return S_OK;
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      return E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      return E_FAIL;
+    }
+  }
+
+  status_t Connection_handler::async_close_pool(const pool_t pool, IMCAS::async_handle_t &out_handle)
+  {
+    API_LOCK();
+
+    auto iobs = make_iob_ptr_send();
+    assert(iobs);
+
+    try {
+      const auto msg = new (iobs->base())
+        mcas::protocol::Message_pool_request(iobs->length(), auth_id(), request_id(), mcas::protocol::OP_CLOSE, pool);
+      iobs->set_length(msg->msg_len());
+
+      out_handle = post_async_exchange(std::move(iobs), msg, decode_pool_status, __func__);
+      return S_OK;
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      return E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      return E_FAIL;
+    }
+  }
+
+  status_t Connection_handler::async_delete_pool(const std::string &name, IMCAS::async_handle_t &out_handle)
+  {
+    if (name.empty()) return E_INVAL;
+
+    API_LOCK();
+
+    auto iobs = make_iob_ptr_send();
+    assert(iobs);
+
+    try {
+      const auto msg = new (iobs->base())
+        mcas::protocol::Message_pool_request(iobs->length(),
+                                             auth_id(),
+                                             request_id(),
+                                             0, // size
+                                             0, // exp obj count
+                                             mcas::protocol::OP_DELETE,
+                                             name,
+                                             0, // flags
+                                             0); // base
+      iobs->set_length(msg->msg_len());
+
+      out_handle = post_async_exchange(std::move(iobs), msg, decode_pool_status, __func__);
+      return S_OK;
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      return E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      return E_FAIL;
+    }
+  }
+
   status_t Connection_handler::async_erase(const IMCAS::pool_t    pool,
                                            const std::string &    key,
                                            IMCAS::async_handle_t &out_async_handle)
@@ -2191,6 +3111,44 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     return status;
   }
 
+  status_t Connection_handler::async_get_attribute(const IKVStore::pool_t    pool,
+                                                   const IKVStore::Attribute attr,
+                                                   std::vector<uint64_t> &   out_attr,
+                                                   const std::string *       key,
+                                                   IMCAS::async_handle_t &   out_handle)
+  {
+    API_LOCK();
+
+    auto iobs = make_iob_ptr_send();
+    assert(iobs);
+
+    try {
+      const auto msg = new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(), attr, pool);
+
+      if (key) msg->set_key(iobs->length(), *key);
+
+      iobs->set_length(msg->message_size());
+
+      out_handle = post_async_exchange(std::move(iobs), msg,
+                                       [&out_attr] (Connection_handler *c, const buffer_t *iob) {
+                                         const auto response_msg = c->msg_recv<const mcas::protocol::Message_INFO_response>(iob, "ASYNC GET_ATTRIBUTE");
+                                         out_attr.clear();
+                                         out_attr.push_back(response_msg->value());
+                                         return response_msg->get_status();
+                                       },
+                                       __func__);
+      return S_OK;
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      return E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      return E_FAIL;
+    }
+  }
+
   status_t Connection_handler::get_statistics(IMCAS::Shard_stats &out_stats)
   {
     API_LOCK();
@@ -2280,6 +3238,105 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
     return status;
   }
 
+  status_t Connection_handler::async_find(const IMCAS::pool_t    pool,
+                                          const std::string &    key_expression,
+                                          const offset_t         offset,
+                                          offset_t &             out_matched_offset,
+                                          std::string &          out_matched_key,
+                                          IMCAS::async_handle_t &out_handle)
+  {
+    API_LOCK();
+
+    auto iobs = make_iob_ptr_send();
+    assert(iobs);
+
+    try {
+      const auto msg =
+        new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(),
+                                                                mcas::protocol::INFO_TYPE_FIND_KEY,
+                                                                pool,
+                                                                offset);
+
+      msg->set_key(iobs->length(), key_expression);
+
+      iobs->set_length(msg->message_size());
+
+      out_handle = post_async_exchange(std::move(iobs), msg,
+                                       [&out_matched_offset, &out_matched_key] (Connection_handler *c, const buffer_t *iob) {
+                                         const auto response_msg = c->msg_recv<const mcas::protocol::Message_INFO_response>(iob, "ASYNC FIND");
+                                         const auto status = response_msg->get_status();
+                                         if (status == S_OK) {
+                                           out_matched_key    = response_msg->c_str();
+                                           out_matched_offset = response_msg->Offset();
+                                         }
+                                         return status;
+                                       },
+                                       __func__);
+      return S_OK;
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      return E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      return E_FAIL;
+    }
+  }
+
+  status_t Connection_handler::find_keys(const IMCAS::pool_t                             pool,
+                                         const std::string &                             key_expression,
+                                         const offset_t                                  offset,
+                                         const size_t                                    max_count,
+                                         offset_t &                                      out_next_offset,
+                                         std::vector<std::pair<offset_t, std::string>> & out_matches)
+  {
+    API_LOCK();
+
+    const auto iobs = make_iob_ptr_send();
+    const auto iobr = make_iob_ptr_recv();
+    assert(iobs);
+    assert(iobr);
+
+    status_t status;
+
+    out_matches.clear();
+    try {
+      const auto msg =
+        new (iobs->base()) mcas::protocol::Message_INFO_request(auth_id(),
+                                                                mcas::protocol::INFO_TYPE_FIND_KEYS,
+                                                                pool,
+                                                                offset,
+                                                                boost::numeric_cast<uint32_t>(max_count));
+
+      msg->set_key(iobs->length(), key_expression);
+
+      post_recv(&*iobr);
+      sync_inject_send(&*iobs, msg, msg->message_size(), __func__);
+
+      wait_for_completion(&*iobr);
+      const auto response_msg = msg_recv<const mcas::protocol::Message_INFO_response>(&*iobr, "FIND_KEYS");
+
+      status = response_msg->get_status();
+
+      if (status == S_OK) {
+        response_msg->for_each_key([&out_matches](offset_t position, std::string &&key) {
+          out_matches.emplace_back(position, std::move(key));
+        });
+        out_next_offset = response_msg->Offset();
+      }
+    }
+    catch (const Exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.cause());
+      status = E_FAIL;
+    }
+    catch (const std::exception &e) {
+      PLOG("%s %s fail %s", __FILE__, __func__, e.what());
+      status = E_FAIL;
+    }
+    return status;
+  }
+
   status_t Connection_handler::receive_and_process_ado_response(
     const iob_ptr & iobr_
     , std::vector<IMCAS::ADO_response> & out_response_
@@ -2339,13 +3396,7 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
         return S_OK;
       }
 
-      const auto iobr = make_iob_ptr_recv();
-      assert(iobr);
-
-      post_recv(&*iobr);
-      sync_send(&*iobs_, msg_, __func__);
-      wait_for_completion(&*iobr); /* wait for response */
-
+      const auto iobr = sync_exchange(&*iobs_, msg_, __func__);
       return receive_and_process_ado_response(iobr, out_response_);
     }
 
@@ -2356,7 +3407,8 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
                                           std::vector<IMCAS::ADO_response>& out_response,
                                           const size_t                      value_size)
   {
-    API_LOCK();
+    /* an invocation which expects no response sends without routing */
+    PIPELINE_LOCK_IF(!(flags & IMCAS::ADO_FLAG_ASYNC));
 
     const auto iobs = make_iob_ptr_send();
     assert(iobs);
@@ -2441,7 +3493,7 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
                                               const unsigned int                flags,
                                               std::vector<IMCAS::ADO_response>& out_response)
   {
-    API_LOCK();
+    PIPELINE_LOCK_IF(!(flags & IMCAS::ADO_FLAG_ASYNC));
 
     if (request.size() == 0) return E_INVAL;
 
@@ -2569,6 +3621,8 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
       /* set security options */
       msg->security_tls_auth = _options.tls;
       PNOTICE("TLS is %s", _options.tls ? "ON" : "OFF");
+      /* the server posts extra receives only for a pipelining client */
+      if (_options.pipeline) msg->set_pipelined();
       iob->set_length(msg->msg_len());
       post_send(iob->iov, iob->iov + 1, iob->desc, &*iob, msg, __func__);
 
@@ -2617,11 +3671,14 @@ status_t Connection_handler::get(const pool_t pool, const std::string &key, std:
       break;
     }
     case SHUTDOWN: {
-      const auto iobs = make_iob_ptr_send();
-      auto       msg  = new (iobs->base()) mcas::protocol::Message_close_session(reinterpret_cast<uint64_t>(this));
+      /* a failed connection refuses sends; the server sees the disconnect instead */
+      if (!_failed) {
+        const auto iobs = make_iob_ptr_send();
+        auto       msg  = new (iobs->base()) mcas::protocol::Message_close_session(reinterpret_cast<uint64_t>(this));
 
-      iobs->set_length(msg->msg_len());
-      post_send(iobs->iov, iobs->iov + 1, iobs->desc, &*iobs, msg, __func__);
+        iobs->set_length(msg->msg_len());
+        post_send(iobs->iov, iobs->iov + 1, iobs->desc, &*iobs, msg, __func__);
+      }
 
       // server-side may have disappeared
       // try {
@@ -38,23 +38,36 @@
 #include <gnutls/crypto.h>
 
 #include <boost/numeric/conversion/cast.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
+#include <thread>
 #include <tuple>
+#include <unordered_map>
 
 /* Enable this to introduce locks to prevent re-entry by multiple
    threads.  The client is not re-entrant because of the state machine
-   and multi-packet operations
+   and multi-packet operations. Operations which are a single request
+   and response (PIPELINE_LOCK) may have up to PIPELINE_WINDOW requests
+   in flight together, if the connection was configured to pipeline;
+   all others (API_LOCK) run alone.
 */
 #define THREAD_SAFE_CLIENT
 
 #define CAFILE "/etc/ssl/certs/ca-bundle.trust.crt"
 
 #ifdef THREAD_SAFE_CLIENT
-#define API_LOCK() std::lock_guard<std::mutex> g(_api_lock);
+#define API_LOCK() api_guard g(this);
+#define PIPELINE_LOCK_IF(C) pipeline_slot g(this, (C));
 #else
 #define API_LOCK()
+#define PIPELINE_LOCK_IF(C)
 #endif
+#define PIPELINE_LOCK() PIPELINE_LOCK_IF(true)
 
 namespace mcas
 {
@@ -95,6 +108,8 @@ public:
   template <typename T>
     using basic_string_view = common::basic_string_view<T>;
   using byte = common::byte;
+  /* unpacks the response to an async request, returning the operation status */
+  using async_decode_t = std::function<status_t(Connection_handler *, const buffer_t *)>;
 
   /**
    * Constructor
@@ -134,6 +149,99 @@ private:
       , unsigned int flags
     );
 
+  /**
+   * Exclusive hold of the API lock. Releasing it nudges the notifier
+   * behind async_completion_fd (see api_unlock).
+   */
+  class api_guard {
+    Connection_handler *_h;
+
+  public:
+    explicit api_guard(Connection_handler *h) : _h(h) { _h->_api_lock.lock(); }
+    api_guard(const api_guard &) = delete;
+    api_guard &operator=(const api_guard &) = delete;
+    ~api_guard() { _h->api_unlock(); }
+  };
+
+  /**
+   * Release an exclusive hold of the API lock. The holder may have
+   * polled away completions of asynchronous handles, which the
+   * notifier's wait on the transport does not see, so the notifier is
+   * nudged to look again.
+   */
+  void api_unlock();
+
+  /**
+   * Admission of a pipelined operation: shared hold of the API lock and
+   * one of PIPELINE_WINDOW slots. The operation holds the API lock
+   * exclusively instead, as it does when not pipelined, if the
+   * connection did not ask the server at handshake for the receives
+   * which pipelining needs, or while asynchronous handles are
+   * outstanding, because their posted receives would take responses
+   * out of turn.
+   */
+  class pipeline_slot {
+    Connection_handler *_h;
+    bool                _exclusive;
+
+  public:
+    pipeline_slot(Connection_handler *h, bool pipelined);
+    pipeline_slot(const pipeline_slot &) = delete;
+    pipeline_slot &operator=(const pipeline_slot &) = delete;
+    ~pipeline_slot();
+  };
+
+  /**
+   * Send a request and wait for the response carrying its request id.
+   * Responses arrive in whichever receive buffer was posted first, so
+   * the buffer returned may have been posted by another thread.
+   *
+   * @param iobs IO buffer holding the request, length set
+   * @param msg Request message
+   * @param desc Description for logging
+   *
+   * @return IO buffer holding the response
+   */
+  template <typename MT>
+    iob_ptr sync_exchange(buffer_t *iobs, const MT *msg, const char *desc);
+
+  static component::IFabric_op_completer::cb_acceptance route_completion(void *        context,
+                                                                         status_t      st,
+                                                                         std::uint64_t completion_flags,
+                                                                         std::size_t   len,
+                                                                         void *        error_data,
+                                                                         void *        param);
+
+  /**
+   * Post a request which has a single response, and return a handle
+   * which completes when the response arrives.
+   *
+   * @param iobs IO buffer holding the request, length set
+   * @param msg Request message
+   * @param decode Function to unpack the response, returning the operation status
+   * @param desc Description for logging
+   *
+   * @return Async handle
+   */
+  template <typename MT>
+    component::IMCAS::async_handle_t post_async_exchange(iob_ptr &&iobs, const MT *msg, async_decode_t decode, const char *desc);
+
+  /**
+   * Async handles with completions waiting, found without consuming the
+   * completions. Caller holds the API lock exclusively.
+   */
+  std::vector<async_buffer_set_t *> ready_async_handles();
+
+  static component::IFabric_op_completer::cb_acceptance note_completion(void *        context,
+                                                                        status_t      st,
+                                                                        std::uint64_t completion_flags,
+                                                                        std::size_t   len,
+                                                                        void *        error_data,
+                                                                        void *        param);
+
+  /* body of the thread behind async_completion_fd */
+  void notify_completions();
+
 public:
   using pool_t = uint64_t;
 
@@ -168,6 +276,22 @@ public:
 
   status_t configure_pool(const component::IKVStore::pool_t pool, const std::string &json);
 
+  status_t async_create_pool(const std::string &               name,
+                             const size_t                      size,
+                             const unsigned int                flags,
+                             const uint64_t                    expected_obj_count,
+                             component::IMCAS::pool_t &        out_pool,
+                             component::IMCAS::async_handle_t &out_handle);
+
+  status_t async_open_pool(const std::string &               name,
+                           const unsigned int                flags,
+                           component::IMCAS::pool_t &        out_pool,
+                           component::IMCAS::async_handle_t &out_handle);
+
+  status_t async_close_pool(const pool_t pool, component::IMCAS::async_handle_t &out_handle);
+
+  status_t async_delete_pool(const std::string &name, component::IMCAS::async_handle_t &out_handle);
+
   status_t put(const pool_t       pool,
                const std::string  key,
                const void *       value,
@@ -218,10 +342,34 @@ public:
 
   status_t check_async_completion(component::IMCAS::async_handle_t &handle);
 
+  std::size_t poll_completions(std::size_t max, component::IMCAS::async_handle_t out_handles[], status_t out_status[]);
+
+  int async_completion_fd();
+
   status_t get(const pool_t pool, const std::string &key, std::string &value);
 
+  status_t async_get(const pool_t                      pool,
+                     const std::string &               key,
+                     std::string &                     out_value,
+                     component::IMCAS::async_handle_t &out_handle);
+
   status_t get(const pool_t pool, const std::string &key, void *&value, size_t &value_len);
 
+  status_t get(const pool_t                         pool,
+               const std::string &                  key,
+               void *                               value,
+               size_t &                             value_len,
+               component::Registrar_memory_direct * rmd,
+               component::IKVStore::memory_handle_t handle);
+
+  status_t get_borrowed(const pool_t                         pool,
+                        const std::string &                  key,
+                        const void *&                        out_value,
+                        size_t &                             out_value_len,
+                        component::IMCAS::borrowed_value_t & out_borrow);
+
+  status_t release_borrowed(component::IMCAS::borrowed_value_t borrow);
+
   status_t get_direct(const pool_t                         pool,
                       const void *                         key,
                       size_t                               key_len,
@@ -291,6 +439,12 @@ public:
                          std::vector<uint64_t> &              out_attr,
                          const std::string *                  key);
 
+  status_t async_get_attribute(const component::IKVStore::pool_t    pool,
+                               const component::IKVStore::Attribute attr,
+                               std::vector<uint64_t> &              out_attr,
+                               const std::string *                  key,
+                               component::IMCAS::async_handle_t &   out_handle);
+
   status_t get_statistics(component::IMCAS::Shard_stats &out_stats);
 
   status_t find(const component::IKVStore::pool_t pool,
@@ -299,6 +453,31 @@ public:
                 offset_t &                        out_matched_offset,
                 std::string &                     out_matched_key);
 
+  status_t async_find(const component::IKVStore::pool_t pool,
+                      const std::string &               key_expression,
+                      const offset_t                    offset,
+                      offset_t &                        out_matched_offset,
+                      std::string &                     out_matched_key,
+                      component::IMCAS::async_handle_t &out_handle);
+
+  status_t get_many(const pool_t                   pool,
+                    const std::vector<std::string> &keys,
+                    std::vector<std::string> &      out_values,
+                    std::vector<status_t> &         out_status);
+
+  status_t put_many(const pool_t                    pool,
+                    const std::vector<std::string> &keys,
+                    const std::vector<std::string> &values,
+                    std::vector<status_t> &         out_status,
+                    const unsigned int              flags);
+
+  status_t find_keys(const component::IKVStore::pool_t               pool,
+                     const std::string &                             key_expression,
+                     const offset_t                                  offset,
+                     const size_t                                    max_count,
+                     offset_t &                                      out_next_offset,
+                     std::vector<std::pair<offset_t, std::string>> & out_matches);
+
   status_t invoke_ado(const component::IMCAS::pool_t               pool,
                       basic_string_view<byte>                      key,
                       basic_string_view<byte>                      request,
@@ -525,15 +704,46 @@ private:
 
 private:
 #ifdef THREAD_SAFE_CLIENT
-  std::mutex _api_lock;
+  std::shared_timed_mutex _api_lock;
 #endif
 
+  /* pipelining state */
+  std::mutex                       _window_lock;
+  std::condition_variable          _window_cv;
+  unsigned                         _in_flight;         /*< pipelined requests admitted, guarded by _window_lock */
+  std::atomic<unsigned>            _async_outstanding; /*< async handles not yet completed */
+  std::mutex                       _transport_lock;    /*< serializes fabric use by pipelined requests */
+  std::set<buffer_t *>             _routed;            /*< posted receives, guarded by _transport_lock */
+  std::map<uint64_t, buffer_t *>   _arrived;           /*< responses by request id, guarded by _transport_lock */
+
   bool     _exit;
   bool     _force_direct = false;
-  uint64_t _request_id;
+  std::atomic<uint64_t> _request_id;
+
+  /* asynchronous completion queue, guarded by _api_lock */
+  std::set<async_buffer_set_t *>                         _async_handles; /*< outstanding handles */
+  std::unordered_map<const void *, async_buffer_set_t *> _async_watch;   /*< posting context to handle */
+
+  /* completion notification (see async_completion_fd) */
+  int                     _completion_fd;
+  std::mutex              _notify_lock;
+  std::condition_variable _notify_cv;
+  bool                    _notify_armed;  /*< guarded by _notify_lock */
+  bool                    _notify_exit;   /*< guarded by _notify_lock */
+  bool                    _notify_nudged; /*< guarded by _notify_lock */
+  std::thread             _notifier;
 
 public: /* for async "move_along" processing */
   uint64_t request_id() { return ++_request_id; }
+  void async_handle_opened(async_buffer_set_t *h);
+  void async_handle_closed(async_buffer_set_t *h);
+  void async_watch(const void *context, async_buffer_set_t *h) { _async_watch[context] = h; }
+  void async_unwatch(const void *context, async_buffer_set_t *h)
+  {
+    auto it = _async_watch.find(context);
+    /* the context may since have been reused by another handle */
+    if (it != _async_watch.end() && it->second == h) _async_watch.erase(it);
+  }
 
 private:
   size_t _max_message_size;
@@ -543,9 +753,10 @@ private:
     bool short_circuit_backend;
     unsigned tls   : 1;
     unsigned hmac : 1;
+    unsigned pipeline : 1;
 
     options_s()
-      : short_circuit_backend(env_scbe && env_scbe[0] == '1'), tls(0), hmac(0)
+      : short_circuit_backend(env_scbe && env_scbe[0] == '1'), tls(0), hmac(0), pipeline(0)
     {}
   };
 
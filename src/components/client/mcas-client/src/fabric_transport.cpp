@@ -28,7 +28,9 @@ Fabric_transport::Fabric_transport(unsigned                   debug_level_,
       _transport(fabric_connection),
       _max_inject_size(_transport->max_inject_size()),
       _bm(bm_),
-      _patience(patience_)
+      _bm_lock{},
+      _patience(patience_),
+      _failed(false)
 {
 }
 
@@ -70,9 +72,11 @@ void Fabric_transport::wait_for_completion(void *wr)
     _transport->poll_completions_tentative(completion_callback, &wr);
   }
 
-  if (wr)
+  if (wr) {
+    set_failed();
     throw Program_exception("time out: start_time %" PRIu64 ", now %" PRIu64 " waited %lu seconds for completion",
       start_time, rdtsc(), _patience);
+  }
 }
 
 }  // namespace client
@@ -20,7 +20,9 @@
 #include <api/fabric_itf.h> /* IFabric_client, IFabric_memory_region, IFabric_op_completer. IKVStore */
 #include <common/destructible.h>
 #include <common/exceptions.h>
+#include <atomic>
 #include <iterator> /* begin, end */
+#include <mutex>
 
 namespace mcas
 {
@@ -34,9 +36,16 @@ class Fabric_transport : protected common::log_source {
 
   inline void u_post_recv(const ::iovec *first, const ::iovec *last, void **descriptors, void *context)
   {
+    check_usable();
     _transport->post_recv(first, last, descriptors, context);
   }
 
+  inline void check_usable() const
+  {
+    if (UNLIKELY(_failed))
+      throw Program_exception("connection unusable: an earlier response timed out");
+  }
+
  public:
   using Transport = component::IFabric_client;
   using Registrar = component::IFabric_memory_control;
@@ -64,12 +73,20 @@ class Fabric_transport : protected common::log_source {
                                                                             void *param);
 
   /**
-   * Wait for completion of a IO buffer posting
+   * Wait for completion of a IO buffer posting. On time out the posting
+   * is still outstanding, and a receive would take a later response, so
+   * the connection is marked failed and refuses further postings.
    *
    * @param iob IO buffer to wait for completion of
    */
   void wait_for_completion(void *wr);
 
+  /**
+   * Mark the connection failed after a lost response. Requests in flight
+   * may still complete; new sends and receives throw.
+   */
+  void set_failed() { _failed = true; }
+
   /**
    * Test completion of work request
    *
@@ -105,6 +122,7 @@ class Fabric_transport : protected common::log_source {
 
   inline void post_send(const ::iovec *first, const ::iovec *last, void **descriptors, void *context)
   {
+    check_usable();
     _transport->post_send(first, last, descriptors, context);
   }
 
@@ -150,6 +168,7 @@ class Fabric_transport : protected common::log_source {
   {
     iob->set_length(len);
     if (len <= _max_inject_size) {
+      check_usable();
       /* when this returns, iob is ready for immediate reuse */
       _transport->inject_send(iob->base(), iob->length());
     }
@@ -234,14 +253,26 @@ class Fabric_transport : protected common::log_source {
     return S_OK;
   }
 
-  inline auto allocate(buffer_t::completion_t c) { return _bm.allocate(c); }
-  inline void free_buffer(buffer_t *buffer) { _bm.free(buffer); }
+  /* Buffer_manager is not thread safe; pipelined requests allocate concurrently */
+  inline auto allocate(buffer_t::completion_t c)
+  {
+    std::lock_guard<std::mutex> g(_bm_lock);
+    return _bm.allocate(c);
+  }
+
+  inline void free_buffer(buffer_t *buffer)
+  {
+    std::lock_guard<std::mutex> g(_bm_lock);
+    _bm.free(buffer);
+  }
 
  protected:
   Transport *               _transport;
   size_t                    _max_inject_size;
   Buffer_manager<Registrar> &_bm;       /*< IO buffer manager */
+  std::mutex                _bm_lock;   /*< guards _bm */
   unsigned                  _patience;  // in seconds
+  std::atomic<bool>         _failed;    /*< set when a posting timed out */
 };
 
 }  // namespace client
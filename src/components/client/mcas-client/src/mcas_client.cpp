@@ -222,6 +222,35 @@ status_t MCAS_client::configure_pool(const IKVStore::pool_t pool, const std::str
   return _connection->configure_pool(pool, json);
 }
 
+status_t MCAS_client::async_create_pool(const std::string &name,
+                                        const size_t       size,
+                                        const flags_t      flags,
+                                        const uint64_t     expected_obj_count,
+                                        IKVStore::pool_t & out_pool,
+                                        async_handle_t &   out_handle)
+{
+  return _connection->async_create_pool(name, size, flags, expected_obj_count, out_pool, out_handle);
+}
+
+status_t MCAS_client::async_open_pool(const std::string &name,
+                                      const flags_t      flags,
+                                      IKVStore::pool_t & out_pool,
+                                      async_handle_t &   out_handle)
+{
+  return _connection->async_open_pool(name, flags, out_pool, out_handle);
+}
+
+status_t MCAS_client::async_close_pool(const IKVStore::pool_t pool, async_handle_t &out_handle)
+{
+  if (!pool) return E_INVAL;
+  return _connection->async_close_pool(pool, out_handle);
+}
+
+status_t MCAS_client::async_delete_pool(const std::string &name, async_handle_t &out_handle)
+{
+  return _connection->async_delete_pool(name, out_handle);
+}
+
 status_t MCAS_client::put(const IKVStore::pool_t pool,
                           const std::string &    key,
                           const void *           value,
@@ -278,6 +307,14 @@ status_t MCAS_client::check_async_completion(async_handle_t &handle)
   return _connection->check_async_completion(handle);
 }
 
+size_t MCAS_client::poll_completions(const size_t max, async_handle_t out_handles[], status_t out_status[])
+{
+  TM_ROOT();
+  return _connection->poll_completions(max, out_handles, out_status);
+}
+
+int MCAS_client::async_completion_fd() { return _connection->async_completion_fd(); }
+
 status_t MCAS_client::get(const IKVStore::pool_t pool,
                           const std::string &    key,
                           void *&                out_value, /* release with free() */
@@ -286,6 +323,56 @@ status_t MCAS_client::get(const IKVStore::pool_t pool,
   return _connection->get(pool, key, out_value, out_value_len);
 }
 
+status_t MCAS_client::get(const IKVStore::pool_t pool, const std::string &key, std::string &out_value)
+{
+  return _connection->get(pool, key, out_value);
+}
+
+status_t MCAS_client::get(const IKVStore::pool_t       pool,
+                          const std::string &          key,
+                          void *                       out_value,
+                          size_t &                     inout_value_len,
+                          const IMCAS::memory_handle_t handle)
+{
+  return _connection->get(pool, key, out_value, inout_value_len, registrar(), handle);
+}
+
+status_t MCAS_client::get_borrowed(const IKVStore::pool_t pool,
+                                   const std::string &    key,
+                                   const void *&          out_value,
+                                   size_t &               out_value_len,
+                                   borrowed_value_t &     out_borrow)
+{
+  return _connection->get_borrowed(pool, key, out_value, out_value_len, out_borrow);
+}
+
+status_t MCAS_client::release_borrowed(borrowed_value_t borrow) { return _connection->release_borrowed(borrow); }
+
+status_t MCAS_client::async_get(const IMCAS::pool_t pool,
+                                const std::string & key,
+                                std::string &       out_value,
+                                async_handle_t &    out_handle)
+{
+  return _connection->async_get(pool, key, out_value, out_handle);
+}
+
+status_t MCAS_client::get_many(const IKVStore::pool_t          pool,
+                               const std::vector<std::string> &keys,
+                               std::vector<std::string> &      out_values,
+                               std::vector<status_t> &         out_status)
+{
+  return _connection->get_many(pool, keys, out_values, out_status);
+}
+
+status_t MCAS_client::put_many(const IKVStore::pool_t          pool,
+                               const std::vector<std::string> &keys,
+                               const std::vector<std::string> &values,
+                               std::vector<status_t> &         out_status,
+                               const unsigned int              flags)
+{
+  return _connection->put_many(pool, keys, values, out_status, flags);
+}
+
 status_t MCAS_client::get_direct(const pool_t           pool,
                                  const std::string &    key,
                                  void *                 out_value,
@@ -374,6 +461,15 @@ status_t MCAS_client::get_attribute(const IKVStore::pool_t    pool,
   return _connection->get_attribute(pool, attr, out_attr, key);
 }
 
+status_t MCAS_client::async_get_attribute(const IMCAS::pool_t       pool,
+                                          const IKVStore::Attribute attr,
+                                          std::vector<uint64_t> &   out_attr,
+                                          const std::string *       key,
+                                          async_handle_t &          out_handle)
+{
+  return _connection->async_get_attribute(pool, attr, out_attr, key, out_handle);
+}
+
 status_t MCAS_client::get_statistics(Shard_stats &out_stats) { return _connection->get_statistics(out_stats); }
 
 status_t MCAS_client::free_memory(void *p)
@@ -400,6 +496,26 @@ status_t MCAS_client::find(const IKVStore::pool_t pool,
   return _connection->find(pool, key_expression, offset, out_matched_offset, out_matched_key);
 }
 
+status_t MCAS_client::async_find(const IKVStore::pool_t pool,
+                                 const std::string &    key_expression,
+                                 const offset_t         offset,
+                                 offset_t &             out_matched_offset,
+                                 std::string &          out_matched_key,
+                                 async_handle_t &       out_handle)
+{
+  return _connection->async_find(pool, key_expression, offset, out_matched_offset, out_matched_key, out_handle);
+}
+
+status_t MCAS_client::find_keys(const IKVStore::pool_t                          pool,
+                                const std::string &                             key_expression,
+                                const offset_t                                  offset,
+                                const size_t                                    max_count,
+                                offset_t &                                      out_next_offset,
+                                std::vector<std::pair<offset_t, std::string>> & out_matches)
+{
+  return _connection->find_keys(pool, key_expression, offset, max_count, out_next_offset, out_matches);
+}
+
 status_t MCAS_client::invoke_ado(const IKVStore::pool_t            pool,
                                  basic_string_view<byte>           key,
                                  basic_string_view<byte>           request,
@@ -143,6 +143,22 @@ class MCAS_client
 
   virtual status_t configure_pool(const component::IKVStore::pool_t pool, const std::string &json) override;
 
+  virtual status_t async_create_pool(const std::string &name,
+                                     const size_t       size,
+                                     const flags_t      flags,
+                                     const uint64_t     expected_obj_count,
+                                     pool_t &           out_pool,
+                                     async_handle_t &   out_handle) override;
+
+  virtual status_t async_open_pool(const std::string &name,
+                                   const flags_t      flags,
+                                   pool_t &           out_pool,
+                                   async_handle_t &   out_handle) override;
+
+  virtual status_t async_close_pool(const pool_t pool, async_handle_t &out_handle) override;
+
+  virtual status_t async_delete_pool(const std::string &name, async_handle_t &out_handle) override;
+
   virtual status_t put(const pool_t       pool,
                        const std::string &key,
                        const void *       value,
@@ -189,11 +205,36 @@ class MCAS_client
 
   virtual status_t check_async_completion(async_handle_t &handle) override;
 
+  virtual size_t poll_completions(const size_t max, async_handle_t out_handles[], status_t out_status[]) override;
+
+  virtual int async_completion_fd() override;
+
   virtual status_t get(const pool_t       pool,
                        const std::string &key,
                        void *&            out_value, /* release with free() */
                        size_t &           out_value_len) override;
 
+  virtual status_t get(const pool_t pool, const std::string &key, std::string &out_value) override;
+
+  virtual status_t get(const pool_t                 pool,
+                       const std::string &          key,
+                       void *                       out_value,
+                       size_t &                     inout_value_len,
+                       const IMCAS::memory_handle_t handle) override;
+
+  virtual status_t get_borrowed(const pool_t       pool,
+                                const std::string &key,
+                                const void *&      out_value,
+                                size_t &           out_value_len,
+                                borrowed_value_t & out_borrow) override;
+
+  virtual status_t release_borrowed(borrowed_value_t borrow) override;
+
+  virtual status_t async_get(const IMCAS::pool_t pool,
+                             const std::string & key,
+                             std::string &       out_value,
+                             async_handle_t &    out_handle) override;
+
   virtual status_t async_get_direct(const pool_t                 pool,
                               const std::string &          key,
                               void *                       out_value,
@@ -244,6 +285,12 @@ class MCAS_client
                                  std::vector<uint64_t> &   out_attr,
                                  const std::string *       key) override;
 
+  virtual status_t async_get_attribute(const IMCAS::pool_t       pool,
+                                       const IKVStore::Attribute attr,
+                                       std::vector<uint64_t> &   out_attr,
+                                       const std::string *       key,
+                                       async_handle_t &          out_handle) override;
+
   virtual status_t get_statistics(Shard_stats &out_stats) override;
 
   virtual void debug(const pool_t pool, const unsigned cmd, const uint64_t arg) override;
@@ -261,6 +308,31 @@ class MCAS_client
                         offset_t &             out_matched_offset,
                         std::string &          out_matched_key) override;
 
+  virtual status_t async_find(const IKVStore::pool_t pool,
+                              const std::string &    key_expression,
+                              const offset_t         offset,
+                              offset_t &             out_matched_offset,
+                              std::string &          out_matched_key,
+                              async_handle_t &       out_handle) override;
+
+  virtual status_t get_many(const IKVStore::pool_t          pool,
+                            const std::vector<std::string> &keys,
+                            std::vector<std::string> &      out_values,
+                            std::vector<status_t> &         out_status) override;
+
+  virtual status_t put_many(const IKVStore::pool_t          pool,
+                            const std::vector<std::string> &keys,
+                            const std::vector<std::string> &values,
+                            std::vector<status_t> &         out_status,
+                            const unsigned int              flags = IMCAS::FLAGS_NONE) override;
+
+  virtual status_t find_keys(const IKVStore::pool_t                          pool,
+                             const std::string &                             key_expression,
+                             const offset_t                                  offset,
+                             const size_t                                    max_count,
+                             offset_t &                                      out_next_offset,
+                             std::vector<std::pair<offset_t, std::string>> & out_matches) override;
+
   virtual status_t invoke_ado(const IKVStore::pool_t            pool,
                               const basic_string_view<byte>     key,
                               const basic_string_view<byte>     request,
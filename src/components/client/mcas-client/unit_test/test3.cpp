@@ -0,0 +1,546 @@
+/*
+   Copyright [2017-2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Tests of IMCAS-specific client operations. Requires a running server
+ * whose shard is configured with an index (e.g. "index" : "rbtree").
+ */
+#include <api/components.h>
+#include <api/mcas_itf.h>
+#include <common/str_utils.h>
+#include <common/utils.h> /* KiB, MiB */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <boost/program_options.hpp>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <cstdlib> /* aligned_alloc, free */
+#include <cstring> /* memset */
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility> /* pair */
+#include <vector>
+
+struct {
+  std::string addr;
+  std::string pool;
+  std::string device;
+  unsigned    debug_level;
+  unsigned    patience;
+} Options{};
+
+using namespace component;
+
+namespace
+{
+component::Itf_ref<component::IMCAS> _mcas;
+
+// The fixture for testing IMCAS operations
+struct mcas_client_test : public ::testing::Test {
+ protected:
+  static IMCAS::pool_t create_pool(const std::string &name, size_t size = MiB(32))
+  {
+    const auto poolname = Options.pool + "/" + name;
+    _mcas->delete_pool(poolname); /* left over from an earlier run */
+    return _mcas->create_pool(poolname, size, 0, 1000);
+  }
+
+  static void delete_pool(IMCAS::pool_t pool, const std::string &name)
+  {
+    ASSERT_EQ(S_OK, _mcas->close_pool(pool));
+    ASSERT_EQ(S_OK, _mcas->delete_pool(Options.pool + "/" + name));
+  }
+};
+
+void instantiate()
+{
+  /* create object instance through factory */
+  IBase *comp = load_component("libcomponent-mcasclient.so", mcas_client_factory);
+
+  auto factory = make_itf_ref(static_cast<IMCAS_factory *>(comp->query_interface(IMCAS_factory::iid())));
+  assert(factory);
+
+  /* pipelined, so that concurrent single-exchange operations share the connection */
+  _mcas.reset(factory->mcas_create(Options.debug_level, Options.patience, "mcas-client-test3", Options.addr, Options.device,
+                                   "{\"pipeline\" : true}"));
+}
+
+std::string numbered_key(const std::string &prefix, unsigned i)
+{
+  return prefix + std::to_string(1000 + i); /* fixed width, so keys sort numerically */
+}
+
+using completions_t = std::map<IMCAS::async_handle_t, status_t>;
+
+/* collect until count completions are in hand, waiting on the eventfd between polls */
+void collect_completions(int fd, size_t count, completions_t &out)
+{
+  static constexpr size_t MAX = 4; /* fewer than are outstanding, so some are left behind */
+  while (out.size() < count) {
+    ::pollfd pfd{fd, POLLIN, 0};
+    ASSERT_EQ(1, ::poll(&pfd, 1, 10000)) << "completion fd not readable";
+    ::eventfd_t v;
+    ASSERT_EQ(0, ::eventfd_read(fd, &v));
+
+    IMCAS::async_handle_t handles[MAX];
+    status_t              status[MAX];
+    const auto            n = _mcas->poll_completions(MAX, handles, status);
+    for (size_t i = 0; i != n; ++i) {
+      ASSERT_TRUE(out.emplace(handles[i], status[i]).second);
+    }
+  }
+}
+
+TEST_F(mcas_client_test, FindKeys)
+{
+  PMAJOR("Running FindKeys...");
+  ASSERT_TRUE(_mcas.get());
+
+  auto pool = create_pool("FindKeys");
+  ASSERT_NE(IMCAS::POOL_ERROR, pool);
+
+  static constexpr unsigned MATCH_COUNT = 100;
+  std::set<std::string>     expected;
+  for (unsigned i = 0; i != MATCH_COUNT; ++i) {
+    const auto key = numbered_key("findKey-", i);
+    ASSERT_EQ(S_OK, _mcas->put(pool, key, "value"));
+    expected.insert(key);
+    ASSERT_EQ(S_OK, _mcas->put(pool, numbered_key("otherKey-", i), "value"));
+  }
+
+  /* a single-match batch agrees with find */
+  {
+    offset_t    matched_offset = 0;
+    std::string matched_key;
+    ASSERT_EQ(S_OK, _mcas->find(pool, "prefix:findKey-", 0, matched_offset, matched_key));
+
+    offset_t                                      next_offset = 0;
+    std::vector<std::pair<offset_t, std::string>> matches;
+    ASSERT_EQ(S_OK, _mcas->find_keys(pool, "prefix:findKey-", 0, 1, next_offset, matches));
+    ASSERT_EQ(1U, matches.size());
+    ASSERT_EQ(matched_offset, matches[0].first);
+    ASSERT_EQ(matched_key, matches[0].second);
+    ASSERT_LT(matches[0].first, next_offset);
+  }
+
+  /* collect every match in small batches */
+  static constexpr size_t BATCH = 16;
+  std::set<std::string>   found;
+  offset_t                offset = 0;
+  unsigned                batches = 0;
+  for (;;) {
+    offset_t                                      next_offset = 0;
+    std::vector<std::pair<offset_t, std::string>> matches;
+    const auto rc = _mcas->find_keys(pool, "prefix:findKey-", offset, BATCH, next_offset, matches);
+    if (rc == E_FAIL) break;
+    ASSERT_EQ(S_OK, rc);
+    ASSERT_FALSE(matches.empty());
+    ASSERT_GE(BATCH, matches.size());
+    for (const auto &m : matches) {
+      ASSERT_LE(offset, m.first);
+      ASSERT_LT(m.first, next_offset);
+      ASSERT_TRUE(found.insert(m.second).second) << "duplicate match " << m.second;
+    }
+    offset = next_offset;
+    ++batches;
+  }
+
+  ASSERT_EQ(expected, found);
+  ASSERT_LE((MATCH_COUNT + BATCH - 1) / BATCH, batches);
+
+  /* no matches at all */
+  offset_t                                      next_offset = 0;
+  std::vector<std::pair<offset_t, std::string>> matches;
+  ASSERT_EQ(E_FAIL, _mcas->find_keys(pool, "prefix:noSuchKey-", 0, BATCH, next_offset, matches));
+  ASSERT_TRUE(matches.empty());
+
+  delete_pool(pool, "FindKeys");
+}
+
+TEST_F(mcas_client_test, GetManyPutMany)
+{
+  PMAJOR("Running GetManyPutMany...");
+  ASSERT_TRUE(_mcas.get());
+
+  auto pool = create_pool("GetManyPutMany", MiB(64));
+  ASSERT_NE(IMCAS::POOL_ERROR, pool);
+
+  /* enough pairs to need several messages */
+  static constexpr unsigned COUNT = 2000;
+  std::vector<std::string>  keys;
+  std::vector<std::string>  values;
+  for (unsigned i = 0; i != COUNT; ++i) {
+    keys.push_back(numbered_key("manyKey-", i));
+    values.push_back(common::random_string(8 + i % 120));
+  }
+
+  std::vector<status_t> status;
+  ASSERT_EQ(S_OK, _mcas->put_many(pool, keys, values, status));
+  ASSERT_EQ(COUNT, status.size());
+  for (unsigned i = 0; i != COUNT; ++i) ASSERT_EQ(S_OK, status[i]) << keys[i];
+
+  /* a value too large to share a response, and a key which does not exist */
+  const std::string large_key = "manyKey-large";
+  const std::string large_value(KiB(100), 'L');
+  ASSERT_EQ(S_OK, _mcas->put(pool, large_key, large_value));
+  keys.insert(keys.begin() + COUNT / 2, large_key);
+  values.insert(values.begin() + COUNT / 2, large_value);
+  keys.push_back("manyKey-missing");
+
+  std::vector<std::string> out_values;
+  ASSERT_EQ(S_OK, _mcas->get_many(pool, keys, out_values, status));
+  ASSERT_EQ(keys.size(), out_values.size());
+  ASSERT_EQ(keys.size(), status.size());
+  for (unsigned i = 0; i != values.size(); ++i) {
+    ASSERT_EQ(S_OK, status[i]) << keys[i];
+    ASSERT_EQ(values[i], out_values[i]) << keys[i];
+  }
+  ASSERT_EQ(IKVStore::E_KEY_NOT_FOUND, status.back());
+  ASSERT_TRUE(out_values.back().empty());
+
+  /* the multi-put values are visible to single gets */
+  std::string value;
+  ASSERT_EQ(S_OK, _mcas->get(pool, keys[0], value));
+  ASSERT_EQ(values[0], value);
+
+  delete_pool(pool, "GetManyPutMany");
+}
+
+TEST_F(mcas_client_test, AsyncCompletionFd)
+{
+  PMAJOR("Running AsyncCompletionFd...");
+  ASSERT_TRUE(_mcas.get());
+
+  auto pool = create_pool("AsyncCompletionFd");
+  ASSERT_NE(IMCAS::POOL_ERROR, pool);
+
+  const int fd = _mcas->async_completion_fd();
+  ASSERT_NE(-1, fd);
+  ASSERT_EQ(fd, _mcas->async_completion_fd());
+
+  /* nothing outstanding: not readable */
+  ::pollfd pfd{fd, POLLIN, 0};
+  ASSERT_EQ(0, ::poll(&pfd, 1, 100));
+
+  static constexpr unsigned       COUNT = 16;
+  std::vector<std::string>        values;
+  std::set<IMCAS::async_handle_t> issued;
+  values.reserve(COUNT); /* values stay put while the puts are outstanding */
+  for (unsigned i = 0; i != COUNT; ++i) {
+    values.push_back(common::random_string(8 + i));
+    IMCAS::async_handle_t handle = IMCAS::ASYNC_HANDLE_INIT;
+    ASSERT_EQ(S_OK, _mcas->async_put(pool, numbered_key("fdKey-", i), values.back(), handle));
+    issued.insert(handle);
+  }
+
+  completions_t collected;
+  ASSERT_NO_FATAL_FAILURE(collect_completions(fd, COUNT, collected));
+  ASSERT_EQ(COUNT, collected.size());
+  for (const auto &c : collected) {
+    ASSERT_EQ(1U, issued.count(c.first));
+    ASSERT_EQ(S_OK, c.second);
+  }
+
+  /* everything collected: the notifier stays quiet */
+  ASSERT_EQ(0, ::poll(&pfd, 1, 100));
+
+  for (unsigned i = 0; i != COUNT; ++i) {
+    std::string value;
+    ASSERT_EQ(S_OK, _mcas->get(pool, numbered_key("fdKey-", i), value));
+    ASSERT_EQ(values[i], value);
+  }
+
+  delete_pool(pool, "AsyncCompletionFd");
+}
+
+TEST_F(mcas_client_test, AsyncMixedOrdering)
+{
+  PMAJOR("Running AsyncMixedOrdering...");
+  ASSERT_TRUE(_mcas.get());
+
+  const int fd = _mcas->async_completion_fd();
+  ASSERT_NE(-1, fd);
+
+  const auto poolname = Options.pool + "/AsyncMixedOrdering";
+  _mcas->delete_pool(poolname); /* left over from an earlier run */
+
+  /* the pool handle is known only once creation completes */
+  IMCAS::pool_t         pool          = IMCAS::POOL_ERROR;
+  IMCAS::async_handle_t create_handle = IMCAS::ASYNC_HANDLE_INIT;
+  ASSERT_EQ(S_OK, _mcas->async_create_pool(poolname, MiB(32), 0, 1000, pool, create_handle));
+  {
+    completions_t collected;
+    ASSERT_NO_FATAL_FAILURE(collect_completions(fd, 1, collected));
+    ASSERT_EQ(S_OK, collected.at(create_handle));
+  }
+  ASSERT_NE(IMCAS::POOL_ERROR, pool);
+
+  /* each operation is issued before those ahead of it complete, and sees their effects */
+  const std::string key    = "mixedKey";
+  const std::string first  = "first";
+  const std::string second = "second value";
+  std::string       got_first;
+  std::string       got_second;
+  offset_t          matched_offset = 0;
+  std::string       matched_key;
+
+  IMCAS::async_handle_t put_first  = IMCAS::ASYNC_HANDLE_INIT;
+  IMCAS::async_handle_t get_first  = IMCAS::ASYNC_HANDLE_INIT;
+  IMCAS::async_handle_t find       = IMCAS::ASYNC_HANDLE_INIT;
+  IMCAS::async_handle_t put_second = IMCAS::ASYNC_HANDLE_INIT;
+  IMCAS::async_handle_t get_second = IMCAS::ASYNC_HANDLE_INIT;
+  ASSERT_EQ(S_OK, _mcas->async_put(pool, key, first, put_first));
+  ASSERT_EQ(S_OK, _mcas->async_get(pool, key, got_first, get_first));
+  ASSERT_EQ(S_OK, _mcas->async_find(pool, "prefix:mixed", 0, matched_offset, matched_key, find));
+  ASSERT_EQ(S_OK, _mcas->async_put(pool, key, second, put_second));
+  ASSERT_EQ(S_OK, _mcas->async_get(pool, key, got_second, get_second));
+
+  completions_t collected;
+  ASSERT_NO_FATAL_FAILURE(collect_completions(fd, 5, collected));
+  ASSERT_EQ(S_OK, collected.at(put_first));
+  ASSERT_EQ(S_OK, collected.at(get_first));
+  ASSERT_EQ(S_OK, collected.at(find));
+  ASSERT_EQ(S_OK, collected.at(put_second));
+  ASSERT_EQ(S_OK, collected.at(get_second));
+  ASSERT_EQ(first, got_first);
+  ASSERT_EQ(key, matched_key);
+  ASSERT_EQ(second, got_second);
+
+  IMCAS::async_handle_t close_handle  = IMCAS::ASYNC_HANDLE_INIT;
+  IMCAS::async_handle_t delete_handle = IMCAS::ASYNC_HANDLE_INIT;
+  ASSERT_EQ(S_OK, _mcas->async_close_pool(pool, close_handle));
+  ASSERT_EQ(S_OK, _mcas->async_delete_pool(poolname, delete_handle));
+  collected.clear();
+  ASSERT_NO_FATAL_FAILURE(collect_completions(fd, 2, collected));
+  ASSERT_EQ(S_OK, collected.at(close_handle));
+  ASSERT_EQ(S_OK, collected.at(delete_handle));
+}
+
+TEST_F(mcas_client_test, GetIntoBuffer)
+{
+  PMAJOR("Running GetIntoBuffer...");
+  ASSERT_TRUE(_mcas.get());
+
+  auto pool = create_pool("GetIntoBuffer");
+  ASSERT_NE(IMCAS::POOL_ERROR, pool);
+
+  const std::string key   = "bufferKey";
+  const std::string value = common::random_string(2000);
+  ASSERT_EQ(S_OK, _mcas->put(pool, key, value));
+
+  static constexpr size_t BUFFER_SIZE = KiB(4);
+  auto buffer = static_cast<char *>(::aligned_alloc(KiB(4), BUFFER_SIZE));
+  ASSERT_NE(nullptr, buffer);
+  auto handle = _mcas->register_direct_memory(buffer, BUFFER_SIZE);
+
+  size_t len = BUFFER_SIZE;
+  ASSERT_EQ(S_OK, _mcas->get(pool, key, buffer, len, handle));
+  ASSERT_EQ(value.size(), len);
+  ASSERT_EQ(value, std::string(buffer, len));
+
+  /* a buffer too small: the rest of the value spills into the receive buffer */
+  static constexpr size_t SHORT_LEN = 100;
+  std::memset(buffer, 0, BUFFER_SIZE);
+  len = SHORT_LEN;
+  ASSERT_EQ(E_INSUFFICIENT_SPACE, _mcas->get(pool, key, buffer, len, handle));
+  ASSERT_EQ(value.size(), len);
+  ASSERT_EQ(value.substr(0, SHORT_LEN), std::string(buffer, SHORT_LEN));
+  ASSERT_EQ('\0', buffer[SHORT_LEN]);
+
+  /* the spill leaves the connection in order */
+  std::string out_value;
+  ASSERT_EQ(S_OK, _mcas->get(pool, key, out_value));
+  ASSERT_EQ(value, out_value);
+
+  ASSERT_EQ(S_OK, _mcas->unregister_direct_memory(handle));
+  ::free(buffer);
+
+  delete_pool(pool, "GetIntoBuffer");
+}
+
+TEST_F(mcas_client_test, GetBorrowed)
+{
+  PMAJOR("Running GetBorrowed...");
+  ASSERT_TRUE(_mcas.get());
+
+  auto pool = create_pool("GetBorrowed");
+  ASSERT_NE(IMCAS::POOL_ERROR, pool);
+
+  /* include a value past the server's threshold for copying into the response */
+  static constexpr unsigned COUNT = 8;
+  std::vector<std::string>  values;
+  for (unsigned i = 0; i != COUNT; ++i) {
+    values.push_back(common::random_string(i + 1 == COUNT ? KiB(256) : 16 + i * 100));
+    ASSERT_EQ(S_OK, _mcas->put(pool, numbered_key("borrowKey-", i), values.back()));
+  }
+
+  std::vector<IMCAS::borrowed_value_t>         borrows;
+  std::vector<std::pair<const void *, size_t>> borrowed;
+  for (unsigned i = 0; i != COUNT; ++i) {
+    const void *            value     = nullptr;
+    size_t                  value_len = 0;
+    IMCAS::borrowed_value_t borrow    = nullptr;
+    ASSERT_EQ(S_OK, _mcas->get_borrowed(pool, numbered_key("borrowKey-", i), value, value_len, borrow));
+    ASSERT_NE(nullptr, borrow);
+    ASSERT_EQ(values[i], std::string(static_cast<const char *>(value), value_len));
+    borrows.push_back(borrow);
+    borrowed.emplace_back(value, value_len);
+  }
+
+  /* other traffic, including changes to the stored values, leaves the borrows alone */
+  for (unsigned i = 0; i != COUNT; ++i) {
+    ASSERT_EQ(S_OK, _mcas->put(pool, numbered_key("borrowKey-", i), "changed"));
+    std::string value;
+    ASSERT_EQ(S_OK, _mcas->get(pool, numbered_key("borrowKey-", i), value));
+    ASSERT_EQ("changed", value);
+  }
+  for (unsigned i = 0; i != COUNT; ++i) {
+    ASSERT_EQ(values[i], std::string(static_cast<const char *>(borrowed[i].first), borrowed[i].second));
+  }
+
+  for (auto borrow : borrows) ASSERT_EQ(S_OK, _mcas->release_borrowed(borrow));
+  ASSERT_EQ(E_INVAL, _mcas->release_borrowed(nullptr));
+
+  /* a key which does not exist sets no borrow */
+  const void *            value     = nullptr;
+  size_t                  value_len = 0;
+  IMCAS::borrowed_value_t borrow    = nullptr;
+  ASSERT_EQ(IKVStore::E_KEY_NOT_FOUND, _mcas->get_borrowed(pool, "borrowKey-missing", value, value_len, borrow));
+  ASSERT_EQ(nullptr, borrow);
+
+  delete_pool(pool, "GetBorrowed");
+}
+
+TEST_F(mcas_client_test, PipelinedPutGetErase)
+{
+  PMAJOR("Running PipelinedPutGetErase...");
+  ASSERT_TRUE(_mcas.get());
+
+  /* PIPELINE_WINDOW in the server's mcas_config.h */
+  static constexpr unsigned PIPELINE_WINDOW = 8;
+  static constexpr unsigned THREADS         = PIPELINE_WINDOW * 4;
+  static constexpr unsigned KEYS            = 50;
+
+  auto pool = create_pool("PipelinedPutGetErase", MiB(64));
+  ASSERT_NE(IMCAS::POOL_ERROR, pool);
+
+  /* More threads than the window share the connection. Values differ in
+   * size from thread to thread, so responses come back out of turn; each
+   * caller must see its own key's value, and its own key's status.
+   */
+  std::vector<unsigned>    failed(THREADS, 0);
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t != THREADS; ++t) {
+    threads.emplace_back([&failed, pool, t]() {
+      const auto prefix = "pipeKey-" + std::to_string(t) + "-";
+      for (unsigned i = 0; i != KEYS; ++i) {
+        const auto        key   = numbered_key(prefix, i);
+        const std::string value = key + std::string(1 + (t * 997 + i * 131) % KiB(4), 'v');
+        if (_mcas->put(pool, key, value) != S_OK) ++failed[t];
+
+        std::string got;
+        if (_mcas->get(pool, key, got) != S_OK || got != value) ++failed[t];
+
+        const void *            p     = nullptr;
+        size_t                  p_len = 0;
+        IMCAS::borrowed_value_t borrow = nullptr;
+        if (_mcas->get_borrowed(pool, key, p, p_len, borrow) != S_OK ||
+            std::string(static_cast<const char *>(p), p_len) != value)
+          ++failed[t];
+        if (borrow) _mcas->release_borrowed(borrow);
+
+        /* erase every other key, and check that only those are gone */
+        if (i % 2 == 0) {
+          if (_mcas->erase(pool, key) != S_OK) ++failed[t];
+          if (_mcas->get(pool, key, got) != IKVStore::E_KEY_NOT_FOUND) ++failed[t];
+        }
+      }
+    });
+  }
+  for (auto &th : threads) th.join();
+
+  for (unsigned t = 0; t != THREADS; ++t) EXPECT_EQ(0U, failed[t]) << "thread " << t;
+
+  /* what is left is what each thread did not erase */
+  for (unsigned t = 0; t != THREADS; ++t) {
+    const auto prefix = "pipeKey-" + std::to_string(t) + "-";
+    for (unsigned i = 0; i != KEYS; ++i) {
+      std::string got;
+      EXPECT_EQ(i % 2 == 0 ? IKVStore::E_KEY_NOT_FOUND : S_OK, _mcas->get(pool, numbered_key(prefix, i), got))
+        << prefix << i;
+    }
+  }
+
+  delete_pool(pool, "PipelinedPutGetErase");
+}
+
+TEST_F(mcas_client_test, Release)
+{
+  PLOG("Releasing instance...");
+
+  /* release instance */
+  _mcas.reset(nullptr);
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  try {
+    namespace po = boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()
+      ("help", "Show help")
+      ("debug", po::value<unsigned>()->default_value(0), "Debug level 0-3")
+      ("patience", po::value<unsigned>()->default_value(30), "Patience with server (seconds)")
+      ("server-addr", po::value<std::string>()->default_value("10.0.0.101:11911:verbs"), "Server address IP:PORT[:PROVIDER]")
+      ("device", po::value<std::string>()->default_value("mlx5_0"), "Network device (e.g., mlx5_0)")
+      ("pool", po::value<std::string>()->default_value("myPool"), "Pool name");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+
+    if (vm.count("help") > 0) {
+      std::cout << desc;
+      return -1;
+    }
+
+    Options.addr        = vm["server-addr"].as<std::string>();
+    Options.debug_level = vm["debug"].as<unsigned>();
+    Options.patience    = vm["patience"].as<unsigned>();
+    Options.pool        = vm["pool"].as<std::string>();
+    Options.device      = vm["device"].as<std::string>();
+
+    PLOG("Instantiating..");
+    instantiate();
+    PLOG("Instantiation OK.");
+
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+  }
+  catch (...) {
+    PLOG("bad command line option configuration");
+    return -1;
+  }
+
+  return 0;
+}
@@ -1,7 +1,8 @@
 #include "ramrbtree.h"
 #include <stdlib.h>
+#include <cctype>
+#include <cstring>
 #include <regex>
-#include <set>
 
 #define SINGLE_THREADED
 
@@ -9,7 +10,8 @@ using namespace component;
 using namespace std;
 
 Rbtree_secondary_index::Rbtree_secondary_index()
-  : _index{}
+  : _index{},
+    _regex_cache{}
 {
 }
 
@@ -30,13 +32,74 @@ string Rbtree_secondary_index::get(offset_t position) const
     throw out_of_range("Position out of range");
   }
 
-  auto it = _index.begin();
-  advance(it, position);
-  return *it;
+  return *_index.find_by_order(position);
 }
 
 size_t Rbtree_secondary_index::count() const { return _index.size(); }
 
+namespace
+{
+/**
+ * Extract the literal characters that any full match of an (ECMAScript)
+ * regular expression must begin with.  Conservative: stops at the first
+ * meta-character and gives up on alternation altogether.
+ */
+std::string regex_literal_prefix(const std::string& expression)
+{
+  std::string prefix;
+
+  if (expression.find('|') != std::string::npos) return prefix;
+
+  size_t i = 0;
+  while (i < expression.size()) {
+    char   c = expression[i];
+    size_t next;
+    if (c == '\\') {
+      /* escaped punctuation is a literal; \d, \w etc. are classes */
+      if (i + 1 >= expression.size() || isalnum(static_cast<unsigned char>(expression[i + 1]))) break;
+      c    = expression[i + 1];
+      next = i + 2;
+    }
+    else if (strchr(".[]()*+?{}^$", c)) {
+      break;
+    }
+    else {
+      next = i + 1;
+    }
+
+    if (next < expression.size()) {
+      char q = expression[next];
+      if (q == '*' || q == '?' || q == '{') break; /* may be absent */
+      if (q == '+') {
+        prefix += c;
+        break;
+      }
+    }
+    prefix += c;
+    i = next;
+  }
+  return prefix;
+}
+}  // namespace
+
+Rbtree_secondary_index::Regex_matcher::Regex_matcher(const std::string& expression)
+  : regex(expression, std::regex::ECMAScript | std::regex::optimize),
+    prefix(regex_literal_prefix(expression))
+{
+}
+
+const Rbtree_secondary_index::Regex_matcher& Rbtree_secondary_index::regex_matcher(const std::string& expression)
+{
+  /* find tasks call in repeatedly with the same expression and a small
+     comparison budget; compile once rather than on every call */
+  auto it = _regex_cache.find(expression);
+  if (it != _regex_cache.end()) return it->second;
+
+  if (_regex_cache.size() >= MAX_CACHED_REGEX) _regex_cache.clear();
+
+  return _regex_cache.emplace(expression, Regex_matcher(expression)).first->second;
+}
+
 status_t Rbtree_secondary_index::find(const std::string& key_expression,
                                       offset_t           begin_position,
                                       find_t             find_type,
@@ -48,36 +111,32 @@ status_t Rbtree_secondary_index::find(const std::string& key_expression,
     return E_FAIL;
   }
 
-  offset_t end_position = _index.size();
+  /* seek once in O(log n), then walk the tree in order */
+  auto it = _index.find_by_order(begin_position);
   unsigned attempts =0;
 
-
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wswitch" // enumeration value ‘FIND_TYPE_NONE’ not handled in switch
-  try {
-    switch (find_type) {
-    case FIND_TYPE_REGEX:
-      {
-        std::regex r(key_expression);
-        for (out_matched_pos = begin_position; out_matched_pos <= end_position; out_matched_pos++) {
-          string key = Rbtree_secondary_index::get(out_matched_pos);
-          if (regex_match(key, r)) {
-            out_matched_key = key;
-            return S_OK;
-          }
-          else {
-            if(++attempts > max_comparisons)
-              return E_MAX_REACHED;
-          }
+  switch (find_type) {
+  case FIND_TYPE_REGEX:
+    {
+      const Regex_matcher& m = regex_matcher(key_expression);
+
+      /* a literal prefix bounds the candidates to a contiguous range */
+      out_matched_pos = begin_position;
+      if (!m.prefix.empty()) {
+        offset_t range_begin = _index.order_of_key(m.prefix);
+        if (begin_position < range_begin) {
+          it              = _index.lower_bound(m.prefix);
+          out_matched_pos = range_begin;
         }
       }
-      break;
-    case FIND_TYPE_EXACT:
-      for (out_matched_pos = begin_position; out_matched_pos <= end_position; out_matched_pos++) {
-        PLOG("Getting from position %lu", out_matched_pos);
-        string key = Rbtree_secondary_index::get(out_matched_pos);
-        if (key.compare(key_expression) == 0) {
-          out_matched_key = key;
+
+      for (; it != _index.end(); ++it, out_matched_pos++) {
+        if (it->compare(0, m.prefix.size(), m.prefix) != 0) break;
+
+        if (regex_match(*it, m.regex)) {
+          out_matched_key = *it;
           return S_OK;
         }
         else {
@@ -85,27 +144,55 @@ status_t Rbtree_secondary_index::find(const std::string& key_expression,
             return E_MAX_REACHED;
         }
       }
-      break;
-    case FIND_TYPE_PREFIX:
-      for (out_matched_pos = begin_position; out_matched_pos <= end_position; out_matched_pos++) {
-        string key = Rbtree_secondary_index::get(out_matched_pos);
-        if (key.find(key_expression) != string::npos) {
-          out_matched_key = key;
-          return S_OK;
-        }
+    }
+    return E_OUT_OF_BOUNDS;
+  case FIND_TYPE_EXACT:
+    for (out_matched_pos = begin_position; it != _index.end(); ++it, out_matched_pos++) {
+      if (it->compare(key_expression) == 0) {
+        out_matched_key = *it;
+        return S_OK;
+      }
+      else {
+        if(++attempts > max_comparisons)
+          return E_MAX_REACHED;
+      }
+    }
+    return E_OUT_OF_BOUNDS;
+  case FIND_TYPE_PREFIX:
+    {
+      /* keys sharing a prefix are contiguous; seek to the first one and
+         stop at the first key outside the range */
+      offset_t range_begin = _index.order_of_key(key_expression);
+      if (begin_position < range_begin) {
+        it              = _index.lower_bound(key_expression);
+        out_matched_pos = range_begin;
+      }
+      else {
+        out_matched_pos = begin_position;
+      }
+
+      if (it != _index.end() && it->compare(0, key_expression.size(), key_expression) == 0) {
+        out_matched_key = *it;
+        return S_OK;
+      }
+    }
+    return E_OUT_OF_BOUNDS;
+  case FIND_TYPE_SUBSTRING:
+    for (out_matched_pos = begin_position; it != _index.end(); ++it, out_matched_pos++) {
+      if (it->find(key_expression) != string::npos) {
+        out_matched_key = *it;
+        return S_OK;
+      }
+      else {
+        if(++attempts > max_comparisons)
+          return E_MAX_REACHED;
       }
-      break;
-    case FIND_TYPE_NEXT:
-      if(begin_position >= end_position)
-        return E_FAIL;
-      out_matched_key = get(begin_position);
-      out_matched_pos = begin_position;
-      return S_OK;
-      break;
     }
-  }
-  catch(std::out_of_range& ex) {
     return E_OUT_OF_BOUNDS;
+  case FIND_TYPE_NEXT:
+    out_matched_key = *it;
+    out_matched_pos = begin_position;
+    return S_OK;
   }
 
 #pragma GCC diagnostic pop
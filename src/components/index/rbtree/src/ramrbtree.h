@@ -7,7 +7,11 @@
 #define __RBTREE_INDEX_COMPONENT_H__
 
 #include <string>
-#include <set>
+#include <functional>
+#include <map>
+#include <regex>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
 #include <api/kvindex_itf.h>
 
 class Rbtree_secondary_index : public component::IKVIndex {
@@ -43,7 +47,28 @@ class Rbtree_secondary_index : public component::IKVIndex {
                            std::string&       out_matched_key,
                            unsigned           max_comparisons = 0) override;
 private:
-  std::set<std::string> _index;
+  /* compiled regular expression and the literal prefix that any key it
+     matches must start with (empty if none could be extracted) */
+  struct Regex_matcher {
+    explicit Regex_matcher(const std::string& expression);
+
+    std::regex  regex;
+    std::string prefix;
+  };
+
+  static constexpr size_t MAX_CACHED_REGEX = 16;
+
+  const Regex_matcher& regex_matcher(const std::string& expression);
+
+  /* red-black tree augmented with subtree sizes (order statistics), so
+     that positional access (get, find resumption) is O(log n) */
+  using index_t = __gnu_pbds::tree<std::string,
+                                   __gnu_pbds::null_type,
+                                   std::less<std::string>,
+                                   __gnu_pbds::rb_tree_tag,
+                                   __gnu_pbds::tree_order_statistics_node_update>;
+  index_t                              _index;
+  std::map<std::string, Regex_matcher> _regex_cache;
 };
 
 class Rbtree_secondary_index_factory : public component::IKVIndex_factory {
@@ -9,6 +9,8 @@
 #include <gtest/gtest.h>
 #pragma GCC diagnostic pop
 
+#include <cstdio>
+#include <cstdlib> /* getenv */
 #include <ctime>
 
 #define COUNT 1000000
@@ -107,10 +109,88 @@ TEST_F(KVIndex_test, FIND)
   PINF("Key= %s", key.c_str());
 }
 
+TEST_F(KVIndex_test, FindPrefix)
+{
+  uint64_t pos = 0;
+  string   key;
+  ASSERT_EQ(S_OK, _kvindex->find("MyKey", 0, IKVIndex::FIND_TYPE_PREFIX, pos, key));
+  ASSERT_EQ(0UL, pos);
+  ASSERT_EQ("MyKey1", key);
+  ASSERT_EQ(S_OK, _kvindex->find("MyKey", pos + 1, IKVIndex::FIND_TYPE_PREFIX, pos, key));
+  ASSERT_EQ(1UL, pos);
+  ASSERT_EQ("MyKey2", key);
+  ASSERT_NE(S_OK, _kvindex->find("MyKey", pos + 1, IKVIndex::FIND_TYPE_PREFIX, pos, key));
+  ASSERT_EQ(S_OK, _kvindex->find("ab", 0, IKVIndex::FIND_TYPE_PREFIX, pos, key));
+  ASSERT_EQ(2UL, pos);
+}
+
+TEST_F(KVIndex_test, FindRegex)
+{
+  uint64_t pos = 0;
+  string   key;
+  /* literal prefix "MyKey" seeks straight to the range */
+  ASSERT_EQ(S_OK, _kvindex->find("MyKey[2-9]", 0, IKVIndex::FIND_TYPE_REGEX, pos, key, 10));
+  ASSERT_EQ(1UL, pos);
+  ASSERT_EQ("MyKey2", key);
+  ASSERT_NE(S_OK, _kvindex->find("MyKey[2-9]", pos + 1, IKVIndex::FIND_TYPE_REGEX, pos, key, 10));
+  /* no literal prefix: full scan */
+  ASSERT_EQ(S_OK, _kvindex->find(".*c|x", 0, IKVIndex::FIND_TYPE_REGEX, pos, key, 10));
+  ASSERT_EQ(2UL, pos);
+  ASSERT_EQ("abc", key);
+}
+
+TEST_F(KVIndex_test, FindSubstring)
+{
+  uint64_t pos = 0;
+  string   key;
+  ASSERT_EQ(S_OK, _kvindex->find("Key2", 0, IKVIndex::FIND_TYPE_SUBSTRING, pos, key, 10));
+  ASSERT_EQ(1UL, pos);
+  ASSERT_EQ("MyKey2", key);
+  ASSERT_EQ(E_MAX_REACHED, _kvindex->find("bc", 0, IKVIndex::FIND_TYPE_SUBSTRING, pos, key, 0));
+}
+
 TEST_F(KVIndex_test, Erase) { _kvindex->erase("MyKey"); }
 
 TEST_F(KVIndex_test, Count) { PINF("Size: %lu", _kvindex->count()); }
 
+/* Full key walk via find(FIND_TYPE_NEXT), as issued by IMCAS::find "next:".
+ * Runs at 1M, 10M and 100M keys, capped by WALK_COUNT_MAX (default 1M).
+ */
+TEST_F(KVIndex_test, WalkPerf)
+{
+  const unsigned long walk_max =
+    std::getenv("WALK_COUNT_MAX") ? std::stoul(std::getenv("WALK_COUNT_MAX")) : 1000000UL;
+
+  for (unsigned long n = 1000000UL; n <= walk_max && n <= 100000000UL; n *= 10) {
+    _kvindex->clear();
+    char key[32];
+    for (unsigned long i = 0; i < n; i++) {
+      snprintf(key, sizeof key, "key-%012lu", i);
+      _kvindex->insert(key);
+    }
+    ASSERT_EQ(n, _kvindex->count());
+
+    clock_t  start = clock();
+    uint64_t pos   = 0;
+    string   matched;
+    for (uint64_t i = 0; i < n; i++) {
+      ASSERT_EQ(S_OK, _kvindex->find("", i, IKVIndex::FIND_TYPE_NEXT, pos, matched));
+      ASSERT_EQ(i, pos);
+    }
+    double duration = double(clock() - start) / double(CLOCKS_PER_SEC);
+    PINF("Walk %lu keys: %lf sec (%lf usec/key)", n, duration, duration * 1e6 / double(n));
+
+    start = clock();
+    for (uint64_t i = 0; i < n; i += 997) {
+      snprintf(key, sizeof key, "key-%012lu", i);
+      ASSERT_EQ(string(key), _kvindex->get(i));
+    }
+    duration = double(clock() - start) / double(CLOCKS_PER_SEC);
+    PINF("Positional get over %lu keys: %lf sec", n, duration);
+  }
+  _kvindex->clear();
+}
+
 
 }  // namespace
 
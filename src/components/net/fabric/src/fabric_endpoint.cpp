@@ -41,6 +41,7 @@
 #include <rdma/fi_errno.h> /* fi_strerror */
 #include "rdma-fi_rma.h" /* fi_{read,recv,send,write}v, fj_inject, fi_sendmsg */
 
+#include <poll.h> /* pollfd */
 #include <sys/select.h> /* pselect */
 #include <sys/mman.h> /* madvise */
 #include <sys/resource.h> /* rusage */
@@ -554,7 +555,8 @@ std::size_t fabric_endpoint::poll_completions_tentative(const component::IFabric
 void fabric_endpoint::wait_for_next_completion(std::chrono::milliseconds timeout)
 {
   Fd_pair fd_unblock;
-  fd_unblock_set_monitor(_m_fd_unblock_set, _fd_unblock_set, fd_unblock.fd_write());
+  /* named, so that the fd stays registered for the whole wait */
+  fd_unblock_set_monitor m(_m_fd_unblock_set, _fd_unblock_set, fd_unblock.fd_write());
   /* Only block if we have not seen FI_SHUTDOWN */
   if ( ! _shut_down )
   {
@@ -633,6 +635,37 @@ void fabric_endpoint::wait_for_next_completion(unsigned polls_limit)
   }
 }
 
+std::unique_ptr<fd_unblock_set_monitor> fabric_endpoint::monitor_unblock(int fd_)
+{
+  return std::make_unique<fd_unblock_set_monitor>(_m_fd_unblock_set, _fd_unblock_set, fd_);
+}
+
+bool fabric_endpoint::completion_wait_fds(std::vector<::pollfd> &fds_)
+{
+  if ( _shut_down )
+  {
+    return false;
+  }
+#if USE_WAIT_SETS
+  return false;
+#else
+  static constexpr unsigned cq_count = 2;
+  ::fid_t f[cq_count] = { _rxcq.fid(), _txcq.fid() };
+  /* as in wait_for_next_completion, block only if the fabric says it is safe */
+  if ( fabric().trywait(f, cq_count) != FI_SUCCESS )
+  {
+    return false;
+  }
+  for ( unsigned i = 0; i != cq_count; ++i )
+  {
+    int fd;
+    CHECK_FI_ERR(::fi_control(f[i], FI_GETWAIT, &fd));
+    fds_.push_back(::pollfd{fd, POLLIN | POLLPRI, 0});
+  }
+  return true;
+#endif
+}
+
 /**
  * Unblock any threads waiting on completions
  *
@@ -22,6 +22,7 @@
 #include "fabric_ptr.h" /* fid_unique_ptr */
 #include "fabric_types.h" /* addr_ep_t */
 #include "fd_pair.h"
+#include "fd_unblock_set_monitor.h"
 
 #include "rdma-fi_domain.h" /* fi_cq_attr, fi_cq_err_entry, fi_cq_data_entry */
 
@@ -34,6 +35,7 @@
 #include <vector>
 
 struct fi_info;
+struct pollfd;
 struct fi_cq_err_entry;
 struct fid_cq;
 struct fid_domain;
@@ -230,6 +232,19 @@ public:
   void wait_for_next_completion(std::chrono::milliseconds timeout) override;
   void unblock_completions() override;
 
+  /* For a wait on several endpoints at once (see Fabric_server_factory::wait_for_activity) */
+
+  /* unblock_completions writes fd while the returned monitor lives */
+  std::unique_ptr<fd_unblock_set_monitor> monitor_unblock(int fd);
+  /*
+   * Add the fds which signal completions to fds. False if the caller
+   * should not block: a completion may be waiting, or the endpoint has
+   * shut down.
+   *
+   * @throw fabric_runtime_error : std::runtime_error : ::fi_control fail
+   */
+  bool completion_wait_fds(std::vector<::pollfd> &fds);
+
   /*
    * @throw fabric_runtime_error : std::runtime_error : ::fi_sendv fail
    */
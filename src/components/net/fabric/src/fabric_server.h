@@ -34,6 +34,7 @@ class Fabric_server
 {
 public:
 	void expect_event(std::uint32_t ev) { aep()->expect_event(ev); }
+	fabric_endpoint *endpoint() const { return aep(); }
   /*
    * @throw fabric_bad_alloc : std::bad_alloc - libfabric allocation out of memory
    *
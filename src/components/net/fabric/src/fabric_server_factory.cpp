@@ -15,10 +15,12 @@
 #include "fabric_server_factory.h"
 
 #include "fabric_server.h"
+#include "fd_pair.h"
 
+#include <poll.h> /* pollfd */
 #include <algorithm> /* transform */
 #include <iterator> /* back_inserter */
-#include <memory> /* make_shared, static_pointer_cast */
+#include <memory> /* make_shared, static_pointer_cast, unique_ptr */
 
 Fabric_server_factory::Fabric_server_factory(Fabric &fabric_, event_producer &eq_, ::fi_info &info_, std::uint32_t addr_, std::uint16_t port_)
   : Fabric_server_generic_factory(fabric_, eq_, info_, addr_, port_)
@@ -55,3 +57,21 @@ void Fabric_server_factory::close_connection(component::IFabric_server * cnxn_)
 {
   return Fabric_server_generic_factory::close_connection(static_cast<Fabric_server *>(cnxn_));
 }
+
+void Fabric_server_factory::wait_for_activity(const std::vector<component::IFabric_server *> &connections_, std::chrono::milliseconds timeout_)
+{
+  /* one fd, written by a new connection or by unblock_completions on any of the connections */
+  Fd_pair wake;
+  std::vector<::pollfd> fds{::pollfd{wake.fd_read(), POLLIN, 0}};
+  std::vector<std::unique_ptr<fd_unblock_set_monitor>> monitors;
+  for ( auto c : connections_ )
+  {
+    auto ep = static_cast<Fabric_server *>(c)->endpoint();
+    monitors.emplace_back(ep->monitor_unblock(wake.fd_write()));
+    if ( ! ep->completion_wait_fds(fds) )
+    {
+      return;
+    }
+  }
+  Fabric_server_generic_factory::wait_for_new_endpoint(fds, wake.fd_write(), timeout_);
+}
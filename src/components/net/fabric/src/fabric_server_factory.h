@@ -33,6 +33,12 @@ class Fabric_server_factory
 {
 public:
 	component::IFabric_endpoint_unconnected_server * get_new_endpoint_unconnected() override { return Fabric_server_generic_factory::get_new_endpoint_unconnected(); }
+	void wait_for_new_endpoint(std::chrono::milliseconds timeout) override { return Fabric_server_generic_factory::wait_for_new_endpoint(timeout); }
+  /*
+   * @throw fabric_runtime_error : std::runtime_error : ::fi_control fail
+   * @throw std::system_error : poll fail
+   */
+	void wait_for_activity(const std::vector<component::IFabric_server *> &connections, std::chrono::milliseconds timeout) override;
 	Fabric_server *open_connection(component::IFabric_endpoint_unconnected_server *) override;
   /**
    * Note: fi_info is not const because we reuse it when constructing the passize endpoint
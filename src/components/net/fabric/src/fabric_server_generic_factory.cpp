@@ -21,11 +21,13 @@
 #include "fabric_endpoint_server.h"
 #include "fabric_util.h" /* get_name */
 #include "fd_control.h"
+#include "fd_unblock_set_monitor.h"
 #include "system_fail.h"
 
 #include "rdma-fi_cm.h" /* fi_listen */
 
 #include <common/pointer_cast.h>
+#include <poll.h>
 #include <unistd.h> /* write */
 #include <netinet/in.h> /* sockaddr_in */
 #include <sys/select.h> /* fd_set, pselect */
@@ -36,6 +38,7 @@
 #include <exception>
 #include <functional> /* ref */
 #include <iostream> /* cerr */
+#include <limits> /* numeric_limits */
 #include <memory> /* make_shared */
 #include <string> /* to_string */
 #include <thread> /* sleep_for */
@@ -47,6 +50,8 @@ Fabric_server_generic_factory::Fabric_server_generic_factory(Fabric &fabric_, ev
   /* register as an event consumer */
   , _event_registration(eq_, *this, *_pep)
   , _m_pending{}
+  , _cv_pending{}
+  , _fd_pending_set{}
   , _pending{}
   , _open{}
   , _end{}
@@ -104,9 +109,18 @@ try
   case FI_CONNREQ:
     {
       auto aep = std::unique_ptr<component::IFabric_endpoint_unconnected_server>(new fabric_endpoint_server(_fabric, _eq, *entry_.info));
-      std::lock_guard<std::mutex> g{_m_pending};
-      pending_count++;
-      _pending.push(std::move(aep));
+      {
+        std::lock_guard<std::mutex> g{_m_pending};
+        pending_count++;
+        _pending.push(std::move(aep));
+        for ( auto fd : _fd_pending_set )
+        {
+          char c{};
+          auto sz = ::write(fd, &c, 1);
+          (void) sz;
+        }
+      }
+      _cv_pending.notify_all();
     }
     break;
   default:
@@ -298,6 +312,36 @@ auto Fabric_server_generic_factory::get_new_endpoint_unconnected() -> component:
   return _pending.remove().release();
 }
 
+void Fabric_server_generic_factory::wait_for_new_endpoint(std::chrono::milliseconds timeout_)
+{
+  std::unique_lock<std::mutex> g{_m_pending};
+  _cv_pending.wait_for(g, timeout_, [this] { return ! _pending.empty() || _listen_exception; });
+}
+
+void Fabric_server_generic_factory::wait_for_new_endpoint(std::vector<::pollfd> &fds_, int wake_fd_, std::chrono::milliseconds timeout_)
+{
+  fd_unblock_set_monitor m(_m_pending, _fd_pending_set, wake_fd_);
+  {
+    std::lock_guard<std::mutex> g{_m_pending};
+    if ( ! _pending.empty() || _listen_exception )
+    {
+      return;
+    }
+  }
+
+  const auto ms = std::min(timeout_.count(), std::chrono::milliseconds::rep(std::numeric_limits<int>::max()));
+  if ( -1 == ::poll(fds_.data(), fds_.size(), int(ms)) )
+  {
+    switch ( auto e = errno )
+    {
+    case EINTR:
+      break;
+    default:
+      system_fail(e, __func__);
+    }
+  }
+}
+
 void Fabric_server_generic_factory::open_connection_generic(event_expecter *c)
 {
 	c->expect_event(FI_CONNECTED);
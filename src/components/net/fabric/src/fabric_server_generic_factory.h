@@ -24,10 +24,14 @@
 #include "pending_cnxns.h"
 #include "open_cnxns.h"
 
+#include <chrono> /* milliseconds */
+#include <condition_variable>
 #include <cstdint> /* uint16_t */
 #include <future>
 #include <memory> /* shared_ptr */
 #include <mutex> /* mutex */
+#include <set>
+#include <vector>
 
 struct fi_info;
 struct fid_pep;
@@ -36,6 +40,7 @@ class Fabric;
 struct event_expecter;
 struct event_producer;
 struct fabric_endpoint;
+struct pollfd;
 namespace component
 {
 	class IFabric_endpoint_unconnected;
@@ -51,6 +56,8 @@ class Fabric_server_generic_factory
 
   /* pending connections: inserts by polling thread, removes by user thread */
   std::mutex _m_pending;
+  std::condition_variable _cv_pending; /* signalled on insert to _pending */
+  std::set<int> _fd_pending_set; /* written on insert to _pending */
   Pending_cnxns _pending;
 
   Open_cnxns _open;
@@ -107,6 +114,16 @@ public:
    */
   component::IFabric_endpoint_unconnected_server * get_new_endpoint_unconnected();
 
+  void wait_for_new_endpoint(std::chrono::milliseconds timeout);
+
+  /*
+   * Block until a new connection is pending, one of fds is ready, or the
+   * timeout expires. wake_fd is written when a connection is queued.
+   *
+   * @throw std::system_error : poll fail
+   */
+  void wait_for_new_endpoint(std::vector<::pollfd> &fds, int wake_fd, std::chrono::milliseconds timeout);
+
   void close_connection(event_expecter* connection);
 
   std::vector<event_expecter *> connections();
@@ -35,6 +35,7 @@ class Fabric_server_grouped_factory
 {
 public:
 	component::IFabric_endpoint_unconnected_server * get_new_endpoint_unconnected() override { return Fabric_server_generic_factory::get_new_endpoint_unconnected(); }
+	void wait_for_new_endpoint(std::chrono::milliseconds timeout) override { return Fabric_server_generic_factory::wait_for_new_endpoint(timeout); }
 	Fabric_server_grouped *open_connection(component::IFabric_endpoint_unconnected_server *) override;
   /**
    * Note: fi_info is not const because we reuse it when constructing the passize endpoint
@@ -42,3 +42,9 @@ auto Pending_cnxns::remove() -> cnxn_t
   }
   return c;
 }
+
+bool Pending_cnxns::empty()
+{
+  guard g{_m};
+  return _q.empty();
+}
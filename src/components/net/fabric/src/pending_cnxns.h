@@ -40,6 +40,7 @@ public:
   Pending_cnxns();
   void push(cnxn_t && c);
   cnxn_t remove();
+  bool empty();
 };
 
 #endif
@@ -206,20 +206,51 @@ namespace impl
 					for ( auto it = _buckets; it != _buckets_end; ++it )
 					{
 						typename bucket_type::owner_type &w = *it;
-						typename bucket_type::content_type &c = *it;
-						/* reconsititute key and value */
 						if ( w.is_adjacent_content_in_use() )
 						{
-							/* ERROR: depends on the types of first and second,
-							 * so should be handled by the session level, not here
-							 */
-							const_cast<
-								typename std::remove_const<typename bucket_type::content_type::key_t>::type &
-							>(c.value().first).reconstitute(av_);
-							std::get<0>(c.value().second).reconstitute(av_);
+							reconstitute_bucket(av_, std::size_t(it - _buckets));
 						}
 					}
 				}
+
+			/* Call f_ with the index of each bucket in [first_, last_) whose
+			 * content is in use. Reads only; may run concurrently with other
+			 * scans.
+			 */
+			template <typename F>
+				void in_use(
+					std::size_t first_
+					, std::size_t last_
+					, F f_
+				) const
+				{
+					for ( auto bi = first_; bi != last_; ++bi )
+					{
+						const typename bucket_type::owner_type &w = _buckets[bi];
+						if ( w.is_adjacent_content_in_use() )
+						{
+							f_(bi);
+						}
+					}
+				}
+
+			/* Reconstitute the key and value of the bucket at bi_ */
+			template <typename Allocator>
+				void reconstitute_bucket(
+					Allocator av_
+					, std::size_t bi_
+				)
+				{
+					typename bucket_type::content_type &c = _buckets[bi_];
+					/* reconsititute key and value */
+					/* ERROR: depends on the types of first and second,
+					 * so should be handled by the session level, not here
+					 */
+					const_cast<
+						typename std::remove_const<typename bucket_type::content_type::key_t>::type &
+					>(c.value().first).reconstitute(av_);
+					std::get<0>(c.value().second).reconstitute(av_);
+				}
 		};
 }
 
@@ -28,6 +28,7 @@
 #include <cstddef> /* size_t */
 #include <limits> /* numeric_limits */
 #include <string>
+#include <type_traits> /* remove_const */
 
 /*
  * content
@@ -92,6 +93,11 @@ namespace impl
 			{
 				return _value.first;
 			}
+			/* Record, in the key, a hint derived from its hash. Lets key compares fail early. */
+			void key_tag_set(typename std::remove_const_t<key_t>::tag_type t)
+			{
+				const_cast<std::remove_const_t<key_t> &>(_value.first).set_tag(t);
+			}
 			const mapped_t &mapped() const
 			{
 				return _value.second;
@@ -19,6 +19,7 @@
 
 #include "alloc_key.h" /* AK_ACTUAL */
 #include "construction_mode.h"
+#include "map_config.h"
 
 #include <common/perf/tm_fwd.h>
 
@@ -81,8 +82,9 @@ template <
 			persist_data_type *pc_
 			, construction_mode mode_
 			, const Allocator &av_ = Allocator()
+			, const map_config &mc_ = map_config()
 		)
-			: base(AK_REF pc_, mode_, av_)
+			: base(AK_REF pc_, mode_, av_, mc_)
 		{}
 #if 0
 		hop_hash(hop_hash &&) noexcept = default;
@@ -97,6 +99,10 @@ template <
 		using base::size;
 		using base::get_auto_resize;
 		using base::set_auto_resize;
+		using base::get_resize_step;
+		using base::set_resize_step;
+		using base::reconstitute_start;
+		using base::reconstitute_wait;
 		using base::bucket_count;
 		auto max_size() const noexcept -> size_type
 		{
@@ -24,11 +24,15 @@
 #include "bucket_unique_lock.h"
 #include "construction_mode.h"
 #include "hop_hash_iterators.h"
+#include "map_config.h"
 #include "trace_flags.h"
 #include <common/string_view.h>
 
 #include <cstddef> /* size_t */
+#include <future>
 #include <memory> /* allocator_traits */
+#include <mutex> /* call_once, once_flag */
+#include <shared_mutex> /* shared_lock */
 #include <tuple>
 #include <utility> /* pair */
 
@@ -189,6 +193,25 @@ namespace impl
 			hasher _hasher;
 
 			bool _auto_resize;
+			/* senior owners migrated per update during an incremental resize.
+			 * 0 selects a non-incremental resize.
+			 */
+			bix_t _resize_step;
+			/* Guards the incremental resize state (phase and cursor) and the
+			 * bucket count, which completing a resize changes. Key operations
+			 * hold it shared while a resize step holds it exclusively. Not
+			 * taken when incremental resize is off.
+			 */
+			mutable SharedMutex _resize_mutex;
+			/* threads which scan for allocations to reconstitute when a pool is opened */
+			unsigned _reconstitute_threads;
+			/* The allocator state was not reconstituted by the constructor. Set only
+			 * by the constructor; the reconstitution runs once, under _reconstitute_once,
+			 * in the background (reconstitute_start) or on first update (reconstitute_wait).
+			 */
+			bool _reconstitute_deferred;
+			std::once_flag _reconstitute_once;
+			std::shared_future<void> _reconstitute_lazy;
 
 			bucket_control_t _bc[_segment_capacity];
 
@@ -202,8 +225,44 @@ namespace impl
 				return persist_map_controller_t::segment_count_actual().value_not_stable();
 			}
 
+			std::shared_lock<SharedMutex> resize_shared_lock() const
+			{
+				return
+					_resize_step == 0
+					? std::shared_lock<SharedMutex>()
+					: std::shared_lock<SharedMutex>(_resize_mutex)
+					;
+			}
+
+			/* find, for a caller which holds resize_shared_lock */
+			template <typename K>
+				auto find_resizing(
+					TM_FORMAL
+					const K &k
+				) -> iterator;
+
+			/* An incremental resize is migrating content to the junior segment */
+			bool is_resizing() const
+			{
+				return persist_map_controller_t::current_resize_phase() == resize_phase::migrate;
+			}
+
+			/* Buckets in the ring of linked segments. During an incremental resize
+			 * the junior segment is linked but not yet counted.
+			 */
+			auto bucket_count_linked() const -> size_type
+			{
+				return is_resizing() ? bucket_count() * 2U : bucket_count();
+			}
+
 			auto bucket_ix(const hash_result_t h) const -> bix_t;
 			auto bucket_expanded_ix(const hash_result_t h) const -> bix_t;
+			/* The key tag: high-order hash bits, which do not select the bucket. Never 0. */
+			static auto key_tag(const hash_result_t h) -> typename key_type::tag_type
+			{
+				const auto t = typename key_type::tag_type(h >> (8U * (sizeof h - sizeof(typename key_type::tag_type))));
+				return t == 0 ? typename key_type::tag_type(1U) : t;
+			}
 
 			auto nearest_free_bucket(segment_and_bucket_t bi) -> content_unique_lock_t;
 
@@ -225,12 +284,24 @@ namespace impl
 					, const K &k
 				) const -> segment_and_bucket_t;
 
-			auto locate_key_inner(
-				TM_FORMAL
-				owner::value_type ownership_bits_
-				, segment_and_bucket_t sb_
-				, common::string_view k_
-			) const -> segment_and_bucket_t;
+			template <typename TagFn>
+				auto locate_key_inner(
+					TM_FORMAL
+					owner::value_type ownership_bits_
+					, segment_and_bucket_t sb_
+					, common::string_view k_
+					, TagFn tag_fn_
+				) const -> segment_and_bucket_t;
+
+			/* locate_key, for an owner_shared_lock which may be moved
+			 * to the expanded owner during an incremental resize.
+			 */
+			template <typename K>
+				auto locate_key_resizing(
+					TM_FORMAL
+					owner_shared_lock_t &bi
+					, const K &k
+				) const -> segment_and_bucket_t;
 
 			void resize(AK_FORMAL0);
 			void resize_pass1();
@@ -240,6 +311,14 @@ namespace impl
 				, bucket_control_t &junior_bucket_control
 				, content_unique_lock_t &populated_content_lk
 			);
+			void reconstitute_segments(const Allocator &av);
+			void reconstitute_deferred();
+			void resize_begin(AK_FORMAL0);
+			void resize_unwrap();
+			void resize_link();
+			void resize_step(bix_t owner_count);
+			void resize_migrate_owner(bix_t ix_senior_owner);
+			auto resize_movable(owner_unique_lock_t &senior_owner_lk) const -> owner::index_type;
 			auto locate_bucket_mutexes(
 				const segment_and_bucket_t &
 			) const -> bucket_mutexes_t &;
@@ -276,6 +355,7 @@ namespace impl
 
 			auto make_segment_and_bucket(bix_t ix) const -> segment_and_bucket_t;
 			auto make_segment_and_bucket_unsafe(bix_t ix) const -> segment_and_bucket_t;
+			auto make_segment_and_bucket_expanded(bix_t ix) const -> segment_and_bucket_t;
 			auto make_segment_and_bucket_for_iterator(
 				bix_t ix
 			) const -> segment_and_bucket_t;
@@ -313,6 +393,7 @@ namespace impl
 				persist_data_type *pc
 				, construction_mode mode
 				, const Allocator &av = Allocator()
+				, const map_config &mc = map_config()
 			);
 			hop_hash_base(const hop_hash_base &) = delete;
 			hop_hash_base(hop_hash_base &&) noexcept = default;
@@ -321,6 +402,10 @@ namespace impl
 		public:
 			hop_hash_base &operator=(const hop_hash_base &) = delete;
 			void check_consistency() const;
+			/* Start a deferred reconstitution in the background */
+			void reconstitute_start();
+			/* Wait for a deferred or background reconstitution to finish. Required before any update. */
+			void reconstitute_wait();
 			allocator_type get_allocator() const noexcept
 			{
 				return static_cast<const hop_hash_allocator<Allocator> &>(*this);
@@ -434,6 +519,9 @@ namespace impl
 
 			bool set_auto_resize(bool v1) { auto v0 = _auto_resize; _auto_resize = v1; return v0; }
 			bool get_auto_resize() const { return _auto_resize; }
+			/* set before the table is shared between threads */
+			void set_resize_step(bix_t step) { _resize_step = step; }
+			bix_t get_resize_step() const { return _resize_step; }
 
 #if TRACED_TABLE
 			friend
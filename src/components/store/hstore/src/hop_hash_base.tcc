@@ -30,10 +30,14 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdlib> /* getenv, strtoul */
 #include <exception>
+#include <future> /* async */
+#include <mutex>
 #include <sstream> /* ostringstream */
 #include <thread> /* this_thread */
 #include <utility> /* move */
+#include <vector>
 
 
 /*
@@ -54,11 +58,18 @@ template <
 		persist_data_type *pc_
 		, construction_mode mode_
 		, const Allocator &av_
+		, const map_config &mc_
 	)
 		: hop_hash_allocator<Allocator>{av_}
 		, persist_map_controller_t(AK_REF av_, pc_, mode_)
 		, _hasher{}
 		, _auto_resize{true}
+		, _resize_step(0)
+		, _resize_mutex{}
+		, _reconstitute_threads(std::max(1U, mc_.reconstitute_threads))
+		, _reconstitute_deferred(false)
+		, _reconstitute_once()
+		, _reconstitute_lazy()
 		, _consistency_check(hstore_consistency_check() ? atoi(hstore_consistency_check()) : 0)
 	{
 		const auto bp_src = this->persist_map_controller_t::bp_src();
@@ -79,11 +90,6 @@ template <
 		{
 			segment_layout::six_t ix = 0U;
 			_bc[ix].extend(_bc[ix].buckets(), &_bc[0], &_bc[0], ix);
-
-			if ( mode_ == construction_mode::reconstitute )
-			{
-				_bc[ix].reconstitute(av_);
-			}
 		}
 
 		for ( segment_layout::six_t ix = 1U; ix != this->persist_map_controller_t::segment_count_actual().value_not_stable(); ++ix )
@@ -91,10 +97,25 @@ template <
 			_bc[ix-1]._next = &_bc[ix];
 			_bc[0]._prev = &_bc[ix];
 			_bc[ix].extend(_bc[ix].buckets(), &_bc[ix-1], &_bc[0], ix);
+		}
 
-			if ( mode_ == construction_mode::reconstitute )
+		if ( mode_ == construction_mode::reconstitute )
+		{
+			/* If no recovery is needed, updates are the only operations which depend
+			 * on the reconstituted allocator state. Reconstitution may be deferred
+			 * to the background (see reconstitute_start), and updates wait for it.
+			 */
+			if (
+				mc_.reconstitute_lazy
+				&& this->persist_map_controller_t::segment_count_actual().is_stable()
+				&& this->persist_map_controller_t::is_size_stable()
+			)
 			{
-				_bc[ix].reconstitute(av_);
+				_reconstitute_deferred = true;
+			}
+			else
+			{
+				reconstitute_segments(av_);
 			}
 		}
 		hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, " segment_count ", this->persist_map_controller_t::segment_count_actual().value_not_stable()
@@ -122,8 +143,30 @@ template <
 			hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION
 				, " finishing resize in constructor"
 			);
-			resize_pass2();
-			this->persist_map_controller_t::resize_epilog();
+			if ( this->persist_map_controller_t::current_resize_phase() == resize_phase::none )
+			{
+				resize_pass2();
+				this->persist_map_controller_t::resize_epilog();
+			}
+			else
+			{
+				/* An incremental resize: finish it now, not over subsequent updates. */
+				if ( this->persist_map_controller_t::current_resize_phase() == resize_phase::unwrap )
+				{
+					resize_unwrap();
+					this->persist_map_controller_t::resize_state_set(resize_phase::migrate, 0U);
+				}
+				resize_link();
+				resize_step(bucket_count());
+			}
+		}
+		else if ( this->persist_map_controller_t::current_resize_phase() != resize_phase::none )
+		{
+			/* An incremental resize was recorded, but the segment count did not
+			 * change (crash before resize_interlog) or already changed (crash
+			 * after resize_epilog).
+			 */
+			this->persist_map_controller_t::resize_state_set(resize_phase::none, 0U);
 		}
 
 		hop_hash_log<TEST_HSTORE_PERISHABLE>::write(LOG_LOCATION, "HopHash base constructor: "
@@ -181,9 +224,124 @@ template <
 >
 	impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::~hop_hash_base()
 	{
+		if ( _reconstitute_lazy.valid() )
+		{
+			_reconstitute_lazy.wait();
+		}
 		perishable::report();
 	}
 
+/*
+ * Reconstitute the allocator state implied by the keys and values in all
+ * live segments. With more than one thread, the buckets of each segment
+ * are divided among _reconstitute_threads threads which scan for contents
+ * in use. The heap is not safe for concurrent injection, so the allocations
+ * found are then injected by this thread alone, without locking.
+ */
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::reconstitute_segments(
+		const Allocator &av_
+	)
+	{
+		const auto segment_count = this->persist_map_controller_t::segment_count_actual().value_not_stable();
+		const auto thread_count = _reconstitute_threads;
+		if ( thread_count == 1U )
+		{
+			for ( six_t ix = 0U; ix != segment_count; ++ix )
+			{
+				_bc[ix].reconstitute(av_);
+			}
+		}
+		else
+		{
+			/* per thread, in-use buckets as (segment, bucket index) */
+			using in_use_t = std::vector<std::pair<six_t, std::size_t>>;
+			std::vector<in_use_t> in_use(thread_count);
+			auto scan_share =
+				[this, &in_use, segment_count, thread_count] (unsigned t_)
+				{
+					for ( six_t ix = 0U; ix != segment_count; ++ix )
+					{
+						const auto sz = _bc[ix].segment_size();
+						_bc[ix].in_use(
+							sz * t_ / thread_count
+							, sz * (t_ + 1U) / thread_count
+							, [&in_use, ix, t_] (std::size_t bi) { in_use[t_].emplace_back(ix, bi); }
+						);
+					}
+				};
+
+			std::vector<std::future<void>> shares;
+			for ( auto t = 1U; t < thread_count; ++t )
+			{
+				shares.emplace_back(std::async(std::launch::async, scan_share, t));
+			}
+			scan_share(0U);
+			for ( auto &f : shares )
+			{
+				f.get();
+			}
+
+			for ( const auto &v : in_use )
+			{
+				for ( const auto &e : v )
+				{
+					_bc[e.first].reconstitute_bucket(av_, e.second);
+				}
+			}
+		}
+		hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, " reconstituted ", segment_count, " segments using ", thread_count, " threads");
+	}
+
+/*
+ * Run a reconstitution deferred by the constructor. Safe to call from any
+ * number of threads: the first runs it and the others wait for it to finish.
+ */
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::reconstitute_deferred()
+	{
+		if ( _reconstitute_deferred )
+		{
+			std::call_once(_reconstitute_once, [this] () { reconstitute_segments(get_allocator()); });
+		}
+	}
+
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::reconstitute_start()
+	{
+		/* called by the owner before the map is shared between threads */
+		if ( _reconstitute_deferred && ! _reconstitute_lazy.valid() )
+		{
+			_reconstitute_lazy = std::async(std::launch::async, [this] () { reconstitute_deferred(); }).share();
+		}
+	}
+
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::reconstitute_wait()
+	{
+		if ( _reconstitute_lazy.valid() )
+		{
+			/* get through a copy: a shared_future is safe to share only by copies.
+			 * get propagates any exception thrown by the reconstitution.
+			 */
+			auto f = _reconstitute_lazy;
+			f.get();
+		}
+		reconstitute_deferred();
+	}
+
 /*
  * Return a bit mask describing which contents are owned by the owner at a_.
  * bit 0 (LSB) is 1 iff the owner at a_ owns the content at a_, bit n is 1 iff
@@ -309,7 +467,7 @@ template <
 			(
 				(
 					last < first
-					? last + bucket_count()
+					? last + bucket_count_linked()
 					: last
 				) - first
 			);
@@ -601,43 +759,89 @@ template <
 			, const K &k_
 		) const -> segment_and_bucket_t
 		{
-			return locate_key_inner(TM_REF bi_.ref().ownership_bits(bi_), bi_.sb(), common::string_view(k_.data(), k_.size()));
+			return
+				locate_key_inner(
+					TM_REF bi_.ref().ownership_bits(bi_)
+					, bi_.sb()
+					, common::string_view(k_.data(), k_.size())
+					, [this, &k_] () { return key_tag(_hasher.hf(k_)); }
+				);
 		}
 
 template <
 	typename Key, typename T, typename Hash, typename Pred
 	, typename Allocator, typename SharedMutex
 >
-	auto impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::locate_key_inner(
-		TM_ACTUAL
-		owner::value_type ownership_bits_
-		, segment_and_bucket_t sb_
-		, const common::string_view k_
-	) const -> segment_and_bucket_t
-	{
-		TM_SCOPE()
-		/* Use the ownership bits to filter key checks, a performance aid to reduce the number of key compares. */
-		auto distance_to_end = owner::size;
-
-		while ( ownership_bits_ )
+	template <typename TagFn>
+		auto impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::locate_key_inner(
+			TM_ACTUAL
+			owner::value_type ownership_bits_
+			, segment_and_bucket_t sb_
+			, const common::string_view k_
+			, TagFn tag_fn_
+		) const -> segment_and_bucket_t
 		{
+			TM_SCOPE()
+			/* Use the ownership bits to filter key checks, a performance aid to reduce the number of key compares. */
+			auto distance_to_end = owner::size;
+			/* Use key tags to filter compares against out-of-line keys, which would
+			 * otherwise require a reference to the key data. The tag of k_ is computed
+			 * only if some candidate has a tag.
+			 */
+			typename key_type::tag_type tag = 0;
+
+			while ( ownership_bits_ )
+			{
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wconversion"
-			auto distance = unsigned(__builtin_ctzl(ownership_bits_));
+				auto distance = unsigned(__builtin_ctzl(ownership_bits_));
 #pragma GCC diagnostic pop
-			sb_.add_small(distance);
-			distance_to_end -= distance;
-			if ( key_equal()(sb_.deref().key(), k_) )
-			{
-				hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, " returns (success) ", sb_.index());
-				return sb_;
+				sb_.add_small(distance);
+				distance_to_end -= distance;
+				const auto &candidate = sb_.deref().key();
+				const auto candidate_tag = candidate.tag();
+				if ( candidate_tag != 0 && tag == 0 )
+				{
+					tag = tag_fn_();
+				}
+				if ( candidate.tag_admits(tag) && key_equal()(candidate, k_) )
+				{
+					hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, " returns (success) ", sb_.index());
+					return sb_;
+				}
+				ownership_bits_ = (ownership_bits_ >> distance) & ~owner::value_type(1);
 			}
-			ownership_bits_ = (ownership_bits_ >> distance) & ~owner::value_type(1);
+
+			sb_.add_small(distance_to_end);
+			return sb_;
 		}
 
-		sb_.add_small(distance_to_end);
-		return sb_;
-	}
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	template <typename K>
+		auto impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::locate_key_resizing(
+			TM_ACTUAL
+			owner_shared_lock_t &bi_
+			, const K &k_
+		) const -> segment_and_bucket_t
+		{
+			auto key_bi = locate_key(TM_REF bi_, k_);
+			/* During an incremental resize, a key not found at its senior owner
+			 * may have migrated to (or been inserted at) its expanded owner.
+			 */
+			if ( distance_small(bi_.sb(), key_bi) == owner::size && is_resizing() )
+			{
+				const auto ix_expanded = bucket_expanded_ix(_hasher.hf(k_));
+				if ( ix_expanded != bi_.index() )
+				{
+					bi_ = make_owner_shared_lock(make_segment_and_bucket_expanded(ix_expanded));
+					key_bi = locate_key(TM_REF bi_, k_);
+				}
+			}
+			return key_bi;
+		}
 
 template <
 	typename Key, typename T, typename Hash, typename Pred
@@ -659,11 +863,25 @@ template <
 			);
 
 		RETRY:
+			if ( is_resizing() )
+			{
+				resize_step(_resize_step);
+			}
+			/* keeps a resize step from changing the bucket count, or moving the key, during the attempt */
+			auto resize_lk = resize_shared_lock();
+
 			/* convert the args to a value_type */
 			value_type v(std::forward<Args>(args)...);
+			const auto hash = _hasher.hf(v.first);
 
-			/* The bucket in which to place the new entry */
-			auto sbw = make_segment_and_bucket(bucket(v.first));
+			/* The bucket in which to place the new entry. During an incremental
+			 * resize, new entries go directly to the expanded table.
+			 */
+			auto sbw =
+				is_resizing()
+				? make_segment_and_bucket_expanded(bucket_expanded_ix(hash))
+				: make_segment_and_bucket(bucket_ix(hash))
+				;
 			auto owner_lk = make_owner_unique_lock(sbw);
 
 			TM_SCOPE(check_exists)
@@ -676,6 +894,17 @@ template <
 					return {iterator{sbw, content_offset}, false};
 				}
 			}
+			/* The key may yet be owned by its senior owner */
+			if ( is_resizing() && sbw.index() != bucket_ix(hash) )
+			{
+				auto senior_owner_lk = make_owner_shared_lock(make_segment_and_bucket(bucket_ix(hash)));
+				auto senior_key_bi = locate_key(TM_REF senior_owner_lk, v.first);
+				auto content_offset = distance_small(senior_owner_lk.sb(), senior_key_bi);
+				if ( content_offset != owner::size )
+				{
+					return {iterator{senior_owner_lk.sb(), content_offset}, false};
+				}
+			}
 
 			/* the nearest free bucket */
 			try
@@ -704,6 +933,7 @@ template <
 					TM_SCOPE(insert)
 					persist_size_change<Allocator, size_incr> s(*this);
 					b_dst.ref().content_construct(owner_lk.index(), std::move(v));
+					b_dst.ref().key_tag_set(key_tag(hash));
 					if ( owner_lk.index() == b_dst.index() )
 					{
 						owner_lk.ref().set_adjacent_content_in_use();
@@ -739,9 +969,22 @@ template <
 				if ( _auto_resize )
 				{
 					owner_lk.unlock();
+					if ( resize_lk.owns_lock() )
+					{
+						resize_lk.unlock();
+					}
 
 					hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION, "1. before resize\n", dump<HSTORE_TRACE_MANY>::make_hop_hash_dump(*this));
 
+					if ( is_resizing() )
+					{
+						/* The expanded table filled before the incremental resize completed.
+						 * Complete it; the retry may start another.
+						 */
+						resize_step(bucket_count());
+						goto RETRY;
+					}
+
 					if ( segment_count() < _segment_capacity )
 					{
 						resize(AK_REF0);
@@ -781,6 +1024,12 @@ template <
 >
 	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize(AK_ACTUAL0)
 	{
+		if ( _resize_step != 0 )
+		{
+			resize_begin(AK_REF0);
+			return;
+		}
+
 		hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION
 			, " capacity ", bucket_count()
 			, " size ", size()
@@ -1092,6 +1341,249 @@ template <
 		_bc[0]._prev = &junior_bucket_control;
 	}
 
+/*
+ * Incremental resize.
+ *
+ * Begins like the non-incremental resize: a junior segment is allocated and
+ * the segment count is made unstable. Content is not copied wholesale. Instead,
+ * the junior segment is linked into the circular list of segments at once, so
+ * that the table appears to have its expanded bucket count, and the content of
+ * each senior owner which belongs to its expanded (junior) owner is moved a few
+ * owners at a time by subsequent updates. Until the last senior owner has been
+ * migrated, a key may be found either at its senior or at its junior owner.
+ */
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_begin(AK_ACTUAL0)
+	{
+		std::unique_lock<SharedMutex> resize_lk(_resize_mutex);
+		if ( is_resizing() )
+		{
+			/* another thread began the resize */
+			return;
+		}
+		hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION
+			, " incremental, capacity ", bucket_count()
+			, " size ", size()
+		);
+		const auto ix_junior = segment_count();
+		_bc[ix_junior].extend(
+			this->persist_map_controller_t::resize_prolog(AK_REF0)
+			, &_bc[ix_junior-1]
+			, &_bc[0]
+			, ix_junior
+		);
+		this->persist_map_controller_t::persist_new_segment("incremental resize junior segment");
+
+		/* The phase distinguishes an incremental resize from a pass 2 restart */
+		this->persist_map_controller_t::resize_state_set(resize_phase::unwrap, 0U);
+		this->persist_map_controller_t::resize_interlog();
+
+		resize_unwrap();
+		this->persist_map_controller_t::resize_state_set(resize_phase::migrate, 0U);
+		resize_link();
+	}
+
+/*
+ * Content owned by the last (owner::size - 1) senior owners may have wrapped
+ * to the start of the senior segments. Once the junior segment is linked, the
+ * range of those owners extends into the junior segment rather than wrapping.
+ * Copy the wrapped content to the corresponding junior buckets.
+ *
+ * Idempotent, as it may be repeated by a restart.
+ */
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_unwrap()
+	{
+		bucket_control_t &junior_bucket_control = _bc[segment_count_not_stable()];
+		for ( auto ix_owner = bucket_count() - (owner::size - 1U); ix_owner != bucket_count(); ++ix_owner )
+		{
+			auto owner_lk = make_owner_unique_lock(make_segment_and_bucket(ix_owner));
+			for ( auto p = owner::index_type(bucket_count() - ix_owner); p != owner::size; ++p )
+			{
+				if ( owner_lk.ref().is_in_use(owner_lk, p) )
+				{
+					const auto ix = ix_owner + p - bucket_count();
+					auto senior_content_lk = make_content_unique_lock(make_segment_and_bucket(ix));
+					/* special locate, used to access junior buckets before they are linked */
+					content_unique_lock_t
+						junior_content_lk(
+							junior_bucket_control.buckets()[ix]
+							, segment_and_bucket_t(&junior_bucket_control, ix)
+							, junior_bucket_control._bucket_mutexes[ix]._m_content
+						);
+					persist_size_change<Allocator, size_no_change> s(*this);
+					if ( ! junior_content_lk.owner_ref().is_adjacent_content_in_use() )
+					{
+						junior_content_lk.ref().content_share(senior_content_lk.ref());
+						junior_content_lk.owner_ref().set_adjacent_content_in_use(true);
+						this->persist_map_controller_t::persist_content(junior_content_lk.ref(), "unwrap content in use");
+					}
+					if ( senior_content_lk.owner_ref().is_adjacent_content_in_use() )
+					{
+						senior_content_lk.ref().content_erase();
+						senior_content_lk.owner_ref().set_adjacent_content_in_use(false);
+						this->persist_map_controller_t::persist_content(senior_content_lk.ref(), "unwrap content free");
+					}
+				}
+			}
+		}
+	}
+
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_link()
+	{
+		/* link in new segment in non-persistent circular list of segments */
+		const auto ix_junior = segment_count_not_stable();
+		_bc[ix_junior-1]._next = &_bc[ix_junior];
+		_bc[0]._prev = &_bc[ix_junior];
+	}
+
+/*
+ * Migrate up to owner_count_ senior owners, and complete the resize
+ * if no senior owners remain.
+ */
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_step(
+		bix_t owner_count_
+	)
+	{
+		std::unique_lock<SharedMutex> resize_lk(_resize_mutex);
+		if ( ! is_resizing() )
+		{
+			/* another thread completed the resize */
+			return;
+		}
+		auto ix_senior_owner = this->persist_map_controller_t::resize_cursor();
+		const auto ix_last = ix_senior_owner + std::min(owner_count_, bucket_count() - ix_senior_owner);
+		for ( ; ix_senior_owner != ix_last; ++ix_senior_owner )
+		{
+			resize_migrate_owner(ix_senior_owner);
+			this->persist_map_controller_t::resize_state_set(resize_phase::migrate, ix_senior_owner + 1U);
+		}
+
+		if ( ix_senior_owner == bucket_count() )
+		{
+			hop_hash_log<HSTORE_TRACE_RESIZE>::write(LOG_LOCATION
+				, " incremental resize complete, capacity ", bucket_count() * 2U
+			);
+			this->persist_map_controller_t::resize_epilog();
+			this->persist_map_controller_t::resize_state_set(resize_phase::none, 0U);
+		}
+	}
+
+/*
+ * The first position of content owned by the senior owner which belongs
+ * to the junior owner, or owner::size if there is none.
+ */
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	auto impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_movable(
+		owner_unique_lock_t &senior_owner_lk_
+	) const -> owner::index_type
+	{
+		auto sb = senior_owner_lk_.sb();
+		for ( owner::index_type p = 0U; p != owner::size; ++p, sb.incr_with_wrap() )
+		{
+			if (
+				senior_owner_lk_.ref().is_in_use(senior_owner_lk_, p)
+				&&
+				bucket_expanded_ix(_hasher.hf(sb.deref().key())) != senior_owner_lk_.index()
+			)
+			{
+				return p;
+			}
+		}
+		return owner::size;
+	}
+
+/*
+ * Move, to the junior owner, each element of the senior owner which belongs there.
+ */
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	void impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::resize_migrate_owner(
+		bix_t ix_senior_owner_
+	)
+	{
+		TM_ROOT()
+		const auto sb_senior_owner = make_segment_and_bucket(ix_senior_owner_);
+		const auto ix_junior_owner = ix_senior_owner_ + bucket_count();
+		const auto sb_junior_owner = make_segment_and_bucket_expanded(ix_junior_owner);
+
+		for ( ;; )
+		{
+			{
+				auto senior_owner_lk = make_owner_unique_lock(sb_senior_owner);
+				if ( resize_movable(senior_owner_lk) == owner::size )
+				{
+					break;
+				}
+			}
+
+			auto junior_owner_lk = make_owner_unique_lock(sb_junior_owner);
+			auto b_dst = make_space_for_insert(ix_junior_owner, nearest_free_bucket(sb_junior_owner));
+
+			/* make_space_for_insert may have relocated the senior owner's content */
+			auto senior_owner_lk = make_owner_unique_lock(sb_senior_owner);
+			const auto p = resize_movable(senior_owner_lk);
+			if ( p == owner::size )
+			{
+				break;
+			}
+			auto b_src = make_content_unique_lock(senior_owner_lk, p);
+
+			hop_hash_log<HSTORE_TRACE_MANY>::write(LOG_LOCATION
+				, " migrate content at ", b_src.sb()
+				, " owner ", ix_senior_owner_, " -> ", ix_junior_owner
+				, " to ", b_dst.sb()
+			);
+
+			persist_size_change<Allocator, size_no_change> s(*this);
+			/* A restart may find the content already owned by the junior owner */
+			const auto junior_key_sb = locate_key(TM_REF junior_owner_lk, b_src.ref().key());
+			if ( distance_small(junior_owner_lk.sb(), junior_key_sb) == owner::size )
+			{
+				b_dst.ref().content_share(b_src.ref(), ix_junior_owner);
+				b_dst.owner_ref().set_adjacent_content_in_use(true);
+				this->persist_map_controller_t::persist_content(b_dst.ref(), "migrate content in use");
+
+				junior_owner_lk.ref().insert(
+					ix_junior_owner
+					, distance_small(junior_owner_lk.sb(), b_dst.sb())
+					, junior_owner_lk
+					, gsl::not_null<persist_map_controller_t *>(this)
+				);
+				this->persist_map_controller_t::persist_owner(junior_owner_lk.ref(), "migrate junior owner");
+			}
+			senior_owner_lk.ref().erase(
+				p
+				, senior_owner_lk
+				, gsl::not_null<persist_map_controller_t *>(this)
+			);
+			this->persist_map_controller_t::persist_owner(senior_owner_lk.ref(), "migrate senior owner");
+
+			b_src.ref().content_erase();
+			b_src.owner_ref().set_adjacent_content_in_use(false);
+			this->persist_map_controller_t::persist_content(b_src.ref(), "migrate content free");
+		}
+	}
+
 template <
 	typename Key, typename T, typename Hash, typename Pred
 	, typename Allocator, typename SharedMutex
@@ -1167,6 +1659,25 @@ template <
 #endif
 	}
 
+/* Like make_segment_and_bucket, but ix_ may be in the junior segment */
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	auto impl::hop_hash_base<
+		Key, T, Hash, Pred, Allocator, SharedMutex
+	>::make_segment_and_bucket_expanded(
+		bix_t ix_
+	) const -> segment_and_bucket_t
+	{
+		assert( ix_ < bucket_count() * 2 );
+		return
+			ix_ < bucket_count()
+			? make_segment_and_bucket(ix_)
+			: segment_and_bucket_t(&_bc[segment_count_not_stable()], ix_ - bucket_count())
+			;
+	}
+
 template <
 	typename Key, typename T, typename Hash, typename Pred
 	, typename Allocator, typename SharedMutex
@@ -1212,7 +1723,7 @@ template <
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Warray-bounds"
 		return
-			si == segment_count()
+			si == segment_count_not_stable()
 			? segment_and_bucket_t(&_bc[si-1], _bc[si-1].segment_size() ) /* end iterator */
 			: segment_and_bucket_t(&_bc[si], bi)
 			;
@@ -1238,7 +1749,7 @@ template <
 		Key, T, Hash, Pred, Allocator, SharedMutex
 	>::make_segment_and_bucket_at_end() const -> segment_and_bucket_t
 	{
-		auto ix = bucket_count();
+		auto ix = bucket_count_linked();
 
 		auto si =
 			__builtin_expect((segment_layout::ix_high(ix) == 0),false)
@@ -1371,10 +1882,24 @@ template <
 			TM_ACTUAL
 			const K &k_
 		) -> iterator
+		{
+			auto resize_lk = resize_shared_lock();
+			return find_resizing(TM_REF k_);
+		}
+
+template <
+	typename Key, typename T, typename Hash, typename Pred
+	, typename Allocator, typename SharedMutex
+>
+	template <typename K>
+		auto impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>::find_resizing(
+			TM_ACTUAL
+			const K &k_
+		) -> iterator
 		{
 			TM_SCOPE()
 			auto bi_lk = make_owner_shared_lock(k_);
-			auto key_bi = locate_key(TM_REF bi_lk, k_);
+			auto key_bi = locate_key_resizing(TM_REF bi_lk, k_);
 			auto content_ix = distance_small(bi_lk.sb(), key_bi);
 			return content_ix == owner::size ? end() : iterator{bi_lk.sb(), content_ix};
 		}
@@ -1390,8 +1915,9 @@ template <
 		) const -> const_iterator
 		{
 			TM_SCOPE()
+			auto resize_lk = resize_shared_lock();
 			auto bi_lk = make_owner_shared_lock(k_);
-			auto key_bi = locate_key(TM_REF bi_lk, k_);
+			auto key_bi = locate_key_resizing(TM_REF bi_lk, k_);
 			return distance_small(bi_lk.si(), key_bi.si()) == owner::size ? end() : key_bi;
 		}
 
@@ -1425,7 +1951,7 @@ template <
 		{
 			persist_size_change<Allocator, size_decr> s(*this);
 			owner_lk.ref().erase(
-				static_cast<unsigned>(erase_src_lk.index()-owner_lk.index())
+				distance_small(owner_lk.sb(), erase_src_lk.sb())
 				, owner_lk
 				, gsl::not_null<persist_map_controller_t *>(this)
 			);
@@ -1460,7 +1986,12 @@ template <
 		try
 		{
 			consistency_guard<impl::hop_hash_base<Key, T, Hash, Pred, Allocator, SharedMutex>> g(this);
-			auto it = find(TM_REF k_);
+			if ( is_resizing() )
+			{
+				resize_step(_resize_step);
+			}
+			auto resize_lk = resize_shared_lock();
+			auto it = find_resizing(TM_REF k_);
 			return
 				it == end()
 				? 0U
@@ -1484,8 +2015,9 @@ template <
 			const K &k_
 		) const -> size_type
 		{
+			auto resize_lk = resize_shared_lock();
 			auto bi_lk = make_owner_shared_lock(k_);
-			auto key_bi = locate_key(TM_REF bi_lk, k_);
+			auto key_bi = locate_key_resizing(TM_REF bi_lk, k_);
 			return distance_small(bi_lk.sb(), key_bi.sb()) == owner::size ? 0U : 1U;
 		}
 
@@ -1500,9 +2032,10 @@ template <
 		) const -> const mapped_type &
 		{
 			TM_SCOPE()
+			auto resize_lk = resize_shared_lock();
 			/* The bucket which owns the entry */
 			auto bi_lk = make_owner_shared_lock(k_);
-			const auto key_bi = locate_key(TM_REF bi_lk, k_);
+			const auto key_bi = locate_key_resizing(TM_REF bi_lk, k_);
 			if ( distance_small(bi_lk.sb(), key_bi) == owner::size )
 			{
 				/* no such element */
@@ -1523,9 +2056,10 @@ template <
 		) -> mapped_type &
 		{
 			TM_SCOPE()
+			auto resize_lk = resize_shared_lock();
 			/* Lock the entry owner */
 			auto bi_lk = make_owner_shared_lock(k_);
-			const auto key_bi = locate_key(TM_REF bi_lk, k_);
+			const auto key_bi = locate_key_resizing(TM_REF bi_lk, k_);
 			if ( distance_small(bi_lk.sb(), key_bi) == owner::size )
 			{
 				/* no such element */
@@ -99,6 +99,7 @@ hstore::hstore(
 	, const string_view owner_
 	, const string_view name_
 	, std::unique_ptr<dax_manager> &&mgr_
+	, const map_config &map_config_
 	)
   : common::log_source(debug_level_)
   , _pool_manager(std::make_shared<pm_type>(
@@ -108,7 +109,8 @@ hstore::hstore(
 #endif
 		, owner_
 		, name_
-		, std::move(mgr_))
+		, std::move(mgr_)
+		, map_config_)
 	)
   , _pools_mutex{}
   , _pools{}
@@ -616,6 +618,17 @@ auto hstore::set_attribute(
       session->set_auto_resize(bool(value[0]));
       return S_OK;
     }
+#if ENABLE_TIMESTAMPS
+  case WRITE_TIME_INDEX:
+    if ( value.size() < 1 )
+    {
+      return E_BAD_PARAM;
+    }
+    {
+      session->set_write_log(bool(value[0]));
+      return S_OK;
+    }
+#endif
   default:
     return E_NOT_SUPPORTED;
   }
@@ -23,6 +23,7 @@
 
 #include "hop_hash.h"
 #include "hstore_nupm.h"
+#include "map_config.h"
 
 #include "region.h"
 
@@ -108,6 +109,7 @@ public:
 		, string_view owner
 		, string_view name
 		, std::unique_ptr<dax_manager> &&mgr
+		, const map_config &map_config
 	);
 
   /**
@@ -75,6 +75,9 @@ auto hstore_factory::create(
   auto dax_base_it = mc.find(+k_dax_base);
   auto dax_size_it = mc.find(+k_dax_size);
   auto dax_config_it = mc.find(+k_dax_config);
+  auto resize_step_it = mc.find(+k_resize_step);
+  auto reconstitute_threads_it = mc.find(+k_reconstitute_threads);
+  auto reconstitute_lazy_it = mc.find(+k_reconstitute_lazy);
 
   namespace c_json = common::json;
   using json = c_json::serializer<c_json::dummy_writer>;
@@ -83,6 +86,19 @@ auto hstore_factory::create(
   unsigned effective_debug_level = std::max(debug_level_, map_debug_level);
 	auto dax_base = dax_base_it == mc.end() ? nullptr : reinterpret_cast<byte *>(std::stoul(dax_base_it->second));
 	auto dax_size = dax_size_it == mc.end() ? std::size_t(0) : std::stoul(dax_size_it->second);
+  map_config map_config_;
+  if ( resize_step_it != mc.end() )
+  {
+    map_config_.resize_step = std::stoul(resize_step_it->second);
+  }
+  if ( reconstitute_threads_it != mc.end() )
+  {
+    map_config_.reconstitute_threads = unsigned(std::stoul(reconstitute_threads_it->second));
+  }
+  if ( reconstitute_lazy_it != mc.end() )
+  {
+    map_config_.reconstitute_lazy = std::stoul(reconstitute_lazy_it->second) != 0;
+  }
   component::IKVStore *obj =
     new hstore(
       effective_debug_level
@@ -97,6 +113,7 @@ auto hstore_factory::create(
           , bool(std::getenv("DAX_RESET"))
           , common::make_byte_span(dax_base, dax_size)
         )
+      , map_config_
     );
   obj->add_ref();
 
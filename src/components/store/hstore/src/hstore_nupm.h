@@ -20,6 +20,7 @@
 #include "alloc_key.h" /* AK_FORMAL */
 #include "hstore_nupm_types.h"
 #include "hstore_open_pool.h"
+#include "map_config.h"
 #include "persister_nupm.h"
 
 #include <common/string_view.h>
@@ -61,6 +62,7 @@ template <typename Region, typename Table, typename Allocator, typename LockType
 #endif
     std::unique_ptr<dax_manager> _dax_manager;
     unsigned _numa_node;
+    map_config _map_config;
 
     static unsigned name_to_numa_node(const string_view name);
   public:
@@ -72,6 +74,7 @@ template <typename Region, typename Table, typename Allocator, typename LockType
 			, const string_view owner
 			, const string_view name
 			, std::unique_ptr<dax_manager> mgr
+			, const map_config &map_config
 		);
 
     virtual ~hstore_nupm();
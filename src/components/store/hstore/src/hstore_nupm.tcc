@@ -57,6 +57,7 @@ template <typename Region, typename Table, typename Allocator, typename LockType
 		, const common::string_view // owner_
 		, const common::string_view name_
 		, std::unique_ptr<dax_manager> mgr_
+		, const map_config &map_config_
 	)
     : pool_manager<::open_pool<non_owner<region_type>>>(
 		debug_level_
@@ -66,6 +67,7 @@ template <typename Region, typename Table, typename Allocator, typename LockType
 #endif
     , _dax_manager(std::move(mgr_))
     , _numa_node(name_to_numa_node(name_))
+    , _map_config(map_config_)
   {}
 
 template <typename Region, typename Table, typename Allocator, typename LockType>
@@ -177,6 +179,7 @@ template <typename Region, typename Table, typename Allocator, typename LockType
 				this->debug_level()
 				, std::move(h)
 				, construction_mode::create
+				, _map_config
 			);
 		}
 		catch ( const General_exception &e )
@@ -248,6 +251,7 @@ template <typename Region, typename Table, typename Allocator, typename LockType
 	            this->debug_level()
 				, std::move(h)
 				, construction_mode::reconstitute
+				, _map_config
 			);
 		return s;
 	}
@@ -0,0 +1,42 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef MCAS_HSTORE_MAP_CONFIG_H
+#define MCAS_HSTORE_MAP_CONFIG_H
+
+#include <cstddef> /* size_t */
+
+/* Hash table tuning, from the component configuration */
+struct map_config
+{
+	/* senior owners migrated per update during an incremental resize.
+	 * 0 selects a non-incremental resize.
+	 */
+	std::size_t resize_step;
+	/* threads which scan the table for allocations to reconstitute when
+	 * a pool is opened
+	 */
+	unsigned reconstitute_threads;
+	/* when the pool needs no recovery, reconstitute allocations in the
+	 * background at open. Updates wait for the reconstitution.
+	 */
+	bool reconstitute_lazy;
+	map_config()
+		: resize_step(0)
+		, reconstitute_threads(1)
+		, reconstitute_lazy(false)
+	{}
+};
+
+#endif
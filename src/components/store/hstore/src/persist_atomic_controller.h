@@ -70,6 +70,7 @@ namespace impl
 		public:
 			persist_atomic_controller(
 				persist_type &persist_
+				, table_type &map_
 				, allocator_type al_
 				, construction_mode mode_
 			);
@@ -30,6 +30,7 @@ struct perishable_expiry;
 template <typename Table>
 	impl::persist_atomic_controller<Table>::persist_atomic_controller(
 			persist_type &persist_
+			, table_type &map_
 			, allocator_type al_
 			, construction_mode mode_
 		)
@@ -39,6 +40,11 @@ template <typename Table>
 			, _tick_expired(false)
 #endif
 		{
+			if ( _persist->mod_size != 0 )
+			{
+				/* An operation will be redone; the map must be reconstituted first */
+				map_.reconstitute_wait();
+			}
 			if ( mode_ == construction_mode::reconstitute && al_.pool()->can_reconstitute() )
 			{
 				/* reconstitute allocated memory */
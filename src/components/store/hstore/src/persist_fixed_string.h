@@ -29,6 +29,7 @@
 #include <array>
 #include <cassert>
 #include <cstddef> /* size_t */
+#include <cstdint> /* uint16_t */
 #include <cstring> /* memcpy */
 #include <memory> /* allocator_traits */
 #include <tuple> /* make_from_tuple */
@@ -216,6 +217,15 @@ template <typename T, std::size_t SmallLimit, typename Allocator>
 			sizeof _outline <= sizeof _inline.value
 			, "outline_type overlays _inline.size"
 		);
+		using tag_type = std::uint16_t;
+	private:
+		/* An out-of-line string keeps its tag in the last bytes of _inline.value */
+		static constexpr std::size_t tag_offset = sizeof _inline.value - sizeof(tag_type);
+		static_assert(
+			sizeof _outline <= tag_offset
+			, "outline_type overlays tag"
+		);
+	public:
 
 		/* ERROR: caller needs to persist */
 		persist_fixed_string()
@@ -453,6 +463,7 @@ template <typename T, std::size_t SmallLimit, typename Allocator>
 				{
 					_outline.assign(AK_REF first_, last_, fill_len_, alignment_, lock_, al_);
 					_inline.set_fixed();
+					set_tag(0);
 				}
 				return *this;
 			}
@@ -532,6 +543,7 @@ template <typename T, std::size_t SmallLimit, typename Allocator>
 					new (&_outline.al()) allocator_type_element(other._outline.al());
 					new (&_outline.P) ptr_t(other._outline.ptr());
 					_outline.ptr()->inc_ref(__LINE__, "=&");
+					set_tag(other.tag());
 				}
 			}
 			else
@@ -562,6 +574,7 @@ template <typename T, std::size_t SmallLimit, typename Allocator>
 					_outline.P = other._outline.P;
 					_outline.ptr()->inc_ref(__LINE__, "=&");
 					new (&_outline.al()) allocator_type_element(other._outline.al());
+					set_tag(other.tag());
 				}
 			}
 			return *this;
@@ -581,8 +594,9 @@ template <typename T, std::size_t SmallLimit, typename Allocator>
 					/* _inline <- _outline */
 					_inline = inline_type(fixed_data_location);
 					new (&_outline.al()) allocator_type_element(other._outline.al());
-					new (&_outline.cptr) cptr_type(other._outline.cptr);
-					other._outline.cptr = nullptr;
+					new (&_outline.P) ptr_t(other._outline.ptr());
+					other._outline.P = nullptr;
+					set_tag(other.tag());
 				}
 			}
 			else
@@ -598,7 +612,7 @@ template <typename T, std::size_t SmallLimit, typename Allocator>
 				{
 					auto sz = _outline.ptr()->alloc_element_count();
 					_outline.ptr()->~element_type();
-					_outline.al().deallocate(_outline.cptr, sz);
+					_outline.al().deallocate(_outline.P, sz);
 				}
 				_outline.al().~allocator_char_type();
 
@@ -610,9 +624,10 @@ template <typename T, std::size_t SmallLimit, typename Allocator>
 				else
 				{
 					/* _outline <- _outline */
-					_outline.cptr = other._outline.cptr;
+					_outline.P = other._outline.P;
 					new (&_outline.al()) allocator_type_element(other._outline.al());
-					other._outline.cptr = nullptr;
+					other._outline.P = nullptr;
+					set_tag(other.tag());
 				}
 			}
 			return *this;
@@ -719,6 +734,37 @@ template <typename T, std::size_t SmallLimit, typename Allocator>
 			return size() == other.size() && std::equal(data(), data() + size(), other.data());
 		}
 
+		/* A hint, derived from a hash of the string by its user, which lets a comparison
+		 * fail without a reference to out-of-line data. 0 means "no hint".
+		 * Inline strings have no tag: their data is at hand.
+		 */
+		tag_type tag() const
+		{
+			tag_type t = 0;
+			if ( ! is_inline() )
+			{
+				std::memcpy(&t, &_inline.value[tag_offset], sizeof t);
+			}
+			return t;
+		}
+
+		void set_tag(tag_type t_)
+		{
+			if ( ! is_inline() )
+			{
+				std::memcpy(&_inline.value[tag_offset], &t_, sizeof t_);
+			}
+		}
+
+		/* false only if the hint rules out equality with a string whose tag is t_.
+		 * An untagged string (0, e.g. one written before tags) admits every tag.
+		 */
+		bool tag_admits(tag_type t_) const
+		{
+			const auto t = tag();
+			return t == 0 || t == t_;
+		}
+
 		auto outline_size() const
 		{
 			assert(!is_inline());
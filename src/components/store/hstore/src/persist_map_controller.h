@@ -111,6 +111,7 @@ namespace impl
 			auto resize_restart_prolog() -> bucket_aligned_t *;
 			void resize_interlog();
 			void resize_epilog();
+			void resize_state_set(resize_phase p, bix_t c);
 
 			void size_stabilize();
 			void size_destabilize();
@@ -180,6 +181,14 @@ namespace impl
 			{
 				return _persist->_segment_count.specified();
 			}
+			resize_phase current_resize_phase() const
+			{
+				return _persist->_segment_count.get_resize_phase();
+			}
+			bix_t resize_cursor() const
+			{
+				return _persist->_segment_count.resize_cursor();
+			}
 
 			auto size_unstable() const /* debugging only */
 			{
@@ -240,3 +240,10 @@ template <typename Allocator>
 		_bucket_count_cached = bucket_count_uncached();
 		persist_segment_count();
 	}
+
+template <typename Allocator>
+	void impl::persist_map_controller<Allocator>::resize_state_set(resize_phase p_, bix_t c_)
+	{
+		_persist->_segment_count.set_resize_state(p_, c_);
+		persist_segment_count();
+	}
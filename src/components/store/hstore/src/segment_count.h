@@ -24,28 +24,72 @@
 #include "segment_layout.h" /* segment_layout::six_t */
 #include "value_unstable.h" /* value_unstable */
 
+#include <cassert>
+
 namespace impl
 {
 	using segment_count_actual_t = value_unstable<segment_layout::six_t, 1>;
 
+	/* Progress of an incremental resize:
+	 *   none: no incremental resize (a non-incremental resize may be in progress)
+	 *   unwrap: content which wrapped from the last senior bucket is moving to the junior segment
+	 *   migrate: senior owners are passing content to junior owners
+	 */
+	enum class resize_phase : unsigned
+	{
+		none
+		, unwrap
+		, migrate
+	};
+
 	struct segment_count
 	{
 	private:
+		using six_t = segment_layout::six_t;
+		using bix_t = segment_layout::bix_t;
 		/* current segment count */
 		segment_count_actual_t _actual;
-		/* desired segment count */
-		persistent_atomic_t<segment_layout::six_t> _specified;
+		/* desired segment count in the low bits and, above them, the state of an
+		 * incremental resize: its phase and the number of senior owners migrated.
+		 * Pools created before incremental resize hold zero above the count,
+		 * which reads as "no incremental resize"; the persistent layout of
+		 * segment_count is unchanged.
+		 */
+		persistent_atomic_t<six_t> _specified_and_resize;
+		static constexpr unsigned specified_bits = 8U;
+		static constexpr unsigned phase_bits = 2U;
+		static constexpr unsigned cursor_shift = specified_bits + phase_bits;
+		static constexpr six_t specified_mask = (six_t(1U) << specified_bits) - 1U;
+		static constexpr six_t phase_mask = (six_t(1U) << phase_bits) - 1U;
 	public:
-		segment_count(segment_layout::six_t specified_)
+		segment_count(six_t specified_)
 			: _actual(0)
-			, _specified(specified_)
-		{}
+			, _specified_and_resize(specified_)
+		{
+			assert(specified_ <= specified_mask);
+		}
 		segment_count_actual_t actual() const { return _actual; }
-		auto specified() const { return _specified; }
+		six_t specified() const { return _specified_and_resize & specified_mask; }
 		void actual_destabilize() { _actual.destabilize(); }
 		void actual_incr() { _actual.incr(); }
-		void actual_value_set_stable(segment_layout::six_t v) { _actual.value_set_stable(v); }
+		void actual_value_set_stable(six_t v) { _actual.value_set_stable(v); }
+		resize_phase get_resize_phase() const
+		{
+			return resize_phase((_specified_and_resize >> specified_bits) & phase_mask);
+		}
+		bix_t resize_cursor() const { return _specified_and_resize >> cursor_shift; }
+		/* phase and cursor change in a single store */
+		void set_resize_state(resize_phase p, bix_t c)
+		{
+			assert(c < (bix_t(1U) << (8U * sizeof(six_t) - cursor_shift)));
+			_specified_and_resize = specified() | (six_t(p) << specified_bits) | (c << cursor_shift);
+		}
 	};
+
+	static_assert(
+		sizeof(segment_count) == sizeof(segment_count_actual_t) + sizeof(persistent_atomic_t<segment_layout::six_t>)
+		, "persistent layout of segment_count changed"
+	);
 }
 
 #endif
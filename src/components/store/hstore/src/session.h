@@ -22,14 +22,18 @@
 #include "lock_result.h"
 #include "persist_atomic_controller.h"
 #include "construction_mode.h"
+#include "map_config.h"
 
 #include <common/string_view.h>
 #include <common/time.h> /* tsc_time_t, epoch_time_t */
+#include <common/write_log.h>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
+#include <shared_mutex> /* shared_lock */
 #include <tuple>
 #include <string>
 #include <functional>
@@ -69,6 +73,26 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		table_type _map;
 		impl::persist_atomic_controller<table_type> _atomic_state;
 		std::map<pool_iterator_type *, std::shared_ptr<pool_iterator_type>> _iterators;
+#if ENABLE_TIMESTAMPS
+		/* optional time-ordered index of writes, see IKVStore::WRITE_TIME_INDEX */
+		std::atomic<bool> _write_log_enabled;
+		/* After the map update, writers check _write_log_enabled without a
+		 * lock, and only if it is set take this shared to recheck and record.
+		 * Enabling holds it exclusive while it sets the flag and seeds the
+		 * log, so that every write is either seen by the seeding scan or
+		 * recorded.
+		 */
+		hstore_impl::shared_mutex _write_log_mutex;
+		common::Write_log _write_log;
+		void write_log_record(string_view key, common::Write_log::stamp_t stamp);
+		void write_log_record_erase(string_view key);
+
+		void log_write(
+			TM_FORMAL
+			const table_type &map
+			, string_view key
+		);
+#endif
 
 		static bool try_lock(typename std::tuple_element<0, mapped_type>::type &d, lock_type type);
 
@@ -103,6 +127,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 			unsigned debug_level
 			, handle_type &&pop
 			, construction_mode mode
+			, const map_config &map_config
 		);
 
 		~session();
@@ -194,6 +219,10 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 
 		void set_auto_resize(bool auto_resize);
 
+#if ENABLE_TIMESTAMPS
+		void set_write_log(bool enable);
+#endif
+
 		auto erase(
 			TM_FORMAL
 			const std::string & key
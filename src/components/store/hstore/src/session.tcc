@@ -65,6 +65,11 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		, _map(persist_data_, _heap)
 		, _atomic_state(*persist_data_, _map)
 		, _iterators()
+#if ENABLE_TIMESTAMPS
+		, _write_log_enabled(false)
+		, _write_log_mutex{}
+		, _write_log()
+#endif
 	{}
 
 template <typename Handle, typename Allocator, typename Table, typename LockType>
@@ -76,6 +81,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		unsigned debug_level_
 		, Handle &&pop_
 		, construction_mode mode_
+		, const map_config &map_config_
 	)
 		: session_base<Handle>(std::move(pop_), debug_level_)
 		, _heap(
@@ -85,10 +91,19 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		)
 		, _is_crash_consistent(_heap.pool()->is_crash_consistent())
 		, _pin_seq(_is_crash_consistent && (undo_redo_pin_data(AK_REF _heap) || undo_redo_pin_key(AK_REF _heap)))
-		, _map(AK_REF &this->pool()->persist_data()._persist_map, mode_, _heap)
-		, _atomic_state(this->pool()->persist_data()._persist_atomic, _heap, mode_)
+		, _map(AK_REF &this->pool()->persist_data()._persist_map, mode_, _heap, map_config_)
+		, _atomic_state(this->pool()->persist_data()._persist_atomic, _map, _heap, mode_)
 		, _iterators()
-	{}
+#if ENABLE_TIMESTAMPS
+		, _write_log_enabled(false)
+		, _write_log_mutex{}
+		, _write_log()
+#endif
+	{
+		_map.set_resize_step(map_config_.resize_step);
+		/* The atomic state has reconstituted its allocations; the map may finish in the background */
+		_map.reconstitute_start();
+	}
 
 template <typename Handle, typename Allocator, typename Table, typename LockType>
 	session<Handle, Allocator, Table, LockType>::~session()
@@ -198,6 +213,8 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 	auto session<Handle, Allocator, Table, LockType>::locate_map(const string_view key_) -> table_type &
     {
 		(void)key_;
+		/* non-const access may update the map or its allocations */
+		_map.reconstitute_wait();
 		return _map;
 	}
 
@@ -230,7 +247,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 
 		++this->_writes;
 		TM_SCOPE(emplace)
-		return
+		auto r =
 			map.emplace(
 				AK_REF
 				TM_REF
@@ -247,6 +264,13 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 #endif
 				)
 			);
+#if ENABLE_TIMESTAMPS
+		if ( r.second )
+		{
+			write_log_record(key, std::get<1>(r.first->second).raw());
+		}
+#endif
+		return r;
 	}
 
 template <typename Handle, typename Allocator, typename Table, typename LockType>
@@ -282,6 +306,9 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 				, 0
 				, std::tuple_element<0, mapped_type>::type::default_alignment /* requested default mapped_type alignment */
 			);
+#if ENABLE_TIMESTAMPS
+			log_write(TM_REF map, key);
+#endif
 		}
 		else
 		{
@@ -395,6 +422,9 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 				, d.size() < new_mapped_len ? new_mapped_len - d.size() : std::size_t(0)
 				, alignment_
 			);
+#if ENABLE_TIMESTAMPS
+			log_write(TM_REF map, key);
+#endif
 		}
 	}
 
@@ -454,6 +484,9 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 				auto &k = v.first;
 				auto &m = v.second;
 				auto &d = std::get<0>(m);
+#if ENABLE_TIMESTAMPS
+				write_log_record(key, std::get<1>(m).raw());
+#endif
 #if 0
 				PLOG(PREFIX "data exposed (newly created): %p", LOCATION, d.data_fixed());
 				PLOG(PREFIX "key exposed (newly created): %p", LOCATION, k.data_fixed());
@@ -514,6 +547,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 			if ( type == component::IKVStore::STORE_LOCK_WRITE && r.key != component::IKVStore::KEY_NONE )
 			{
 				std::get<1>(m) = impl::tsc_now();
+				write_log_record(key, std::get<1>(m).raw());
 			}
 #endif
 			return r;
@@ -579,6 +613,105 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		map.set_auto_resize(auto_resize);
 	}
 
+#if ENABLE_TIMESTAMPS
+template <typename Handle, typename Allocator, typename Table, typename LockType>
+	void session<Handle, Allocator, Table, LockType>::log_write(
+		TM_ACTUAL
+		const table_type &map_
+		, const string_view key_
+	)
+	{
+		if ( ! _write_log_enabled )
+		{
+			return;
+		}
+		std::shared_lock<hstore_impl::shared_mutex> g(_write_log_mutex);
+		if ( _write_log_enabled )
+		{
+			const std::string key(key_.data(), key_.size());
+			_write_log.record(key.data(), key.size(), std::get<1>(map_.at(TM_REF key)).raw());
+		}
+	}
+
+template <typename Handle, typename Allocator, typename Table, typename LockType>
+	void session<Handle, Allocator, Table, LockType>::write_log_record(
+		const string_view key_
+		, const common::Write_log::stamp_t stamp_
+	)
+	{
+		if ( ! _write_log_enabled )
+		{
+			return;
+		}
+		std::shared_lock<hstore_impl::shared_mutex> g(_write_log_mutex);
+		if ( _write_log_enabled )
+		{
+			_write_log.record(key_.data(), key_.size(), stamp_);
+		}
+	}
+
+template <typename Handle, typename Allocator, typename Table, typename LockType>
+	void session<Handle, Allocator, Table, LockType>::write_log_record_erase(
+		const string_view key_
+	)
+	{
+		if ( ! _write_log_enabled )
+		{
+			return;
+		}
+		std::shared_lock<hstore_impl::shared_mutex> g(_write_log_mutex);
+		if ( _write_log_enabled )
+		{
+			_write_log.record_erase(key_.data(), key_.size());
+		}
+	}
+
+template <typename Handle, typename Allocator, typename Table, typename LockType>
+	void session<Handle, Allocator, Table, LockType>::set_write_log(
+		bool enable_
+	)
+	{
+		std::unique_lock<hstore_impl::shared_mutex> g(_write_log_mutex);
+		if ( ! enable_ )
+		{
+			_write_log_enabled = false;
+			_write_log.clear();
+			return;
+		}
+		if ( _write_log_enabled )
+		{
+			return;
+		}
+
+		/* Set the flag before the seeding scan. A writer which then sees the
+		 * flag clear made its map update before the scan reached that bucket,
+		 * so the scan sees it; a writer which sees the flag set waits for the
+		 * seeding to finish, and records.
+		 */
+		_write_log_enabled = true;
+		try
+		{
+			const string_view key{};
+			auto & map = locate_map(key);
+			std::vector<common::Write_log::Entry> seed;
+			seed.reserve(map.size());
+			for ( auto &mt : map )
+			{
+				const auto &pstring = mt.first;
+				seed.push_back({std::get<1>(mt.second).raw(), std::string(pstring.data(), pstring.size()), false});
+			}
+			_write_log.clear();
+			_write_log.seed(std::move(seed));
+		}
+		catch ( ... )
+		{
+			_write_log_enabled = false;
+			_write_log.clear();
+			throw;
+		}
+	}
+#endif
+
 template <typename Handle, typename Allocator, typename Table, typename LockType>
 	auto session<Handle, Allocator, Table, LockType>::erase(
 		TM_ACTUAL
@@ -598,6 +731,9 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 				monitor_emplace<Allocator> me(this->allocator());
 				++this->_writes;
 				map.erase(it);
+#if ENABLE_TIMESTAMPS
+				write_log_record_erase(key);
+#endif
 				return S_OK;
 			}
 			else
@@ -688,6 +824,31 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		auto begin_tsc = t_begin.is_defined() ? std::numeric_limits<raw_type>::min() : impl::epoch_to_tsc(t_begin).raw();
 		auto end_tsc = t_end.is_defined() ? std::numeric_limits<raw_type>::max() : impl::epoch_to_tsc(t_end).raw();
 
+		if ( _write_log_enabled )
+		{
+			/* visit only keys written in range; an entry is current if the
+			 * key still carries the logged timestamp
+			 */
+			TM_ROOT()
+			for ( const auto &e : _write_log.range(begin_tsc, end_tsc) )
+			{
+				auto it = map.find(TM_REF e.key);
+				if ( it != map.end() && std::get<1>(it->second).raw() == e.stamp )
+				{
+					const auto &pstring = it->first;
+					const auto &m = it->second;
+					function_(
+						reinterpret_cast<const void*>(pstring.data())
+						, pstring.size()
+						, std::get<0>(m).data()
+						, std::get<0>(m).size()
+						, impl::tsc_to_epoch(std::get<1>(m))
+					);
+				}
+			}
+			return S_OK;
+		}
+
 		for ( auto &mt : map )
 		{
 			const auto &pstring = mt.first;
@@ -736,6 +897,9 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		)
 		{
 			_atomic_state.enter_update(AK_REF TM_REF this->allocator(), &map_, lock_, key_, first_, last_);
+#if ENABLE_TIMESTAMPS
+			log_write(TM_REF map_, key_);
+#endif
 		}
 
 template <typename Handle, typename Allocator, typename Table, typename LockType>
@@ -774,6 +938,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		, std::size_t alignment_
 	)
 	{
+		_map.reconstitute_wait();
 		persistent_t<char *> p = nullptr;
 		/* ERROR: leaks memory on a crash */
 		allocator().allocate_tracked(AK_REF p, size, clean_align(alignment_, sizeof(void *)));
@@ -786,6 +951,7 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 		, size_t size
 	)
 	{
+		_map.reconstitute_wait();
 #if 0
 		persistent_t<char *> p = static_cast<char *>(const_cast<void *>(addr));
 		/* ERROR: if using a crash-consistent allocator, may leak memory on a crash */
@@ -835,6 +1001,10 @@ template <typename Handle, typename Allocator, typename Table, typename LockType
 			d0.mapped()
 			, d1.mapped()
 		);
+#if ENABLE_TIMESTAMPS
+		log_write(TM_REF map0, key0);
+		log_write(TM_REF map1, key1);
+#endif
 
 		return S_OK;
 	}
@@ -1419,6 +1419,73 @@ TEST_F(KVStore_test, Timestamps)
   ASSERT_EQ(S_OK, _kvstore->close_pool(pool));
 }
 
+TEST_F(KVStore_test, WriteTimeIndex)
+{
+	ASSERT_NE(nullptr, _kvstore);
+	pool = _kvstore->create_pool("write-index-test.pool", MiB(32), component::IKVStore::FLAGS_CREATE_ONLY);
+	ASSERT_NE(0, int64_t(pool));
+
+	if ( _kvstore->get_capability(IKVStore::Capability::WRITE_TIMESTAMPS) )
+	{
+		std::vector<std::string> keys;
+		for ( unsigned i=0; i != 10; ++i )
+		{
+			keys.push_back(common::random_string(8));
+			_kvstore->put(pool, keys.back(), "old", 3);
+		}
+
+		/* enabling seeds the index with the keys already present */
+		ASSERT_EQ(S_OK, _kvstore->set_attribute(pool, IKVStore::Attribute::WRITE_TIME_INDEX, {1}));
+
+		sleep(1);
+		auto now = common::epoch_now();
+
+		/* 5 new keys, 2 rewritten, 1 erased */
+		for ( unsigned i=0; i != 5; ++i )
+		{
+			keys.push_back(common::random_string(8));
+			_kvstore->put(pool, keys.back(), "new", 3);
+		}
+		_kvstore->put(pool, keys[0], "newer", 5);
+		_kvstore->put(pool, keys[1], "newer", 5);
+		ASSERT_EQ(S_OK, _kvstore->erase(pool, keys.back()));
+
+		auto count_since =
+			[] (component::IKVStore::pool_t pool_, common::epoch_time_t t)
+			{
+				unsigned n = 0;
+				_kvstore->map(
+					pool_
+					, [&n] (const void *, const size_t, const void *, const size_t, const common::tsc_time_t) -> bool
+					{
+						++n;
+						return true;
+					}
+					, t
+					, 0
+				);
+				return n;
+			};
+
+		EXPECT_EQ(6U, count_since(pool, now));
+		EXPECT_EQ(15U - 1U, count_since(pool, 0));
+
+		/* without the index, the same answers by scan */
+		ASSERT_EQ(S_OK, _kvstore->set_attribute(pool, IKVStore::Attribute::WRITE_TIME_INDEX, {0}));
+		EXPECT_EQ(6U, count_since(pool, now));
+		EXPECT_EQ(15U - 1U, count_since(pool, 0));
+
+		/* re-enabling after further writes seeds from the current contents */
+		_kvstore->put(pool, keys[2], "newest", 6);
+		ASSERT_EQ(S_OK, _kvstore->set_attribute(pool, IKVStore::Attribute::WRITE_TIME_INDEX, {1}));
+		EXPECT_EQ(7U, count_since(pool, now));
+		EXPECT_EQ(15U - 1U, count_since(pool, 0));
+	}
+
+	ASSERT_EQ(S_OK, _kvstore->close_pool(pool));
+	ASSERT_EQ(S_OK, _kvstore->delete_pool("write-index-test.pool"));
+}
+
 /* copied from mapstore */
 TEST_F(KVStore_test, Iterator)
 {
@@ -0,0 +1,245 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "store_map.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <common/utils.h>
+#include <api/components.h>
+/* note: we do not include component source, only the API definition */
+#include <api/kvstore_itf.h>
+
+#include <algorithm> /* max */
+#include <cstdlib> /* getenv */
+#include <set>
+#include <string>
+
+/*
+ * Incremental resize: with resize_step set, a table expansion migrates only
+ * a few senior buckets per update. These tests grow a table across many
+ * such steps while inserting and erasing, and close/reopen the pool at
+ * points which fall in the middle of a resize.
+ */
+
+using namespace component;
+
+namespace {
+
+class KVStore_test
+  : public ::testing::Test
+{
+ protected:
+  static component::IKVStore *_kvstore;
+  static component::IKVStore::pool_t pool;
+  /* keys currently expected to be in the pool */
+  static std::set<std::string> present;
+  /* keys [0, key_limit) have been touched */
+  static std::size_t key_limit;
+
+  /* small enough that a resize does not finish within one update */
+  static constexpr unsigned resize_step = 1;
+  /* enough keys to force several expansions of the initial table */
+  static const std::size_t key_count;
+  /* close and reopen the pool after this many updates */
+  static constexpr std::size_t reopen_interval = 97;
+
+  static std::string pool_name()
+  {
+    return "test-" + store_map::impl->name + store_map::numa_zone() + "-resize.pool";
+  }
+  static std::string debug_level()
+  {
+    return std::getenv("DEBUG") ? std::getenv("DEBUG") : "0";
+  }
+  static std::string key(std::size_t i) { return "key-" + std::to_string(i); }
+  static std::string value(std::size_t i) { return "value-" + std::to_string(i * 7); }
+
+  static void reopen()
+  {
+    ASSERT_EQ(S_OK, _kvstore->close_pool(pool));
+    pool = _kvstore->open_pool(pool_name());
+    ASSERT_NE(+component::IKVStore::POOL_ERROR, pool);
+  }
+
+  static void verify_all()
+  {
+    EXPECT_EQ(present.size(), _kvstore->count(pool));
+    for ( auto i = std::size_t(); i != key_limit; ++i )
+    {
+      void *v = nullptr;
+      std::size_t v_len = 0;
+      auto r = _kvstore->get(pool, key(i), v, v_len);
+      if ( present.count(key(i)) )
+      {
+        EXPECT_EQ(S_OK, r) << key(i);
+        if ( r == S_OK )
+        {
+          EXPECT_EQ(value(i), std::string(static_cast<const char *>(v), v_len));
+          _kvstore->free_memory(v);
+        }
+      }
+      else
+      {
+        EXPECT_EQ(IKVStore::E_KEY_NOT_FOUND, r) << key(i);
+      }
+    }
+  }
+};
+
+component::IKVStore *KVStore_test::_kvstore = nullptr;
+component::IKVStore::pool_t KVStore_test::pool;
+std::set<std::string> KVStore_test::present;
+std::size_t KVStore_test::key_limit = 0;
+constexpr unsigned KVStore_test::resize_step;
+constexpr std::size_t KVStore_test::reopen_interval;
+const std::size_t KVStore_test::key_count =
+  std::getenv("COUNT_TARGET") ? std::stoul(std::getenv("COUNT_TARGET")) : 5000;
+
+TEST_F(KVStore_test, Instantiate)
+{
+  /* create object instance through factory */
+  auto link_library = "libcomponent-" + store_map::impl->name + ".so";
+  component::IBase * comp = component::load_component(link_library,
+                                                      store_map::impl->factory_id);
+
+  ASSERT_TRUE(comp);
+  auto fact =
+    component::make_itf_ref(
+      static_cast<IKVStore_factory *>(
+        comp->query_interface(IKVStore_factory::iid())
+      )
+    );
+
+  _kvstore =
+    fact->create(
+      0
+      , {
+          { +component::IKVStore_factory::k_dax_config, store_map::location }
+          , { +component::IKVStore_factory::k_debug, debug_level() }
+          , { +component::IKVStore_factory::k_resize_step, std::to_string(resize_step) }
+        }
+    );
+}
+
+TEST_F(KVStore_test, RemoveOldPool)
+{
+  if ( _kvstore )
+  {
+    try
+    {
+      _kvstore->delete_pool(pool_name());
+    }
+    catch ( Exception & )
+    {
+    }
+  }
+}
+
+TEST_F(KVStore_test, CreatePool)
+{
+  ASSERT_TRUE(_kvstore);
+  /* expected object count 1: start with the smallest table */
+  pool = _kvstore->create_pool(pool_name(), MiB(32), 0, 1);
+  ASSERT_LT(0, int64_t(pool));
+}
+
+TEST_F(KVStore_test, GrowWhileInsertingAndErasing)
+{
+  ASSERT_LT(0, int64_t(pool));
+  /* insert every key, erasing every third key shortly after its insertion,
+   * so that erases land in both the junior and senior halves of a resize
+   */
+  for ( auto i = std::size_t(); i != key_count; ++i )
+  {
+    auto r = _kvstore->put(pool, key(i), value(i).data(), value(i).size());
+    ASSERT_EQ(S_OK, r) << key(i);
+    present.insert(key(i));
+    key_limit = i + 1;
+    if ( i % 3 == 2 )
+    {
+      auto e = i - 2;
+      EXPECT_EQ(S_OK, _kvstore->erase(pool, key(e))) << key(e);
+      present.erase(key(e));
+    }
+    /* every key inserted so far must remain reachable during the resize */
+    if ( i % 101 == 0 )
+    {
+      void *v = nullptr;
+      std::size_t v_len = 0;
+      auto k = key(i / 2);
+      if ( present.count(k) )
+      {
+        EXPECT_EQ(S_OK, _kvstore->get(pool, k, v, v_len)) << k;
+        if ( v ) { _kvstore->free_memory(v); }
+      }
+    }
+  }
+  verify_all();
+}
+
+TEST_F(KVStore_test, ReopenMidResize)
+{
+  ASSERT_LT(0, int64_t(pool));
+  /* Re-insert the erased keys and add as many new keys again, reopening
+   * the pool every reopen_interval updates. With a step of one bucket per
+   * update most of the reopens fall in the middle of a resize, which
+   * reconstitution must complete.
+   */
+  auto updates = std::size_t();
+  for ( auto i = std::size_t(); i != 2 * key_count; ++i )
+  {
+    if ( ! present.count(key(i)) )
+    {
+      ASSERT_EQ(S_OK, _kvstore->put(pool, key(i), value(i).data(), value(i).size())) << key(i);
+      present.insert(key(i));
+      key_limit = std::max(key_limit, i + 1);
+      if ( ++updates % reopen_interval == 0 )
+      {
+        reopen();
+      }
+    }
+  }
+  reopen();
+  verify_all();
+}
+
+TEST_F(KVStore_test, ClosePool)
+{
+  if ( _kvstore && int64_t(pool) > 0 )
+  {
+    EXPECT_EQ(S_OK, _kvstore->close_pool(pool));
+  }
+}
+
+TEST_F(KVStore_test, DeletePool)
+{
+  if ( _kvstore )
+  {
+    EXPECT_EQ(S_OK, _kvstore->delete_pool(pool_name()));
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  auto r = RUN_ALL_TESTS();
+
+  return r;
+}
@@ -0,0 +1,216 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "store_map.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <common/utils.h>
+#include <api/components.h>
+/* note: we do not include component source, only the API definition */
+#include <api/kvstore_itf.h>
+
+#include <cstdlib> /* getenv */
+#include <string>
+
+/*
+ * Reconstitution at pool open: allocator state is rebuilt from the keys and
+ * values of a populated pool, with the table scanned by several threads,
+ * and (second test) in the background. Values must read back intact, and
+ * updates after the open must not reuse memory which is still in use.
+ */
+
+using namespace component;
+
+namespace {
+
+class KVStore_test
+  : public ::testing::Test
+{
+ protected:
+  static component::IKVStore *_kvstore;
+  static constexpr unsigned reconstitute_threads = 4;
+  static const std::size_t key_count;
+
+  static component::IKVStore *kvstore() { return _kvstore; }
+  static std::string pool_name()
+  {
+    return "test-" + store_map::impl->name + store_map::numa_zone() + "-reconstitute.pool";
+  }
+  static std::string debug_level()
+  {
+    return std::getenv("DEBUG") ? std::getenv("DEBUG") : "0";
+  }
+  static std::string key(std::size_t i) { return "reconstitute-key-" + std::to_string(i); }
+  /* long enough that key and value both need allocations */
+  static std::string value(std::size_t i, char c = 'v') { return std::string(40 + i % 50, c) + std::to_string(i); }
+
+  static component::IKVStore *make_store(bool lazy_)
+  {
+    auto link_library = "libcomponent-" + store_map::impl->name + ".so";
+    component::IBase * comp = component::load_component(link_library,
+                                                        store_map::impl->factory_id);
+    EXPECT_TRUE(comp);
+    if ( ! comp ) { return nullptr; }
+    auto fact =
+      component::make_itf_ref(
+        static_cast<IKVStore_factory *>(
+          comp->query_interface(IKVStore_factory::iid())
+        )
+      );
+
+    return
+      fact->create(
+        0
+        , {
+            { +component::IKVStore_factory::k_dax_config, store_map::location }
+            , { +component::IKVStore_factory::k_debug, debug_level() }
+            , { +component::IKVStore_factory::k_reconstitute_threads, std::to_string(reconstitute_threads) }
+            , { +component::IKVStore_factory::k_reconstitute_lazy, lazy_ ? "1" : "0" }
+          }
+      );
+  }
+
+  static void instantiate(bool lazy);
+  static void populate();
+  static void reopen_and_read();
+  static void reopen_and_update();
+  static void delete_pool();
+
+  static void verify(component::IKVStore::pool_t pool_, char c_)
+  {
+    EXPECT_EQ(key_count, kvstore()->count(pool_));
+    for ( auto i = std::size_t(); i != key_count; ++i )
+    {
+      void *v = nullptr;
+      std::size_t v_len = 0;
+      auto r = kvstore()->get(pool_, key(i), v, v_len);
+      EXPECT_EQ(S_OK, r) << key(i);
+      if ( r == S_OK )
+      {
+        EXPECT_EQ(value(i, c_), std::string(static_cast<const char *>(v), v_len)) << key(i);
+        kvstore()->free_memory(v);
+      }
+    }
+  }
+};
+
+component::IKVStore *KVStore_test::_kvstore = nullptr;
+constexpr unsigned KVStore_test::reconstitute_threads;
+const std::size_t KVStore_test::key_count =
+  std::getenv("COUNT_TARGET") ? std::stoul(std::getenv("COUNT_TARGET")) : 10000;
+
+void KVStore_test::instantiate(bool lazy_)
+{
+  _kvstore = make_store(lazy_);
+  ASSERT_TRUE(kvstore());
+  try
+  {
+    kvstore()->delete_pool(pool_name());
+  }
+  catch ( Exception & )
+  {
+  }
+}
+
+void KVStore_test::populate()
+{
+  ASSERT_TRUE(kvstore());
+  auto pool = kvstore()->create_pool(pool_name(), MiB(64), 0, key_count);
+  ASSERT_LT(0, int64_t(pool));
+  for ( auto i = std::size_t(); i != key_count; ++i )
+  {
+    ASSERT_EQ(S_OK, kvstore()->put(pool, key(i), value(i).data(), value(i).size())) << key(i);
+  }
+  EXPECT_EQ(S_OK, kvstore()->close_pool(pool));
+}
+
+void KVStore_test::reopen_and_read()
+{
+  ASSERT_TRUE(kvstore());
+  auto pool = kvstore()->open_pool(pool_name());
+  ASSERT_LT(0, int64_t(pool));
+  /* reads need no reconstituted allocator state, and may overlap a lazy reconstitution */
+  verify(pool, 'v');
+  EXPECT_EQ(S_OK, kvstore()->close_pool(pool));
+}
+
+void KVStore_test::reopen_and_update()
+{
+  ASSERT_TRUE(kvstore());
+  auto pool = kvstore()->open_pool(pool_name());
+  ASSERT_LT(0, int64_t(pool));
+  /* Replace every value immediately after the open. If any allocation were
+   * missing from the reconstituted state, a new value could overwrite a
+   * live key or value, which verify would detect.
+   */
+  for ( auto i = std::size_t(); i != key_count; i += 2 )
+  {
+    ASSERT_EQ(S_OK, kvstore()->erase(pool, key(i))) << key(i);
+    ASSERT_EQ(S_OK, kvstore()->put(pool, key(i), value(i, 'u').data(), value(i, 'u').size())) << key(i);
+  }
+  for ( auto i = std::size_t(1); i < key_count; i += 2 )
+  {
+    ASSERT_EQ(S_OK, kvstore()->put(pool, key(i), value(i, 'u').data(), value(i, 'u').size())) << key(i);
+  }
+  verify(pool, 'u');
+  EXPECT_EQ(S_OK, kvstore()->close_pool(pool));
+
+  /* and again, after the updates */
+  pool = kvstore()->open_pool(pool_name());
+  ASSERT_LT(0, int64_t(pool));
+  verify(pool, 'u');
+  EXPECT_EQ(S_OK, kvstore()->close_pool(pool));
+}
+
+void KVStore_test::delete_pool()
+{
+  ASSERT_TRUE(kvstore());
+  EXPECT_EQ(S_OK, kvstore()->delete_pool(pool_name()));
+  kvstore()->release_ref();
+  _kvstore = nullptr;
+}
+
+/* allocator state reconstituted during open_pool */
+TEST_F(KVStore_test, EagerReconstitute)
+{
+  instantiate(false);
+  populate();
+  reopen_and_read();
+  reopen_and_update();
+  delete_pool();
+}
+
+/* allocator state reconstituted in the background after open_pool */
+TEST_F(KVStore_test, LazyReconstitute)
+{
+  instantiate(true);
+  populate();
+  reopen_and_read();
+  reopen_and_update();
+  delete_pool();
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  auto r = RUN_ALL_TESTS();
+
+  return r;
+}
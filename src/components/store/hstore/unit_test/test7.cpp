@@ -0,0 +1,302 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "store_map.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <store/hstore/src/persist_fixed_string.h>
+#include <common/utils.h>
+#include <api/components.h>
+/* note: we do not include component source, only the API definition */
+#include <api/kvstore_itf.h>
+
+#include <city.h>
+#include <cstdlib> /* aligned_alloc, free, getenv */
+#include <string>
+#include <utility> /* move */
+#include <vector>
+
+/*
+ * Key tags: an out-of-line hstore key carries 16 bits of its hash, which
+ * lets a lookup skip candidates without reading their key data.
+ *
+ * The first tests exercise the tag of a persist_fixed_string directly, on
+ * the heap. The last puts long keys which share a bucket (and therefore a
+ * neighbourhood) into a pool, grows the table past them, and reopens the
+ * pool: every key must still be found, and keys which were never stored
+ * (but share the bucket) must not be.
+ */
+
+using namespace component;
+
+namespace {
+
+/* An allocator for persist_fixed_string outside of any pool */
+template <typename T>
+  struct heap_allocator
+  {
+    using value_type = T;
+    heap_allocator() = default;
+    template <typename U>
+      heap_allocator(const heap_allocator<U> &) {}
+    void allocate(char *&p_, std::size_t sz_, std::size_t alignment_)
+    {
+      p_ = static_cast<char *>(std::aligned_alloc(alignment_, (sz_ * sizeof(T) + alignment_ - 1) / alignment_ * alignment_));
+      if ( ! p_ ) { throw std::bad_alloc(); }
+    }
+    void deallocate(char *&p_, std::size_t) { std::free(p_); p_ = nullptr; }
+    void persist(const void *, std::size_t) const {}
+  };
+
+using string_type = persist_fixed_string<char, 24, heap_allocator<char>>;
+using tag_type = string_type::tag_type;
+
+const std::string short_data("short");
+const std::string long_data("a string too long to be stored inline, 47 bytes");
+
+string_type make_string(const std::string &s_)
+{
+  return string_type(s_.begin(), s_.end(), lock_state::free, heap_allocator<char>());
+}
+
+std::string str(const string_type &s_)
+{
+  return std::string(s_.data(), s_.size());
+}
+
+TEST(Key_tag, InlineHasNoTag)
+{
+  auto s = make_string(short_data);
+  ASSERT_TRUE(s.is_inline());
+  s.set_tag(0x1234);
+  EXPECT_EQ(0, s.tag());
+  EXPECT_TRUE(s.tag_admits(0x1234));
+  EXPECT_TRUE(s.tag_admits(0x4321));
+  EXPECT_EQ(short_data, str(s));
+}
+
+TEST(Key_tag, ZeroTagAlwaysCompares)
+{
+  auto s = make_string(long_data);
+  ASSERT_FALSE(s.is_inline());
+  /* an out-of-line string starts untagged, as do all keys in pools written before tags */
+  EXPECT_EQ(0, s.tag());
+  for ( auto t : { tag_type(1), tag_type(0x1234), tag_type(0xffff) } )
+  {
+    EXPECT_TRUE(s.tag_admits(t)) << t;
+  }
+  s.set_tag(0x1234);
+  EXPECT_EQ(0x1234, s.tag());
+  EXPECT_TRUE(s.tag_admits(0x1234));
+  EXPECT_FALSE(s.tag_admits(0x4321));
+  /* the tag shares storage with the inline area, not with the data */
+  EXPECT_EQ(long_data, str(s));
+  /* reassignment makes a new string, which must not inherit the old hint */
+  s.assign(long_data.rbegin(), long_data.rend(), lock_state::free, heap_allocator<char>());
+  EXPECT_EQ(0, s.tag());
+}
+
+TEST(Key_tag, CopyAndMoveKeepTag)
+{
+  const tag_type t = 0xbeef;
+  auto s = make_string(long_data);
+  s.set_tag(t);
+
+  string_type c(s);
+  EXPECT_EQ(t, c.tag());
+  EXPECT_EQ(long_data, str(c));
+
+  string_type m(std::move(c));
+  EXPECT_EQ(t, m.tag());
+  EXPECT_EQ(long_data, str(m));
+
+  /* assignment to an inline string, and to an out-of-line string with another tag */
+  auto ca = make_string(short_data);
+  ca = s;
+  EXPECT_EQ(t, ca.tag());
+  EXPECT_EQ(long_data, str(ca));
+
+  auto ma = make_string(long_data + "!");
+  ma.set_tag(0x1111);
+  ma = std::move(m);
+  EXPECT_EQ(t, ma.tag());
+  EXPECT_EQ(long_data, str(ma));
+
+  auto mi = make_string(short_data);
+  mi = std::move(ma);
+  EXPECT_EQ(t, mi.tag());
+  EXPECT_EQ(long_data, str(mi));
+
+  /* an inline source leaves no tag behind */
+  mi = make_string(short_data);
+  EXPECT_TRUE(mi.is_inline());
+  EXPECT_EQ(0, mi.tag());
+}
+
+class KVStore_test
+  : public ::testing::Test
+{
+ protected:
+  /* all colliding keys agree in this many low hash bits, more than the table will use */
+  static constexpr unsigned collision_bits = 16;
+  /* fewer than a neighbourhood */
+  static constexpr std::size_t collision_count = 24;
+  /* enough to resize the table several times */
+  static constexpr std::size_t filler_count = 2000;
+
+  static std::string pool_name()
+  {
+    return "test-" + store_map::impl->name + store_map::numa_zone() + "-tag.pool";
+  }
+  static std::string debug_level()
+  {
+    return std::getenv("DEBUG") ? std::getenv("DEBUG") : "0";
+  }
+  static std::uint64_t hash(const std::string &k_) { return CityHash64(k_.data(), k_.size()); }
+
+  /* Long keys whose hashes agree in the low collision_bits, so that they
+   * all start in one bucket. Every other one is stored; the rest are
+   * probes which must not be found.
+   */
+  static std::vector<std::string> colliding_keys()
+  {
+    const auto mask = (std::uint64_t(1) << collision_bits) - 1U;
+    const std::string prefix(40, 'k');
+    std::vector<std::string> v;
+    std::uint64_t target = 0;
+    for ( std::size_t i = 0; v.size() != collision_count * 2; ++i )
+    {
+      auto k = prefix + std::to_string(i);
+      auto h = hash(k);
+      if ( v.empty() )
+      {
+        target = h & mask;
+      }
+      if ( ( h & mask ) == target )
+      {
+        v.push_back(k);
+      }
+    }
+    return v;
+  }
+
+  static std::string value(const std::string &k_) { return "value of " + k_; }
+
+  static component::IKVStore *make_store()
+  {
+    auto link_library = "libcomponent-" + store_map::impl->name + ".so";
+    component::IBase * comp = component::load_component(link_library,
+                                                        store_map::impl->factory_id);
+    EXPECT_TRUE(comp);
+    if ( ! comp ) { return nullptr; }
+    auto fact =
+      component::make_itf_ref(
+        static_cast<IKVStore_factory *>(
+          comp->query_interface(IKVStore_factory::iid())
+        )
+      );
+
+    return
+      fact->create(
+        0
+        , {
+            { +component::IKVStore_factory::k_dax_config, store_map::location }
+            , { +component::IKVStore_factory::k_debug, debug_level() }
+          }
+      );
+  }
+
+  static void verify(component::IKVStore *kvstore_, component::IKVStore::pool_t pool_, const std::vector<std::string> &keys_)
+  {
+    for ( auto i = std::size_t(); i != keys_.size(); ++i )
+    {
+      const auto &k = keys_[i];
+      void *v = nullptr;
+      std::size_t v_len = 0;
+      auto r = kvstore_->get(pool_, k, v, v_len);
+      if ( i % 2 == 0 )
+      {
+        EXPECT_EQ(S_OK, r) << k;
+        if ( r == S_OK )
+        {
+          EXPECT_EQ(value(k), std::string(static_cast<const char *>(v), v_len)) << k;
+          kvstore_->free_memory(v);
+        }
+      }
+      else
+      {
+        EXPECT_EQ(IKVStore::E_KEY_NOT_FOUND, r) << k;
+      }
+    }
+  }
+};
+
+constexpr unsigned KVStore_test::collision_bits;
+constexpr std::size_t KVStore_test::collision_count;
+constexpr std::size_t KVStore_test::filler_count;
+
+TEST_F(KVStore_test, CollidingOutOfLineKeys)
+{
+  const auto keys = colliding_keys();
+  auto kvstore = make_store();
+  ASSERT_TRUE(kvstore);
+  try
+  {
+    kvstore->delete_pool(pool_name());
+  }
+  catch ( Exception & )
+  {
+  }
+
+  auto pool = kvstore->create_pool(pool_name(), MiB(32), 0, 0);
+  ASSERT_LT(0, int64_t(pool));
+  for ( auto i = std::size_t(); i < keys.size(); i += 2 )
+  {
+    ASSERT_EQ(S_OK, kvstore->put(pool, keys[i], value(keys[i]).data(), value(keys[i]).size())) << keys[i];
+  }
+  verify(kvstore, pool, keys);
+
+  /* grow the table: the colliding keys are relocated, and must keep their tags */
+  for ( auto i = std::size_t(); i != filler_count; ++i )
+  {
+    auto k = "filler-key-" + std::to_string(i) + std::string(32, 'f');
+    ASSERT_EQ(S_OK, kvstore->put(pool, k, value(k).data(), value(k).size())) << k;
+  }
+  verify(kvstore, pool, keys);
+  EXPECT_EQ(S_OK, kvstore->close_pool(pool));
+
+  /* tags are persistent */
+  pool = kvstore->open_pool(pool_name());
+  ASSERT_LT(0, int64_t(pool));
+  verify(kvstore, pool, keys);
+  EXPECT_EQ(keys.size() / 2 + filler_count, kvstore->count(pool));
+  EXPECT_EQ(S_OK, kvstore->close_pool(pool));
+
+  EXPECT_EQ(S_OK, kvstore->delete_pool(pool_name()));
+  kvstore->release_ref();
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  auto r = RUN_ALL_TESTS();
+
+  return r;
+}
@@ -0,0 +1,442 @@
+/*
+  Copyright [2017-2021] [IBM Corporation]
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __MAP_STORE_HASH_TABLE_H__
+#define __MAP_STORE_HASH_TABLE_H__
+
+#include <city.h>
+#include <common/exceptions.h>
+#include <common/time.h>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "pool_heap.h"
+
+/**
+ * Open-addressing hash table used as the mapstore index.
+ *
+ * The layout follows the SwissTable scheme. Each slot has a control
+ * byte which is EMPTY, DELETED or the low 7 bits of the key hash
+ * (H2). The remaining hash bits (H1) pick where a probe starts; the
+ * probe then scans control bytes a group (8 bytes) at a time, so most
+ * misses are settled without touching a slot.
+ *
+ * Keys up to KEY_INLINE bytes live in the slot; longer keys are
+ * allocated from the pool heap. The per-value reader/writer lock is a
+ * single word in the slot. Control bytes, slots and long keys all come
+ * from the pool heap, so key pointers handed out by lock() are in pool
+ * memory (the ADO relies on this).
+ *
+ * The table itself is not thread safe; mapstore stripes a pool over
+ * several tables, each under its own lock. Slot locks are atomic so
+ * they can be taken and released under a shared table lock.
+ *
+ * A slot address is used as the lock handle. If the table is rehashed
+ * while handles are outstanding, the old slot array is retired rather
+ * than freed, and is released once the last of those handles is
+ * returned through live_slot().
+ */
+class Hash_table {
+public:
+  static constexpr size_t KEY_INLINE = 31; /*< longest in-slot key (one byte kept for '\0') */
+
+  struct Slot {
+    Slot(const void *key, size_t key_len, char *ext_key)
+      : _ptr(nullptr), _length(0), _tsc(), _lock(0), _key_len(uint32_t(key_len)), _key{}
+    {
+      if (ext_key) _key.ext_key = ext_key;
+      char *k = ext_key ? ext_key : _key.inline_key;
+      std::memcpy(k, key, key_len);
+      k[key_len] = '\0';
+    }
+
+    const char *key() const { return is_inline() ? _key.inline_key : _key.ext_key; }
+    size_t      key_len() const { return _key_len; }
+    bool        is_inline() const { return _key_len <= KEY_INLINE; }
+
+    /* same return conventions as common::RWLock */
+    int read_trylock()
+    {
+      auto v = __atomic_load_n(&_lock, __ATOMIC_RELAXED);
+      do {
+        if (v & WRITER) return EBUSY;
+      } while (!__atomic_compare_exchange_n(&_lock, &v, v + 1, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+      return 0;
+    }
+
+    int write_trylock()
+    {
+      uint32_t v = 0;
+      return __atomic_compare_exchange_n(&_lock, &v, WRITER, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) ? 0 : EBUSY;
+    }
+
+    int unlock()
+    {
+      auto v = __atomic_load_n(&_lock, __ATOMIC_RELAXED);
+      do {
+        if (v == 0) return EINVAL;
+      } while (!__atomic_compare_exchange_n(&_lock, &v, (v & WRITER) ? 0 : v - 1, true, __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED));
+      return 0;
+    }
+
+    /* number of outstanding lock handles on this slot */
+    unsigned holders() const
+    {
+      auto v = __atomic_load_n(&_lock, __ATOMIC_RELAXED);
+      return (v & WRITER) ? 1 : v;
+    }
+
+    void *             _ptr;    /*< value */
+    size_t             _length; /*< value length */
+    common::tsc_time_t _tsc;    /*< last write */
+
+  private:
+    friend class Hash_table;
+    static constexpr uint32_t WRITER = 1U << 31;
+
+    uint32_t _lock; /*< WRITER bit, or reader count */
+    uint32_t _key_len;
+    union {
+      char   inline_key[KEY_INLINE + 1];
+      char * ext_key;
+    } _key;
+  };
+
+  static_assert(sizeof(Slot) == 64, "slot should fill one cache line");
+
+  class const_iterator {
+  public:
+    const_iterator(const Hash_table *table, size_t index) : _table(table), _index(index) {}
+    const Slot &operator*() const { return _table->_slots[_index]; }
+    const Slot *operator->() const { return &_table->_slots[_index]; }
+    const_iterator &operator++()
+    {
+      _index = _table->next_full(_index + 1);
+      return *this;
+    }
+    const_iterator operator++(int)
+    {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    bool operator==(const const_iterator &other) const { return _index == other._index; }
+    bool operator!=(const const_iterator &other) const { return _index != other._index; }
+
+  private:
+    const Hash_table *_table;
+    size_t            _index;
+  };
+
+  explicit Hash_table(Pool_heap &heap)
+    : _heap(heap), _capacity(0), _size(0), _growth_left(0), _ctrl(nullptr), _slots(nullptr), _retired()
+  {
+    allocate_arrays(MIN_CAPACITY);
+  }
+
+  Hash_table(const Hash_table &) = delete;
+  Hash_table &operator=(const Hash_table &) = delete;
+
+  ~Hash_table()
+  {
+    for (size_t i = 0; i < _capacity; i++)
+      if (is_full(_ctrl[i])) free_key(_slots[i]);
+    free_arrays(_ctrl, _slots, _capacity);
+    for (auto &r : _retired) free_slots(r.slots, r.capacity);
+  }
+
+  size_t size() const { return _size; }
+
+  static uint64_t hash(const void *key, size_t key_len)
+  {
+    return CityHash64(static_cast<const char *>(key), key_len);
+  }
+
+  const_iterator begin() const { return const_iterator(this, next_full(0)); }
+  const_iterator end() const { return const_iterator(this, _capacity); }
+
+  /**
+   * Look up a key
+   *
+   * @return Slot holding the key, or nullptr if not present
+   */
+  Slot *find(const void *key, size_t key_len) { return find(key, key_len, hash(key, key_len)); }
+
+  /**
+   * Look up a key whose hash the caller has already computed
+   */
+  Slot *find(const void *key, size_t key_len, uint64_t h)
+  {
+    auto offset = h1(h) & mask();
+    for (size_t step = GROUP; step <= _capacity + GROUP; step += GROUP) {
+      const auto g = load_group(&_ctrl[offset]);
+      for (auto m = match(g, h2(h)); m; m &= m - 1) {
+        auto &s = _slots[(offset + lowest_lane(m)) & mask()];
+        if (s.key_len() == key_len && std::memcmp(s.key(), key, key_len) == 0) return &s;
+      }
+      if (match_empty(g)) return nullptr;
+      offset = (offset + step) & mask();
+    }
+    return nullptr;
+  }
+
+  /**
+   * Look up a key, inserting it (with an empty value) if absent. The
+   * key is hashed once whichever way this goes.
+   *
+   * @param inserted [out] true if the key was added
+   *
+   * @return Slot holding the key
+   */
+  Slot *find_or_insert(const void *key, size_t key_len, bool &inserted)
+  {
+    return find_or_insert(key, key_len, hash(key, key_len), inserted);
+  }
+
+  Slot *find_or_insert(const void *key, size_t key_len, uint64_t h, bool &inserted)
+  {
+    auto slot = find(key, key_len, h);
+    inserted = (slot == nullptr);
+    if (inserted) slot = insert(key, key_len, h);
+    return slot;
+  }
+
+  /**
+   * Remove an entry. The value is not touched; the caller must have
+   * released it.
+   */
+  void erase(Slot *slot)
+  {
+    const auto i = size_t(slot - _slots);
+    assert(i < _capacity && is_full(_ctrl[i]));
+    free_key(*slot);
+    slot->~Slot();
+    /* if the run of non-empty slots through i is shorter than a group,
+       no probe can have passed over i, so it can go back to EMPTY */
+    const auto empty_before = match_empty(load_group(&_ctrl[(i - GROUP) & mask()]));
+    const auto empty_after  = match_empty(load_group(&_ctrl[i]));
+    const bool was_never_full =
+        empty_before && empty_after &&
+        (size_t(__builtin_ctzll(empty_after)) >> 3) + (size_t(__builtin_clzll(empty_before)) >> 3) < GROUP;
+    set_ctrl(i, was_never_full ? EMPTY : DELETED);
+    if (was_never_full) _growth_left++;
+    _size--;
+  }
+
+  /**
+   * @return Slot at a lock handle if it lies in the current slot array,
+   * otherwise nullptr (the handle may still be in a retired array)
+   */
+  Slot *current_slot(void *handle)
+  {
+    auto slot = static_cast<Slot *>(handle);
+    if (slot >= _slots && slot < _slots + _capacity && is_full(_ctrl[size_t(slot - _slots)])) return slot;
+    return nullptr;
+  }
+
+  /**
+   * Translate a lock handle (a slot address) into the slot now holding
+   * the key. A handle into a retired slot array gives up its pin on
+   * that array.
+   *
+   * @return Live slot, or nullptr if the handle is not one of ours
+   */
+  Slot *live_slot(void *handle)
+  {
+    auto slot = static_cast<Slot *>(handle);
+    if (slot >= _slots && slot < _slots + _capacity) {
+      return is_full(_ctrl[size_t(slot - _slots)]) ? slot : nullptr;
+    }
+
+    for (auto r = _retired.begin(); r != _retired.end(); ++r) {
+      if (slot >= r->slots && slot < r->slots + r->capacity) {
+        auto live = find(slot->key(), slot->key_len());
+        if (--r->pins == 0) {
+          free_slots(r->slots, r->capacity);
+          _retired.erase(r);
+        }
+        return live;
+      }
+    }
+    return nullptr;
+  }
+
+private:
+  using ctrl_t = int8_t;
+
+  static constexpr ctrl_t   EMPTY        = -128; /* 0b10000000 */
+  static constexpr ctrl_t   DELETED      = -2;   /* 0b11111110 */
+  static constexpr size_t   GROUP        = 8;
+  static constexpr size_t   MIN_CAPACITY = 16;
+  static constexpr uint64_t LSBS         = 0x0101010101010101ULL;
+  static constexpr uint64_t MSBS         = 0x8080808080808080ULL;
+
+  struct Retired {
+    Slot * slots;
+    size_t capacity;
+    size_t pins; /*< lock handles still pointing into slots */
+  };
+
+  Pool_heap &          _heap;
+  size_t               _capacity; /*< power of 2 */
+  size_t               _size;
+  size_t               _growth_left; /*< inserts into EMPTY before a rehash */
+  ctrl_t *             _ctrl;        /*< _capacity + GROUP bytes; the tail mirrors the head */
+  Slot *               _slots;
+  std::vector<Retired> _retired;
+
+  static size_t h1(uint64_t h) { return size_t(h >> 7); }
+  static ctrl_t h2(uint64_t h) { return ctrl_t(h & 0x7f); }
+
+  static bool is_full(ctrl_t c) { return c >= 0; }
+
+  static uint64_t load_group(const ctrl_t *p)
+  {
+    uint64_t g;
+    std::memcpy(&g, p, sizeof g);
+    return g;
+  }
+
+  /* bit 7 of each byte lane set where the lane matches; may report
+     false positives, which the key compare weeds out */
+  static uint64_t match(uint64_t g, ctrl_t h)
+  {
+    auto x = g ^ (LSBS * uint8_t(h));
+    return (x - LSBS) & ~x & MSBS;
+  }
+  static uint64_t match_empty(uint64_t g) { return g & (~g << 6) & MSBS; }
+  static uint64_t match_empty_or_deleted(uint64_t g) { return g & MSBS; }
+  static size_t   lowest_lane(uint64_t m) { return size_t(__builtin_ctzll(m)) >> 3; }
+
+  size_t mask() const { return _capacity - 1; }
+  size_t max_load(size_t capacity) const { return capacity - capacity / 8; }
+
+  size_t next_full(size_t i) const
+  {
+    while (i < _capacity && !is_full(_ctrl[i])) i++;
+    return i;
+  }
+
+  void set_ctrl(size_t i, ctrl_t c)
+  {
+    _ctrl[i] = c;
+    _ctrl[((i - (GROUP - 1)) & mask()) + (GROUP - 1)] = c;
+  }
+
+  /* probes visit groups at triangular offsets, which covers every
+     group of a power-of-2 table */
+  size_t find_insert_position(uint64_t h) const
+  {
+    auto offset = h1(h) & mask();
+    for (size_t step = GROUP;; step += GROUP) {
+      if (auto m = match_empty_or_deleted(load_group(&_ctrl[offset]))) return (offset + lowest_lane(m)) & mask();
+      offset = (offset + step) & mask();
+    }
+  }
+
+  Slot *insert(const void *key, size_t key_len, uint64_t h)
+  {
+    auto i = find_insert_position(h);
+    if (_growth_left == 0 && _ctrl[i] == EMPTY) {
+      /* tombstones alone may be what is filling the table */
+      rehash(_size * 2 < max_load(_capacity) ? _capacity : _capacity * 2);
+      i = find_insert_position(h);
+    }
+
+    char *ext_key = nullptr;
+    if (key_len > KEY_INLINE) {
+      if (_heap.allocate(key_len + 1, reinterpret_cast<void **>(&ext_key)) != S_OK)
+        throw General_exception("memory plugin allocate failed (key)");
+    }
+
+    if (_ctrl[i] == EMPTY) _growth_left--;
+    set_ctrl(i, h2(h));
+    _size++;
+    return new (&_slots[i]) Slot(key, key_len, ext_key);
+  }
+
+  void rehash(size_t new_capacity)
+  {
+    auto   old_ctrl     = _ctrl;
+    auto   old_slots    = _slots;
+    auto   old_capacity = _capacity;
+    size_t pins         = 0;
+
+    allocate_arrays(new_capacity);
+
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (!is_full(old_ctrl[i])) continue;
+      auto &s = old_slots[i];
+      auto  h = hash(s.key(), s.key_len());
+      auto  j = find_insert_position(h);
+      set_ctrl(j, h2(h));
+      new (&_slots[j]) Slot(s);
+      _size++;
+      pins += s.holders();
+    }
+    _growth_left = max_load(_capacity) - _size;
+
+    /* locked slots keep the old array alive: their handles and key
+       pointers are still out there */
+    if (pins) {
+      free_arrays(old_ctrl, nullptr, old_capacity);
+      _retired.push_back(Retired{old_slots, old_capacity, pins});
+    }
+    else {
+      free_arrays(old_ctrl, old_slots, old_capacity);
+    }
+  }
+
+  void allocate_arrays(size_t capacity)
+  {
+    void *ctrl  = nullptr;
+    void *slots = nullptr;
+    if (_heap.aligned_allocate(capacity + GROUP, GROUP, &ctrl) != S_OK ||
+        _heap.aligned_allocate(capacity * sizeof(Slot), sizeof(Slot), &slots) != S_OK)
+      throw General_exception("memory plugin aligned_allocate failed (table of %lu slots)", capacity);
+
+    std::memset(ctrl, EMPTY, capacity + GROUP);
+    _ctrl        = static_cast<ctrl_t *>(ctrl);
+    _slots       = static_cast<Slot *>(slots);
+    _capacity    = capacity;
+    _size        = 0;
+    _growth_left = max_load(capacity);
+  }
+
+  void free_arrays(ctrl_t *ctrl, Slot *slots, size_t capacity)
+  {
+    void *p = ctrl;
+    _heap.deallocate(&p, capacity + GROUP);
+    if (slots) free_slots(slots, capacity);
+  }
+
+  void free_slots(Slot *slots, size_t capacity)
+  {
+    void *p = slots;
+    _heap.deallocate(&p, capacity * sizeof(Slot));
+  }
+
+  void free_key(Slot &slot)
+  {
+    if (slot.is_inline()) return;
+    void *p = slot._key.ext_key;
+    _heap.deallocate(&p, slot._key_len + 1);
+  }
+};
+
+#endif
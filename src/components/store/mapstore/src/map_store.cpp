@@ -18,15 +18,21 @@
 #include <common/utils.h>
 #include <common/memory.h>
 #include <common/str_utils.h>
+#include <common/write_log.h>
 #include <fcntl.h>
 #include <nupm/region_descriptor.h>
 #include <stdio.h>
 #include <time.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <array>
+#include <atomic>
 #include <cerrno>
 #include <cmath>
+#include <limits>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <sstream>
 #include <string>
@@ -40,37 +46,19 @@
 
 
 #define DEFAULT_ALIGNMENT 8
-#define SINGLE_THREADED
 #define MIN_POOL (1ULL << DM_REGION_LOG_GRAIN_SIZE)
 
 #include "mm_plugin_itf.h"
+#include "pool_heap.h"
+#include "hash_table.h"
 #include "map_store.h"
 
 using namespace component;
 using namespace common;
 
-struct Value_type {
-  Value_type() : _ptr(nullptr), _length(0), _value_lock(nullptr), _tsc() {
-  }
-
-  Value_type(void* ptr, size_t length, common::RWLock * value_lock) :
-    _ptr(ptr), _length(length), _value_lock(value_lock), _tsc() {
-  }
-  void * _ptr;
-  size_t _length;
-  common::RWLock * _value_lock; /*< read write lock */
-  common::tsc_time_t _tsc;
-};
-
-
-class Key_hash;
-
-/* allocator types using MM_plugin_cxx_allocator (see mm_plugin_itf.h) */
-using aac_t = MM_plugin_cxx_allocator<char>;
-using string_t = std::basic_string<char, std::char_traits<char>, aac_t>;
-using aam_t = MM_plugin_cxx_allocator<std::pair<string_t, Value_type>>;
-using aal_t = MM_plugin_cxx_allocator<common::RWLock>;
-using map_t = std::unordered_map<string_t, Value_type, Key_hash, std::equal_to<string_t>, aam_t>;
+/* open-addressing index (see hash_table.h); slots hold key, value and lock */
+using map_t = Hash_table;
+using slot_t = Hash_table::Slot;
 
 
 static size_t choose_alignment(size_t size)
@@ -83,13 +71,6 @@ static size_t choose_alignment(size_t size)
   return 1;
 }
 
-class Key_hash {
-public:
-  size_t operator()(string_t const &k) const {
-    return CityHash64(k.c_str(), k.length());
-  }
-};
-
 namespace
 {
 int init_map_lock_mask()
@@ -142,22 +123,52 @@ private:
     return pool;
   }
 
+  /*
+    The index is striped over STRIPES tables, chosen by the top bits
+    of the key hash, each with its own lock. Lookups and key locking
+    take a stripe lock shared; inserts, erases and value updates take
+    it exclusive. A table resize therefore stalls only its own stripe.
+  */
+  static constexpr unsigned STRIPE_BITS = 6;
+  static constexpr unsigned STRIPES = 1U << STRIPE_BITS;
+
+  /* lock handles are slot addresses, with the stripe in the low bits */
+  static_assert(STRIPES <= sizeof(slot_t), "stripe index does not fit in slot alignment");
+
+  struct alignas(64) Stripe {
+    common::RWLock lock;
+    map_t *        map;
+  };
+
+  /* plugin heaps per pool; see Pool_heap */
+  static unsigned arena_count()
+  {
+    return std::min(8U, std::max(1U, std::thread::hardware_concurrency()));
+  }
+
+  static unsigned stripe_index(uint64_t hash) { return unsigned(hash >> (64 - STRIPE_BITS)); }
+
+  static IKVStore::key_t make_handle(slot_t * slot, unsigned stripe)
+  {
+    return reinterpret_cast<IKVStore::key_t>(reinterpret_cast<uintptr_t>(slot) | stripe);
+  }
+
   class Iterator {
   public:
     explicit Iterator(const Pool_instance * pool)
       : _pool(checked_pool(pool)),
         _mark(_pool->writes()),
-        _iter(_pool->_map->begin()),
-        _end(_pool->_map->end())
+        _stripe(0),
+        _iter(_pool->_stripes[0].map->begin())
     {}
 
-    bool is_end() const { return _iter == _end; }
+    bool is_end() const { return _stripe == STRIPES; }
     bool check_mark(uint32_t writes) const { return _mark == writes; }
 
     const Pool_instance * _pool;
     uint32_t              _mark;
+    unsigned              _stripe;
     map_t::const_iterator _iter;
-    map_t::const_iterator _end;
   };
 
 public:
@@ -169,15 +180,21 @@ public:
     : _debug_level(debug_level),
       _nsize(nsize < MIN_POOL ? MIN_POOL : nsize),
       _name{name_},
+      _regions_lock{},
       _regions{{allocate_region_memory(round_up_page(_nsize), name_), round_up_page(_nsize)}},
-      _mm_plugin(mm_plugin_path), /* plugin path for heap allocator */
-      _map_lock{},
+      _heap(mm_plugin_path, arena_count()), /* plugin path for heap allocator */
+      _stripes{},
       _flags{flags_},
+      _iterators_lock{},
       _iterators{},
-      _writes{}
+      _writes{},
+      _write_log_enabled(false),
+      _write_log{}
   {
-    /* use a pointer so we can make sure it gets dtored before memory is freed */
-    _map = new map_t({(_mm_plugin.add_managed_region(_regions[0].iov_base, _nsize), aam_t(_mm_plugin))});
+    /* use pointers so we can make sure tables get dtored before memory is freed */
+    _heap.add_managed_region(_regions[0].iov_base, _nsize);
+    for(auto &s : _stripes)
+      s.map = new map_t(_heap);
     CPLOG(1, PREFIX "new pool instance");
   }
 
@@ -186,8 +203,9 @@ public:
     if(_ref_count == 0) {
       CPLOG(1, PREFIX "freeing regions for pool (%s)", _name.c_str());
 
-      /* destroy map before we release memory */
-      delete _map;
+      /* destroy maps before we release memory */
+      for(auto &s : _stripes)
+        delete s.map;
       
       /* release memory */
       for(auto r : _regions) {
@@ -216,13 +234,14 @@ private:
   
   unsigned                   _debug_level;
   unsigned                   _ref_count = 0; 
-  size_t                     _nsize; /*< order important */
+  std::atomic<size_t>        _nsize; /*< order important */
   std::string                _name; /*< pool name */
+  std::mutex                 _regions_lock; /*< serializes grow_pool; guards _regions */
   std::vector<::iovec>       _regions; /*< regions supporting pool */
-  MM_plugin_wrapper          _mm_plugin;
-  map_t *                    _map; /*< hash table based map */
-  common::RWLock             _map_lock; /*< read write lock */
+  Pool_heap                  _heap; /*< thread-safe, per-arena access to the MM plugin */
+  std::array<Stripe, STRIPES> _stripes; /*< hash table based map, striped */
   unsigned int               _flags;
+  std::mutex                 _iterators_lock;
   std::set<Iterator*>        _iterators;
   int                        _fdout;
   /*
@@ -230,14 +249,33 @@ private:
     during an iteration.  This is essentially an optmistic
     locking strategy.
   */
-  uint32_t _writes __attribute__((aligned(4)));
+  std::atomic<uint32_t> _writes;
+
+  /* optional time-ordered index of writes, see IKVStore::WRITE_TIME_INDEX */
+  std::atomic<bool>     _write_log_enabled;
+  common::Write_log     _write_log;
 
   inline void write_touch() { _writes++; }
   inline uint32_t writes() const { return _writes; }
 
-  /* allocator adapters over reconstituting allocator */
-  aac_t aac{_mm_plugin}; /* for keys */
-  aal_t aal{_mm_plugin}; /* for locks */
+  inline void log_write(const std::string &key, const slot_t * slot) {
+    if(_write_log_enabled) _write_log.record(key.data(), key.length(), slot->_tsc.raw());
+  }
+
+  status_t enable_write_log(bool enable);
+
+  Stripe& stripe(uint64_t hash) { return _stripes[stripe_index(hash)]; }
+
+  status_t lock_slot(slot_t * slot,
+                     unsigned stripe,
+                     const std::string &key,
+                     IKVStore::lock_type_t type,
+                     void *&out_value,
+                     size_t &inout_value_len,
+                     IKVStore::key_t& out_key,
+                     const char ** out_key_ptr);
+
+  void settle(Iterator * i);
 
 public:
   status_t put(const std::string &key, const void *value,
@@ -252,6 +290,10 @@ public:
                          std::vector<uint64_t> &out_attr,
                          const std::string *key);
 
+  status_t set_attribute(const IKVStore::Attribute attr,
+                         const std::vector<uint64_t> &value,
+                         const std::string *key);
+
   status_t swap_keys(const std::string key0,
                      const std::string key1);
 
@@ -362,17 +404,16 @@ status_t Pool_instance::put(const std::string &key,
     return E_INVAL;
   }
 
-#ifndef SINGLE_THREADED
-  RWLock_guard guard(map_lock, RWLock_guard::WRITE);
-#endif
+  const auto h = map_t::hash(key.data(), key.length());
+  auto &s = stripe(h);
+  RWLock_guard guard(s.lock, RWLock_guard::WRITE);
 
   write_touch(); /* this could be early, but over-conservative is ok */
 
-  string_t k(key.data(), key.length(), aac);
-
-  auto i = _map->find(k);
+  bool created = false;
+  auto slot = s.map->find_or_insert(key.data(), key.length(), h, created);
 
-  if (i != _map->end()) {
+  if (!created) {
 
     if (flags & IKVStore::FLAGS_DONT_STOMP) {
       PWRN("put refuses to stomp (%s)", key.c_str());
@@ -381,58 +422,61 @@ status_t Pool_instance::put(const std::string &key,
 
     /* take lock */
     int rc;
-    if((rc = (*_map)[k]._value_lock->write_trylock()) != 0) {
+    if((rc = slot->write_trylock()) != 0) {
       PWRN("put refuses, already locked (%d)",rc);
       assert(rc == EBUSY);
       return E_LOCKED;
     }
 
-    auto &p = i->second;
-
-    if (p._length == value_len) {
-      memcpy(p._ptr, value, value_len);
+    if (slot->_length == value_len) {
+      memcpy(slot->_ptr, value, value_len);
     }
     else {
       /* different size, reallocate */
-      auto p_to_free = p._ptr;
-      auto len_to_free = p._length;
+      auto p_to_free = slot->_ptr;
+      auto len_to_free = slot->_length;
+      void * buffer = nullptr;
 
       CPLOG(3, PREFIX "allocating %lu bytes alignment %lu", value_len, choose_alignment(value_len));
 
-      if(_mm_plugin.aligned_allocate(value_len, choose_alignment(value_len),&p._ptr) != S_OK)
+      if(_heap.aligned_allocate(value_len, choose_alignment(value_len), &buffer) != S_OK) {
+        slot->unlock();
         throw General_exception("plugin aligned_allocate failed");
+      }
 
-      memcpy(p._ptr, value, value_len);
+      memcpy(buffer, value, value_len);
 
       /* update entry */
-      i->second._length = value_len;
-      i->second._ptr = p._ptr;
+      slot->_length = value_len;
+      slot->_ptr = buffer;
 
       /* release old memory*/
-      try {  _mm_plugin.deallocate(&p_to_free, len_to_free);      }
+      try {  _heap.deallocate(&p_to_free, len_to_free);      }
       catch(...) {  throw Logic_exception("unable to release old value memory");   }
     }
 
     wmb();
-    i->second._tsc.update(); /* update timestamp */
+    slot->_tsc.update(); /* update timestamp */
+    log_write(key, slot);
 
     /* release lock */
-    (*_map)[k]._value_lock->unlock();
+    slot->unlock();
   }
-  else { /* key does not already exist */
+  else { /* key did not already exist; slot is new */
 
     CPLOG(3, PREFIX "allocating %lu bytes alignment %lu", value_len, choose_alignment(value_len));
 
     void * buffer = nullptr;
-    if(_mm_plugin.aligned_allocate(value_len, choose_alignment(value_len), &buffer) != S_OK)
+    if(_heap.aligned_allocate(value_len, choose_alignment(value_len), &buffer) != S_OK) {
+      s.map->erase(slot);
       throw General_exception("memory plugin aligned_allocate failed");
+    }
 
     memcpy(buffer, value, value_len);
-    //    common::RWLock * p = new (aal.allocate(1, DEFAULT_ALIGNMENT)) common::RWLock();
-    common::RWLock * p = new (aal.allocate(1)) common::RWLock();
 
-    /* create map entry */
-    _map->emplace(k, Value_type{buffer, value_len, p});
+    slot->_ptr = buffer;
+    slot->_length = value_len;
+    log_write(key, slot);
   }
 
   return S_OK;
@@ -444,15 +488,14 @@ status_t Pool_instance::get(const std::string &key,
 {
   CPLOG(1, PREFIX "get(%s,%p,%lu)", key.c_str(), out_value, out_value_len);
 
-#ifndef SINGLE_THREADED
-  RWLock_guard guard(map_lock);
-#endif
-  string_t k(key.c_str(), aac);
-  auto i = _map->find(k);
+  const auto h = map_t::hash(key.data(), key.length());
+  auto &s = stripe(h);
+  RWLock_guard guard(s.lock);
+  auto slot = s.map->find(key.data(), key.length(), h);
 
-  if (i == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
+  if (slot == nullptr) return IKVStore::E_KEY_NOT_FOUND;
 
-  out_value_len = i->second._length;
+  out_value_len = slot->_length;
 
   /* result memory allocated with ::malloc */
   out_value = malloc(out_value_len);
@@ -462,7 +505,7 @@ status_t Pool_instance::get(const std::string &key,
     return IKVStore::E_TOO_LARGE;
   }
   
-  memcpy(out_value, i->second._ptr, i->second._length);  
+  memcpy(out_value, slot->_ptr, slot->_length);  
   return S_OK;
 }
 
@@ -475,25 +518,24 @@ status_t Pool_instance::get_direct(const std::string &key,
   if (out_value == nullptr || out_value_len == 0)
     throw API_exception("invalid parameter");
 
-#ifndef SINGLE_THREADED
-  RWLock_guard guard(map_lock);
-#endif
-  string_t k(key.c_str(), aac);
-  auto i = _map->find(k);
+  const auto h = map_t::hash(key.data(), key.length());
+  auto &s = stripe(h);
+  RWLock_guard guard(s.lock);
+  auto slot = s.map->find(key.data(), key.length(), h);
 
-  if (i == _map->end()) {
+  if (slot == nullptr) {
     if (debug_level()) PERR("Map_store: error key not found");
     return IKVStore::E_KEY_NOT_FOUND;
   }
 
-  if (out_value_len < i->second._length) {
+  if (out_value_len < slot->_length) {
     if (debug_level()) PERR("Map_store: error insufficient buffer");
 
     return E_INSUFFICIENT_BUFFER;
   }
 
-  out_value_len = i->second._length; /* update length */
-  memcpy(out_value, i->second._ptr, i->second._length);
+  out_value_len = slot->_length; /* update length */
+  memcpy(out_value, slot->_ptr, slot->_length);
 
   return S_OK;
 }
@@ -509,27 +551,26 @@ status_t Pool_instance::get_attribute(const IKVStore::Attribute attr,
   }
   case IKVStore::Attribute::VALUE_LEN: {
     if (key == nullptr) return E_INVALID_ARG;
-#ifndef SINGLE_THREADED
-    RWLock_guard guard(map_lock);
-#endif
-    string_t k(key->c_str(), aac);
-    auto i = _map->find(k);
-    if (i == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
-    out_attr.push_back(i->second._length);
+    const auto h = map_t::hash(key->data(), key->length());
+    auto &s = stripe(h);
+    RWLock_guard guard(s.lock);
+    auto slot = s.map->find(key->data(), key->length(), h);
+    if (slot == nullptr) return IKVStore::E_KEY_NOT_FOUND;
+    out_attr.push_back(slot->_length);
     break;
   }
   case IKVStore::Attribute::WRITE_EPOCH_TIME: {
-#ifndef SINGLE_THREADED
-    RWLock_guard guard(map_lock);
-#endif
-    string_t k(key->c_str(), aac);
-    auto i = _map->find(k);
-    if (i == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
-    out_attr.push_back(boost::numeric_cast<uint64_t>(i->second._tsc.to_epoch().seconds()));
+    if (key == nullptr) return E_INVALID_ARG;
+    const auto h = map_t::hash(key->data(), key->length());
+    auto &s = stripe(h);
+    RWLock_guard guard(s.lock);
+    auto slot = s.map->find(key->data(), key->length(), h);
+    if (slot == nullptr) return IKVStore::E_KEY_NOT_FOUND;
+    out_attr.push_back(boost::numeric_cast<uint64_t>(slot->_tsc.to_epoch().seconds()));
     break;
   }
   case IKVStore::Attribute::COUNT: {
-    out_attr.push_back(_map->size());
+    out_attr.push_back(count());
     break;
   }
   default:
@@ -539,41 +580,133 @@ status_t Pool_instance::get_attribute(const IKVStore::Attribute attr,
   return S_OK;
 }
 
+status_t Pool_instance::set_attribute(const IKVStore::Attribute attr,
+                                      const std::vector<uint64_t> &value,
+                                      const std::string *)
+{
+  switch (attr) {
+  case IKVStore::Attribute::WRITE_TIME_INDEX: {
+    if (value.size() < 1) return E_INVALID_ARG;
+    return enable_write_log(bool(value[0]));
+  }
+  default:
+    return E_NOT_SUPPORTED;
+  }
+}
+
+status_t Pool_instance::enable_write_log(bool enable)
+{
+  if (! enable) {
+    _write_log_enabled = false;
+    _write_log.clear();
+    return S_OK;
+  }
+
+  if (_write_log_enabled.exchange(true)) return S_OK;
+
+  /* writes are now logged; seed with keys written before. A write
+     racing with the scan may be seen twice, which the log tolerates */
+  std::vector<common::Write_log::Entry> seed;
+  for (auto &s : _stripes) {
+    RWLock_guard guard(s.lock);
+    for (auto &slot : *s.map)
+      seed.push_back({slot._tsc.raw(), std::string(slot.key(), slot.key_len()), false});
+  }
+  _write_log.seed(std::move(seed));
+
+  CPLOG(1, PREFIX "write time index enabled (%lu entries)", _write_log.size());
+  return S_OK;
+}
+
 
 
 status_t Pool_instance::swap_keys(const std::string key0,
                                   const std::string key1)
 {
-  string_t k0(key0.data(), key0.length(), aac);
-  auto i0 = _map->find(k0);
-  if(i0 == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
+  const auto h0 = map_t::hash(key0.data(), key0.length());
+  const auto h1 = map_t::hash(key1.data(), key1.length());
 
-  string_t k1(key1.data(), key1.length(), aac);
-  auto i1 = _map->find(k1);
-  if(i1 == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
+  /* take both stripes exclusive, in stripe order */
+  auto i0 = stripe_index(h0);
+  auto i1 = stripe_index(h1);
+  RWLock_guard guard(_stripes[std::min(i0, i1)].lock, RWLock_guard::WRITE);
+  std::optional<RWLock_guard> guard2;
+  if(i0 != i1)
+    guard2.emplace(_stripes[std::max(i0, i1)].lock, RWLock_guard::WRITE);
+
+  auto left = _stripes[i0].map->find(key0.data(), key0.length(), h0);
+  if(left == nullptr) return IKVStore::E_KEY_NOT_FOUND;
+
+  auto right = _stripes[i1].map->find(key1.data(), key1.length(), h1);
+  if(right == nullptr) return IKVStore::E_KEY_NOT_FOUND;
 
   /* lock both k-v pairs */
-  auto& left = i0->second;
-  if(left._value_lock->write_trylock() != 0)
+  if(left->write_trylock() != 0)
     return E_LOCKED;
 
-  auto& right = i1->second;
-  if(right._value_lock->write_trylock() != 0) {
-    left._value_lock->unlock();
+  if(right->write_trylock() != 0) {
+    left->unlock();
     return E_LOCKED;
   }
 
   /* swap keys */
-  auto tmp_ptr = left._ptr;
-  auto tmp_len = left._length;
-  left._ptr = right._ptr;
-  left._length = right._length;
-  right._ptr = tmp_ptr;
-  right._length = tmp_len;
+  auto tmp_ptr = left->_ptr;
+  auto tmp_len = left->_length;
+  left->_ptr = right->_ptr;
+  left->_length = right->_length;
+  right->_ptr = tmp_ptr;
+  right->_length = tmp_len;
 
   /* release locks */
-  left._value_lock->unlock();
-  right._value_lock->unlock();
+  left->unlock();
+  right->unlock();
+
+  return S_OK;
+}
+
+status_t Pool_instance::lock_slot(slot_t * slot,
+                                  unsigned stripe,
+                                  const std::string &key,
+                                  IKVStore::lock_type_t type,
+                                  void *&out_value,
+                                  size_t &inout_value_len,
+                                  IKVStore::key_t& out_key,
+                                  const char ** out_key_ptr)
+{
+  if (type == IKVStore::STORE_LOCK_READ) {
+    if(slot->read_trylock() != 0) {
+      if(debug_level())
+        PWRN(PREFIX "key (%s) unable to take read lock", key.c_str());
+
+      out_key = IKVStore::KEY_NONE;
+      return E_LOCKED;
+    }
+  }
+  else if (type == IKVStore::STORE_LOCK_WRITE) {
+
+    write_touch();
+
+    if(slot->write_trylock() != 0) {
+      if(debug_level())
+        PWRN("Map_store: key (%s) unable to take write lock", key.c_str());
+
+      out_key = IKVStore::KEY_NONE;
+      return E_LOCKED;
+    }
+
+  }
+  else throw API_exception("invalid lock type");
+
+  out_value = slot->_ptr;
+  inout_value_len = slot->_length;
+
+  /* the slot address is the key handle. A rehash moves the entry, but
+     the table keeps the old slot array (and so this key pointer)
+     until every handle into it has been unlocked */
+  out_key = make_handle(slot, stripe);
+
+  if(out_key_ptr)
+    *out_key_ptr = slot->key();
 
   return S_OK;
 }
@@ -586,101 +719,62 @@ status_t Pool_instance::lock(const std::string &key,
                              IKVStore::key_t& out_key,
                              const char ** out_key_ptr)
 {
+  CPLOG(1, PREFIX "lock looking for key:(%s)", key.c_str());
 
-  void *buffer = nullptr;
-  string_t k(key.c_str(), aac);
-  bool created = false;
-
-  auto i = _map->find(k);
+  const auto h = map_t::hash(key.data(), key.length());
+  const auto si = stripe_index(h);
+  auto &s = _stripes[si];
 
-  CPLOG(1, PREFIX "lock looking for key:(%s)", key.c_str());
+  {
+    RWLock_guard guard(s.lock);
+    if (auto slot = s.map->find(key.data(), key.length(), h)) {
+      CPLOG(1, PREFIX "lock call has got key");
+      return lock_slot(slot, si, key, type, out_value, inout_value_len, out_key, out_key_ptr);
+    }
+  }
 
-  if (i == _map->end()) { /* create value */
+  /* lock API has semantics of create on demand */
+  if (inout_value_len == 0) {
+    out_key = IKVStore::KEY_NONE;
+    CPLOG(1, PREFIX "could not on-demand allocate without length:(%s) %lu",
+          key.c_str(), inout_value_len);
+    return IKVStore::E_KEY_NOT_FOUND;
+  }
 
-    write_touch();
+  /* another thread may create the key between the two guards */
+  RWLock_guard guard(s.lock, RWLock_guard::WRITE);
+  bool created = false;
+  auto slot = s.map->find_or_insert(key.data(), key.length(), h, created);
 
-    /* lock API has semantics of create on demand */
-    if (inout_value_len == 0) {
-      out_key = IKVStore::KEY_NONE;
-      CPLOG(1, PREFIX "could not on-demand allocate without length:(%s) %lu",
-            key.c_str(), inout_value_len);
-      return IKVStore::E_KEY_NOT_FOUND;
-    }
+  if (created) { /* create value */
 
+    write_touch();
 
     CPLOG(1, PREFIX "lock is on-demand allocating:(%s) %lu", key.c_str(), inout_value_len);
 
     if(alignment == 0)
       alignment = choose_alignment(inout_value_len);
-    
-    if(_mm_plugin.aligned_allocate(inout_value_len, alignment, &buffer) != S_OK)
-      throw General_exception("memory plugin alloc failed");
 
-    if (buffer == nullptr)
+    void *buffer = nullptr;
+    if(_heap.aligned_allocate(inout_value_len, alignment, &buffer) != S_OK || buffer == nullptr) {
+      s.map->erase(slot);
       throw General_exception("Pool_instance::lock on-demand create allocate_memory failed (len=%lu)",
                               inout_value_len);
-    created = true;
+    }
 
     CPLOG(1, PREFIX "creating on demand key=(%s) len=%lu",
           key.c_str(),
           inout_value_len);
 
-    common::RWLock * p = new (aal.allocate(1)) common::RWLock();
-
-    CPLOG(2, PREFIX "created RWLock at %p", reinterpret_cast<void*>(p));
-    _map->emplace(k, Value_type{buffer, inout_value_len, p});
+    slot->_ptr = buffer;
+    slot->_length = inout_value_len;
+    log_write(key, slot);
   }
 
   CPLOG(1, PREFIX "lock call has got key");
 
-  if (type == IKVStore::STORE_LOCK_READ) {
-    if((*_map)[k]._value_lock->read_trylock() != 0) {
-      if(debug_level())
-        PWRN(PREFIX "key (%s) unable to take read lock", key.c_str());
-
-      out_key = IKVStore::KEY_NONE;
-      return E_LOCKED;
-    }
-  }
-  else if (type == IKVStore::STORE_LOCK_WRITE) {
-
-    write_touch();
-
-    if((*_map)[k]._value_lock->write_trylock() != 0) {
-      if(debug_level())
-        PWRN("Map_store: key (%s) unable to take write lock", key.c_str());
-
-      out_key = IKVStore::KEY_NONE;
-      return E_LOCKED;
-    }
-
-  }
-  else throw API_exception("invalid lock type");
-
-  out_value = (*_map)[k]._ptr;
-  inout_value_len = (*_map)[k]._length;
-
-  out_key = reinterpret_cast<IKVStore::key_t>((*_map)[k]._value_lock);
-
-  /* C++11 standard: § 23.2.5/8
-
-     The elements of an unordered associative container are organized
-     into buckets. Keys with the same hash code appear in the same
-     bucket. The number of buckets is automatically increased as
-     elements are added to an unordered associative container, so that
-     the average number of elements per bucket is kept below a
-     bound. Rehashing invalidates iterators, changes ordering between
-     elements, and changes which buckets elements appear in, but does
-     not invalidate pointers or references to elements. For
-     unordered_multiset and unordered_multimap, rehashing preserves
-     the relative ordering of equivalent elements.
-  */
-  if(out_key_ptr) {
-    auto element = _map->find(k);
-    *out_key_ptr = element->first.c_str();
-  }
-
-  return created ? S_OK_CREATED : S_OK;
+  auto rc = lock_slot(slot, si, key, type, out_value, inout_value_len, out_key, out_key_ptr);
+  return rc == S_OK && created ? S_OK_CREATED : rc;
 }
 
 status_t Pool_instance::unlock(IKVStore::key_t key_handle)
@@ -691,8 +785,28 @@ status_t Pool_instance::unlock(IKVStore::key_t key_handle)
     return E_INVAL;
   }
 
-  /* TODO: how do we know key_handle is valid? */
-  if(reinterpret_cast<common::RWLock *>(key_handle)->unlock() != 0) {
+  const auto handle = reinterpret_cast<uintptr_t>(key_handle);
+  auto slot = reinterpret_cast<void *>(handle & ~uintptr_t(STRIPES - 1));
+  auto &s = _stripes[handle & (STRIPES - 1)];
+  int rc = EINVAL;
+  bool current = false;
+
+  {
+    RWLock_guard guard(s.lock);
+    if(auto live = s.map->current_slot(slot)) {
+      current = true;
+      rc = live->unlock();
+    }
+  }
+
+  /* handle from before a resize: releasing it may free a retired array */
+  if(!current) {
+    RWLock_guard guard(s.lock, RWLock_guard::WRITE);
+    if(auto live = s.map->live_slot(slot))
+      rc = live->unlock();
+  }
+
+  if(rc != 0) {
     PWRN("Map_store: bad parameter to unlock");
     return E_INVAL;
   }
@@ -703,15 +817,14 @@ status_t Pool_instance::unlock(IKVStore::key_t key_handle)
 
 status_t Pool_instance::erase(const std::string &key)
 {
-#ifndef SINGLE_THREADED
-  RWLock_guard guard(map_lock, RWLock_guard::WRITE);
-#endif
-  string_t k(key.c_str(), aac);
-  auto i = _map->find(k);
+  const auto h = map_t::hash(key.data(), key.length());
+  auto &s = stripe(h);
+  RWLock_guard guard(s.lock, RWLock_guard::WRITE);
+  auto slot = s.map->find(key.data(), key.length(), h);
 
-  if (i == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
+  if (slot == nullptr) return IKVStore::E_KEY_NOT_FOUND;
 
-  if(i->second._value_lock->write_trylock() != 0) { /* check pair is not locked */
+  if(slot->write_trylock() != 0) { /* check pair is not locked */
     if(debug_level())
       PWRN("Map_store: key (%s) unable to take write lock", key.c_str());
 
@@ -720,19 +833,20 @@ status_t Pool_instance::erase(const std::string &key)
 
 
   write_touch();
-  _map->erase(i);
-
-  _mm_plugin.deallocate(&i->second._ptr, i->second._length);
-  aal.deallocate(i->second._value_lock, 1); //, DEFAULT_ALIGNMENT);
+  _heap.deallocate(&slot->_ptr, slot->_length);
+  s.map->erase(slot);
+  if(_write_log_enabled) _write_log.record_erase(key.data(), key.length());
 
   return S_OK;
 }
 
 size_t Pool_instance::count() {
-#ifndef SINGLE_THREADED
-  RWLock_guard guard(map_lock);
-#endif
-  return _map->size();
+  size_t n = 0;
+  for (auto &s : _stripes) {
+    RWLock_guard guard(s.lock);
+    n += s.map->size();
+  }
+  return n;
 }
 
 status_t Pool_instance::map(std::function<int(const void * key,
@@ -740,13 +854,11 @@ status_t Pool_instance::map(std::function<int(const void * key,
                                               const void * value,
                                               const size_t value_len)> function)
 {
-#ifndef SINGLE_THREADED
-  RWLock_guard guard(map_lock);
-#endif
-
-  for (auto &pair : *_map) {
-    auto val = pair.second;
-    function(pair.first.c_str(), pair.first.length(), val._ptr, val._length);
+  for (auto &s : _stripes) {
+    RWLock_guard guard(s.lock);
+    for (auto &slot : *s.map) {
+      function(slot.key(), slot.key_len(), slot._ptr, slot._length);
+    }
   }
 
   return S_OK;
@@ -760,23 +872,43 @@ status_t Pool_instance::map(std::function<int(const void* key,
                                               const common::epoch_time_t t_begin,
                                               const common::epoch_time_t t_end)
 {
-#ifndef SINGLE_THREADED
-  RWLock_guard guard(map_lock);
-#endif
-
   common::tsc_time_t begin_tsc(t_begin);
   common::tsc_time_t end_tsc(t_end);
 
-  for (auto &pair : *_map) {
-    auto val = pair.second;
+  /* As in the untimed map, the function runs under the stripe lock, shared,
+     and so must not write to the pool (see IKVStore::map). */
+  if(_write_log_enabled) {
+    /* visit only keys written in range; an entry is current if the
+       key still carries the logged timestamp */
+    const auto end_raw = end_tsc == 0 ? std::numeric_limits<common::Write_log::stamp_t>::max() : end_tsc.raw();
+    for (const auto &e : _write_log.range(begin_tsc.raw(), end_raw)) {
+      const auto h = map_t::hash(e.key.data(), e.key.length());
+      auto &s = stripe(h);
+      RWLock_guard guard(s.lock);
+      auto slot = s.map->find(e.key.data(), e.key.length(), h);
+      if(slot == nullptr || slot->_tsc.raw() != e.stamp) continue;
+      if(function(slot->key(),
+                  slot->key_len(),
+                  slot->_ptr,
+                  slot->_length,
+                  slot->_tsc) < 0) {
+        return S_MORE;
+      }
+    }
+    return S_OK;
+  }
 
-    if(val._tsc >= begin_tsc && (end_tsc == 0 || val._tsc <= end_tsc)) {
-      if(function(pair.first.c_str(),
-                  pair.first.length(),
-                  val._ptr,
-                  val._length,
-                  val._tsc) < 0) {
-        return S_MORE; /* break out of the loop if function returns < 0 */
+  for (auto &s : _stripes) {
+    RWLock_guard guard(s.lock);
+    for (auto &slot : *s.map) {
+      if(slot._tsc >= begin_tsc && (end_tsc == 0 || slot._tsc <= end_tsc)) {
+        if(function(slot.key(),
+                    slot.key_len(),
+                    slot._ptr,
+                    slot._length,
+                    slot._tsc) < 0) {
+          return S_MORE; /* break out of the loop if function returns < 0 */
+        }
       }
     }
   }
@@ -787,11 +919,18 @@ status_t Pool_instance::map(std::function<int(const void* key,
 
 status_t Pool_instance::map_keys(std::function<int(const std::string &key)> function)
 {
-#ifndef SINGLE_THREADED
-  RWLock_guard guard(map_lock);
-#endif
-
-  for (auto &pair : *_map) function(std::string(pair.first.c_str()));
+  /* copy each stripe's keys out, so that the function may write to the pool;
+     keys written meanwhile may or may not be visited */
+  std::vector<std::string> keys;
+  for (auto &s : _stripes) {
+    {
+      RWLock_guard guard(s.lock);
+      keys.reserve(s.map->size());
+      for (auto &slot : *s.map) keys.emplace_back(slot.key(), slot.key_len());
+    }
+    for (const auto &k : keys) function(k);
+    keys.clear();
+  }
 
   return S_OK;
 }
@@ -806,65 +945,55 @@ status_t Pool_instance::resize_value(const std::string &key,
   
   if (new_size == 0) return E_INVAL;
 
-#ifndef SINGLE_THREADED
-  RWLock_guard guard(map_lock);
-#endif
+  const auto h = map_t::hash(key.data(), key.length());
+  auto &s = stripe(h);
+  RWLock_guard guard(s.lock, RWLock_guard::WRITE);
 
-  auto i = _map->find(string_t(key.c_str(), aac));
+  auto slot = s.map->find(key.data(), key.length(), h);
 
-  if (i == _map->end()) return IKVStore::E_KEY_NOT_FOUND;
-  if (i->second._length == new_size) {
+  if (slot == nullptr) return IKVStore::E_KEY_NOT_FOUND;
+  if (slot->_length == new_size) {
     CPLOG(2, PREFIX "resize_value request for same size!");
     return E_INVAL;
   }
 
-  write_touch();
-
-  /* perform resize */
-  void * buffer = nullptr;
-  if(_mm_plugin.aligned_allocate(new_size, alignment, &buffer) != S_OK)
-    throw General_exception("memory plufin aligned_allocate failed");
-
   /* lock KV-pair */
-  void *out_value;
-  size_t inout_value_len;
-  IKVStore::key_t out_key_handle = IKVStore::KEY_NONE;
-
-  status_t s = lock(key,
-                    IKVStore::STORE_LOCK_WRITE,
-                    out_value,
-                    inout_value_len,
-                    alignment,
-                    out_key_handle,
-                    nullptr);
-
-  if (out_key_handle == IKVStore::KEY_NONE) {
+  if (slot->write_trylock() != 0) {
     CPLOG(2, PREFIX "bad lock result");
     return E_INVAL;
   }
 
+  write_touch();
+
   CPLOG(2, PREFIX "resize_value locked key-value pair");
 
-  size_t size_to_copy = std::min<size_t>(new_size, boost::numeric_cast<size_t>(i->second._length));
+  /* perform resize */
+  void * buffer = nullptr;
+  if(_heap.aligned_allocate(new_size, alignment, &buffer) != S_OK) {
+    slot->unlock();
+    throw General_exception("memory plufin aligned_allocate failed");
+  }
 
-  memcpy(buffer, i->second._ptr, size_to_copy);
+  size_t size_to_copy = std::min<size_t>(new_size, slot->_length);
+
+  memcpy(buffer, slot->_ptr, size_to_copy);
 
   /* free previous memory */
-  _mm_plugin.deallocate(&i->second._ptr, i->second._length);
+  _heap.deallocate(&slot->_ptr, slot->_length);
 
-  i->second._ptr = buffer;
-  i->second._length = new_size;
+  slot->_ptr = buffer;
+  slot->_length = new_size;
 
   /* release lock */
-  if(unlock(out_key_handle) != S_OK)
-    throw General_exception("unlock in resize failed");
+  slot->unlock();
 
   CPLOG(2, PREFIX "resize_value re-unlocked key-value pair");
-  return s;
+  return S_OK;
 }
 
 status_t Pool_instance::get_pool_regions(nupm::region_descriptor::address_map_t &out_regions)
 {
+  std::lock_guard<std::mutex> g(_regions_lock);
   if (_regions.empty())
     return E_INVAL;
 
@@ -881,10 +1010,12 @@ status_t Pool_instance::grow_pool(const size_t increment_size,
     return E_INVAL;
 
   size_t rounded_increment_size = round_up_page(increment_size);
+
+  std::lock_guard<std::mutex> g(_regions_lock);
   reconfigured_size = _nsize + rounded_increment_size;
 
   void *new_region = allocate_region_memory(rounded_increment_size, _name);
-  _mm_plugin.add_managed_region(new_region, rounded_increment_size);
+  _heap.add_managed_region(new_region, rounded_increment_size);
   _regions.push_back({new_region, rounded_increment_size});
   _nsize = reconfigured_size;
   return S_OK;
@@ -892,13 +1023,19 @@ status_t Pool_instance::grow_pool(const size_t increment_size,
 
 status_t Pool_instance::free_pool_memory(const void *addr, const size_t size) {
 
-  if (!addr || _regions.empty())
+  if (!addr)
     return E_INVAL;
 
+  {
+    std::lock_guard<std::mutex> g(_regions_lock);
+    if (_regions.empty())
+      return E_INVAL;
+  }
+
   if(size)
-    _mm_plugin.deallocate(const_cast<void **>(&addr), size);
+    _heap.deallocate(const_cast<void **>(&addr), size);
   else
-    _mm_plugin.deallocate_without_size(const_cast<void **>(&addr));
+    _heap.deallocate_without_size(const_cast<void **>(&addr));
 
   /* the region memory is not freed, only memory in region */
   return S_OK;
@@ -908,7 +1045,13 @@ status_t Pool_instance::allocate_pool_memory(const size_t size,
                                              const size_t alignment,
                                              void *&out_addr) {
 
-  if (size == 0 || size > _nsize || _regions.empty()) {
+  bool no_regions;
+  {
+    std::lock_guard<std::mutex> g(_regions_lock);
+    no_regions = _regions.empty();
+  }
+
+  if (size == 0 || size > _nsize || no_regions) {
     PWRN("Map_store: invalid allocate_pool_memory request");
     return E_INVAL;
   }
@@ -917,7 +1060,7 @@ status_t Pool_instance::allocate_pool_memory(const size_t size,
     /* we can't fully support alignment choice */
     out_addr = 0;
 
-    if( _mm_plugin.aligned_allocate(size, (alignment > 0) && (size % alignment == 0) ?
+    if( _heap.aligned_allocate(size, (alignment > 0) && (size % alignment == 0) ?
                                     alignment : choose_alignment(size), &out_addr) != S_OK)
       throw General_exception("memory plugin aligned_allocate failed");
 
@@ -934,11 +1077,36 @@ status_t Pool_instance::allocate_pool_memory(const size_t size,
 
 IKVStore::pool_iterator_t Pool_instance::open_pool_iterator()
 {
-  auto i = new Iterator(this);
+  Iterator * i;
+  {
+    RWLock_guard guard(_stripes[0].lock);
+    i = new Iterator(this);
+  }
+  settle(i);
+
+  std::lock_guard<std::mutex> g(_iterators_lock);
   _iterators.insert(i);
   return reinterpret_cast<IKVStore::pool_iterator_t>(i);
 }
 
+/* move an iterator which is at the end of its stripe on to the first
+   entry of a later stripe (or to the end) */
+void Pool_instance::settle(Iterator * i)
+{
+  while (!i->is_end()) {
+    {
+      auto &s = _stripes[i->_stripe];
+      RWLock_guard guard(s.lock);
+      if (i->_iter != s.map->end()) return;
+    }
+    if (++i->_stripe == STRIPES) return;
+
+    auto &s = _stripes[i->_stripe];
+    RWLock_guard guard(s.lock);
+    i->_iter = s.map->begin();
+  }
+}
+
 status_t Pool_instance::deref_pool_iterator(IKVStore::pool_iterator_t iter,
                                             const common::epoch_time_t t_begin,
                                             const common::epoch_time_t t_end,
@@ -947,39 +1115,50 @@ status_t Pool_instance::deref_pool_iterator(IKVStore::pool_iterator_t iter,
                                             bool increment)
 {
   auto i = reinterpret_cast<Iterator*>(iter);
-  if(_iterators.count(i) != 1) return E_INVAL;
+  {
+    std::lock_guard<std::mutex> g(_iterators_lock);
+    if(_iterators.count(i) != 1) return E_INVAL;
+  }
   if(i->is_end()) return E_OUT_OF_BOUNDS;
-  if(!i->check_mark(_writes)) return E_ITERATOR_DISTURBED;
 
   common::tsc_time_t begin_tsc(t_begin);
   common::tsc_time_t end_tsc(t_end);
 
-  auto r = i->_iter;
-  ref.key = r->first.data();
-  ref.key_len = r->first.length();
-  ref.value = r->second._ptr;
-  ref.value_len = r->second._length;
+  {
+    RWLock_guard guard(_stripes[i->_stripe].lock);
+    if(!i->check_mark(_writes)) return E_ITERATOR_DISTURBED;
 
-  ref.timestamp = r->second._tsc.to_epoch();
+    auto r = i->_iter;
+    ref.key = r->key();
+    ref.key_len = r->key_len();
+    ref.value = r->_ptr;
+    ref.value_len = r->_length;
 
-  /* leave condition in timestamp cycles for better accuracy */
-  time_match = (r->second._tsc >= begin_tsc) && (end_tsc == 0 || r->second._tsc <= end_tsc);
+    ref.timestamp = r->_tsc.to_epoch();
 
-  if(increment) {
-    try {
-      i->_iter++;
-    }
-    catch(...) {
-      return E_ITERATOR_DISTURBED;
+    /* leave condition in timestamp cycles for better accuracy */
+    time_match = (r->_tsc >= begin_tsc) && (end_tsc == 0 || r->_tsc <= end_tsc);
+
+    if(increment) {
+      try {
+        i->_iter++;
+      }
+      catch(...) {
+        return E_ITERATOR_DISTURBED;
+      }
     }
   }
 
+  if(increment)
+    settle(i);
+
   return S_OK;
 }
 
 status_t Pool_instance::close_pool_iterator(IKVStore::pool_iterator_t iter)
 {
   auto i = reinterpret_cast<Iterator*>(iter);
+  std::lock_guard<std::mutex> g(_iterators_lock);
   if(iter == nullptr || _iterators.erase(i) != 1) return E_INVAL;
   delete i;
   return S_OK;
@@ -1127,6 +1306,7 @@ IKVStore::pool_t Map_store::open_pool(const std::string &name,
 {
   const std::string &key = name;
 
+  Std_lock_guard g(_pool_sessions_lock);
   Pool_instance *ph = nullptr;
   /* see if a pool exists that matches the key */
   for (auto &h : _pools) {
@@ -1271,6 +1451,17 @@ status_t Map_store::get_attribute(const pool_t pool,
   return session->pool->get_attribute(attr, out_attr, key);
 }
 
+status_t Map_store::set_attribute(const pool_t pool,
+                                  const IKVStore::Attribute attr,
+                                  const std::vector<uint64_t> &value,
+                                  const std::string *key)
+{
+  auto session = get_session(pool);
+  if (!session) return IKVStore::E_POOL_NOT_FOUND;
+
+  return session->pool->set_attribute(attr, value, key);
+}
+
 status_t Map_store::swap_keys(const pool_t           pool,
                               const std::string      key0,
                               const std::string      key1)
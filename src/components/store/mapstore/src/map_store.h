@@ -77,7 +77,7 @@ public:
 
 public:
   /* IKVStore */
-  virtual int thread_safety() const override { return THREAD_MODEL_RWLOCK_PER_POOL; }
+  virtual int thread_safety() const override { return THREAD_MODEL_MULTI_PER_POOL; }
 
   virtual int get_capability(Capability cap) const override;
 
@@ -120,6 +120,10 @@ public:
                                  std::vector<uint64_t> &out_attr,
                                  const std::string *key = nullptr) override;
 
+  virtual status_t set_attribute(const pool_t pool, const Attribute attr,
+                                 const std::vector<uint64_t> &value,
+                                 const std::string *key = nullptr) override;
+
   virtual status_t swap_keys(const pool_t pool,
                              const std::string key0,
                              const std::string key1) override;
@@ -0,0 +1,183 @@
+/*
+  Copyright [2017-2021] [IBM Corporation]
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __MAP_STORE_POOL_HEAP_H__
+#define __MAP_STORE_POOL_HEAP_H__
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mm_plugin_itf.h"
+
+/**
+ * Pool heap shared by all threads using a pool.
+ *
+ * MM plugins are not required to be thread safe, so each plugin heap
+ * must be called under a lock. To keep that lock from serializing every
+ * thread of a pool, the pool's memory is divided among several arenas,
+ * each a separate plugin heap with its own lock. A thread allocates
+ * from its home arena, and from the others only when that one is
+ * exhausted. Memory is returned to the arena which manages its address.
+ *
+ * A region smaller than MIN_ARENA_SPLIT per arena is not divided; it is
+ * given whole to the next arena in turn, so that small pools keep their
+ * largest allocation. An allocation larger than any arena's free space
+ * fails, as it would in a fragmented single heap.
+ */
+class Pool_heap {
+public:
+  static constexpr size_t MIN_ARENA_SPLIT = size_t(1) << 24; /* 16 MiB per arena */
+  static constexpr size_t MAX_SPANS = 1024;
+
+  Pool_heap(const std::string& plugin_path, unsigned arena_count)
+    : _arenas(),
+      _spans{},
+      _span_count(0),
+      _add_lock{},
+      _next_arena(0)
+  {
+    arena_count = std::max(1U, arena_count);
+    for (unsigned i = 0; i != arena_count; ++i)
+      _arenas.emplace_back(new Arena(plugin_path));
+  }
+
+  Pool_heap(const Pool_heap&) = delete;
+  Pool_heap& operator=(const Pool_heap&) = delete;
+
+  unsigned arena_count() const { return unsigned(_arenas.size()); }
+
+  /* may be called while other threads allocate and free */
+  status_t add_managed_region(void * region_base, size_t region_size) {
+    Lock_guard g(_add_lock);
+    const auto n = _arenas.size();
+    if (n == 1 || region_size / n < MIN_ARENA_SPLIT) {
+      return add_span(static_cast<char *>(region_base), region_size,
+                      _next_arena++ % n);
+    }
+
+    /* split into page-aligned pieces, the last taking any remainder */
+    const size_t piece = region_size / n / ARENA_ALIGN * ARENA_ALIGN;
+    auto base = static_cast<char *>(region_base);
+    for (size_t i = 0; i != n; ++i) {
+      const size_t len = (i + 1 == n) ? region_size - piece * i : piece;
+      auto rc = add_span(base + piece * i, len, i);
+      if (rc != S_OK) return rc;
+    }
+    return S_OK;
+  }
+
+  status_t allocate(size_t n, void ** out_ptr) {
+    return each_arena([n, out_ptr](MM_plugin_wrapper& p) { return p.allocate(n, out_ptr); });
+  }
+
+  status_t aligned_allocate(size_t n, size_t alignment, void ** out_ptr) {
+    return each_arena([n, alignment, out_ptr](MM_plugin_wrapper& p) {
+        return p.aligned_allocate(n, alignment, out_ptr); });
+  }
+
+  status_t deallocate(void ** ptr, size_t size) {
+    auto a = owner(*ptr);
+    if (!a) return E_INVAL;
+    Lock_guard g(a->lock);
+    return a->plugin.deallocate(ptr, size);
+  }
+
+  status_t deallocate_without_size(void ** ptr) {
+    auto a = owner(*ptr);
+    if (!a) return E_INVAL;
+    Lock_guard g(a->lock);
+    return a->plugin.deallocate_without_size(ptr);
+  }
+
+private:
+  using Lock_guard = std::lock_guard<std::mutex>;
+  static constexpr size_t ARENA_ALIGN = 4096;
+
+  struct alignas(64) Arena {
+    explicit Arena(const std::string& plugin_path) : plugin(plugin_path), lock{}, managed(false) {}
+    MM_plugin_wrapper plugin;
+    std::mutex        lock;
+    std::atomic<bool> managed; /*< has at least one region */
+  };
+
+  struct Span {
+    const char * base;
+    size_t       len;
+    size_t       arena;
+  };
+
+  /* caller holds _add_lock */
+  status_t add_span(char * base, size_t len, size_t arena) {
+    const auto ix = _span_count.load(std::memory_order_relaxed);
+    if (ix == MAX_SPANS)
+      throw std::length_error("Pool_heap: too many regions");
+    auto& a = *_arenas[arena];
+    {
+      Lock_guard g(a.lock);
+      auto rc = a.plugin.add_managed_region(base, len);
+      if (rc != S_OK) return rc;
+    }
+    _spans[ix] = Span{base, len, arena};
+    /* publish the span before any allocation from it can be freed */
+    _span_count.store(ix + 1, std::memory_order_release);
+    a.managed.store(true, std::memory_order_release);
+    return S_OK;
+  }
+
+  /* spans are only appended, so lookup needs no lock */
+  Arena * owner(const void * p) {
+    const auto count = _span_count.load(std::memory_order_acquire);
+    auto c = static_cast<const char *>(p);
+    for (size_t i = 0; i != count; ++i) {
+      if (_spans[i].base <= c && c < _spans[i].base + _spans[i].len)
+        return _arenas[_spans[i].arena].get();
+    }
+    return nullptr;
+  }
+
+  /* Each thread is given a home arena, in turn, on first use of any pool */
+  size_t home_arena() const {
+    static std::atomic<unsigned> next_thread{0};
+    thread_local unsigned thread_index = next_thread++;
+    return thread_index % _arenas.size();
+  }
+
+  template <typename F>
+  status_t each_arena(F f) {
+    const auto n = _arenas.size();
+    const auto home = home_arena();
+    status_t rc = E_FAIL;
+    for (size_t i = 0; i != n; ++i) {
+      auto& a = *_arenas[(home + i) % n];
+      if (!a.managed.load(std::memory_order_acquire)) continue;
+      Lock_guard g(a.lock);
+      rc = f(a.plugin);
+      if (rc == S_OK) break;
+    }
+    return rc;
+  }
+
+  std::vector<std::unique_ptr<Arena>> _arenas;
+  std::array<Span, MAX_SPANS>         _spans;
+  std::atomic<size_t>                 _span_count;
+  std::mutex                          _add_lock; /*< serializes add_managed_region */
+  size_t                              _next_arena; /*< guarded by _add_lock */
+};
+
+#endif
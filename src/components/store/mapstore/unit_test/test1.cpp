@@ -23,6 +23,11 @@
 #include <api/components.h>
 #include <api/kvstore_itf.h>
 
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 #define ASSERT_OK(X) ASSERT_TRUE(S_OK == X)
 
 using namespace component;
@@ -252,6 +257,50 @@ TEST_F(KVStore_test, Timestamps)
   ASSERT_TRUE(_kvstore->close_pool(pool) == S_OK);
 }
 
+TEST_F(KVStore_test, WriteTimeIndex)
+{
+  ASSERT_TRUE(_kvstore);
+  pool = _kvstore->create_pool("write-index-test.pool", MB(32));
+
+  std::vector<std::string> keys;
+  for(unsigned i=0;i<10;i++) {
+    keys.push_back(common::random_string(8));
+    _kvstore->put(pool, keys.back(), "old", 3);
+  }
+
+  ASSERT_TRUE(_kvstore->set_attribute(pool, IKVStore::Attribute::WRITE_TIME_INDEX, {1}) == S_OK);
+
+  sleep(1);
+  auto now = common::epoch_now();
+
+  /* 5 new keys, 2 rewritten, 1 erased */
+  for(unsigned i=0;i<5;i++) {
+    keys.push_back(common::random_string(8));
+    _kvstore->put(pool, keys.back(), "new", 3);
+  }
+  _kvstore->put(pool, keys[0], "newer", 5);
+  _kvstore->put(pool, keys[1], "newer", 5);
+  ASSERT_TRUE(_kvstore->erase(pool, keys.back()) == S_OK);
+
+  auto count_since = [this] (common::epoch_time_t t) {
+    unsigned n = 0;
+    _kvstore->map(pool, [&n](const void*, const size_t, const void*, const size_t, const common::tsc_time_t) -> int
+                  { ++n; return 0; }
+                  , t
+                  , {0,0});
+    return n;
+  };
+
+  ASSERT_EQ(6U, count_since(now));
+  ASSERT_EQ(15U - 1, count_since({0,0}));
+
+  /* without the index, the same answers by scan */
+  ASSERT_TRUE(_kvstore->set_attribute(pool, IKVStore::Attribute::WRITE_TIME_INDEX, {0}) == S_OK);
+  ASSERT_EQ(6U, count_since(now));
+
+  ASSERT_TRUE(_kvstore->close_pool(pool) == S_OK);
+}
+
 TEST_F(KVStore_test, Iterator)
 {
   ASSERT_TRUE(_kvstore);
@@ -388,6 +437,120 @@ TEST_F(KVStore_test, AlignedLock)
   ASSERT_TRUE(_kvstore->close_pool(pool) == S_OK);
 }
 
+TEST_F(KVStore_test, LockAcrossGrowth)
+{
+  ASSERT_TRUE(_kvstore);
+  pool = _kvstore->create_pool("lockgrowth", MB(32));
+  ASSERT_TRUE(pool != IKVStore::POOL_ERROR);
+
+  /* one short (in-slot) and one long key, locked while the index grows */
+  std::string short_key = "short";
+  std::string long_key(100, 'L');
+  void * addr = nullptr;
+  size_t value_len = 64;
+  IKVStore::key_t short_handle, long_handle;
+  const char * short_key_ptr = nullptr;
+  const char * long_key_ptr = nullptr;
+
+  ASSERT_TRUE(_kvstore->lock(pool, short_key, IKVStore::STORE_LOCK_READ, addr, value_len, 0, short_handle, &short_key_ptr) == S_OK_CREATED);
+  ASSERT_TRUE(_kvstore->lock(pool, long_key, IKVStore::STORE_LOCK_WRITE, addr, value_len, 0, long_handle, &long_key_ptr) == S_OK_CREATED);
+
+  std::string value = "value";
+  for(unsigned i = 0; i < 10000; i++) {
+    ASSERT_OK(_kvstore->put(pool, "key" + std::to_string(i), value.c_str(), value.length()));
+  }
+  ASSERT_TRUE(_kvstore->count(pool) == 10002);
+
+  ASSERT_TRUE(std::string(short_key_ptr) == short_key);
+  ASSERT_TRUE(std::string(long_key_ptr) == long_key);
+  ASSERT_TRUE(_kvstore->erase(pool, long_key) == E_LOCKED);
+
+  ASSERT_OK(_kvstore->unlock(pool, short_handle));
+  ASSERT_OK(_kvstore->unlock(pool, long_handle));
+  ASSERT_OK(_kvstore->erase(pool, short_key));
+  ASSERT_OK(_kvstore->erase(pool, long_key));
+
+  for(unsigned i = 0; i < 10000; i++) {
+    ASSERT_OK(_kvstore->erase(pool, "key" + std::to_string(i)));
+  }
+  ASSERT_TRUE(_kvstore->count(pool) == 0);
+
+  ASSERT_TRUE(_kvstore->close_pool(pool) == S_OK);
+}
+
+TEST_F(KVStore_test, ConcurrentPool)
+{
+  /* Many threads on one pool: puts, gets, erases and key locks on a
+   * thread's own keys, then erases of keys written by another thread, so
+   * that memory is freed by a thread other than the one which allocated it.
+   * The pool is large enough to be divided among the heap arenas.
+   */
+  ASSERT_TRUE(_kvstore);
+  pool = _kvstore->create_pool("concurrent.pool", MB(512));
+  ASSERT_TRUE(pool != IKVStore::POOL_ERROR);
+
+  const unsigned thread_count = 8;
+  const unsigned per_thread = 4000;
+  auto key = [](unsigned t, unsigned i) { return "t" + std::to_string(t) + "-" + std::to_string(i); };
+  /* sizes span inline, small and multi-page values */
+  auto value = [](unsigned t, unsigned i) { return std::string(1 + (i * 37) % 9000, char('a' + t)); };
+  std::atomic<unsigned> failures{0};
+
+  {
+    std::vector<std::thread> threads;
+    for(unsigned t = 0; t < thread_count; t++) {
+      threads.emplace_back([&, t] {
+        for(unsigned i = 0; i < per_thread; i++) {
+          auto v = value(t, i);
+          if(_kvstore->put(pool, key(t, i), v.data(), v.size()) != S_OK) { ++failures; continue; }
+          void * out = nullptr;
+          size_t out_len = 0;
+          if(_kvstore->get(pool, key(t, i), out, out_len) != S_OK ||
+             std::string(static_cast<char *>(out), out_len) != v) ++failures;
+          if(out) _kvstore->free_memory(out);
+          /* erase every fourth key; the erased value is freed while other threads allocate */
+          if(i % 4 == 3 && _kvstore->erase(pool, key(t, i)) != S_OK) ++failures;
+          /* lock and unlock a key which other threads do not touch */
+          if(i % 16 == 0) {
+            void * addr = nullptr;
+            size_t len = 0;
+            IKVStore::key_t handle;
+            if(_kvstore->lock(pool, key(t, i), IKVStore::STORE_LOCK_WRITE, addr, len, 0, handle) != S_OK ||
+               _kvstore->unlock(pool, handle) != S_OK) ++failures;
+          }
+        }
+      });
+    }
+    for(auto &th : threads) th.join();
+  }
+  ASSERT_EQ(0U, failures.load());
+  ASSERT_EQ(size_t(thread_count) * (per_thread - per_thread / 4), _kvstore->count(pool));
+
+  {
+    std::vector<std::thread> threads;
+    for(unsigned t = 0; t < thread_count; t++) {
+      threads.emplace_back([&, t] {
+        const unsigned owner = (t + 1) % thread_count;
+        for(unsigned i = 0; i < per_thread; i++) {
+          if(i % 4 == 3) continue;
+          void * out = nullptr;
+          size_t out_len = 0;
+          if(_kvstore->get(pool, key(owner, i), out, out_len) != S_OK ||
+             std::string(static_cast<char *>(out), out_len) != value(owner, i)) ++failures;
+          if(out) _kvstore->free_memory(out);
+          if(_kvstore->erase(pool, key(owner, i)) != S_OK) ++failures;
+        }
+      });
+    }
+    for(auto &th : threads) th.join();
+  }
+  ASSERT_EQ(0U, failures.load());
+  ASSERT_EQ(0U, _kvstore->count(pool));
+
+  ASSERT_TRUE(_kvstore->close_pool(pool) == S_OK);
+  ASSERT_TRUE(_kvstore->delete_pool("concurrent.pool") == S_OK);
+}
+
 } // namespace
 
 int main(int argc, char **argv) {
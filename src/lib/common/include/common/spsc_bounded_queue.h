@@ -158,6 +158,15 @@ public:
 
   inline bool pop(T &data) { return dequeue(data); }
 
+  /**
+   * Check for an empty queue. Meaningful to the consumer only.
+   *
+   * @return True if there is nothing to dequeue
+   */
+  bool empty() const {
+    return ((_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_relaxed)) & _mask) == 0;
+  }
+
   /**
    * Helper to get the base address of buffer
    *
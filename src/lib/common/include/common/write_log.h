@@ -0,0 +1,169 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _MCAS_COMMON_WRITE_LOG_
+#define _MCAS_COMMON_WRITE_LOG_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace common
+{
+/**
+ * Time-ordered log of writes to a pool. It is an optional, volatile
+ * secondary index which makes time-range iteration cost in proportion
+ * to the entries written in the range, not to the size of the pool.
+ *
+ * Entries are (stamp, key). Rewriting or erasing a key leaves its
+ * older entries in place, so a caller must check an entry against the
+ * key's current timestamp before using it. Stale entries are dropped
+ * by a compaction which runs whenever the log has doubled in size
+ * since the last one.
+ *
+ * Stamps are raw tsc_time_t values. The log is internally locked.
+ */
+class Write_log {
+public:
+  using stamp_t = std::uint64_t;
+
+  struct Entry {
+    stamp_t     stamp;
+    std::string key;
+    bool        erased;
+  };
+
+  Write_log() : _lock{}, _entries{}, _compact_at(MIN_COMPACT) {}
+
+  Write_log(const Write_log &) = delete;
+  Write_log &operator=(const Write_log &) = delete;
+
+  /**
+   * Record a write of a key
+   *
+   * @param stamp Timestamp now held by the key
+   */
+  void record(const void *key, std::size_t key_len, stamp_t stamp)
+  {
+    std::lock_guard<std::mutex> g(_lock);
+    Entry e{stamp, std::string(static_cast<const char *>(key), key_len), false};
+    /* clocks may step back; keep the log ordered */
+    if (_entries.empty() || _entries.back().stamp <= stamp)
+      _entries.push_back(std::move(e));
+    else
+      _entries.insert(std::upper_bound(_entries.begin(), _entries.end(), e, by_stamp), std::move(e));
+    maybe_compact();
+  }
+
+  /**
+   * Record erasure of a key, so that compaction can drop its entries
+   */
+  void record_erase(const void *key, std::size_t key_len)
+  {
+    std::lock_guard<std::mutex> g(_lock);
+    auto stamp = _entries.empty() ? stamp_t(0) : _entries.back().stamp;
+    _entries.push_back(Entry{stamp, std::string(static_cast<const char *>(key), key_len), true});
+    maybe_compact();
+  }
+
+  /**
+   * Merge in entries for keys which were present before the log was
+   * enabled (in any order)
+   */
+  void seed(std::vector<Entry> &&entries)
+  {
+    std::sort(entries.begin(), entries.end(), by_stamp);
+    std::lock_guard<std::mutex> g(_lock);
+    std::deque<Entry> merged;
+    std::merge(std::make_move_iterator(_entries.begin()), std::make_move_iterator(_entries.end()),
+               std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end()),
+               std::back_inserter(merged), by_stamp);
+    _entries.swap(merged);
+    _compact_at = std::max(_compact_at, 2 * _entries.size());
+  }
+
+  /**
+   * Writes stamped within [begin, end], oldest first, without erase
+   * records or duplicates. May include entries which have since been
+   * superseded.
+   */
+  std::vector<Entry> range(stamp_t begin, stamp_t end) const
+  {
+    std::vector<Entry> out;
+    {
+      std::lock_guard<std::mutex> g(_lock);
+      auto it = std::lower_bound(_entries.begin(), _entries.end(), Entry{begin, {}, false}, by_stamp);
+      for (; it != _entries.end() && it->stamp <= end; ++it)
+        if (!it->erased) out.push_back(*it);
+    }
+    /* a key seeded while also being written may appear twice */
+    std::sort(out.begin(), out.end(),
+              [](const Entry &a, const Entry &b) { return a.stamp < b.stamp || (a.stamp == b.stamp && a.key < b.key); });
+    out.erase(std::unique(out.begin(), out.end(),
+                          [](const Entry &a, const Entry &b) { return a.stamp == b.stamp && a.key == b.key; }),
+              out.end());
+    return out;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> g(_lock);
+    _entries.clear();
+    _compact_at = MIN_COMPACT;
+  }
+
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> g(_lock);
+    return _entries.size();
+  }
+
+private:
+  static constexpr std::size_t MIN_COMPACT = 4096;
+
+  static bool by_stamp(const Entry &a, const Entry &b) { return a.stamp < b.stamp; }
+
+  /* keep only the newest entry of each key, and none for erased keys */
+  void maybe_compact()
+  {
+    if (_entries.size() < _compact_at) return;
+
+    std::unordered_set<std::string_view> seen;
+    std::vector<bool>                    keep(_entries.size());
+    for (auto i = _entries.size(); i != 0; --i) {
+      auto &e = _entries[i - 1];
+      keep[i - 1] = seen.insert(e.key).second && !e.erased;
+    }
+
+    std::deque<Entry> kept;
+    for (std::size_t i = 0; i != _entries.size(); ++i)
+      if (keep[i]) kept.push_back(std::move(_entries[i]));
+    _entries.swap(kept);
+    _compact_at = std::max(MIN_COMPACT, 2 * _entries.size());
+  }
+
+  mutable std::mutex _lock;
+  std::deque<Entry>  _entries;
+  std::size_t        _compact_at;
+};
+}  // namespace common
+
+#endif
@@ -56,6 +56,8 @@ enum class MSG_TYPE {
   CONFIGURE_REQUEST = 18,
   CLUSTER_EVENT = 19,
   MAP_MEMORY_NAMED = 20,
+  TABLE_OP_BATCH_REQUEST = 21,
+  TABLE_OP_BATCH_RESPONSE = 22,
 };
 
 enum class chirp_t {
@@ -518,6 +520,140 @@ struct Table_response : public Message {
 };
 
 
+//-------------
+
+/* fixed part of one operation in a Table_batch_request */
+struct Table_batch_op {
+  uint64_t          work_key;
+  uint64_t          value_len;
+  uint64_t          key_len;
+  uint64_t          addr;
+  uint64_t          align_or_flags;
+  component::ADO_op op;
+};
+
+struct Table_batch_request : public Message {
+  static constexpr auto id = MSG_TYPE::TABLE_OP_BATCH_REQUEST;
+  static constexpr const char *description = "mcas::ipc::Table_batch_request";
+
+  /* message size for count operations, with total_key_len bytes of keys */
+  static size_t size_required(size_t count, size_t total_key_len)
+  {
+    return sizeof(Table_batch_request) + (count * sizeof(Table_batch_op)) + total_key_len;
+  }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++" // ops uninitialized
+  Table_batch_request(size_t buffer_size,
+                      const component::IADO_plugin::table_op_t * _ops,
+                      size_t _count)
+    : Message(id), count(_count)
+  {
+    size_t total_key_len = 0;
+    for(size_t i = 0; i != _count; ++i)
+      total_key_len += _ops[i].key.size();
+
+    if(size_required(_count, total_key_len) > buffer_size)
+      throw std::length_error(description);
+
+    char * key_ptr = keys();
+    for(size_t i = 0; i != _count; ++i) {
+      const auto& op = _ops[i];
+      ops[i] = Table_batch_op{op.work_id,
+                              op.value_len,
+                              op.key.size(),
+                              reinterpret_cast<uint64_t>(op.addr),
+                              op.align_or_flags,
+                              op.op};
+      ::memcpy(key_ptr, op.key.data(), op.key.size());
+      key_ptr += op.key.size();
+    }
+  }
+#pragma GCC diagnostic pop
+
+  /* keys are packed, in operation order, after the operations */
+  inline char * keys() { return reinterpret_cast<char *>(&ops[count]); }
+  inline const char * keys() const { return reinterpret_cast<const char *>(&ops[count]); }
+
+  /* true if count and every key length lie within a received message of buffer_size bytes */
+  bool well_formed(size_t buffer_size) const
+  {
+    if(buffer_size < sizeof(Table_batch_request))
+      return false;
+    size_t remaining = buffer_size - sizeof(Table_batch_request);
+    if(count > remaining / sizeof(Table_batch_op))
+      return false;
+    remaining -= count * sizeof(Table_batch_op);
+    for(uint64_t i = 0; i != count; ++i) {
+      if(ops[i].key_len > remaining)
+        return false;
+      remaining -= ops[i].key_len;
+    }
+    return true;
+  }
+
+  uint64_t       count;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic" // zero-size array
+  Table_batch_op ops[];
+#pragma GCC diagnostic pop
+};
+
+//-------------
+
+/* one result in a Table_batch_response; see Table_response */
+struct Table_batch_result {
+  uint64_t value_addr;
+  uint64_t value_len;
+  uint64_t key_addr;
+  uint64_t key_handle;
+  status_t status;
+};
+
+struct Table_batch_response : public Message {
+  static constexpr auto id = MSG_TYPE::TABLE_OP_BATCH_RESPONSE;
+  static constexpr const char *description = "mcas::ipc::Table_batch_response";
+
+  static size_t size_required(size_t count)
+  {
+    return sizeof(Table_batch_response) + (count * sizeof(Table_batch_result));
+  }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++" // results uninitialized
+  Table_batch_response(size_t buffer_size,
+                       const component::IADO_plugin::table_op_result_vector_t& _results)
+    : Message(id), count(_results.size())
+  {
+    if(size_required(count) > buffer_size)
+      throw std::length_error(description);
+
+    for(size_t i = 0; i != count; ++i) {
+      const auto& r = _results[i];
+      results[i] = Table_batch_result{reinterpret_cast<uint64_t>(r.value_addr),
+                                      r.value_len,
+                                      reinterpret_cast<uint64_t>(r.key_ptr),
+                                      reinterpret_cast<uint64_t>(r.key_handle),
+                                      r.status};
+    }
+  }
+#pragma GCC diagnostic pop
+
+  /* true if count results lie within a received message of buffer_size bytes */
+  bool well_formed(size_t buffer_size) const
+  {
+    return buffer_size >= sizeof(Table_batch_response) &&
+      count <= (buffer_size - sizeof(Table_batch_response)) / sizeof(Table_batch_result);
+  }
+
+  uint64_t           count;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic" // zero-size array
+  Table_batch_result results[];
+#pragma GCC diagnostic pop
+};
+
+
 //-------------
 
 struct Index_request : public Message {
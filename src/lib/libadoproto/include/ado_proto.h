@@ -28,6 +28,7 @@
 #include <unistd.h>
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <memory>
 #include <string>
@@ -50,8 +51,8 @@ class ADO_protocol_builder : common::log_source
 public:
   static constexpr size_t MAX_MESSAGE_SIZE  = MB(2); //4096;
   static constexpr size_t QUEUE_SIZE        = 32;
-  static constexpr size_t POLL_SLEEP_USEC   = 1000; /* 1 ms */
-  static constexpr size_t POLL_RETRY_LIMIT  = 1000000;
+  static constexpr unsigned DEFAULT_SPIN_USEC = 100; /* poll this long before blocking */
+  static constexpr unsigned BLOCK_WAIT_USEC   = 100000; /* limit on one doorbell wait */
 
   static_assert(MAX_MESSAGE_SIZE > 64, "MAX_MESSAGE_SIZE too small");
 
@@ -109,6 +110,9 @@ public:
 
   ~ADO_protocol_builder();
 
+  /* time a receiver polls before blocking on the channel doorbell */
+  void set_spin_usec(unsigned spin_usec) { _spin_usec = spin_usec; }
+
   void create_uipc_channels();
 
   status_t recv_bootstrap_response();
@@ -192,6 +196,13 @@ public:
   status_t send_table_op_free_pool_memory(const void * ptr,
                                       const size_t size);
 
+  /* number of leading operations of ops which fit in one batch message */
+  static size_t table_op_batch_fit(const component::IADO_plugin::table_op_t * ops,
+                                   size_t count);
+
+  status_t send_table_op_batch(const component::IADO_plugin::table_op_t * ops,
+                               size_t count);
+
   status_t send_find_index_request(const std::string& key_expression,
                                offset_t begin_position,
                                component::IKVIndex::find_t find_type);
@@ -249,6 +260,15 @@ public:
                               const char ** out_key_ptr = nullptr,
                               component::IKVStore::key_t * out_key_handle = nullptr);
 
+  /* shard-side, must not block */
+  bool recv_table_op_batch_request(const Buffer_header * buffer,
+                                   component::IADO_plugin::table_op_vector_t& ops);
+
+  status_t send_table_op_batch_response(const component::IADO_plugin::table_op_result_vector_t& results);
+
+  /* appends to out_results */
+  void recv_table_op_batch_response(component::IADO_plugin::table_op_result_vector_t& out_results);
+
   void recv_find_index_response(status_t& status,
                                 offset_t& out_matched_position,
                                 std::string& out_matched_key);
@@ -309,7 +329,17 @@ public:
   /* UIPC helpers */
   inline status_t send_callback(void * buffer)
   {
-    return ::uipc_send(_channel_callback, buffer);
+    auto s = ::uipc_send(_channel_callback, buffer);
+    /* the shard waits on the work channel doorbell for both channels */
+    if(_role == Role::ACCEPT)
+      ::uipc_notify(_channel);
+    return s;
+  }
+
+  /* shard-side: block until the ADO sends a work completion or callback */
+  status_t wait_for_ado(unsigned timeout_usec)
+  {
+    return ::uipc_wait(_channel, _channel_callback, timeout_usec);
   }
 
   inline status_t recv(Buffer_header *& out_buffer) __attribute__((warn_unused_result)) { return recv(_channel, out_buffer); }
@@ -331,28 +361,42 @@ public:
     return s;
   }
 
+  /* poll, then block on the doorbell once idle for the spin time */
   status_t poll_recv_sleep(Buffer_header *& out_buffer) __attribute__((warn_unused_result)) {
-    status_t s;
-    unsigned retries = 0;
-    while((s = recv(out_buffer)) == E_EMPTY) {
-      if(retries++ < POLL_RETRY_LIMIT)
-        cpu_relax();
-      else
-        usleep(POLL_SLEEP_USEC);
-    }
-    return s;
+    return spin_then_block(_channel, out_buffer);
   }
 
   status_t poll_recv_callback(Buffer_header *& out_buffer) __attribute__((warn_unused_result)) {
+    return spin_then_block(_channel_callback, out_buffer);
+  }
+
+private:
+  status_t spin_then_block(channel_t ch, Buffer_header *& out_buffer) __attribute__((warn_unused_result)) {
+    /* reading the clock on every poll would be wasteful; sample it */
+    static constexpr unsigned CLOCK_INTERVAL = 64;
+
     status_t s;
-    while((s = recv_callback(out_buffer)) == E_EMPTY) {
-      cpu_relax();
+    unsigned polls = 0;
+    bool blocking = (_spin_usec == 0);
+    std::chrono::steady_clock::time_point spin_end;
+    while((s = recv(ch, out_buffer)) == E_EMPTY) {
+      if(blocking) {
+        (void) ::uipc_wait(ch, nullptr, BLOCK_WAIT_USEC);
+      }
+      else {
+        if(polls == 0)
+          spin_end = std::chrono::steady_clock::now() + std::chrono::microseconds(_spin_usec);
+        else if(polls % CLOCK_INTERVAL == 0)
+          blocking = (std::chrono::steady_clock::now() >= spin_end);
+        ++polls;
+        cpu_relax();
+      }
     }
-
     return s;
   }
 
-private:
+  Role _role;
+  unsigned _spin_usec;
   std::string _channel_prefix;
   Channel_wrap _channel;
   Channel_wrap _channel_callback;
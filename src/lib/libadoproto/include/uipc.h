@@ -118,6 +118,27 @@ status_t uipc_send(channel_t channel, void* data) __attribute__((warn_unused_res
  * @return S_OK or E_EMPTY
  */
 status_t uipc_recv(channel_t channel, void** data_out) __attribute__((warn_unused_result));
+
+/**
+ * Wait for a message by blocking on the channel's doorbell, which the
+ * other side rings on each send. The message is not dequeued.
+ *
+ * @param channel Channel handle
+ * @param also Optional second channel (or NULL) whose messages also end
+ *             the wait; its sender must call uipc_notify on it
+ * @param timeout_us Time limit in microseconds
+ *
+ * @return S_OK if a message is waiting, E_TIMEOUT otherwise
+ */
+status_t uipc_wait(channel_t channel, channel_t also, unsigned timeout_us);
+
+/**
+ * Ring the other side's doorbell for a channel without sending a
+ * message, e.g., after sending on a second channel (see uipc_wait)
+ *
+ * @param channel Channel handle
+ */
+void uipc_notify(channel_t channel);
 #ifdef __cplusplus
 }
 #endif
@@ -77,6 +77,8 @@ ADO_protocol_builder::ADO_protocol_builder(unsigned debug_level_,
                                            const std::string& channel_prefix,
                                            Role role)
   : common::log_source(debug_level_),
+  _role(role),
+  _spin_usec(DEFAULT_SPIN_USEC),
   _channel_prefix(channel_prefix),
   _channel(),
   _channel_callback(),
@@ -643,6 +645,97 @@ bool ADO_protocol_builder::recv_table_op_request(const Buffer_header * buffer,
 
 
 
+/// --- table op batch
+
+size_t ADO_protocol_builder::table_op_batch_fit(const IADO_plugin::table_op_t * ops,
+                                                size_t count)
+{
+  size_t total_key_len = 0;
+  for(size_t i = 0; i != count; ++i) {
+    total_key_len += ops[i].key.size();
+    if(Table_batch_request::size_required(i + 1, total_key_len) > MAX_MESSAGE_SIZE ||
+       Table_batch_response::size_required(i + 1) > MAX_MESSAGE_SIZE)
+      return i;
+  }
+  return count;
+}
+
+status_t ADO_protocol_builder::send_table_op_batch(const IADO_plugin::table_op_t * ops,
+                                                   size_t count)
+{
+  auto buffer = get_buffer().release();
+  if(!buffer) throw General_exception("%s:%u out of buffers", __FILE__, __LINE__);
+
+  new (buffer) Table_batch_request(MAX_MESSAGE_SIZE, ops, count);
+  return send_callback(buffer);
+}
+
+bool ADO_protocol_builder::recv_table_op_batch_request(const Buffer_header * buffer,
+                                                       IADO_plugin::table_op_vector_t& ops)
+{
+  if(mcas::ipc::Message::is_valid(buffer) &&
+     mcas::ipc::Message::type(buffer) == MSG_TYPE::TABLE_OP_BATCH_REQUEST) {
+    auto * msg = reinterpret_cast<const Table_batch_request*>(buffer);
+    ops.clear();
+    /* a malformed batch is answered with an empty response */
+    if(!msg->well_formed(MAX_MESSAGE_SIZE)) {
+      PWRN("%s: malformed batch (count=%lu)", __func__, msg->count);
+      return true;
+    }
+    const char * key_ptr = msg->keys();
+    ops.reserve(msg->count);
+    for(uint64_t i = 0; i != msg->count; ++i) {
+      const auto& op = msg->ops[i];
+      ops.push_back(IADO_plugin::table_op_t{op.op,
+                                            op.work_key,
+                                            std::string(key_ptr, op.key_len),
+                                            op.value_len,
+                                            op.align_or_flags,
+                                            reinterpret_cast<const void*>(op.addr)});
+      key_ptr += op.key_len;
+    }
+    return true;
+  }
+  return false;
+}
+
+status_t ADO_protocol_builder::send_table_op_batch_response(const IADO_plugin::table_op_result_vector_t& results)
+{
+  auto buffer = get_buffer().release();
+  if(!buffer) throw General_exception("%s:%u out of buffers", __FILE__, __LINE__);
+
+  new (buffer) Table_batch_response(MAX_MESSAGE_SIZE, results);
+  return send_callback(buffer);
+}
+
+void ADO_protocol_builder::recv_table_op_batch_response(IADO_plugin::table_op_result_vector_t& out_results)
+{
+  Buffer_header * buffer;
+  auto st = poll_recv_callback(buffer);
+  if ( st != S_OK )
+    throw std::runtime_error("bad response from recv_table_op_batch_response");
+
+  if(mcas::ipc::Message::is_valid(buffer) &&
+     mcas::ipc::Message::type(buffer) == MSG_TYPE::TABLE_OP_BATCH_RESPONSE) {
+    auto * wr = reinterpret_cast<Table_batch_response*>(buffer);
+    if(!wr->well_formed(MAX_MESSAGE_SIZE)) {
+      free_ipc_buffer(buffer);
+      throw Logic_exception("recv_table_op_batch_response got a malformed response");
+    }
+    for(uint64_t i = 0; i != wr->count; ++i) {
+      const auto& r = wr->results[i];
+      out_results.push_back(IADO_plugin::table_op_result_t{r.status,
+                                                           reinterpret_cast<void*>(r.value_addr),
+                                                           r.value_len,
+                                                           reinterpret_cast<const char *>(r.key_addr),
+                                                           reinterpret_cast<component::IKVStore::key_t>(r.key_handle)});
+    }
+    free_ipc_buffer(buffer);
+  }
+  else throw Logic_exception("recv_table_op_batch_response got something else");
+}
+
+
 /// --- vector
 
 status_t ADO_protocol_builder::send_vector_request(const common::epoch_time_t t_begin,
@@ -87,4 +87,16 @@ status_t uipc_recv(channel_t channel, void** data_out) {
   assert(ch);
   return ch->recv(*data_out);
 }
+
+status_t uipc_wait(channel_t channel, channel_t also, unsigned timeout_us) {
+  auto ch = static_cast<core::uipc::Channel*>(channel);
+  assert(ch);
+  return ch->wait(timeout_us, static_cast<core::uipc::Channel*>(also));
+}
+
+void uipc_notify(channel_t channel) {
+  auto ch = static_cast<core::uipc::Channel*>(channel);
+  assert(ch);
+  ch->notify();
+}
 }
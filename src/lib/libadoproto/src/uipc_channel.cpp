@@ -22,6 +22,7 @@
 #include "uipc_channel.h"
 
 #include "resource_unavailable.h"
+#include "uipc_doorbell.h"
 #include "uipc_shared_memory.h"
 #include <common/errors.h>
 #include <common/exceptions.h>
@@ -41,6 +42,8 @@
 
 #include <unistd.h>
 #include <cassert>
+#include <chrono>
+#include <ctime>
 #include <string>
 
 namespace core
@@ -65,8 +68,11 @@ Channel::Channel(const std::string &name, size_t message_size, size_t queue_size
   , _shmem_slab()
   , _in_queue(nullptr)
   , _out_queue(nullptr)
+  , _in_bell(nullptr)
+  , _out_bell(nullptr)
   , _slab_ring(nullptr) {
-  const size_t queue_footprint = queue_t::memory_footprint(queue_size);
+  static_assert(sizeof(Doorbell) <= DOORBELL_SPACE, "doorbell does not fit");
+  const size_t queue_footprint = DOORBELL_SPACE + queue_t::memory_footprint(queue_size);
   size_t pages_per_queue = round_up(queue_footprint, PAGE_SIZE) / PAGE_SIZE;
 
   assert((queue_size != 0) && ((queue_size & (~queue_size + 1)) ==
@@ -104,11 +110,15 @@ Channel::Channel(const std::string &name, size_t message_size, size_t queue_size
   _shmem_slab_ring = std::make_unique<Shared_memory>(name + "-slabring", slab_queue_pages);
   _shmem_slab = std::make_unique<Shared_memory>(name + "-slab", slab_pages);
 
-  _out_queue = new (_shmem_fifo_m2s->get_addr()) queue_t(
-      queue_size, (static_cast<char*>(_shmem_fifo_m2s->get_addr())) + sizeof(queue_t));
+  auto m2s = static_cast<char*>(_shmem_fifo_m2s->get_addr());
+  _out_bell = new (m2s) Doorbell();
+  _out_queue = new (m2s + DOORBELL_SPACE) queue_t(
+      queue_size, m2s + DOORBELL_SPACE + sizeof(queue_t));
 
-  _in_queue = new (_shmem_fifo_s2m->get_addr()) queue_t(
-      queue_size, (static_cast<char*>(_shmem_fifo_s2m->get_addr())) + sizeof(queue_t));
+  auto s2m = static_cast<char*>(_shmem_fifo_s2m->get_addr());
+  _in_bell = new (s2m) Doorbell();
+  _in_queue = new (s2m + DOORBELL_SPACE) queue_t(
+      queue_size, s2m + DOORBELL_SPACE + sizeof(queue_t));
 
   size_t slab_slots = queue_size * slab_multiplier;
   _slab_ring = new (_shmem_slab_ring->get_addr()) mqueue_t(
@@ -137,8 +147,10 @@ Channel::Channel(const std::string &name)
   , _shmem_fifo_s2m(std::make_unique<Shared_memory>(name + "-s2m"))
   , _shmem_slab_ring(std::make_unique<Shared_memory>(name + "-slabring"))
   , _shmem_slab(std::make_unique<Shared_memory>(name + "-slab"))
-  , _in_queue(reinterpret_cast<queue_t*>(_shmem_fifo_m2s->get_addr()))
-  , _out_queue(reinterpret_cast<queue_t*>(_shmem_fifo_s2m->get_addr()))
+  , _in_queue(reinterpret_cast<queue_t*>(static_cast<char*>(_shmem_fifo_m2s->get_addr()) + DOORBELL_SPACE))
+  , _out_queue(reinterpret_cast<queue_t*>(static_cast<char*>(_shmem_fifo_s2m->get_addr()) + DOORBELL_SPACE))
+  , _in_bell(static_cast<Doorbell*>(_shmem_fifo_m2s->get_addr()))
+  , _out_bell(static_cast<Doorbell*>(_shmem_fifo_s2m->get_addr()))
   , _slab_ring(reinterpret_cast<mqueue_t*>(_shmem_slab_ring->get_addr())) {
 
   CPLOG(1, "got fifo (m2s) @ %p - %lu bytes", _shmem_fifo_m2s->get_addr(),
@@ -165,6 +177,7 @@ Channel::~Channel() {
 status_t Channel::send(void* msg) {
   assert(_out_queue);
   if (_out_queue->enqueue(msg)) {
+    _out_bell->ring();
     return S_OK;
   }
   else {
@@ -180,6 +193,31 @@ status_t Channel::recv(void*& recvd_msg) {
     return E_EMPTY;
 }
 
+bool Channel::ready() const { return !_in_queue->empty(); }
+
+status_t Channel::wait(unsigned timeout_us, const Channel* also) {
+  using namespace std::chrono;
+  assert(_in_bell);
+  auto ready = [this, also] () { return this->ready() || (also && also->ready()); };
+
+  /* a ring can be for a message which has since been taken; wait again */
+  const auto deadline = steady_clock::now() + microseconds(timeout_us);
+  while ( ! ready() ) {
+    const auto remaining = duration_cast<nanoseconds>(deadline - steady_clock::now()).count();
+    if ( remaining <= 0 )
+      return E_TIMEOUT;
+
+    const ::timespec timeout{remaining / 1000000000, remaining % 1000000000};
+    _in_bell->wait(ready, &timeout);
+  }
+  return S_OK;
+}
+
+void Channel::notify() {
+  assert(_out_bell);
+  _out_bell->ring();
+}
+
 void Channel::unblock_threads() { _in_queue->exit_threads(); }
 
 void* Channel::alloc_msg() {
@@ -40,6 +40,7 @@ namespace uipc
 {
 
 class Shared_memory;
+class Doorbell;
 
 class Channel : public uipc_channel, private common::log_source {
   /* we use the non-sleeping queue for the moment,
@@ -103,6 +104,24 @@ class Channel : public uipc_channel, private common::log_source {
    */
   status_t recv(void*& recvd_msg);
 
+  /**
+   * Wait for a message, blocking on the doorbell of the incoming
+   * queue. Does not dequeue the message.
+   *
+   * @param timeout_us Time limit in microseconds
+   * @param also Optional other channel whose incoming queue also
+   *             satisfies the wait; its sender must call notify() on it
+   *
+   * @return S_OK if a message is waiting, E_TIMEOUT otherwise
+   */
+  status_t wait(unsigned timeout_us, const Channel* also = nullptr);
+
+  /**
+   * Ring the peer's doorbell without sending a message (see wait)
+   *
+   */
+  void notify();
+
   /**
    * Allocate message (in shared memory) for
    * exchange on channel
@@ -143,6 +162,12 @@ class Channel : public uipc_channel, private common::log_source {
  private:
   void initialize_data_structures();
 
+  /* the incoming queue has a message */
+  bool ready() const;
+
+  /* doorbell at the start of each queue's shared memory; the queue follows */
+  static constexpr size_t DOORBELL_SPACE = 128;
+
  private:
   bool _shutdown = false;
   bool _master;
@@ -155,6 +180,8 @@ class Channel : public uipc_channel, private common::log_source {
 
   queue_t* _in_queue;
   queue_t* _out_queue;
+  Doorbell* _in_bell;
+  Doorbell* _out_bell;
   mqueue_t* _slab_ring;
 };
 
@@ -0,0 +1,98 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __CORE_UIPC_DOORBELL_H__
+#define __CORE_UIPC_DOORBELL_H__
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+
+namespace core
+{
+namespace uipc
+{
+
+/**
+ * Doorbell for a shared-memory queue, which lets an idle receiver block
+ * in the kernel rather than poll. It lives in shared memory next to the
+ * queue and is rung by the sender after each enqueue. Ringing costs a
+ * system call only when a receiver is asleep.
+ *
+ * The futex is process-shared (no FUTEX_PRIVATE_FLAG), since the two
+ * ends of a channel are different processes.
+ */
+class Doorbell {
+ public:
+  Doorbell() : _seq(0), _sleepers(0) {}
+
+  Doorbell(const Doorbell &) = delete;
+  Doorbell &operator=(const Doorbell &) = delete;
+
+  /**
+   * Wake any sleeping receiver. Call after publishing the message (or
+   * other state) which the receiver's ready check looks at.
+   */
+  void ring()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleepers.load(std::memory_order_relaxed) != 0) {
+      _seq.fetch_add(1, std::memory_order_release);
+      futex(FUTEX_WAKE, INT_MAX, nullptr);
+    }
+  }
+
+  /**
+   * Sleep until rung or timed out, unless ready() holds. ready() is
+   * evaluated after the sleep is announced, so a ring which comes
+   * between the caller's last check and the sleep is not lost.
+   *
+   * @param ready Check for the awaited state
+   * @param timeout Relative timeout, or nullptr for none
+   *
+   * @return False on timeout
+   */
+  template <typename F>
+  bool wait(F ready, const ::timespec *timeout)
+  {
+    _sleepers.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto seen = _seq.load(std::memory_order_acquire);
+
+    bool woken = true;
+    if (!ready())
+      woken = !(futex(FUTEX_WAIT, seen, timeout) == -1 && errno == ETIMEDOUT);
+
+    _sleepers.fetch_sub(1, std::memory_order_relaxed);
+    return woken;
+  }
+
+ private:
+  long futex(int op, std::uint32_t val, const ::timespec *timeout)
+  {
+    return ::syscall(SYS_futex, &_seq, op, val, timeout, nullptr, 0);
+  }
+
+  std::atomic<std::uint32_t> _seq;      /* futex word, bumped by each ring with a sleeper */
+  std::atomic<std::uint32_t> _sleepers; /* receivers in wait() */
+};
+
+}  // namespace uipc
+}  // namespace core
+
+#endif
@@ -0,0 +1,140 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "uipc_doorbell.h"
+
+/* Tests of the doorbell which lets a UIPC receiver block */
+
+using core::uipc::Doorbell;
+using clock_type = std::chrono::steady_clock;
+
+namespace
+{
+  const ::timespec one_second{1, 0};
+  const ::timespec ten_seconds{10, 0};
+
+  /*
+   * Receive as ADO_protocol_builder does: poll up to spins times, then
+   * block on the doorbell. Returns the number of timed-out waits after
+   * which the awaited state was found set, i.e. the rings missed.
+   */
+  template <typename F>
+    unsigned spin_then_block(Doorbell &bell, F ready, unsigned spins)
+  {
+    for (unsigned i = 0; i != spins; ++i) {
+      if (ready()) return 0;
+    }
+    unsigned missed = 0;
+    while (!ready()) {
+      if (!bell.wait(ready, &one_second) && ready()) ++missed;
+    }
+    return missed;
+  }
+}
+
+TEST(Doorbell, WaitReady)
+{
+  Doorbell bell;
+  const auto start = clock_type::now();
+  /* a ready state ends the wait without a ring */
+  EXPECT_TRUE(bell.wait([] { return true; }, &ten_seconds));
+  EXPECT_LT(clock_type::now() - start, std::chrono::seconds(5));
+}
+
+TEST(Doorbell, WaitTimeout)
+{
+  Doorbell bell;
+  const ::timespec timeout{0, 20000000}; /* 20ms */
+  const auto start = clock_type::now();
+  EXPECT_FALSE(bell.wait([] { return false; }, &timeout));
+  EXPECT_GE(clock_type::now() - start, std::chrono::milliseconds(15));
+}
+
+TEST(Doorbell, RingWithoutSleeper)
+{
+  /* a ring with nobody waiting is not remembered, but the state is */
+  Doorbell bell;
+  std::atomic<bool> flag{false};
+  flag.store(true);
+  bell.ring();
+  EXPECT_TRUE(bell.wait([&flag] { return flag.load(); }, &ten_seconds));
+}
+
+TEST(Doorbell, RingWakesSleeper)
+{
+  Doorbell bell;
+  std::atomic<bool> flag{false};
+  bool woken = false;
+  clock_type::duration waited{};
+
+  std::thread receiver([&] {
+      const auto start = clock_type::now();
+      woken = bell.wait([&flag] { return flag.load(); }, &ten_seconds);
+      waited = clock_type::now() - start;
+    });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  flag.store(true);
+  bell.ring();
+  receiver.join();
+
+  EXPECT_TRUE(woken);
+  EXPECT_LT(waited, std::chrono::seconds(5));
+}
+
+TEST(Doorbell, SpinThenBlockHandoff)
+{
+  /* Two threads pass a token back and forth, each spinning briefly and
+   * then blocking, so that rings race with the sleeps. A ring lost
+   * between a receiver's last check and its sleep shows as a timed-out
+   * wait with the token present.
+   */
+  const unsigned rounds = 20000;
+  Doorbell bells[2];
+  std::atomic<unsigned> token{0};
+  unsigned missed[2] = {0, 0};
+
+  auto player = [&] (unsigned me) {
+    for (unsigned r = me; r < rounds; r += 2) {
+      missed[me] += spin_then_block(bells[me], [&token, r] { return token.load() == r; }, 64);
+      token.store(r + 1);
+      bells[1 - me].ring();
+    }
+  };
+
+  std::thread t0(player, 0U);
+  std::thread t1(player, 1U);
+  t0.join();
+  t1.join();
+
+  EXPECT_EQ(rounds, token.load());
+  EXPECT_EQ(0U, missed[0]);
+  EXPECT_EQ(0U, missed[1]);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  auto r = RUN_ALL_TESTS();
+
+  return r;
+}
@@ -10,7 +10,7 @@
 //#define DEBUG /* enable log output */
 
 #include "../../mm_plugin_itf.h"
-#include "rc_alloc_lb.h"
+#include "thread_cache.h"
 #include "logging.h"
 
 
@@ -19,7 +19,8 @@ namespace global
 static unsigned debug_level = 3;
 }
 
-using Heap = Rca_LB;
+/* Rca_LB is not thread safe; the cache front end serializes access to it */
+using Heap = Thread_cached_heap;
 
 PUBLIC status_t mm_plugin_init()
 {
@@ -115,7 +116,7 @@ PUBLIC status_t mm_plugin_deallocate(mm_plugin_heap_t heap, void ** ptr, size_t
   if(ptr == nullptr || n == 0) return S_OK;
   PPLOG("%s (%p, %lu)",__func__, ptr, n);
   auto h = reinterpret_cast<Heap*>(heap);
-  h->free(*ptr, 0); // should use size   h->free(ptr, 0);
+  h->free(*ptr, 0, n);
   *ptr = nullptr;
   return S_OK;
 }
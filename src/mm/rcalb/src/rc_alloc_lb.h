@@ -30,7 +30,8 @@ class Region_map;
 
 /**
  * Reconstituting allocator.  Metadata is held in DRAM (C runtime allocator).
- * NOTE: This class is NOT thread safe.
+ * NOTE: This class is NOT thread safe. The plugin uses it through
+ * Thread_cached_heap (thread_cache.h).
  *
  */
 class Rca_LB : public common::Reconstituting_allocator {
@@ -28,41 +28,48 @@
 #include <common/exceptions.h> /* API_exception, Logic_exception */
 #include <common/utils.h>      /* check_aligned */
 #include <cstddef>             /* size_t */
-#include <forward_list>
+#include <cstdint>             /* uint64_t */
 #include <functional>
 #include <iostream> /* cout */
 #include <list>
 #include <map>
 #include <memory>
-#include <set>
 #include <sstream> /* stringstream */
+#include <vector>
 
 #include "safe_print.h"
 #include "mappers.h"
 #include "rc_alloc_avl.h"
 
 
-#define SANITY_CHECK 0
-
 /**
- * Class to manage individual regions on the heap
+ * Class to manage individual regions on the heap. Free objects are
+ * tracked by a bitmap, one bit per object, set when the object is free.
  *
  */
 class Region : private common::log_source {
   Region(const Region &) = delete;
   Region &operator=(const Region &) = delete;
 
-  using list_t = std::forward_list<void *>;
-  using set_t =
-    std::set<void *, std::less<void *>>;
+  using word_t = std::uint64_t;
+  using bitmap_t = std::vector<word_t>;
+  static constexpr std::size_t WORD_BITS = 64;
 
-  void mark_used(void *p) {
-#if SANITY_CHECK
-    _used.push_front(p);
-#else
-    (void) p;
-    ++_use_count;
-#endif
+  /* object index of p, or capacity() if p is not the start of an object */
+  std::size_t index_of(void *p) const {
+    if (!in_range(p))
+      return _capacity;
+    auto offset = std::size_t(static_cast<byte *>(p) - static_cast<byte *>(_base));
+    return offset % _object_size ? _capacity : offset / _object_size;
+  }
+
+  void *object_at(std::size_t ix) const {
+    return static_cast<byte *>(_base) + ix * _object_size;
+  }
+
+  void mark_used(std::size_t ix) {
+    _free_map[ix / WORD_BITS] &= ~(word_t(1) << (ix % WORD_BITS));
+    --_free_count;
     /* If single use, or passing the use_count threshold, reclaim when empty */
     if ( ! _reclaim_when_empty && _capacity / 2 < use_count() )
     {
@@ -70,24 +77,16 @@ class Region : private common::log_source {
     }
   }
 
-  void mark_unused(void *p) {
-    _free_list.push_front(p);
-#if SANITY_CHECK
-#else
-    --_use_count;
-#endif
-  }
-
 public:
   Region(void *region_ptr, const size_t region_size, const size_t object_size)
       : common::log_source(0U),
         _object_size(object_size), _base(region_ptr),
         _top(static_cast<char *>(_base) + region_size),
-        _free_list{},
-        _free_set{},
         _capacity(region_size / object_size),
-        _reclaim_when_empty(false),
-        _use_count(0)
+        _free_map((_capacity + WORD_BITS - 1) / WORD_BITS, ~word_t(0)),
+        _free_count(_capacity),
+        _hint(0),
+        _reclaim_when_empty(false)
   {
     //    SAFE_PRINT("new region: region_base=%p region_size=%lu objsize=%lu capacity=%lu",
     // region_ptr, region_size, object_size, _capacity);
@@ -99,13 +98,9 @@ public:
     if (object_size < 8)
       throw std::invalid_argument("Region: minimum object size is 8 bytes");
 
-    byte *rp = static_cast<byte *>(region_ptr);
-
-    /* add to free map - all slots are free initially */
-    for (size_t i = 0; i < _capacity; i++) {
-      _free_set.insert(rp);
-      rp += object_size;
-    }
+    /* all slots are free initially; bits past capacity are never free */
+    if (auto tail = _capacity % WORD_BITS)
+      _free_map.back() = (word_t(1) << tail) - 1;
   }
 
   size_t object_size() const { return _object_size; }
@@ -115,104 +110,55 @@ public:
     return _reclaim_when_empty;
   }
 
-  inline bool in_range(void *p) const { return (_base <= p && p < _top); }
+  inline bool in_range(const void *p) const { return (_base <= p && p < _top); }
 
   void *allocate() {
-    /* migrate any remaining entries on map to list */
-    if (!_free_set.empty()) {
-      for (const auto &i : _free_set) {
-        _free_list.push_front(i);
-      }
-      _free_set.clear();
-    }
-
-    if (_free_list.empty())
+    if (_free_count == 0)
       return nullptr;
-    void *p = _free_list.front();
-    _free_list.pop_front();
-    mark_used(p);
-    return p;
-  }
 
-  bool free(void *p) {
-#if SANITY_CHECK
-    auto i = _used.begin();
+    /* _hint is at or below the lowest word with a free bit */
+    while (_free_map[_hint] == 0)
+      ++_hint;
 
-    /* Note: considerable code here to allow implementation of the free list
-     * as a std::forward_list rather than a std::list.
-     */
-    if (*i == p) {
-      _used.pop_front();
-      mark_unused(p);
-      return true;
-    }
+    auto ix = _hint * WORD_BITS + std::size_t(__builtin_ctzll(_free_map[_hint]));
+    mark_used(ix);
+    return object_at(ix);
+  }
 
-    auto last = i;
-    ++i;
-    const auto e = _used.end();
-    while (i != e) {
-      if (*i == p) {
-        _used.erase_after(last);
-        mark_unused(p);
-        /* TODO: we could check for total free region */
-        return true;
-      }
-      last = i;
-      ++i;
-    }
-    return false;
-#else
-    mark_unused(p);
+  bool free(void *p) {
+    auto ix = index_of(p);
+    if (ix == _capacity)
+      return false;
+
+    auto &w = _free_map[ix / WORD_BITS];
+    const auto bit = word_t(1) << (ix % WORD_BITS);
+    if (w & bit)
+      return false; /* already free */
+
+    w |= bit;
+    ++_free_count;
+    _hint = std::min(_hint, ix / WORD_BITS);
     return true;
-#endif
   }
 
   /**
-   * Allocate at is used during the reconstitution phase. To avoid
-   * linear scans, we use a map instead of list here.  Elements
-   * are then migrated back to the list on free.
+   * Allocate at is used during the reconstitution phase.
    *
    */
   bool allocate_at(void *ptr) {
-    if (!_free_set.empty()) { /* after construction, free elements are put on
-                                 map first */
-      if (_free_set.erase(ptr) != 1)
-        throw Logic_exception("allocate_at failed to remove from map");
-      mark_used(ptr);
-      return true;
-    }
+    auto ix = index_of(ptr);
+    if (ix == _capacity)
+      throw Logic_exception("allocate_at %p not an object of the region", ptr);
 
-    /* otherwise use the list */
-    auto i = _free_list.begin();
+    if ((_free_map[ix / WORD_BITS] & (word_t(1) << (ix % WORD_BITS))) == 0)
+      throw Logic_exception("allocate_at %p already allocated", ptr);
 
-    if (*i == ptr) {
-      _free_list.pop_front();
-      mark_used(ptr);
-      return true;
-    }
-    auto last = i;
-    i++;
-
-    while (i != _free_list.end()) {
-      if (*i == ptr) {
-        _free_list.erase_after(last);
-        mark_used(ptr);
-        return true;
-      }
-      last = i;
-      i++;
-    }
+    mark_used(ix);
     return true;
   }
 
   std::size_t use_count() const {
-    return
-#if SANITY_CHECK
-        _used.size()
-#else
-        _use_count
-#endif
-            ;
+    return _capacity - _free_count;
   }
 
   void *base() const { return _base; }
@@ -228,20 +174,14 @@ public:
   void debug_dump(std::string *out_log = nullptr) {
     std::stringstream ss;
 
-#if SANITY_CHECK
-    for (auto i : _used)
-      ss << "u(" << i << ")\n";
-#endif
-    for (auto i : _free_list)
-      ss << "f(" << i << ")\n";
-    /* dump the map, using reverse order in an attempt to match
-     * the order in which elements will appear in the equivalent list.
-     * Should this fail in the future (in the sense that the LB
-     * reconstitute test fails, dump a sorted copy of the _free_list,
-     * and the free_set.
+    /* free objects in address order, which depends only on the
+     * allocation state, so that reconstituted and original regions
+     * dump identically
      */
-    for (auto it = _free_set.rbegin(); it != _free_set.rend(); ++it) {
-      ss << "f(" << *it << ")\n";
+    for (std::size_t i = 0; i != _free_map.size(); ++i) {
+      for (auto w = _free_map[i]; w != 0; w &= w - 1) {
+        ss << "f(" << object_at(i * WORD_BITS + std::size_t(__builtin_ctzll(w))) << ")\n";
+      }
     }
     ss << "\n";
     if (out_log)
@@ -254,16 +194,11 @@ private:
   const size_t _object_size;
   void *const _base;
   void *const _top;
-  list_t _free_list;
-  set_t _free_set;
-
   std::size_t _capacity;
+  bitmap_t _free_map;
+  std::size_t _free_count;
+  std::size_t _hint; /* lowest word which may have a free bit */
   bool _reclaim_when_empty;
-#if SANITY_CHECK
-  list_t _used; /* we could do without this, but it guards against misuse */
-#else
-  std::size_t _use_count;
-#endif
 };
 
 /**
@@ -273,12 +208,25 @@ class Region_map : private common::log_source {
   static constexpr unsigned NUM_BUCKETS = 64;
   static constexpr int MAX_NUMA_ZONES = 2;
 
+  using region_list_t = std::list<std::unique_ptr<Region>>;
+
+  /* where a region lives in _buckets */
+  struct region_position {
+    int numa_node;
+    unsigned bucket;
+    region_list_t::iterator it;
+  };
+
+  /* regions by base address, so that free need not search the buckets */
+  using region_index_t = std::map<const void *, region_position>;
+
 public:
   Region_map(unsigned debug_level_)
     : common::log_source(debug_level_)
     , _mapper()
     , _arena_allocator()
     , _buckets()
+    , _region_index()
   {}
 
   ~Region_map()
@@ -354,42 +302,35 @@ public:
   void free(void *p, int numa_node, size_t object_size) {
     if (UNLIKELY(numa_node < 0 || numa_node >= MAX_NUMA_ZONES))
       throw std::invalid_argument("numa node outside max range");
-    /* begin and end of buckets to search */
-    const auto start_bucket = object_size > 0 ? _mapper.bucket(object_size) : 0;
-    const auto end_bucket = object_size > 0 ? start_bucket + 1 : NUM_BUCKETS;
-
-    auto &node_buckets = _buckets[numa_node];
+    /* object size, if given, restricts the search to one bucket */
+    const auto bucket = object_size > 0 ? _mapper.bucket(object_size) : 0;
 
-    if (start_bucket >= NUM_BUCKETS)
+    if (bucket >= NUM_BUCKETS)
       throw std::out_of_range("object size beyond available buckets");
 
-    /* search starting at first eligible bucket, ending at ineligible bucket */
-    for (auto i = start_bucket; i != end_bucket; ++i) {
-      /* search regions */
-      auto &buckets = node_buckets[i];
-      auto it = std::find_if(std::begin(buckets), std::end(buckets),
-                             [&p](auto &r) { return r->in_range(p); });
-      if (it != std::end(buckets)) {
-        if (!(*it)->free(p)) {
-          throw Logic_exception("region in range, but not free");
-        }
+    auto ix = locate_region(p);
+    if (ix == _region_index.end() || ix->second.numa_node != numa_node ||
+        (object_size > 0 && ix->second.bucket != bucket)) {
+      throw API_exception("invalid pointer to free (ptr=%p,numa=%d,size=%lu)", p,
+                          numa_node, object_size);
+    }
 
-        /*
-         * bucket *it has one less allocated object.
-         * If the bucket has no allocated objects, return it to the arena
-         * from whence it came.
-         */
-        if ( (*it)->reclaim_when_empty() && ( (*it)->use_count() == 0 ) ) {
-          auto r = std::move(*it);
-          buckets.erase(it);
-          _arena_allocator.free(r->base(), numa_node, r->size());
-        }
+    auto it = ix->second.it;
+    if (!(*it)->free(p)) {
+      throw Logic_exception("region in range, but not free");
+    }
 
-        return;
-      }
+    /*
+     * bucket *it has one less allocated object.
+     * If the bucket has no allocated objects, return it to the arena
+     * from whence it came.
+     */
+    if ( (*it)->reclaim_when_empty() && ( (*it)->use_count() == 0 ) ) {
+      auto r = std::move(*it);
+      _buckets[numa_node][ix->second.bucket].erase(it);
+      _region_index.erase(ix);
+      _arena_allocator.free(r->base(), numa_node, r->size());
     }
-    throw API_exception("invalid pointer to free (ptr=%p,numa=%d,size=%lu)", p,
-                        numa_node, object_size);
   }
 
   /**
@@ -405,8 +346,6 @@ public:
     if (UNLIKELY(numa_node < 0 || numa_node >= MAX_NUMA_ZONES))
       throw std::invalid_argument("numa node outside max range");
 
-    auto &node_buckets = _buckets[numa_node];
-
     /* debugging/ */
     if (debug_level() > 2) {
       if (size <=
@@ -416,16 +355,16 @@ public:
       }
     }
 
-    auto &bucket = node_buckets[_mapper.bucket(size)];
+    const auto bucket = _mapper.bucket(size);
 
     /* check existing regions in the bucket */
-    auto rit =
-      std::find_if(
-        bucket.begin()
-        , bucket.end()
-        , [ptr] (const auto &r) { return r->in_range(ptr); }
-      );
-    if ( rit == bucket.end() )
+    Region *region = nullptr;
+    auto ix = locate_region(ptr);
+    if ( ix != _region_index.end() && ix->second.numa_node == numa_node && ix->second.bucket == bucket )
+    {
+      region = ix->second.it->get();
+    }
+    else
     {
       /* we have to create the region at the correct position  */
       auto region_size = _mapper.region_size(size);
@@ -443,14 +382,13 @@ public:
                                       ? region_size
                                       : _mapper.rounded_up_object_size(size);
 
-      bucket.push_front(
-        std::make_unique<Region>(region_base, region_size, region_object_size)
+      region = add_region(
+        numa_node
+        , bucket
+        , std::make_unique<Region>(region_base, region_size, region_object_size)
       );
-
-      rit = bucket.begin();
     }
 
-    auto region = rit->get();
     try {
       region->allocate_at(ptr);
     }
@@ -477,6 +415,22 @@ public:
   }
 
 private:
+  /* the index entry of the region containing p, or end() */
+  region_index_t::iterator locate_region(const void *p) {
+    auto ix = _region_index.upper_bound(p);
+    if (ix == _region_index.begin())
+      return _region_index.end();
+    --ix;
+    return (*ix->second.it)->in_range(p) ? ix : _region_index.end();
+  }
+
+  Region *add_region(int numa_node, unsigned bucket, std::unique_ptr<Region> &&region) {
+    auto &regions = _buckets[numa_node][bucket];
+    regions.push_front(std::move(region));
+    _region_index[regions.front()->base()] = region_position{numa_node, bucket, regions.begin()};
+    return regions.front().get();
+  }
+
   void *allocate_from_existing_region(size_t object_size, int numa_node) {
     auto bucket = _mapper.bucket(object_size);
     if (bucket >= NUM_BUCKETS)
@@ -520,27 +474,18 @@ private:
 
     assert(rp);
 
-    auto &node_buckets = _buckets[numa_node];
-    node_buckets[bucket].push_front(std::move(new_region));
+    add_region(numa_node, bucket, std::move(new_region));
 
     return rp;
   }
 
   /* Note: unused. Why no object_size and numa_zone arguments? */
   void delete_region(Region *region) {
-    for (unsigned z = 0; z < MAX_NUMA_ZONES; z++) {
-      for (unsigned i = 0; i < NUM_BUCKETS; i++) {
-        auto &buckets = _buckets[z][i];
-        auto iter =
-            std::find_if(std::begin(buckets), std::end(buckets),
-                         [region](const auto &x) { return x.get() == region; });
-        if (iter != std::end(_buckets[z][i])) {
-          _buckets[z][i].erase(iter);
-          return;
-        }
-      }
-    }
-    throw std::invalid_argument("delete_region: region not found");
+    auto ix = _region_index.find(region->base());
+    if (ix == _region_index.end() || ix->second.it->get() != region)
+      throw std::invalid_argument("delete_region: region not found");
+    _buckets[ix->second.numa_node][ix->second.bucket].erase(ix->second.it);
+    _region_index.erase(ix);
   }
 
 private:
@@ -548,11 +493,12 @@ private:
   Rca_AVL       _arena_allocator;
   std::array<
     std::array<
-      std::list<std::unique_ptr<Region>>
+      region_list_t
       , NUM_BUCKETS
     >
     , MAX_NUMA_ZONES
   > _buckets;
+  region_index_t _region_index;
 };
 
 
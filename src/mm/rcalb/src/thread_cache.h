@@ -0,0 +1,333 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __THREAD_CACHE_H__
+#define __THREAD_CACHE_H__
+
+#include <algorithm> /* min */
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <new> /* bad_alloc */
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "mappers.h" /* get_log2_bin */
+#include "rc_alloc_lb.h"
+
+/**
+ * Thread-caching front end for Rca_LB, which is not thread safe.
+ *
+ * Each thread keeps a magazine of free objects per small size class,
+ * refilled from and flushed to the shared allocator in batches, so most
+ * allocations and frees take no shared lock. Small-object regions hold
+ * power-of-two objects aligned to their size, so any object of a class
+ * satisfies any valid alignment for a request in that class.
+ *
+ * Objects in a magazine are allocated as far as Rca_LB is concerned.
+ * The magazines are flushed at the start of a reconstitution (the first
+ * inject_allocation after objects were cached) and before debug_dump, so
+ * reconstitution and state dumps see only objects held by the client.
+ * A thread's magazines are flushed when the thread exits.
+ * Frees without a size, objects outside the cached classes and NUMA
+ * nodes other than 0 go directly to the shared allocator.
+ */
+class Thread_cached_heap {
+ public:
+  static constexpr unsigned MAX_CLASS = 15; /* 32KiB; larger objects are not cached */
+  static constexpr std::size_t MIN_CACHED_SIZE = 8; /* smallest Rca_LB object */
+  static constexpr std::size_t MAX_CACHED_SIZE = std::size_t(1) << MAX_CLASS;
+  static constexpr std::size_t MAGAZINE = 64; /* free objects per class per thread */
+  static constexpr std::size_t BATCH = MAGAZINE / 2;
+
+ private:
+  using Lock_guard = std::lock_guard<std::mutex>;
+
+  /* One per thread using the heap. The owning thread takes the lock on
+     every use; other threads take it only to flush the magazines, so it
+     is seldom contended. A cache released by an exited thread is reused
+     by the next new thread. */
+  struct Cache {
+    std::mutex lock;
+    std::array<std::vector<void *>, MAX_CLASS + 1> magazine;
+    bool in_use; /* guarded by the heap _lock */
+  };
+
+  /* Heaps which exist, by id. A thread's caches outlive neither the
+     thread nor the heap: whichever ends first releases them, and the
+     registry lock keeps the two from overlapping. */
+  static std::mutex &registry_lock()
+  {
+    static std::mutex m;
+    return m;
+  }
+
+  static std::unordered_map<std::uint64_t, Thread_cached_heap *> &registry()
+  {
+    static std::unordered_map<std::uint64_t, Thread_cached_heap *> r;
+    return r;
+  }
+
+  /* the calling thread's caches, one per heap it has used */
+  struct Thread_caches {
+    std::vector<std::pair<std::uint64_t, Cache *>> caches;
+
+    Thread_caches() : caches() {}
+    Thread_caches(const Thread_caches &) = delete;
+    Thread_caches &operator=(const Thread_caches &) = delete;
+
+    ~Thread_caches()
+    {
+      Lock_guard g(registry_lock());
+      for (const auto &c : caches) {
+        auto it = registry().find(c.first);
+        if (it != registry().end()) it->second->release_cache(c.second);
+      }
+    }
+  };
+
+  static Thread_caches &thread_caches()
+  {
+    thread_local Thread_caches tc;
+    return tc;
+  }
+
+  /* the size class of an object, which is also its Rca_LB bucket */
+  static unsigned size_class(std::size_t size) { return get_log2_bin(size); }
+
+  static bool is_cached(std::size_t size, int numa_node)
+  {
+    return numa_node == 0 && MIN_CACHED_SIZE <= size && size <= MAX_CACHED_SIZE;
+  }
+
+  static std::uint64_t next_id()
+  {
+    static std::atomic<std::uint64_t> id{0};
+    return ++id;
+  }
+
+ public:
+  Thread_cached_heap(unsigned debug_level)
+    : _id(next_id()), _lock{}, _heap(debug_level), _caches{}, _cached(false)
+  {
+    Lock_guard g(registry_lock());
+    registry().emplace(_id, this);
+  }
+
+  ~Thread_cached_heap()
+  {
+    Lock_guard g(registry_lock());
+    registry().erase(_id);
+  }
+
+  Thread_cached_heap(const Thread_cached_heap &) = delete;
+  Thread_cached_heap &operator=(const Thread_cached_heap &) = delete;
+
+  void add_managed_region(void *region_base, size_t region_length, int numa_node)
+  {
+    Lock_guard g(_lock);
+    _heap.add_managed_region(region_base, region_length, numa_node);
+  }
+
+  void *alloc(size_t size, int numa_node, size_t alignment = 0)
+  {
+    if (!is_cached(size, numa_node) ||
+        (alignment != 0 && (size < alignment || size % alignment != 0))) {
+      Lock_guard g(_lock);
+      return _heap.alloc(size, numa_node, alignment);
+    }
+
+    const auto c = size_class(size);
+    auto cache = local_cache();
+    Lock_guard g(cache->lock);
+    auto &mag = cache->magazine[c];
+    if (mag.empty()) refill(cache, c);
+
+    auto p = mag.back();
+    mag.pop_back();
+    return p;
+  }
+
+  void free(void *ptr, int numa_node, size_t size = 0)
+  {
+    if (!is_cached(size, numa_node) || ptr == nullptr) {
+      Lock_guard g(_lock);
+      _heap.free(ptr, numa_node, size);
+      return;
+    }
+
+    const auto c = size_class(size);
+    auto cache = local_cache();
+    Lock_guard g(cache->lock);
+    auto &mag = cache->magazine[c];
+    mag.push_back(ptr);
+    note_cached();
+
+    /* keep the most recently freed, which are likeliest to be in cache */
+    if (MAGAZINE < mag.size()) {
+      Lock_guard gh(_lock);
+      flush(mag, c, BATCH);
+    }
+  }
+
+  void inject_allocation(void *ptr, size_t size, int numa_node)
+  {
+    /* Reconstitution is a run of injections. Flush once, at its start;
+       objects cached since then (by a client which allocates between
+       injections) cause another flush. */
+    if (_cached.exchange(false)) flush_all();
+    Lock_guard g(_lock);
+    _heap.inject_allocation(ptr, size, numa_node);
+  }
+
+  void debug_dump(std::string *out_log = nullptr)
+  {
+    _cached = false;
+    flush_all();
+    Lock_guard g(_lock);
+    _heap.debug_dump(out_log);
+  }
+
+  /* objects held in all magazines; for tests and statistics */
+  std::size_t cached_count()
+  {
+    Lock_guard g(_lock);
+    std::size_t n = 0;
+    for (auto &cache : _caches)
+      for (const auto &mag : cache.magazine) n += mag.size();
+    return n;
+  }
+
+ private:
+  void note_cached()
+  {
+    if (!_cached.load(std::memory_order_relaxed)) _cached.store(true, std::memory_order_relaxed);
+  }
+
+  Cache *local_cache()
+  {
+    auto &caches = thread_caches().caches;
+    for (const auto &c : caches)
+      if (c.first == _id) return c.second;
+
+    Cache *cache = nullptr;
+    {
+      Lock_guard g(_lock);
+      for (auto &c : _caches) {
+        if (!c.in_use) {
+          cache = &c;
+          break;
+        }
+      }
+      if (!cache) {
+        _caches.emplace_back();
+        cache = &_caches.back();
+        for (auto &mag : cache->magazine) mag.reserve(MAGAZINE + 1);
+      }
+      cache->in_use = true;
+    }
+
+    /* heap ids are never reused; drop entries for heaps which no longer exist */
+    Lock_guard g(registry_lock());
+    caches.erase(std::remove_if(caches.begin(), caches.end(),
+                                [](const std::pair<std::uint64_t, Cache *> &c) {
+                                  return registry().count(c.first) == 0;
+                                }),
+                 caches.end());
+    caches.emplace_back(_id, cache);
+    return cache;
+  }
+
+  /* Called at thread exit, with the registry lock held */
+  void release_cache(Cache *cache)
+  {
+    Lock_guard gc(cache->lock);
+    Lock_guard g(_lock);
+    for (unsigned c = 0; c != cache->magazine.size(); ++c)
+      flush(cache->magazine[c], c, cache->magazine[c].size());
+    cache->in_use = false;
+  }
+
+  /* return the n oldest objects of a magazine. Caller holds _lock */
+  void flush(std::vector<void *> &mag, unsigned c, std::size_t n)
+  {
+    n = std::min(n, mag.size());
+    for (std::size_t i = 0; i != n; ++i)
+      _heap.free(mag[i], 0, std::size_t(1) << c);
+    mag.erase(mag.begin(), mag.begin() + std::ptrdiff_t(n));
+  }
+
+  /* Caller holds cache->lock */
+  void refill(Cache *cache, unsigned c)
+  {
+    auto &mag = cache->magazine[c];
+    for (auto attempt = 0; attempt != 2; ++attempt) {
+      {
+        Lock_guard g(_lock);
+        try {
+          while (mag.size() != BATCH)
+            mag.push_back(_heap.alloc(std::size_t(1) << c, 0));
+        }
+        catch (const std::bad_alloc &) {
+        }
+      }
+      if (!mag.empty()) {
+        note_cached();
+        return;
+      }
+
+      /* out of memory: reclaim what other threads are holding */
+      flush_all(cache);
+    }
+    throw std::bad_alloc();
+  }
+
+  /* Return every magazine to the shared allocator. A busy cache other
+     than the caller's own is skipped, to avoid lock order inversion
+     when called with a cache lock held. */
+  void flush_all(Cache *own = nullptr)
+  {
+    std::vector<Cache *> caches;
+    {
+      Lock_guard g(_lock);
+      for (auto &cache : _caches) caches.push_back(&cache);
+    }
+
+    for (auto cache : caches) {
+      std::unique_lock<std::mutex> gc(cache->lock, std::defer_lock);
+      if (cache != own) {
+        if (own) {
+          if (!gc.try_lock()) continue;
+        }
+        else
+          gc.lock();
+      }
+      Lock_guard g(_lock);
+      for (unsigned c = 0; c != cache->magazine.size(); ++c)
+        flush(cache->magazine[c], c, cache->magazine[c].size());
+    }
+  }
+
+  const std::uint64_t _id;
+  std::mutex          _lock; /* guards _heap and _caches */
+  Rca_LB              _heap;
+  std::list<Cache>    _caches;
+  std::atomic<bool>   _cached; /* a magazine may hold objects */
+};
+
+#endif
@@ -0,0 +1,413 @@
+/*
+  Copyright [2021] [IBM Corporation]
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+  http://www.apache.org/licenses/LICENSE-2.0
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <sys/mman.h>
+#include <common/utils.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "region.h"
+#include "thread_cache.h"
+
+/* Tests of the region allocator, and of the thread-caching front end of the rcalb plugin */
+
+TEST(Region_test, AllocateInAddressOrder)
+{
+  /* 200 objects: four bitmap words, the last partly used */
+  const size_t object_size = 64;
+  const size_t count = 200;
+  std::vector<char> mem(object_size * count);
+  Region r(mem.data(), mem.size(), object_size);
+  ASSERT_EQ(count, r.capacity());
+
+  std::vector<void *> v;
+  for (size_t i = 0; i != count; ++i) {
+    v.push_back(r.allocate());
+    ASSERT_EQ(&mem[i * object_size], v.back());
+  }
+  /* bits past capacity are never handed out */
+  EXPECT_EQ(nullptr, r.allocate());
+  EXPECT_EQ(count, r.use_count());
+
+  /* a free lowers the hint: the lowest free object is always next */
+  EXPECT_TRUE(r.free(v[130]));
+  EXPECT_TRUE(r.free(v[5]));
+  EXPECT_EQ(v[5], r.allocate());
+  EXPECT_EQ(v[130], r.allocate());
+  EXPECT_EQ(nullptr, r.allocate());
+
+  EXPECT_TRUE(r.free(v[count - 1]));
+  EXPECT_EQ(v[count - 1], r.allocate());
+  EXPECT_EQ(nullptr, r.allocate());
+}
+
+TEST(Region_test, ReclaimThreshold)
+{
+  const size_t object_size = 128;
+  std::vector<char> mem(object_size * 100);
+  Region r(mem.data(), mem.size(), object_size);
+
+  for (size_t i = 0; i != r.capacity() / 2; ++i) ASSERT_NE(nullptr, r.allocate());
+  EXPECT_FALSE(r.reclaim_when_empty());
+  auto p = r.allocate();
+  EXPECT_TRUE(r.reclaim_when_empty());
+
+  /* the decision sticks as the region empties */
+  EXPECT_TRUE(r.free(p));
+  EXPECT_TRUE(r.reclaim_when_empty());
+}
+
+TEST(Region_test, BadFree)
+{
+  const size_t object_size = 64;
+  std::vector<char> mem(object_size * 64);
+  Region r(mem.data(), mem.size(), object_size);
+  auto base = static_cast<char *>(r.base());
+
+  auto p = r.allocate();
+  auto q = static_cast<char *>(r.allocate());
+  EXPECT_TRUE(r.free(p));
+  /* double free */
+  EXPECT_FALSE(r.free(p));
+  /* misaligned, and out of range */
+  EXPECT_FALSE(r.free(q + 8));
+  EXPECT_FALSE(r.free(base + r.size()));
+  EXPECT_FALSE(r.free(base - object_size));
+  EXPECT_EQ(1U, r.use_count());
+
+  /* reconstitution of an allocated or misaligned object is an error */
+  EXPECT_THROW(r.allocate_at(q), Logic_exception);
+  EXPECT_THROW(r.allocate_at(q + 8), Logic_exception);
+  EXPECT_EQ(1U, r.use_count());
+
+  /* but of a free one is not, and the object is no longer handed out */
+  EXPECT_TRUE(r.allocate_at(p));
+  EXPECT_EQ(base + 2 * object_size, r.allocate());
+  EXPECT_EQ(3U, r.use_count());
+}
+
+class Region_map_test : public ::testing::Test {
+protected:
+  static constexpr size_t arena_size = MiB(32);
+  static constexpr size_t region_size = MiB(1);
+
+  virtual void SetUp() {
+    /* regions are region_size-aligned within the arena; align the arena too */
+    _slab = mmap(nullptr, arena_size + region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(MAP_FAILED, _slab);
+    _arena = static_cast<char *>(round_up(_slab, region_size));
+  }
+
+  virtual void TearDown() {
+    ASSERT_EQ(0, munmap(_slab, arena_size + region_size));
+  }
+
+  void *_slab = nullptr;
+  char *_arena = nullptr;
+};
+
+constexpr size_t Region_map_test::arena_size;
+constexpr size_t Region_map_test::region_size;
+
+TEST_F(Region_map_test, LocateRegion)
+{
+  /* several regions per bucket, and several buckets, so that a free must
+   * find its region among many by address
+   */
+  Region_map m(0);
+  m.add_arena(_arena, arena_size, 0);
+
+  std::vector<std::pair<void *, size_t>> v;
+  for (size_t i = 0; i != 1000; ++i) {
+    for (auto size : {size_t(64), size_t(4096)}) {
+      v.emplace_back(m.allocate(size, 0, 0), size);
+    }
+    if (i % 250 == 0) {
+      v.emplace_back(m.allocate(KiB(512), 0, 0), KiB(512));
+    }
+  }
+
+  /* a pointer in no region, or given with the wrong numa node or size, is rejected */
+  auto outside = _arena + arena_size;
+  EXPECT_THROW(m.free(outside, 0, 64), API_exception);
+  EXPECT_THROW(m.free(v[0].first, 1, v[0].second), API_exception);
+  EXPECT_THROW(m.free(v[0].first, 0, 4096), API_exception);
+
+  std::shuffle(v.begin(), v.end(), std::mt19937(1));
+  size_t n = 0;
+  for (auto &e : v) {
+    /* every other free omits the size, and so searches all buckets */
+    EXPECT_NO_THROW(m.free(e.first, 0, ++n % 2 ? e.second : 0)) << e.first << " " << e.second;
+  }
+}
+
+TEST_F(Region_map_test, BadFree)
+{
+  Region_map m(0);
+  m.add_arena(_arena, arena_size, 0);
+
+  auto p = m.allocate(64, 0, 0);
+  auto q = static_cast<char *>(m.allocate(64, 0, 0));
+  m.free(p, 0, 64);
+  EXPECT_THROW(m.free(p, 0, 64), Logic_exception);
+  EXPECT_THROW(m.free(q + 8, 0, 64), Logic_exception);
+  m.free(q, 0, 64);
+}
+
+TEST_F(Region_map_test, ReclaimEmptyRegions)
+{
+  /* an arena of a single region: a second region can be made only if the first is reclaimed */
+  Region_map m(0);
+  m.add_arena(_arena, region_size, 0);
+
+  const size_t object_size = 64;
+  std::vector<void *> v;
+  for (size_t i = 0; i != region_size / object_size / 2 + 1; ++i) {
+    v.push_back(m.allocate(object_size, 0, 0));
+  }
+  EXPECT_EQ(_arena, v.front());
+  for (auto p : v) m.free(p, 0, object_size);
+
+  std::string dump;
+  m.debug_dump(&dump);
+  EXPECT_EQ("", dump);
+
+  /* the region went back to the arena, and is reused for another size */
+  auto p = m.allocate(object_size * 2, 0, 0);
+  EXPECT_EQ(_arena, p);
+  m.free(p, 0, object_size * 2);
+}
+
+TEST_F(Region_map_test, Reconstitute)
+{
+  /* the live allocations of one map, injected into a fresh map over the
+   * same arena, reproduce its state
+   */
+  Region_map m(0);
+  m.add_arena(_arena, arena_size, 0);
+
+  std::vector<std::pair<void *, size_t>> v;
+  for (size_t i = 0; i != 300; ++i) {
+    v.emplace_back(m.allocate(64, 0, 0), 64);
+    if (i % 3 == 0) v.emplace_back(m.allocate(1000, 0, 0), 1000);
+    if (i % 100 == 0) v.emplace_back(m.allocate(KiB(300), 0, 0), KiB(300));
+  }
+
+  std::vector<std::pair<void *, size_t>> live;
+  for (size_t i = 0; i != v.size(); ++i) {
+    if (i % 4 == 1)
+      m.free(v[i].first, 0, v[i].second);
+    else
+      live.push_back(v[i]);
+  }
+
+  std::string dump;
+  m.debug_dump(&dump);
+
+  Region_map r(0);
+  r.add_arena(_arena, arena_size, 0);
+  for (auto &e : live) r.inject_allocation(e.first, e.second, 0);
+
+  std::string reconstituted_dump;
+  r.debug_dump(&reconstituted_dump);
+  EXPECT_EQ(dump, reconstituted_dump);
+
+  /* both maps hand out the same objects next */
+  for (auto size : {size_t(64), size_t(1000)}) {
+    EXPECT_EQ(m.allocate(size, 0, 0), r.allocate(size, 0, 0)) << size;
+  }
+
+  /* a second injection of a live object is an error */
+  EXPECT_THROW(r.inject_allocation(live.front().first, live.front().second, 0), Logic_exception);
+}
+
+class Thread_cache_test : public ::testing::Test {
+protected:
+  static constexpr size_t slab_size = MiB(32);
+
+  virtual void SetUp() {
+    _slab = mmap(nullptr, slab_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(MAP_FAILED, _slab);
+    _heap.reset(new Thread_cached_heap(0));
+    _heap->add_managed_region(_slab, slab_size, 0);
+  }
+
+  virtual void TearDown() {
+    _heap.reset();
+    ASSERT_EQ(0, munmap(_slab, slab_size));
+  }
+
+  void *                              _slab = nullptr;
+  std::unique_ptr<Thread_cached_heap> _heap;
+};
+
+constexpr size_t Thread_cache_test::slab_size;
+
+TEST_F(Thread_cache_test, MagazineRefill)
+{
+  /* the first allocation of a class fills the magazine with a batch */
+  auto p = _heap->alloc(64, 0);
+  ASSERT_NE(nullptr, p);
+  EXPECT_EQ(Thread_cached_heap::BATCH - 1, _heap->cached_count());
+
+  /* a free goes back to the magazine, not to the shared allocator */
+  _heap->free(p, 0, 64);
+  EXPECT_EQ(Thread_cached_heap::BATCH, _heap->cached_count());
+
+  /* and is the next object handed out */
+  EXPECT_EQ(p, _heap->alloc(64, 0));
+  _heap->free(p, 0, 64);
+}
+
+TEST_F(Thread_cache_test, MagazineFlush)
+{
+  const size_t n = Thread_cached_heap::MAGAZINE * 4;
+  std::vector<void *> v;
+  for (size_t i = 0; i != n; ++i) {
+    v.push_back(_heap->alloc(128, 0));
+    ASSERT_NE(nullptr, v.back());
+  }
+  EXPECT_GE(Thread_cached_heap::BATCH, _heap->cached_count());
+
+  /* a magazine which overflows returns a batch to the shared allocator */
+  for (auto p : v) {
+    _heap->free(p, 0, 128);
+    EXPECT_GE(Thread_cached_heap::MAGAZINE, _heap->cached_count());
+  }
+}
+
+TEST_F(Thread_cache_test, ThreadExitFlush)
+{
+  std::thread t([this] {
+    std::vector<std::pair<void *, size_t>> v;
+    for (size_t i = 0; i != 1000; ++i) {
+      const size_t size = size_t(8) << (i % 10);
+      v.emplace_back(_heap->alloc(size, 0), size);
+    }
+    for (auto &e : v) _heap->free(e.first, 0, e.second);
+    EXPECT_NE(0U, _heap->cached_count());
+  });
+  t.join();
+
+  /* the thread's magazines went back to the shared allocator when it exited */
+  EXPECT_EQ(0U, _heap->cached_count());
+}
+
+TEST_F(Thread_cache_test, CrossThreadFree)
+{
+  /* Producers allocate and fill objects; consumers check and free them, so
+   * that objects migrate between magazines. No object may be handed out
+   * twice while live.
+   */
+  const unsigned producers = 4;
+  const unsigned consumers = 4;
+  const unsigned per_producer = 20000;
+  std::mutex lock;
+  std::deque<std::pair<unsigned char *, size_t>> queue;
+  std::set<void *> live;
+  unsigned done = 0;
+  unsigned errors = 0;
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t != producers; ++t) {
+    threads.emplace_back([&, t] {
+      for (unsigned i = 0; i != per_producer; ++i) {
+        const size_t size = size_t(16) << (i % 8);
+        auto p = static_cast<unsigned char *>(_heap->alloc(size, 0));
+        std::memset(p, int(t + 1), size);
+        std::lock_guard<std::mutex> g(lock);
+        if (!live.insert(p).second) ++errors;
+        queue.emplace_back(p, size);
+      }
+      std::lock_guard<std::mutex> g(lock);
+      ++done;
+    });
+  }
+  for (unsigned t = 0; t != consumers; ++t) {
+    threads.emplace_back([&] {
+      for (;;) {
+        std::pair<unsigned char *, size_t> e{nullptr, 0};
+        {
+          std::lock_guard<std::mutex> g(lock);
+          if (queue.empty()) {
+            if (done == producers) return;
+          }
+          else {
+            e = queue.front();
+            queue.pop_front();
+            live.erase(e.first);
+          }
+        }
+        if (e.first == nullptr) {
+          std::this_thread::yield();
+          continue;
+        }
+        for (size_t i = 1; i != e.second; ++i) {
+          if (e.first[i] != e.first[0]) {
+            std::lock_guard<std::mutex> g(lock);
+            ++errors;
+            break;
+          }
+        }
+        _heap->free(e.first, 0, e.second);
+      }
+    });
+  }
+  for (auto &t : threads) t.join();
+
+  EXPECT_EQ(0U, errors);
+  EXPECT_TRUE(live.empty());
+  EXPECT_EQ(0U, _heap->cached_count());
+}
+
+TEST_F(Thread_cache_test, InjectFlushes)
+{
+  /* an object freed into a magazine and then injected, as at reconstitution,
+   * must not be handed out again
+   */
+  auto p = _heap->alloc(256, 0);
+  _heap->free(p, 0, 256);
+  ASSERT_NE(0U, _heap->cached_count());
+
+  _heap->inject_allocation(p, 256, 0);
+  EXPECT_EQ(0U, _heap->cached_count());
+
+  std::vector<void *> v;
+  for (size_t i = 0; i != Thread_cached_heap::MAGAZINE * 4; ++i) {
+    v.push_back(_heap->alloc(256, 0));
+    EXPECT_NE(p, v.back());
+  }
+  for (auto q : v) _heap->free(q, 0, 256);
+  _heap->free(p, 0, 256);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  auto r = RUN_ALL_TESTS();
+
+  return r;
+}
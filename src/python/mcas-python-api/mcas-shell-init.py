@@ -11,3 +11,12 @@ def get_keys(pool, expr):
         (k, offset) = pool.find_key(expr, offset)
     return result
 
+
+def get_keys_batched(pool, expr, count=1024):
+    result = []
+    offset=0
+    (matches,offset)=pool.find_keys(expr, offset, count)
+    while matches != None:
+        result.extend([k for (k,_) in matches])
+        (matches,offset)=pool.find_keys(expr, offset, count)
+    return result
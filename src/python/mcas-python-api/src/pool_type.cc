@@ -32,6 +32,7 @@ static PyObject * pool_get_size(Pool* self, PyObject *args, PyObject *kwds);
 static PyObject * pool_erase(Pool* self, PyObject *args, PyObject *kwds);
 static PyObject * pool_configure(Pool* self, PyObject *args, PyObject *kwds);
 static PyObject * pool_find_key(Pool* self, PyObject *args, PyObject *kwds);
+static PyObject * pool_find_keys(Pool* self, PyObject *args, PyObject *kwds);
 static PyObject * pool_get_attribute(Pool* self, PyObject* args, PyObject* kwds);
 static PyObject * pool_type(Pool* self);
 static PyObject * pool_free_direct_memory(Pool *self, PyObject* args, PyObject* kwds);
@@ -90,6 +91,7 @@ PyDoc_STRVAR(count_doc,"Pool.count() -> Get number of objects in the pool.");
 PyDoc_STRVAR(erase_doc,"Pool.erase(key) -> Erase object from the pool.");
 PyDoc_STRVAR(configure_doc,"Pool.configure(jsoncmd) -> Configure pool.");
 PyDoc_STRVAR(find_key_doc,"Pool.find(expr, [limit]) -> Find keys using expression.");
+PyDoc_STRVAR(find_keys_doc,"Pool.find_keys(expr, [offset], [count]) -> Find batch of keys using expression. Returns ([(key,offset)...], next_offset).");
 PyDoc_STRVAR(get_attribute_doc,"Pool.get_attribute(key, attribute_name) -> Attribute value(s).");
 PyDoc_STRVAR(free_direct_memory_doc,"Pool.free_direct_memory(val_from_get_direct) -> Release memory allocated by get_direct call.");
 
@@ -107,6 +109,7 @@ static PyMethodDef Pool_methods[] = {
                                      {"erase",(PyCFunction) pool_erase, METH_VARARGS | METH_KEYWORDS, erase_doc},
                                      {"configure",(PyCFunction) pool_configure, METH_VARARGS | METH_KEYWORDS, configure_doc},
                                      {"find_key",(PyCFunction) pool_find_key, METH_VARARGS | METH_KEYWORDS, find_key_doc},
+                                     {"find_keys",(PyCFunction) pool_find_keys, METH_VARARGS | METH_KEYWORDS, find_keys_doc},
                                      {"get_attribute",(PyCFunction) pool_get_attribute, METH_VARARGS | METH_KEYWORDS, get_attribute_doc},
                                      {"free_direct_memory", (PyCFunction) pool_free_direct_memory, METH_VARARGS | METH_KEYWORDS, free_direct_memory_doc},
                                      {NULL}
@@ -771,6 +774,73 @@ static PyObject * pool_find_key(Pool* self, PyObject *args, PyObject *kwds)
   return NULL;
 }
 
+static PyObject * pool_find_keys(Pool* self, PyObject *args, PyObject *kwds)
+{
+  static const char *kwlist[] = {"expr",
+                                 "offset",
+                                 "count",
+                                 NULL};
+
+  const char * expr_param = nullptr;
+  unsigned long offset_param = 0;
+  unsigned long count_param = 1024;
+
+  if (! PyArg_ParseTupleAndKeywords(args,
+                                    kwds,
+                                    "s|kk",
+                                    const_cast<char**>(kwlist),
+                                    &expr_param,
+                                    &offset_param,
+                                    &count_param)) {
+    PyErr_SetString(PyExc_RuntimeError,"bad arguments");
+    return NULL;
+  }
+
+  assert(self->_pool);
+
+  const std::string expr(expr_param);
+
+  std::vector<std::pair<offset_t, std::string>> matches;
+  offset_t next_offset = 0;
+  auto hr = self->_mcas->find_keys(self->_pool,
+                                   expr,
+                                   offset_param,
+                                   count_param,
+                                   next_offset,
+                                   matches);
+
+  if(hr == S_OK) {
+    auto list = PyList_New(matches.size());
+    Py_ssize_t i = 0;
+    for(const auto& m : matches) {
+      auto item = PyTuple_New(2);
+      PyTuple_SetItem(item, 0, PyUnicode_FromStringAndSize(m.second.data(), m.second.size()));
+      PyTuple_SetItem(item, 1, PyLong_FromUnsignedLong(m.first));
+      PyList_SetItem(list, i++, item);
+    }
+    auto tuple = PyTuple_New(2);
+    PyTuple_SetItem(tuple, 0, list);
+    PyTuple_SetItem(tuple, 1, PyLong_FromUnsignedLong(next_offset));
+    return tuple;
+  }
+  else if(hr == E_FAIL) {
+    auto tuple = PyTuple_New(2);
+    Py_INCREF(Py_None);
+    PyTuple_SetItem(tuple, 0, Py_None);
+    Py_INCREF(Py_None);
+    PyTuple_SetItem(tuple, 1, Py_None);
+    return tuple;
+  }
+  else {
+    std::stringstream ss;
+    ss << "pool.find_keys [status:" << hr << "]";
+    PyErr_SetString(PyExc_RuntimeError,ss.str().c_str());
+    return NULL;
+  }
+
+  return NULL;
+}
+
 
 static PyObject * pool_get_attribute(Pool* self, PyObject *args, PyObject *kwds)
 {
@@ -16,6 +16,7 @@
 #include "ado_ipc_proto.h"
 #include "ado_proto_buffer.h"
 #include "resource_unavailable.h"
+#include "work_threads.h"
 
 #include <common/logging.h>
 #include <common/exceptions.h>
@@ -34,6 +35,7 @@
 #include <mutex>
 #include <queue>
 #include <map>
+#include <memory>
 #include <sched.h>
 #include <cstdio>
 #include <cstdlib>
@@ -189,6 +191,121 @@ private:
 
 
 
+/**
+ * Table operation batches posted to the shard and not yet completed.
+ * The shard answers callbacks in the order they are sent, so any
+ * synchronous callback must first complete the posted batches, as must
+ * the end of an ADO invocation (the shard releases the invocation's
+ * deferred locks when it sees the work response).
+ *
+ * The pipeline also serializes use of the callback channel by worker
+ * threads. With workers, a posted batch is completed before post()
+ * returns, so that a completion never runs on another worker's thread.
+ */
+class Table_op_pipeline
+{
+public:
+  /* message buffers are shared with all other callbacks */
+  static constexpr size_t MAX_POSTED = ADO_protocol_builder::QUEUE_SIZE / 4;
+
+  using lock_t = std::unique_lock<std::recursive_mutex>;
+
+  Table_op_pipeline(ADO_protocol_builder& ipc, bool complete_on_post)
+    : _ipc(ipc), _complete_on_post(complete_on_post), _lock(), _posted() {}
+
+  void post(const IADO_plugin::table_op_vector_t& ops, IADO_plugin::table_op_completion_t completion)
+  {
+    auto batch = std::make_shared<Batch>(std::move(completion));
+
+    if(ops.empty()) {
+      batch->completion(batch->results);
+      return;
+    }
+
+    batch->results.reserve(ops.size());
+
+    lock_t g(_lock);
+
+    /* large batches go as several messages */
+    size_t sent = 0;
+    while(sent != ops.size()) {
+      auto count = ADO_protocol_builder::table_op_batch_fit(&ops[sent], ops.size() - sent);
+      if(count == 0)
+        throw std::length_error("table operation too large for a batch message");
+
+      if(_posted.size() == MAX_POSTED)
+        complete_one();
+
+      if(_ipc.send_table_op_batch(&ops[sent], count) != S_OK)
+        throw General_exception("send_table_op_batch failed");
+
+      sent += count;
+      _posted.push(Posted{batch, count, sent == ops.size()});
+    }
+
+    if(_complete_on_post)
+      complete_all();
+  }
+
+  void drain()
+  {
+    lock_t g(_lock);
+    complete_all();
+  }
+
+  /* take the callback channel for a synchronous callback */
+  lock_t claim()
+  {
+    lock_t g(_lock);
+    complete_all();
+    return g;
+  }
+
+private:
+  struct Batch {
+    explicit Batch(IADO_plugin::table_op_completion_t completion_)
+      : completion(std::move(completion_)), results() {}
+    IADO_plugin::table_op_completion_t       completion;
+    IADO_plugin::table_op_result_vector_t    results;
+  };
+
+  struct Posted {
+    std::shared_ptr<Batch> batch;
+    size_t                 count; /* operations in this message */
+    bool                   last;  /* last message of the batch */
+  };
+
+  void complete_all()
+  {
+    while(!_posted.empty())
+      complete_one();
+  }
+
+  void complete_one()
+  {
+    auto posted = _posted.front();
+    _posted.pop();
+    auto& results = posted.batch->results;
+    const auto expected = results.size() + posted.count;
+    _ipc.recv_table_op_batch_response(results);
+
+    /* one result per operation, whatever the shard sent */
+    if(results.size() != expected) {
+      PWRN("ADO: table op batch response has %lu results, expected %lu",
+           results.size() + posted.count - expected, posted.count);
+      results.resize(expected, IADO_plugin::table_op_result_t{E_INVAL, nullptr, 0, nullptr, nullptr});
+    }
+    if(posted.last)
+      posted.batch->completion(posted.batch->results);
+  }
+
+  ADO_protocol_builder& _ipc;
+  const bool            _complete_on_post;
+  std::recursive_mutex  _lock; /* recursive: a completion may make callbacks */
+  std::queue<Posted>    _posted;
+};
+
+
 /**
  * Main entry point
  *
@@ -204,6 +321,8 @@ int main(int argc, char* argv[])
     {
       std::string plugins, channel_id, base;
       unsigned debug_level;
+      unsigned spin_usec;
+      unsigned threads;
       std::string cpu_mask;
       std::vector<std::string> ado_params;
       bool use_log = false;      
@@ -217,6 +336,10 @@ int main(int argc, char* argv[])
           ("channel_id", po::value<std::string>(&channel_id)->required(), "Channel (prefix) identifier")
           ("debug", po::value<unsigned>(&debug_level)->default_value(0), "Debug level")
           ("cpumask", po::value<std::string>(&cpu_mask), "Cores to restrict threads to (string form)")
+          ("spin_us", po::value<unsigned>(&spin_usec)->default_value(ADO_protocol_builder::DEFAULT_SPIN_USEC),
+           "Time, in microseconds, to poll for a request before blocking")
+          ("threads", po::value<unsigned>(&threads)->default_value(1),
+           "Worker threads for invocations (plugins must then be thread safe)")
           ("param", po::value<std::vector<std::string>>(&ado_params), "Plugin parameters")
           ("base", po::value<std::string>(&base), "Virtual base address for memory mapping into ADO space")
           ("log", "Redirect output to ado.log")          
@@ -262,12 +385,15 @@ int main(int argc, char* argv[])
       PMAJOR("ADO: launched");
 
       ADO_protocol_builder ipc(debug_level, channel_id, ADO_protocol_builder::Role::ACCEPT);
+      ipc.set_spin_usec(spin_usec);
       PMAJOR("ADO: listening");
 
+      Table_op_pipeline table_op_pipeline(ipc, threads > 1);
+
       /* Callback functions */
 
       auto ipc_create_key =
-        [&ipc] (const uint64_t work_request_id,
+        [&ipc, &table_op_pipeline] (const uint64_t work_request_id,
                 const std::string& key_name,
                 const size_t value_size,
                 const uint64_t flags,
@@ -275,6 +401,7 @@ int main(int argc, char* argv[])
                 const char ** out_key_ptr,
                 component::IKVStore::key_t * out_key_handle) -> status_t
         {
+          auto g = table_op_pipeline.claim();
           status_t rc = S_OK;
           ipc.send_table_op_create(work_request_id, key_name, value_size, flags);
           ipc.recv_table_op_response(rc, out_value_addr, nullptr /* value len */, out_key_ptr, out_key_handle);
@@ -282,7 +409,7 @@ int main(int argc, char* argv[])
         };
 
       auto ipc_open_key =
-        [&ipc] (const uint64_t work_request_id,
+        [&ipc, &table_op_pipeline] (const uint64_t work_request_id,
                 const std::string& key_name,
                 const uint64_t flags,
                 void*& out_value_addr,
@@ -290,6 +417,7 @@ int main(int argc, char* argv[])
                 const char** out_key_ptr,
                 component::IKVStore::key_t * out_key_handle) -> status_t
         {
+          auto g = table_op_pipeline.claim();
           status_t rc = S_OK;
           ipc.send_table_op_open(work_request_id, key_name, out_value_len, flags);
           ipc.recv_table_op_response(rc, out_value_addr, &out_value_len, out_key_ptr, out_key_handle);
@@ -297,8 +425,9 @@ int main(int argc, char* argv[])
         };
 
       auto ipc_erase_key =
-        [&ipc] (const std::string& key_name) -> status_t
+        [&ipc, &table_op_pipeline] (const std::string& key_name) -> status_t
         {
+          auto g = table_op_pipeline.claim();
           status_t rc = S_OK;
           void* na;
           ipc.send_table_op_erase(key_name);
@@ -307,11 +436,12 @@ int main(int argc, char* argv[])
         };
 
       auto ipc_resize_value =
-        [&ipc] (const uint64_t work_request_id,
+        [&ipc, &table_op_pipeline] (const uint64_t work_request_id,
                 const std::string& key_name,
                 const size_t new_value_size,
                 void*& out_new_value_addr) -> status_t
         {
+          auto g = table_op_pipeline.claim();
           status_t rc = S_OK;
           ipc.send_table_op_resize(work_request_id, key_name, new_value_size);
           ipc.recv_table_op_response(rc, out_new_value_addr);
@@ -320,10 +450,11 @@ int main(int argc, char* argv[])
 
 
       auto ipc_allocate_pool_memory =
-        [&ipc] (const size_t size,
+        [&ipc, &table_op_pipeline] (const size_t size,
                 const size_t alignment,
                 void *&out_new_addr) -> status_t
         {
+          auto g = table_op_pipeline.claim();
           status_t rc = S_OK;
           ipc.send_table_op_allocate_pool_memory(size, alignment);
           ipc.recv_table_op_response(rc, out_new_addr);
@@ -331,9 +462,10 @@ int main(int argc, char* argv[])
         };
 
       auto ipc_free_pool_memory =
-        [&ipc] (const size_t size,
+        [&ipc, &table_op_pipeline] (const size_t size,
                 const void * addr) -> status_t
         {
+          auto g = table_op_pipeline.claim();
           status_t rc = S_OK;
           void * na;
           ipc.send_table_op_free_pool_memory(addr, size);
@@ -342,12 +474,13 @@ int main(int argc, char* argv[])
         };
 
       auto ipc_find_key =
-        [&ipc] (const std::string& key_expression,
+        [&ipc, &table_op_pipeline] (const std::string& key_expression,
                 const offset_t begin_position,
                 const component::IKVIndex::find_t find_type,
                 offset_t& out_matched_position,
                 std::string& out_matched_key) -> status_t
         {
+          auto g = table_op_pipeline.claim();
           status_t rc = S_OK;
           ipc.send_find_index_request(key_expression,
                                       begin_position,
@@ -361,10 +494,11 @@ int main(int argc, char* argv[])
         };
 
       auto ipc_get_reference_vector =
-        [&ipc] (const common::epoch_time_t t_begin,
+        [&ipc, &table_op_pipeline] (const common::epoch_time_t t_begin,
                 const common::epoch_time_t t_end,
                 IADO_plugin::Reference_vector& out_vector) -> status_t
         {
+          auto g = table_op_pipeline.claim();
           status_t rc = S_OK;
           ipc.send_vector_request(t_begin, t_end);
           ipc.recv_vector_response(rc, out_vector);
@@ -372,8 +506,9 @@ int main(int argc, char* argv[])
         };
 
       auto ipc_get_pool_info =
-        [&ipc] (std::string& out_response) -> status_t
+        [&ipc, &table_op_pipeline] (std::string& out_response) -> status_t
         {
+          auto g = table_op_pipeline.claim();
           status_t rc = S_OK;
           ipc.send_pool_info_request();
           ipc.recv_pool_info_response(rc, out_response);
@@ -381,11 +516,12 @@ int main(int argc, char* argv[])
         };
 
       auto ipc_iterate =
-        [&ipc] (const common::epoch_time_t t_begin,
+        [&ipc, &table_op_pipeline] (const common::epoch_time_t t_begin,
                 const common::epoch_time_t t_end,
                 component::IKVStore::pool_iterator_t& iterator,
                 component::IKVStore::pool_reference_t& reference) -> status_t
         {
+          auto g = table_op_pipeline.claim();
           status_t rc = S_OK;
           ipc.send_iterate_request(t_begin, t_end, iterator);
           ipc.recv_iterate_response(rc, iterator, reference);
@@ -393,9 +529,10 @@ int main(int argc, char* argv[])
         };
 
       auto ipc_unlock =
-        [&ipc] (const uint64_t work_id,
+        [&ipc, &table_op_pipeline] (const uint64_t work_id,
                 component::IKVStore::key_t key_handle) -> status_t
         {
+          auto g = table_op_pipeline.claim();
           status_t rc = S_OK;
           if(work_id == 0 || key_handle == nullptr) return E_INVAL;
           ipc.send_unlock_request(work_id, key_handle);
@@ -404,8 +541,9 @@ int main(int argc, char* argv[])
           return rc;
         };
 
-      auto ipc_configure = [&ipc](const uint64_t options) -> status_t
+      auto ipc_configure = [&ipc, &table_op_pipeline](const uint64_t options) -> status_t
                            {
+                             auto g = table_op_pipeline.claim();
                              status_t rc = S_OK;
                              ipc.send_configure_request(options);
                              if(!ipc.recv_configure_response(rc))
@@ -413,6 +551,34 @@ int main(int argc, char* argv[])
                              return rc;
                            };
 
+      auto ipc_table_ops =
+        [&table_op_pipeline] (const IADO_plugin::table_op_vector_t& ops,
+                              IADO_plugin::table_op_result_vector_t& out_results) -> status_t
+        {
+          table_op_pipeline.post(ops,
+                                 [&out_results] (const IADO_plugin::table_op_result_vector_t& results)
+                                 {
+                                   out_results = results;
+                                 });
+          table_op_pipeline.drain();
+          return S_OK;
+        };
+
+      auto ipc_table_ops_async =
+        [&table_op_pipeline] (const IADO_plugin::table_op_vector_t& ops,
+                              IADO_plugin::table_op_completion_t completion) -> status_t
+        {
+          table_op_pipeline.post(ops, std::move(completion));
+          return S_OK;
+        };
+
+      auto ipc_table_ops_wait =
+        [&table_op_pipeline] () -> status_t
+        {
+          table_op_pipeline.drain();
+          return S_OK;
+        };
+
       for(auto a: ado_params) { PLOG("ado_param:%s", a.c_str()); }
 
       /* load plugin and register callbacks */
@@ -437,7 +603,10 @@ int main(int argc, char* argv[])
                                     ipc_get_pool_info,
                                     ipc_iterate,
                                     ipc_unlock,
-                                    ipc_configure});
+                                    ipc_configure,
+                                    ipc_table_ops,
+                                    ipc_table_ops_async,
+                                    ipc_table_ops_wait});
 
       /* main loop */
       unsigned long count = 0;
@@ -460,6 +629,72 @@ int main(int argc, char* argv[])
 
       PLOG("ADO process: main thread (%lu) debug_level:%d", pthread_self(), debug_level);
 
+      /* handle an invocation and free its request buffer. With worker
+         threads this runs on the thread chosen for the key */
+      std::mutex response_lock; /* workers share the work channel */
+      auto handle_work_request =
+        [&] (Buffer_header * buffer)
+        {
+          component::IADO_plugin::response_buffer_vector_t response_buffers;
+          auto * wr = reinterpret_cast<mcas::ipc::Work_request*>(buffer);
+
+          if(debug_level > 1) 
+            PLOG("ADO process: RECEIVED Work_request: key=(%p:%.*s) value=%p "
+                 "value_len=%lu invocation_len=%lu detached_value=%p (%.*s) len=%lu new=%d",
+                 shard_to_local(wr->get_key()),
+                 boost::numeric_cast<int>(wr->get_key_len()),
+                 shard_to_local<char>(wr->get_key()),
+                 shard_to_local(wr->get_value_addr()),
+                 wr->value_len,
+                 wr->invocation_data_len,
+                 shard_to_local(wr->get_detached_value_addr()),
+                 int(wr->detached_value_len),
+                 shard_to_local<char>(wr->get_detached_value_addr()),
+                 wr->detached_value_len,
+                 wr->new_root);
+
+          auto work_request_id = wr->work_key;
+
+          IADO_plugin::value_space_t values;
+          values.append(shard_to_local(wr->get_value_addr()), wr->value_len);
+          if(wr->detached_value_len > 0) {
+            assert(wr->get_detached_value_addr() != nullptr);
+            values.append(shard_to_local(wr->get_detached_value_addr()),
+                          wr->detached_value_len);
+          }
+
+          /* forward to plugins */
+          status_t rc =
+            plugin_mgr.do_work(work_request_id,
+                               shard_to_local<const char>(wr->get_key()),
+                               wr->get_key_len(),
+                               values,
+                               wr->get_invocation_data(),
+                               wr->invocation_data_len,
+                               wr->new_root,
+                               response_buffers);
+
+          /* posted table operations belong to this invocation */
+          table_op_pipeline.drain();
+
+          /* the request is no longer needed; free it before taking a
+             buffer for the response */
+          ipc.free_ipc_buffer(buffer);
+
+          /* pass back response data */
+          std::lock_guard<std::mutex> g(response_lock);
+          ipc.send_work_response(rc,
+                                 work_request_id,
+                                 response_buffers);
+        };
+
+      std::unique_ptr<Work_threads<Buffer_header*>> work_threads;
+      if(threads > 1) {
+        /* workers inherit the cpu mask */
+        work_threads = std::make_unique<Work_threads<Buffer_header*>>(threads, handle_work_request);
+        PLOG("ADO process: %u worker threads", threads);
+      }
+
 #ifdef PROFILE
       PMAJOR("ADO: starting profiler");
       ProfilerStart("/tmp/ADO_cpu_profile.prof");
@@ -474,7 +709,7 @@ int main(int argc, char* argv[])
 
         Buffer_header * buffer = nullptr; /* recv will dequeue this */
 
-        /* poll until there is a request, sleep on too much polling  */
+        /* poll until there is a request, block once idle for spin_us */
         auto st = ipc.poll_recv_sleep(buffer);
         if(st != S_OK) throw Logic_exception(__FILE__ " ADO: ipc.poll_recv_sleep failed unexpectedly");
         assert(buffer);
@@ -486,6 +721,10 @@ int main(int argc, char* argv[])
 
         if(mcas::ipc::Message::is_valid(buffer)) {
 
+          /* other messages wait for invocations in progress */
+          if(work_threads && mcas::ipc::Message::type(buffer) != mcas::ipc::MSG_TYPE::WORK_REQUEST)
+            work_threads->quiesce();
+
           switch(mcas::ipc::Message::type(buffer))
             {
             case mcas::ipc::MSG_TYPE::CHIRP: {
@@ -497,6 +736,7 @@ int main(int argc, char* argv[])
                   PMAJOR("ADO: received Shutdown chirp in %p",
                          common::p_fmt(buffer));
                   plugin_mgr.shutdown();
+                  table_op_pipeline.drain();
                   exit = true;
                   break;
                 default:
@@ -618,50 +858,17 @@ int main(int argc, char* argv[])
             }
             case mcas::ipc::MSG_TYPE::WORK_REQUEST:  {
 
-              component::IADO_plugin::response_buffer_vector_t response_buffers;
-              auto * wr = reinterpret_cast<Work_request*>(buffer);
-
-              if(debug_level > 1) 
-                PLOG("ADO process: RECEIVED Work_request: key=(%p:%.*s) value=%p "
-                     "value_len=%lu invocation_len=%lu detached_value=%p (%.*s) len=%lu new=%d",
-                     shard_to_local(wr->get_key()),
-                     boost::numeric_cast<int>(wr->get_key_len()),
-                     shard_to_local<char>(wr->get_key()),
-                     shard_to_local(wr->get_value_addr()),
-                     wr->value_len,
-                     wr->invocation_data_len,
-                     shard_to_local(wr->get_detached_value_addr()),
-                     int(wr->detached_value_len),
-                     shard_to_local<char>(wr->get_detached_value_addr()),
-                     wr->detached_value_len,
-                     wr->new_root);
-
-              auto work_request_id = wr->work_key;
-
-              IADO_plugin::value_space_t values;
-              values.append(shard_to_local(wr->get_value_addr()), wr->value_len);
-              if(wr->detached_value_len > 0) {
-                assert(wr->get_detached_value_addr() != nullptr);
-                values.append(shard_to_local(wr->get_detached_value_addr()),
-                              wr->detached_value_len);
+              if(work_threads) {
+                auto * wr = reinterpret_cast<Work_request*>(buffer);
+                work_threads->dispatch(common::string_view(shard_to_local<const char>(wr->get_key()),
+                                                           wr->get_key_len()),
+                                       buffer);
+              }
+              else {
+                handle_work_request(buffer);
               }
 
-              /* forward to plugins */
-              status_t rc =
-                plugin_mgr.do_work(work_request_id,
-                                   shard_to_local<const char>(wr->get_key()),
-                                   wr->get_key_len(),
-                                   values,
-                                   wr->get_invocation_data(),
-                                   wr->invocation_data_len,
-                                   wr->new_root,
-                                   response_buffers);
-
-              /* pass back response data */
-              ipc.send_work_response(rc,
-                                     work_request_id,
-                                     response_buffers);
-
+              buffer = nullptr; /* freed by handle_work_request */
               break;
             }
             case mcas::ipc::MSG_TYPE::BOOTSTRAP_REQUEST:  {
@@ -686,6 +893,7 @@ int main(int argc, char* argv[])
                                       boot_req->expected_obj_count,
                                       ado_params);
 
+              table_op_pipeline.drain();
               ipc.send_bootstrap_response();
 
               break;
@@ -698,6 +906,7 @@ int main(int argc, char* argv[])
 
               /* invoke plugin then return completion */
               plugin_mgr.notify_op_event(event->op);
+              table_op_pipeline.drain();
               ipc.send_op_event_response(event->op);
 
               break;
@@ -710,6 +919,7 @@ int main(int argc, char* argv[])
               plugin_mgr.send_cluster_event(event->sender(),
                                             event->type(),
                                             event->message());
+              table_op_pipeline.drain();
               break;
             }
             default: {
@@ -717,7 +927,8 @@ int main(int argc, char* argv[])
             }
             }
 
-          ipc.free_ipc_buffer(buffer);
+          if(buffer)
+            ipc.free_ipc_buffer(buffer);
           count++;
         }
       } // end of while loop
@@ -0,0 +1,119 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __ADO_WORK_THREADS_H__
+#define __ADO_WORK_THREADS_H__
+
+#include <common/string_view.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * Worker threads for ADO invocations, used when the shard configures
+ * more than one (ado_threads). A work request goes to the thread chosen
+ * by the hash of its key, so invocations on a key run in the order
+ * received while those on different keys run in parallel. Invocations without a key are
+ * spread round-robin. Other messages are handled by the main thread
+ * after quiesce().
+ */
+template <typename Item>
+class Work_threads
+{
+public:
+  using work_t = std::function<void(Item)>;
+
+  Work_threads(unsigned count, work_t work)
+    : _work(std::move(work)), _lock(), _idle(), _pending(0), _next(0), _exit(false), _workers()
+  {
+    for(unsigned i = 0; i != count; ++i)
+      _workers.emplace_back(std::make_unique<Worker>());
+    for(auto& w : _workers)
+      w->thread = std::thread(&Work_threads::run, this, w.get());
+  }
+
+  Work_threads(const Work_threads&) = delete;
+  Work_threads& operator=(const Work_threads&) = delete;
+
+  ~Work_threads()
+  {
+    {
+      std::lock_guard<std::mutex> g(_lock);
+      _exit = true;
+    }
+    for(auto& w : _workers) {
+      w->wake.notify_one();
+      w->thread.join();
+    }
+  }
+
+  void dispatch(common::string_view key, Item item)
+  {
+    auto i = key.empty() ? _next++ : std::hash<common::string_view>{}(key);
+    auto& w = *_workers[i % _workers.size()];
+    {
+      std::lock_guard<std::mutex> g(_lock);
+      w.queue.push(item);
+      ++_pending;
+    }
+    w.wake.notify_one();
+  }
+
+  /* wait until every dispatched request has been handled */
+  void quiesce()
+  {
+    std::unique_lock<std::mutex> g(_lock);
+    _idle.wait(g, [this] { return _pending == 0; });
+  }
+
+private:
+  struct Worker {
+    Worker() : wake(), queue(), thread() {}
+    std::condition_variable     wake;
+    std::queue<Item>            queue;
+    std::thread                 thread;
+  };
+
+  void run(Worker* w)
+  {
+    std::unique_lock<std::mutex> g(_lock);
+    while(true) {
+      w->wake.wait(g, [this, w] { return _exit || !w->queue.empty(); });
+      if(w->queue.empty())
+        return;
+
+      auto item = w->queue.front();
+      w->queue.pop();
+      g.unlock();
+      _work(item);
+      g.lock();
+
+      if(--_pending == 0)
+        _idle.notify_all();
+    }
+  }
+
+  work_t                               _work;
+  std::mutex                           _lock; /* guards the queues and _pending */
+  std::condition_variable              _idle;
+  size_t                               _pending; /* dispatched and not yet handled */
+  size_t                               _next;
+  bool                                 _exit;
+  std::vector<std::unique_ptr<Worker>> _workers;
+};
+
+#endif
@@ -0,0 +1,191 @@
+/*
+   Copyright [2021] [IBM Corporation]
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+       http://www.apache.org/licenses/LICENSE-2.0
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "work_threads.h"
+
+/* Tests of the ADO's invocation worker threads */
+
+namespace
+{
+  struct item_t {
+    std::string key;
+    unsigned    seq;
+  };
+
+  /* counts work running at once, overall and per key */
+  struct Concurrency {
+    Concurrency() : lock(), running(0), max_running(0), key_running(), key_overlaps(0) {}
+
+    void enter(const std::string &key)
+    {
+      std::lock_guard<std::mutex> g(lock);
+      max_running = std::max(max_running, ++running);
+      if (++key_running[key] != 1) ++key_overlaps;
+    }
+
+    void leave(const std::string &key)
+    {
+      std::lock_guard<std::mutex> g(lock);
+      --running;
+      --key_running[key];
+    }
+
+    std::mutex                      lock;
+    unsigned                        running;
+    unsigned                        max_running;
+    std::map<std::string, unsigned> key_running;
+    unsigned                        key_overlaps;
+  };
+
+  /* wait, for no more than a second, until at least n items have run at once */
+  bool await_running(Concurrency &c, unsigned n)
+  {
+    const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (std::chrono::steady_clock::now() < end) {
+      {
+        std::lock_guard<std::mutex> g(c.lock);
+        if (c.max_running >= n) return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+  }
+}
+
+TEST(Work_threads, SameKeySerialized)
+{
+  const unsigned count = 2001; /* a multiple of the key count */
+  Concurrency c;
+  std::mutex lock;
+  std::map<std::string, std::vector<unsigned>> order;
+
+  {
+    Work_threads<const item_t *> w(4, [&](const item_t *item) {
+        c.enter(item->key);
+        {
+          std::lock_guard<std::mutex> g(lock);
+          order[item->key].push_back(item->seq);
+        }
+        c.leave(item->key);
+      });
+
+    std::vector<item_t> items;
+    for (unsigned i = 0; i != count; ++i)
+      items.push_back(item_t{"key-" + std::to_string(i % 3), i});
+    for (const auto &item : items)
+      w.dispatch(item.key, &item);
+    w.quiesce();
+  }
+
+  /* invocations on one key never overlap, and run in the order received */
+  EXPECT_EQ(0U, c.key_overlaps);
+  ASSERT_EQ(3U, order.size());
+  for (const auto &o : order) {
+    EXPECT_EQ(count / 3, o.second.size());
+    for (size_t i = 1; i < o.second.size(); ++i)
+      EXPECT_LT(o.second[i - 1], o.second[i]);
+  }
+}
+
+TEST(Work_threads, DifferentKeysParallel)
+{
+  /* Each invocation waits for another to be running. Unless every key
+   * went to one thread, two invocations on different keys run at once.
+   */
+  Concurrency c;
+  {
+    Work_threads<const item_t *> w(4, [&c](const item_t *item) {
+        c.enter(item->key);
+        await_running(c, 2);
+        c.leave(item->key);
+      });
+
+    std::vector<item_t> items;
+    for (unsigned i = 0; i != 16; ++i)
+      items.push_back(item_t{"key-" + std::to_string(i), i});
+    for (const auto &item : items)
+      w.dispatch(item.key, &item);
+    w.quiesce();
+  }
+
+  EXPECT_LE(2U, c.max_running);
+  EXPECT_EQ(0U, c.key_overlaps);
+}
+
+TEST(Work_threads, KeylessRoundRobin)
+{
+  /* invocations without a key go to each thread in turn, so all run at once */
+  const unsigned threads = 4;
+  Concurrency c;
+  {
+    Work_threads<const item_t *> w(threads, [&c](const item_t *item) {
+        c.enter(std::to_string(item->seq));
+        await_running(c, threads);
+        c.leave(std::to_string(item->seq));
+      });
+
+    std::vector<item_t> items;
+    for (unsigned i = 0; i != threads; ++i)
+      items.push_back(item_t{std::string(), i});
+    for (const auto &item : items)
+      w.dispatch(common::string_view(), &item);
+    w.quiesce();
+  }
+
+  EXPECT_EQ(threads, c.max_running);
+}
+
+TEST(Work_threads, Quiesce)
+{
+  /* after quiesce, as before any other message is handled, all dispatched work is done */
+  const unsigned count = 200;
+  std::atomic<unsigned> done{0};
+  std::atomic<unsigned> running{0};
+  Work_threads<unsigned> w(4, [&](unsigned) {
+      ++running;
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      --running;
+      ++done;
+    });
+
+  for (unsigned round = 0; round != 3; ++round) {
+    for (unsigned i = 0; i != count; ++i)
+      w.dispatch(std::to_string(i), i);
+    w.quiesce();
+    EXPECT_EQ(count * (round + 1), done.load());
+    EXPECT_EQ(0U, running.load());
+  }
+
+  /* with nothing dispatched, quiesce returns at once */
+  w.quiesce();
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  auto r = RUN_ALL_TESTS();
+
+  return r;
+}
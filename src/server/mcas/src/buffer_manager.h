@@ -29,19 +29,23 @@
 #include "mcas_config.h"
 #include "memory_registered.h"
 #include <gsl/pointers> /* not_null */
+#include <algorithm>    /* min */
 #include <cassert>
-#include <cstring>      /* memset */
 #include <memory>       /* unique_ptr */
+#include <optional>
 
 namespace
 {
+  /* Slabs are fresh anonymous mappings: the kernel supplies them zeroed, so
+   * a response shorter than its buffer cannot expose old heap contents, and
+   * nothing is written here. The pages are faulted in when the slab is locked.
+   */
   inline auto alloc_base(std::size_t len) -> gsl::not_null<void *>
   {
-    auto b = ::aligned_alloc(MiB(2), len);
-    if (b == nullptr) {
+    auto b = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (b == MAP_FAILED) {
       throw std::bad_alloc();
     }
-    ::memset(b, 0, len);
     return gsl::not_null<void *>(b);
   }
 }
@@ -58,6 +62,27 @@ public:
   static constexpr size_t BUFFER_LEN           = MiB(2); /* corresponds to huge page see below */
   using memory_registered_t                    = memory_registered<Memory>;
 
+  /* Buffers come in size classes. Each class is populated on demand, so
+   * a connection holds only the buffers it has actually needed. The
+   * buffer count bounds the memory of all classes together, in units of
+   * BUFFER_LEN. BUFFER_LEN is the large class and the default.
+   */
+  enum class size_class : unsigned { SMALL = 0, MEDIUM = 1, LARGE = 2 };
+  static constexpr unsigned SIZE_CLASS_COUNT = 3;
+  static constexpr size_t   SMALL_BUFFER_LEN  = KiB(4);
+  static constexpr size_t   MEDIUM_BUFFER_LEN = KiB(64);
+
+  static constexpr size_t class_length(size_class c)
+  {
+    return c == size_class::SMALL ? SMALL_BUFFER_LEN : c == size_class::MEDIUM ? MEDIUM_BUFFER_LEN : BUFFER_LEN;
+  }
+
+  /* smallest class which holds len bytes */
+  static constexpr size_class class_of(size_t len)
+  {
+    return len <= SMALL_BUFFER_LEN ? size_class::SMALL : len <= MEDIUM_BUFFER_LEN ? size_class::MEDIUM : size_class::LARGE;
+  }
+
   using memory_region_t = typename Memory::memory_region_t;
 
   struct iov_mem_lock
@@ -68,7 +93,10 @@ public:
     iov_mem_lock(::iovec *iov_)
       : _iov(iov_)
     {
-      ::madvise(_iov->iov_base, _iov->iov_len, MADV_HUGEPAGE);
+      if ( _iov->iov_len >= MiB(2) )
+      {
+        ::madvise(_iov->iov_base, _iov->iov_len, MADV_HUGEPAGE);
+      }
       ::mlock(_iov->iov_base, _iov->iov_len);
     }
     iov_mem_lock(iov_mem_lock &&) noexcept = default;
@@ -90,10 +118,14 @@ public:
     static constexpr const char *_cname = "buffer_base";
     void *_base;
     std::size_t _original_length;
-    memory_registered_t _region;
+    std::optional<memory_registered_t> _owned_region; /* empty if the memory lies in a registered slab */
+    Memory *_transport;
+    memory_region_t _mr;
+    void *_desc;
     const unsigned magic;
 
   public:
+    /* registers the memory */
     buffer_base(unsigned    debug_level_,
              Memory * transport_,
              void *      base_,
@@ -102,7 +134,10 @@ public:
       : common::log_source(debug_level_)
       , _base(base_)
       , _original_length(length_)
-      , _region(memory_registered_t(debug_level_, transport_, base_, length_, 0, 0))
+      , _owned_region(std::in_place, debug_level_, transport_, base_, length_, 0, 0)
+      , _transport(transport_)
+      , _mr(_owned_region->mr())
+      , _desc(_owned_region->desc())
       , magic(0xC0FFEE)
     {
       if ( length_ <= 1 )
@@ -113,7 +148,28 @@ public:
             common::p_fmt(transport()), common::p_fmt(region()));
     }
 
-    void *get_desc() const { return _region.desc(); }
+    /* uses the registration of the slab which contains the memory */
+    buffer_base(unsigned                   debug_level_,
+                const memory_registered_t &slab_region_,
+                void *                     base_,
+                size_t                     length_
+    )
+      : common::log_source(debug_level_)
+      , _base(base_)
+      , _original_length(length_)
+      , _owned_region()
+      , _transport(slab_region_.transport())
+      , _mr(slab_region_.mr())
+      , _desc(slab_region_.desc())
+      , magic(0xC0FFEE)
+    {
+      if ( length_ <= 1 )
+      {
+        throw std::domain_error("buffer length too small");
+      }
+    }
+
+    void *get_desc() const { return _desc; }
 
     DELETE_COPY(buffer_base);
 
@@ -127,8 +183,8 @@ public:
   public:
     size_t original_length() const { return _original_length; }
     inline gsl::not_null<void *> base() const { return _base; }
-    auto region() const { return _region.mr(); }
-    Memory * transport() const { return _region.transport(); }
+    auto region() const { return _mr; }
+    Memory * transport() const { return _transport; }
 
 #if 0
     /* unused */
@@ -137,18 +193,40 @@ public:
 #endif
   };
 
-  struct free_deleter
+  struct munmap_deleter
   {
-    void operator()(void *v_) { ::free(v_); }
+    std::size_t len;
+    void operator()(void *v_) { ::munmap(v_, len); }
+  };
+
+  /* A single allocation, locked and registered once, from which buffers are carved */
+  struct slab
+  {
+  private:
+    std::unique_ptr<void, munmap_deleter> _memory;
+    ::iovec _iov;
+    iov_mem_lock _ml;
+  public:
+    const memory_registered_t region;
+
+    slab(unsigned debug_level_, Memory *transport_, size_t length_)
+      : _memory(alloc_base(length_), munmap_deleter{length_})
+      , _iov{_memory.get(), length_}
+      , _ml(&_iov)
+      , region(debug_level_, transport_, _memory.get(), length_, 0, 0)
+    {
+    }
+
+    DELETE_COPY(slab);
+
+    char *base() const { return static_cast<char *>(_iov.iov_base); }
   };
 
   struct buffer_internal
-    : private std::unique_ptr<void, free_deleter>
-    , public buffer_base
+    : public buffer_base
   {
     ::iovec iov[2];
     void *desc[2];
-    iov_mem_lock _ml;
     using completion_t = void (*)(void *, buffer_internal *);
     completion_t   completion_cb;
     void *         value_adjunct;
@@ -159,14 +237,13 @@ public:
       value_adjunct = value_adjunct_;
     }
     buffer_internal(unsigned debug_level_,
-             Memory *         transport_,
+             const slab &        slab_,
+             size_t              offset_,
              size_t              length_
     )
-      : std::unique_ptr<void, free_deleter>(alloc_base(length_))
-      , buffer_base(debug_level_, transport_, std::unique_ptr<void, free_deleter>::get(), length_)
+      : buffer_base(debug_level_, slab_.region, slab_.base() + offset_, length_)
       , iov{{this->base(), this->original_length()}, {nullptr, 0}}
       , desc{this->get_desc(), nullptr}
-      , _ml(&this->iov[0])
       , completion_cb(nullptr)
       , value_adjunct(nullptr)
     {
@@ -193,17 +270,18 @@ public:
 #pragma GCC diagnostic ignored "-Weffc++"  // missing initializers
   Buffer_manager(unsigned debug_level_,
                  Memory *transport,
-                 size_t buffer_count = DEFAULT_BUFFER_COUNT)
+                 size_t buffer_count = DEFAULT_BUFFER_COUNT,
+                 size_t initial_count = INITIAL_SHARD_BUFFERS)
     : common::log_source(debug_level_),
-      _buffer_count(buffer_count),
+      _byte_limit(buffer_count * BUFFER_LEN),
+      _slab_bytes(0),
       _transport(transport)
   {
-    for (unsigned i = 0; i < _buffer_count; i++) {
-      const auto len  = BUFFER_LEN;
-      _buffers.emplace_back(std::make_unique<buffer_internal>(debug_level_, _transport, len));
-      _free.push_back(_buffers.back().get());
+    auto &large = _classes[unsigned(size_class::LARGE)];
+    while (large.buffers.size() < std::min(initial_count, buffer_count)) {
+      grow(large, size_class::LARGE);
     }
-    PLOG("%s %p allocated %lu buffers", __func__, common::p_fmt(this), buffer_count);
+    PLOG("%s %p allocated %lu of %lu bytes", __func__, common::p_fmt(this), _slab_bytes, _byte_limit);
   }
 #pragma GCC diagnostic pop
 
@@ -215,12 +293,20 @@ public:
 
   using completion_t = void (*)(void *, buffer_internal *);
 
-  gsl::not_null<buffer_internal *> allocate(completion_t completion_)
+  /**
+   * Allocate a buffer of at least len_ bytes (default: a large buffer)
+   */
+  gsl::not_null<buffer_internal *> allocate(completion_t completion_, size_t len_ = BUFFER_LEN)
   {
-    if (UNLIKELY(_free.empty())) throw Program_exception("Buffer_manager: no shard buffers remaining");
-    gsl::not_null<buffer_internal *> iob = _free.back();
-    _free.pop_back();
-    CPLOG(3, "%s::%s %p (%lu free)", _cname, __func__, common::p_fmt(iob), _free.size());
+    const auto c = class_of(len_);
+    auto &cls = _classes[unsigned(c)];
+
+    if (cls.free.empty()) grow(cls, c);
+
+    gsl::not_null<buffer_internal *> iob = cls.free.back();
+    cls.free.pop_back();
+
+    CPLOG(3, "%s::%s %p len %zu (%lu free)", _cname, __func__, common::p_fmt(iob), iob->original_length(), cls.free.size());
     iob->reset_length();
     iob->set_completion(completion_);
     return iob;
@@ -228,22 +314,50 @@ public:
 
   void free(gsl::not_null<buffer_internal *> iob)
   {
-    CPLOG(3, "%s::%s %p (%lu free)", _cname, __func__, common::p_fmt(iob), _free.size());
+    auto &cls = _classes[unsigned(class_of(iob->original_length()))];
+    CPLOG(3, "%s::%s %p (%lu free)", _cname, __func__, common::p_fmt(iob), cls.free.size());
     iob->reset_length();
     iob->set_completion(nullptr);
-    _free.push_back(iob);
+    cls.free.push_back(iob);
   }
 
 private:
-  // static constexpr size_t buffer_len() { return BUFFER_LEN; }
+  struct class_pool {
+    std::vector<std::unique_ptr<slab>>            slabs;
+    std::vector<std::unique_ptr<buffer_internal>> buffers; /* destroyed before the slabs */
+    std::vector<buffer_internal *>                free;
+  };
+
+  /* number of buffers carved from each slab, per size class */
+  static constexpr size_t slab_buffer_count(size_class c)
+  {
+    return c == size_class::SMALL ? 32 : c == size_class::MEDIUM ? 8 : INITIAL_SHARD_BUFFERS;
+  }
+
+  /* add one slab of buffers to a class; registration and locking is per slab */
+  void grow(class_pool &cls, size_class c)
+  {
+    const auto len = class_length(c);
+    const auto count = std::min(slab_buffer_count(c), (_byte_limit - _slab_bytes) / len);
+    if (UNLIKELY(count == 0)) throw Program_exception("Buffer_manager: no shard buffer memory remaining");
+
+    cls.slabs.emplace_back(std::make_unique<slab>(debug_level(), _transport, len * count));
+    _slab_bytes += len * count;
+    const auto &sl = *cls.slabs.back();
+    for (size_t i = 0; i != count; ++i) {
+      cls.buffers.emplace_back(std::make_unique<buffer_internal>(debug_level(), sl, i * len, len));
+      cls.free.push_back(cls.buffers.back().get());
+    }
+    CPLOG(2, "%s::%s %p len %zu (%lu buffers)", _cname, __func__, common::p_fmt(this), len, cls.buffers.size());
+  }
 
   using pool_t = component::IKVStore::pool_t;
   using key_t  = std::uint64_t;
 
-  const size_t                           _buffer_count;
+  const size_t                           _byte_limit; /*< limit for all size classes together */
+  size_t                                 _slab_bytes; /*< bytes held in slabs */
   gsl::not_null<Memory *>             _transport;
-  std::vector<std::unique_ptr<buffer_internal>> _buffers;
-  std::vector<buffer_internal *>        _free;
+  class_pool                             _classes[SIZE_CLASS_COUNT];
 };
 }  // namespace mcas
 
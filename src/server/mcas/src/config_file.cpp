@@ -35,6 +35,7 @@ namespace mcas
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm> /* max */
 #include <cassert>
 #include <cstring>
 #include <limits>
@@ -87,6 +88,11 @@ struct ParseException
 const char *k_typenames[] = {"Null", "False", "True", "Object", "Array", "String", "Number"};
 
 constexpr unsigned int DEFAULT_CLUSTER_PORT = 11800U;
+constexpr unsigned int DEFAULT_HANDLER_MSG_BUDGET = 16U;
+constexpr unsigned int DEFAULT_IDLE_SPIN_US = 10000U;
+constexpr unsigned int DEFAULT_ADO_SPIN_US = 100U;
+constexpr unsigned int DEFAULT_ADO_LOCK_WAIT_MS = 1000U;
+constexpr unsigned int DEFAULT_ADO_THREADS = 1U;
 
 boost::optional<std::string> init_net_providers(rapidjson::Document &doc_)
 {
@@ -340,6 +346,128 @@ auto make_schema_shard()
               )
             )
           , json::member
+          ( config::handler_msg_budget
+            , json::object
+            ( json::member(schema::description, "Maximum number of queued messages processed for one client connection before moving to the next.")
+              , json::member(schema::examples, json::array(json::number(1), json::number(16)))
+              , json::member
+              ( schema::type
+                , schema::integer
+                )
+              , json::member
+              ( schema::minimum
+                , json::number(1)
+                )
+              , json::member
+              ( schema::k_default /* informational only */
+                , json::number(DEFAULT_HANDLER_MSG_BUDGET)
+                )
+              )
+            )
+          , json::member
+          ( config::handler_time_budget_us
+            , json::object
+            ( json::member(schema::description, "Maximum time, in microseconds, spent on one client connection's queued messages before moving to the next. 0 means no time limit.")
+              , json::member(schema::examples, json::array(json::number(0), json::number(50)))
+              , json::member
+              ( schema::type
+                , schema::integer
+                )
+              , json::member
+              ( schema::minimum
+                , json::number(0)
+                )
+              )
+            )
+          , json::member
+          ( config::idle_spin_us
+            , json::object
+            ( json::member(schema::description, "Time, in microseconds, the shard polls without finding work before it starts blocking on network completions.")
+              , json::member(schema::examples, json::array(json::number(1000), json::number(10000)))
+              , json::member
+              ( schema::type
+                , schema::integer
+                )
+              , json::member
+              ( schema::minimum
+                , json::number(0)
+                )
+              , json::member
+              ( schema::k_default /* informational only */
+                , json::number(DEFAULT_IDLE_SPIN_US)
+                )
+              )
+            )
+          , json::member
+          ( config::ado_spin_us
+            , json::object
+            ( json::member(schema::description, "Time, in microseconds, an ADO process polls for a request before it blocks on the channel doorbell.")
+              , json::member(schema::examples, json::array(json::number(0), json::number(100)))
+              , json::member
+              ( schema::type
+                , schema::integer
+                )
+              , json::member
+              ( schema::minimum
+                , json::number(0)
+                )
+              , json::member
+              ( schema::k_default /* informational only */
+                , json::number(DEFAULT_ADO_SPIN_US)
+                )
+              )
+            )
+          , json::member
+          ( config::ado_lock_wait_ms
+            , json::object
+            ( json::member(schema::description, "Time, in milliseconds, an ADO invocation on a locked key waits in the shard for the lock before failing with E_LOCKED. 0 fails at once.")
+              , json::member(schema::examples, json::array(json::number(0), json::number(1000)))
+              , json::member
+              ( schema::type
+                , schema::integer
+                )
+              , json::member
+              ( schema::minimum
+                , json::number(0)
+                )
+              , json::member
+              ( schema::k_default /* informational only */
+                , json::number(DEFAULT_ADO_LOCK_WAIT_MS)
+                )
+              )
+            )
+          , json::member
+          ( config::ado_threads
+            , json::object
+            ( json::member(schema::description, "Worker threads in each ADO process for invocations. Invocations on one key run in order, on different keys in parallel. More than 1 requires a thread-safe ADO plugin.")
+              , json::member(schema::examples, json::array(json::number(1), json::number(4)))
+              , json::member
+              ( schema::type
+                , schema::integer
+                )
+              , json::member
+              ( schema::minimum
+                , json::number(1)
+                )
+              , json::member
+              ( schema::k_default /* informational only */
+                , json::number(DEFAULT_ADO_THREADS)
+                )
+              )
+            )
+          , json::member
+          ( config::worker_cores
+            , json::object
+            ( json::member(schema::description, "CPU cores for worker threads which share the shard's port and store. Client sessions are distributed across the workers. Not supported with ADO. Store calls are serialized unless the store is multi-thread safe per pool.")
+              , json::member(schema::examples, json::array("1,2,3", "8"))
+              , json::member(schema::type, schema::string)
+              , json::member
+              ( schema::pattern
+                , "[0-9]+(,[0-9]+)*"
+                )
+              )
+            )
+          , json::member
           ( config::default_backend
             , json::object
             ( json::member(schema::description, "Key/value store implementation to use.")
@@ -411,7 +539,7 @@ auto make_schema_shard()
           , json::member
           ( config::ado_core_count
             , json::object
-            ( json::member(schema::description, "A scheduling parameter for ADO. Perhaps it indicates the expected CPU load, relative to other AOO prcoesses.")
+            ( json::member(schema::description, "A scheduling parameter for ADO: the expected CPU load, relative to other ADO processes. With 2 or more, the ADO runs invocations on that many worker threads (whole cores), by key; its plugins must then be thread safe.")
               , json::member(schema::examples, json::array(json::number("0", "2"), json::number("1", "4")))
               , json::member(schema::type, schema::number)
               )
@@ -806,6 +934,69 @@ unsigned int Config_file::get_shard_security_port(rapidjson::SizeType i) const
   return m == shard.MemberEnd() ? 0 : m->value.GetUint();
 }
 
+unsigned int Config_file::get_shard_handler_msg_budget(rapidjson::SizeType i) const
+{
+  if (i > shard_count()) throw Config_exception("%s out of bounds", __func__);
+  assert(_shards[i].IsObject());
+  auto shard = _shards[i].GetObject();
+  auto m     = shard.FindMember(config::handler_msg_budget);
+  return m == shard.MemberEnd() ? DEFAULT_HANDLER_MSG_BUDGET : std::max(1U, m->value.GetUint());
+}
+
+unsigned int Config_file::get_shard_handler_time_budget_us(rapidjson::SizeType i) const
+{
+  if (i > shard_count()) throw Config_exception("%s out of bounds", __func__);
+  assert(_shards[i].IsObject());
+  auto shard = _shards[i].GetObject();
+  auto m     = shard.FindMember(config::handler_time_budget_us);
+  return m == shard.MemberEnd() ? 0 : m->value.GetUint();
+}
+
+unsigned int Config_file::get_shard_idle_spin_us(rapidjson::SizeType i) const
+{
+  if (i > shard_count()) throw Config_exception("%s out of bounds", __func__);
+  assert(_shards[i].IsObject());
+  auto shard = _shards[i].GetObject();
+  auto m     = shard.FindMember(config::idle_spin_us);
+  return m == shard.MemberEnd() ? DEFAULT_IDLE_SPIN_US : m->value.GetUint();
+}
+
+unsigned int Config_file::get_shard_ado_spin_us(rapidjson::SizeType i) const
+{
+  if (i > shard_count()) throw Config_exception("%s out of bounds", __func__);
+  assert(_shards[i].IsObject());
+  auto shard = _shards[i].GetObject();
+  auto m     = shard.FindMember(config::ado_spin_us);
+  return m == shard.MemberEnd() ? DEFAULT_ADO_SPIN_US : m->value.GetUint();
+}
+
+unsigned int Config_file::get_shard_ado_lock_wait_ms(rapidjson::SizeType i) const
+{
+  if (i > shard_count()) throw Config_exception("%s out of bounds", __func__);
+  assert(_shards[i].IsObject());
+  auto shard = _shards[i].GetObject();
+  auto m     = shard.FindMember(config::ado_lock_wait_ms);
+  return m == shard.MemberEnd() ? DEFAULT_ADO_LOCK_WAIT_MS : m->value.GetUint();
+}
+
+unsigned int Config_file::get_shard_ado_threads(rapidjson::SizeType i) const
+{
+  if (i > shard_count()) throw Config_exception("%s out of bounds", __func__);
+  assert(_shards[i].IsObject());
+  auto shard = _shards[i].GetObject();
+  auto m     = shard.FindMember(config::ado_threads);
+  return m == shard.MemberEnd() ? DEFAULT_ADO_THREADS : m->value.GetUint();
+}
+
+std::string Config_file::get_shard_worker_cores(rapidjson::SizeType i) const
+{
+  if (i > shard_count()) throw Config_exception("%s out of bounds", __func__);
+  assert(_shards[i].IsObject());
+  auto shard = _shards[i].GetObject();
+  auto m     = shard.FindMember(config::worker_cores);
+  return m == shard.MemberEnd() ? std::string() : std::string(m->value.GetString());
+}
+
 boost::optional<std::string> Config_file::get_shard_optional(std::string field, rapidjson::SizeType i) const
 {
   if (field.empty()) throw Config_exception("%s invalid field", __func__);
@@ -61,6 +61,13 @@ static constexpr const char *cert_path = "cert_path";
 static constexpr const char *key_path = "key_path";
 static constexpr const char *security_mode = "security_mode";
 static constexpr const char *security_port = "security_port";
+static constexpr const char *handler_msg_budget = "handler_msg_budget";
+static constexpr const char *handler_time_budget_us = "handler_time_budget_us";
+static constexpr const char *worker_cores = "worker_cores";
+static constexpr const char *idle_spin_us = "idle_spin_us";
+static constexpr const char *ado_spin_us = "ado_spin_us";
+static constexpr const char *ado_lock_wait_ms = "ado_lock_wait_ms";
+static constexpr const char *ado_threads = "ado_threads";
 }
 
 namespace mcas
@@ -116,6 +123,20 @@ public:
 
   unsigned int get_shard_security_port(rapidjson::SizeType i) const;
 
+  unsigned int get_shard_handler_msg_budget(rapidjson::SizeType i) const;
+
+  unsigned int get_shard_handler_time_budget_us(rapidjson::SizeType i) const;
+
+  std::string get_shard_worker_cores(rapidjson::SizeType i) const;
+
+  unsigned int get_shard_idle_spin_us(rapidjson::SizeType i) const;
+
+  unsigned int get_shard_ado_spin_us(rapidjson::SizeType i) const;
+
+  unsigned int get_shard_ado_lock_wait_ms(rapidjson::SizeType i) const;
+
+  unsigned int get_shard_ado_threads(rapidjson::SizeType i) const;
+
   boost::optional<std::string> get_shard_optional(std::string field, rapidjson::SizeType i) const;
 
   std::string get_shard_required(std::string field, rapidjson::SizeType i) const;
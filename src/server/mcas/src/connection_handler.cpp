@@ -17,6 +17,11 @@
 
 static constexpr unsigned EXTRA_BISCUITS = 0;
 
+/* receive buffers posted beyond the first for a client which asked, at
+   handshake, to pipeline requests, so that it does not outrun the posted
+   receives */
+static constexpr unsigned PIPELINE_BISCUITS = PIPELINE_WINDOW - 1;
+
 namespace mcas
 {
 Connection_handler::Connection_handler(unsigned debug_level,
@@ -193,6 +198,13 @@ int Connection_handler::tick()
         throw General_exception("handshake status != S_OK (%d)", msg->get_status());
 
       set_auth_id(msg->auth_id());
+
+      /* before the reply, after which the client may send */
+      if (msg->is_pipelined()) {
+        for (auto i = PIPELINE_BISCUITS; i != 0; --i) {
+          post_recv_buffer(allocate_recv());
+        }
+      }
       
       /* if security_tls_auth bit is set, then we need to establish a
          GNU TLS side-channel as part of this session. this is
@@ -236,7 +248,7 @@ void Connection_handler::configure_security(const std::string& bind_ipaddr,
   
 void Connection_handler::respond_to_handshake(bool start_tls)
 {
-  auto reply_iob = allocate_send();
+  auto reply_iob = allocate_send(sizeof(protocol::Message_handshake_reply));
   assert(reply_iob);
 
   auto reply_msg = new (reply_iob->base()) protocol::Message_handshake_reply(reply_iob->length(),
@@ -179,6 +179,8 @@ public:
   inline bool client_connected() { return _state != Connection_state::CLIENT_DISCONNECTED; }
 
   auto allocate_send() { return allocate(static_send_callback); }
+  /* a send buffer from the smallest size class which holds len bytes */
+  auto allocate_send(size_t len) { return allocate(static_send_callback, len); }
   auto allocate_recv() { return allocate(static_recv_callback); }
 
   /** 
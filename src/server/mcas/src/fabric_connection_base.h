@@ -20,6 +20,7 @@
 #include <api/fabric_itf.h> /* IFabric_memory_region, IFabric_server */
 #include <gsl/pointers>
 #include <algorithm>
+#include <chrono>
 #include <list>
 #include <queue>
 
@@ -284,12 +285,16 @@ private:
 
   inline void deregister_memory(memory_region_t region) { return transport()->deregister_memory(region); }
 
+  /* the fabric connection, for a wait on several connections at once */
+  inline component::IFabric_server *fabric_connection() const { return transport(); }
+
   inline void *get_memory_descriptor(memory_region_t region) { return transport()->get_memory_descriptor(region); }
 
   inline uint64_t get_memory_remote_key(memory_region_t region) { return transport()->get_memory_remote_key(region); }
 
  protected:
   inline auto allocate(buffer_t::completion_t c) { return _bm.allocate(c); }
+  inline auto allocate(buffer_t::completion_t c, size_t len) { return _bm.allocate(c, len); }
 
   inline void free_buffer(buffer_t *buffer) { _bm.free(buffer); }
 
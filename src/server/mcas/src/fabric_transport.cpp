@@ -125,4 +125,13 @@ auto Fabric_transport::get_new_connection() -> Connection_handler *
     : nullptr;
 }
 
+void Fabric_transport::wait_for_activity(const std::vector<Connection_handler *> &handlers,
+                                         std::chrono::milliseconds                timeout)
+{
+  std::vector<component::IFabric_server *> connections;
+  connections.reserve(handlers.size());
+  for (auto h : handlers) connections.push_back(h->fabric_connection());
+  _server_factory->wait_for_activity(connections, timeout);
+}
+
 }  // namespace mcas
@@ -19,8 +19,10 @@
 #include <boost/optional.hpp>
 
 #include "buffer_manager.h"
+#include <chrono>
 #include <memory>  // unique_ptr
 #include <string>
+#include <vector>
 
 namespace mcas
 {
@@ -42,6 +44,12 @@ class Fabric_transport {
 
   Connection_handler *get_new_connection();
 
+  /* block until a new connection is pending, or the timeout expires */
+  void wait_for_new_connection(std::chrono::milliseconds timeout) { _server_factory->wait_for_new_endpoint(timeout); }
+
+  /* block until a session has a completion, a new connection is pending, or the timeout expires */
+  void wait_for_activity(const std::vector<Connection_handler *> &handlers, std::chrono::milliseconds timeout);
+
   inline unsigned get_port() const { return _port; }
 
  private:
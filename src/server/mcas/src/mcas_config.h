@@ -15,13 +15,27 @@
 
 #include <cstddef> /* size_t */
 
-/* NUM_SHARD_BUFFERS: number of buffers per connection */
+/* NUM_SHARD_BUFFERS: maximum buffer memory per connection, in large (2MiB)
+ * buffers; smaller size classes draw on the same budget */
 static constexpr std::size_t NUM_SHARD_BUFFERS = 128;
 
+/* INITIAL_SHARD_BUFFERS: number of large buffers allocated up front per
+ * connection; more are allocated on demand */
+static constexpr std::size_t INITIAL_SHARD_BUFFERS = 4;
+
+/* PIPELINE_WINDOW: maximum number of synchronous requests a client keeps
+ * in flight on one connection; the server keeps as many receive buffers
+ * posted on a connection whose client asked to pipeline at handshake */
+static constexpr unsigned PIPELINE_WINDOW = 8;
+
 /* WORK_REQUEST_ALLOCATOR_COUNT: number of work request slots for ADO
  * communications */
 static constexpr std::size_t WORK_REQUEST_ALLOCATOR_COUNT = 256;
 
+/* PARKED_ADO_REQUEST_LIMIT: maximum number of ADO invocations, per shard,
+ * waiting for a locked key; beyond this they fail with E_LOCKED */
+static constexpr std::size_t PARKED_ADO_REQUEST_LIMIT = 1024;
+
 /* Maximum number of comparison to make on a index scan.  We limit the max so
    that the shard thread does not get "jammed up" scanning the index. */
 static constexpr unsigned MAX_INDEX_COMPARISONS = 10000;
@@ -73,6 +73,7 @@ enum INFO_TYPE : uint32_t {
   /* must be above IKVStore::Attributes */
   INFO_TYPE_FIND_KEY  = 0xF0,
   INFO_TYPE_GET_STATS = 0xF1,
+  INFO_TYPE_FIND_KEYS = 0xF2, /*< batched find: many (position,key) matches per response */
 };
 
 enum {
@@ -118,6 +119,8 @@ enum OP_TYPE : uint8_t {
   OP_LOCATE      = 19,  // locate space for DMA access
   OP_RELEASE     = 20,  // release space located for DMA access
   OP_RELEASE_WITH_FLUSH = 21,  // flush and release space located for DMA access
+  OP_MULTI_GET   = 22,  // get many small values in one message
+  OP_MULTI_PUT   = 23,  // put many small key-value pairs in one message
   OP_INVALID     = 0xFE, // not applicable
 };
 
@@ -595,6 +598,60 @@ struct Message_IO_request : public Message_numbered_request {
   auto key_len() const { return _key_len; }
   auto flags() const { return _flags; }
 
+  /* OP_MULTI_GET/OP_MULTI_PUT: the data area holds a sequence of
+     multi_record headers, each followed by the key and (put only) the
+     value. _key_len is the total length of the records, _val_len their
+     count.
+  */
+  struct multi_record {
+    uint32_t key_len;
+    uint32_t value_len;
+  } __attribute__((packed));
+
+  static size_t multi_record_size(size_t key_len, size_t value_len)
+  {
+    return sizeof(multi_record) + key_len + value_len;
+  }
+
+  /**
+   * Append a key (and value) to an OP_MULTI_GET/OP_MULTI_PUT request.
+   * Returns false if the record does not fit in buffer_size, leaving the
+   * message unchanged.
+   */
+  bool append_multi_record(size_t buffer_size, const void* key, size_t key_len_, const void* value, size_t value_len)
+  {
+    auto record_len = multi_record_size(key_len_, value_len);
+    if (msg_len() + record_len > buffer_size) return false;
+
+    auto record       = common::pointer_cast<multi_record>(&data()[_key_len]);
+    record->key_len   = boost::numeric_cast<uint32_t>(key_len_);
+    record->value_len = boost::numeric_cast<uint32_t>(value_len);
+    auto p            = common::pointer_cast<data_t>(record + 1);
+    std::memcpy(p, key, key_len_);
+    if (value_len) std::memcpy(p + key_len_, value, value_len);
+
+    _key_len += record_len;
+    _val_len++;
+    data()[_key_len] = '\0';
+    increase_msg_len(record_len);
+    return true;
+  }
+
+  size_t multi_record_count() const { return _val_len; }
+
+  /* f(key, key_len, value, value_len) */
+  template <typename F>
+  void for_each_multi_record(F f) const
+  {
+    size_t pos = 0;
+    while (pos < _key_len) {
+      auto record = common::pointer_cast<const multi_record>(&data()[pos]);
+      auto p      = common::pointer_cast<const data_t>(record + 1);
+      f(p, size_t(record->key_len), p + record->key_len, size_t(record->value_len));
+      pos += multi_record_size(record->key_len, record->value_len);
+    }
+  }
+
   // fields
  private:
   uint64_t _key_len;
@@ -673,6 +730,58 @@ class Message_IO_response : public Message_numbered_response {
     return data_length() / sizeof(locate_element);
   }
 
+  /* OP_MULTI_GET/OP_MULTI_PUT: data is a sequence of multi_result
+     headers, one per request record in order, each followed by the
+     value (get only). Results may stop short of the request count if
+     the response buffer fills up.
+  */
+  struct multi_result {
+    int32_t  status;
+    uint32_t value_len;
+  } __attribute__((packed));
+
+  static size_t multi_result_size(size_t value_len) { return sizeof(multi_result) + value_len; }
+
+  /* space left for the value of the next multi_result */
+  size_t multi_result_space(size_t buffer_size) const
+  {
+    auto used = msg_len() + sizeof(multi_result);
+    return used < buffer_size ? buffer_size - used : 0;
+  }
+
+  /* location at which the value of the next multi_result is written */
+  void* multi_result_value() { return data() + data_length() + sizeof(multi_result); }
+
+  /**
+   * Append a result whose value (if any) has already been written to
+   * multi_result_value(). Returns false if the result does not fit.
+   */
+  bool append_multi_result(size_t buffer_size, status_t status, size_t value_len)
+  {
+    assert(!is_set_twostage_bit());
+    auto result_len = multi_result_size(value_len);
+    if (msg_len() + result_len > buffer_size) return false;
+
+    auto result       = common::pointer_cast<multi_result>(data() + data_length());
+    result->status    = status;
+    result->value_len = boost::numeric_cast<uint32_t>(value_len);
+    _data_len += result_len;
+    increase_msg_len(result_len);
+    return true;
+  }
+
+  /* f(status, value, value_len); called at the MCAS client side */
+  template <typename F>
+  void for_each_multi_result(F f) const
+  {
+    size_t pos = 0;
+    while (pos < data_length()) {
+      auto result = common::pointer_cast<const multi_result>(data() + pos);
+      f(status_t(result->status), static_cast<const void*>(result + 1), size_t(result->value_len));
+      pos += multi_result_size(result->value_len);
+    }
+  }
+
   // fields
  public:
   uint64_t _data_len; /* bit 63 is twostage flag */
@@ -701,7 +810,7 @@ struct Message_INFO_request : public Message {
       : Message(auth_id, (sizeof *this), id, OP_INVALID),
         _pool_id(pool_id_),
         _type(type_),
-        pad(),
+        max_count(),
         offset(),
         key_len(0)
   {
@@ -711,7 +820,7 @@ struct Message_INFO_request : public Message {
       : Message(auth_id, (sizeof *this), id, OP_INVALID),
         _pool_id(pool_id_),
         _type(type_),
-        pad(),
+        max_count(),
         offset(),
         key_len(0)
   {
@@ -721,7 +830,18 @@ struct Message_INFO_request : public Message {
       : Message(auth_id, (sizeof *this), id, OP_INVALID),
         _pool_id(pool_id_),
         _type(type_),
-        pad(),
+        max_count(),
+        offset(offset_),
+        key_len(0)
+  {
+  }
+
+  /*< version used for INFO_TYPE_FIND_KEYS */
+  Message_INFO_request(uint64_t auth_id, INFO_TYPE type_, uint64_t pool_id_, offset_t offset_, uint32_t max_count_)
+      : Message(auth_id, (sizeof *this), id, OP_INVALID),
+        _pool_id(pool_id_),
+        _type(type_),
+        max_count(max_count_),
         offset(offset_),
         key_len(0)
   {
@@ -748,7 +868,7 @@ struct Message_INFO_request : public Message {
   // fields
   uint64_t _pool_id;
   uint32_t _type;
-  uint32_t pad;
+  uint32_t max_count; /*< INFO_TYPE_FIND_KEYS only: maximum matches to return */
   uint64_t offset;
   uint64_t key_len;
   /* data immediately follows */
@@ -794,6 +914,48 @@ struct Message_INFO_response : public Message {
   std::size_t value() const { return _v._value; }
   offset_t Offset() const { return _offset; }
 
+  /* INFO_TYPE_FIND_KEYS: data is a sequence of key records, each a
+     key_record header followed by the (unterminated) key */
+  struct key_record {
+    uint64_t position;
+    uint32_t key_len;
+  } __attribute__((packed));
+
+  static size_t key_record_size(size_t key_len) { return sizeof(key_record) + key_len; }
+
+  /**
+   * Append a matched key. Returns false if the record does not fit in
+   * buffer_size, leaving the message unchanged.
+   */
+  bool append_key(size_t buffer_size, offset_t position, const std::string& key)
+  {
+    auto record_len = key_record_size(key.size());
+    if (message_size() + record_len > buffer_size) return false;
+
+    auto record      = common::pointer_cast<key_record>(&data()[_v._value_len]);
+    record->position = position;
+    record->key_len  = boost::numeric_cast<uint32_t>(key.size());
+    std::memcpy(record + 1, key.data(), key.size());
+    _v._value_len += record_len;
+    data()[_v._value_len] = '\0';
+    return true;
+  }
+
+  /* position from which a subsequent INFO_TYPE_FIND_KEYS should resume */
+  void set_next_offset(offset_t offset_) { _offset = offset_; }
+
+  /* called at the MCAS client side */
+  template <typename F>
+  void for_each_key(F f) const
+  {
+    size_t pos = 0;
+    while (pos < _v._value_len) {
+      auto record = common::pointer_cast<const key_record>(&data()[pos]);
+      f(offset_t(record->position), std::string(common::pointer_cast<const char>(record + 1), record->key_len));
+      pos += key_record_size(record->key_len);
+    }
+  }
+
   // fields
   /* The type of the request (to which this is a response) determines the field */
 private:
@@ -813,7 +975,8 @@ struct Message_handshake : public Message {
       : Message(auth_id, (sizeof *this), id, OP_INVALID),
         seq(sequence),
         protocol(PROTOCOL_V1),
-        security_tls_auth(0)
+        security_tls_auth(0),
+        pipelined(0)
   {
   }
 
@@ -823,11 +986,14 @@ struct Message_handshake : public Message {
   uint64_t seq;
   uint8_t  protocol;
   bool security_tls_auth  : 1;
+  bool pipelined          : 1; /* client may have several requests in flight */
   /* add more fields for HMAC, encryption etc. */
 
   inline void set_as_protocol() { protocol = PROTOCOL_V2; }
   inline void set_tls_auth() {  security_tls_auth = true; }
   inline bool is_tls_auth() const { return security_tls_auth; }
+  inline void set_pipelined() { pipelined = true; }
+  inline bool is_pipelined() const { return pipelined; }
 
 } __attribute__((packed));
 
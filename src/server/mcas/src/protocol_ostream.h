@@ -66,6 +66,9 @@ static const std::map<mcas::protocol::OP_TYPE, const char *> op_map{
     {mcas::protocol::OP_GET_RELEASE, "GET_RELEASE"},
     {mcas::protocol::OP_LOCATE, "LOCATE"},
     {mcas::protocol::OP_RELEASE, "RELEASE"},
+    {mcas::protocol::OP_RELEASE_WITH_FLUSH, "RELEASE_WITH_FLUSH"},
+    {mcas::protocol::OP_MULTI_GET, "MULTI_GET"},
+    {mcas::protocol::OP_MULTI_PUT, "MULTI_PUT"},
     {mcas::protocol::OP_INVALID, "N/A"},
 };
 
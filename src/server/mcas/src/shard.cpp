@@ -37,6 +37,7 @@
 #include <unistd.h>
 
 #include <algorithm> /* remove */
+#include <chrono>
 #include <cinttypes>
 #include <cstdlib> /* system */
 
@@ -108,6 +109,8 @@ namespace global
 unsigned debug_level = 0;
 }
 
+thread_local Shard::worker_t *Shard::_current_worker = nullptr;
+
 static std::string default_mm_plugin(const Config_file& /* config_file */,
                                      const std::string& backend,
                                      const boost::optional<std::string>& config_value)
@@ -149,6 +152,12 @@ Shard::Shard(const Config_file &config_file,
     _forced_exit(forced_exit),
     _core(config_file.get_shard_core(shard_index)),
     _max_message_size(0),
+    _handler_msg_budget(config_file.get_shard_handler_msg_budget(shard_index)),
+    _handler_time_budget_us(config_file.get_shard_handler_time_budget_us(shard_index)),
+    _idle_spin_us(config_file.get_shard_idle_spin_us(shard_index)),
+    _ado_spin_us(config_file.get_shard_ado_spin_us(shard_index)),
+    _ado_lock_wait_ms(config_file.get_shard_ado_lock_wait_ms(shard_index)),
+    _ado_threads(config_file.get_shard_ado_threads(shard_index)),
     _i_kvstore(nullptr),
     _i_ado_mgr(nullptr),
     _ado_pool_map(debug_level_),
@@ -160,8 +169,17 @@ Shard::Shard(const Config_file &config_file,
     _spaces_shared{},
     _pending_renames{},
     _tasks{},
+    _workers{},
+    _shard_lock{},
+    _store_lock{},
+    _serialize_store(false),
+    _worker_session_count(0),
+    _next_worker(0),
     _outstanding_work{},
     _failed_async_requests{},
+    _parked_ado_requests{},
+    _parked_ado_count(0),
+    _ado_nap_us(IDLE_NAP_US),
     _ado_path(config_file.get_ado_path() ? *config_file.get_ado_path() : ""),
     _ado_plugins(config_file.get_shard_ado_plugins(shard_index)),
     _ado_params(config_file.get_shard_ado_params(shard_index)),
@@ -186,6 +204,7 @@ Shard::Shard(const Config_file &config_file,
                        debug_level(),
                        config_file.get_shard_ado_cores(shard_index),
                        config_file.get_shard_ado_core_number(shard_index),
+                       config_file.get_shard_worker_cores(shard_index),
                        profile_file_,
                        triggered_profile_))
 {
@@ -197,6 +216,7 @@ void Shard::thread_entry(const std::string& backend,
                          const unsigned     debug_level,
                          const std::string  ado_cores,
                          const float        ado_core_num,
+                         const std::string  worker_cores,
                          const char *const  profile_main_loop_,
                          const bool         triggered_profile_)
 {
@@ -228,6 +248,8 @@ void Shard::thread_entry(const std::string& backend,
       throw;
     }
 
+    start_workers(worker_cores);
+
     common::profiler p(profile_main_loop_, !triggered_profile_);
     main_loop(p);
   }
@@ -241,6 +263,8 @@ void Shard::thread_entry(const std::string& backend,
   /* main_loop sets _thread_exit true, but it will not be called on early failure */
   _thread_exit = true;
 
+  stop_workers();
+
   CPLOG(2, "Shard: %u worker thread exited.", _core);
 }
 
@@ -355,9 +379,7 @@ void Shard::main_loop(common::profiler &pr_)
   static constexpr uint64_t CHECK_CONNECTION_INTERVAL     = 1000;
   static constexpr uint64_t CHECK_CLUSTER_SIGNAL_INTERVAL = 10000;
   static constexpr uint64_t OUTPUT_DEBUG_INTERVAL         = 10000000;
-  static constexpr unsigned SESSIONS_EMPTY_USLEEP         = 50000;
-
-  Connection_handler::action_t action;
+  static constexpr std::chrono::milliseconds SESSIONS_EMPTY_WAIT{50};
 
 #ifdef DEBUG_LIVENESS
   static std::mutex score_board_lock;
@@ -366,6 +388,7 @@ void Shard::main_loop(common::profiler &pr_)
 
   unsigned idle            = 0;
   uint64_t tick alignas(8) = 0;
+  std::chrono::steady_clock::time_point idle_start;
 
   for (; _thread_exit == false; ++idle, ++tick) {
 #ifdef DEBUG_LIVENESS
@@ -393,7 +416,8 @@ void Shard::main_loop(common::profiler &pr_)
       _thread_exit = true;
     }
     else if (_handlers.empty()) { /* if there are no sessions, sleep thread */
-      usleep(SESSIONS_EMPTY_USLEEP);
+      /* wait for a client; returns promptly when one connects */
+      wait_for_new_connection(SESSIONS_EMPTY_WAIT);
       try {
         check_for_new_connections();
       }
@@ -436,137 +460,24 @@ void Shard::main_loop(common::profiler &pr_)
 
       assert(_handlers.size() < 1000);
 
-      /* iterate connection handlers (each connection is a client session) */
-      for (const auto handler : _handlers) {
-
-        /* issue tick, unless we are stalling */
-        auto tick_response = handler->tick();
-
-        if(tick_response == mcas::Connection_handler::TICK_RESPONSE_WAIT_SECURITY) {
-          /* first tick, complete initialization */
-          handler->configure_security(_security.ipaddr(),
-                                      _security.port(),
-                                      _security.cert_path(),
-                                      _security.key_path());
-        }
-        /* Close session, this will occur if the client shuts down (cleanly or
-         * not). Also close sessions in response to SIGINT */
-        else if ((tick_response == mcas::Connection_handler::TICK_RESPONSE_CLOSE) ||
-                 (signals::sigint > 0)) {
-          idle = 0;
-
-          /* close all open pools belonging to session  */
-          CPLOG(1, "Shard: forcing pool closures");
-
-          /* iterate open pool handles, close them and associated ADO processes
-           */
-          auto& pool_set = handler->pool_manager().open_pool_set();
-
-          for (auto &p : pool_set) {
-            auto pool_id = p.first;
-
-            /* close ADO process on pool close */
-            if (ado_enabled()) {
-              {
-                /* decrement reference to ADO proxy, clean up
-                   when zero */
-                auto ado_itf = get_ado_interface(pool_id);
-
-                CPLOG(2, "Shard: check for ADO close ref count=%u", ado_itf->ref_count());
-
-                if (ado_itf->ref_count() == 1) {
-                  ado_itf->shutdown();
-                  _ado_map.remove(ado_itf);
-
-                  if (_i_kvstore->close_pool(pool_id) != S_OK)
-                    throw Logic_exception("failed to close pool");
-                }
-
-                ado_itf->release_ref();
-              }
-
-              _ado_pool_map.release(pool_id);
-            }
-
-            CPLOG(2, "Shard: closed pool handle %lx for connection close request", pool_id);
-          }
-
-          CPLOG(1,"Shard: closing connection %p", common::p_fmt(handler));
+      /* iterate connection handlers (each connection is a client session),
+         starting from a different handler each tick so that no session is
+         always served first */
+      const auto handler_count = _handlers.size();
+      for (std::size_t h = 0; h != handler_count; ++h) {
+        const auto handler = _handlers[(tick + h) % handler_count];
+        if (service_handler(handler, pr_, idle))
           pending_close.push_back(handler);
-        } // TICK_RESPONSE_CLOSE
-
-        /* process ALL deferred actions */
-        int get_pending_iter = 0;
-        while (handler->get_pending_action(action)) {
-          idle = 0;
-          (void)get_pending_iter;
-          assert(get_pending_iter++ < 1000);
-
-          switch (action.op) {
-#if 0
-          case Connection_handler::action_type::ACTION_RELEASE_VALUE_LOCK_EXCLUSIVE:
-            CPLOG(2, "releasing esxclusive value lock (%p)", action.parm);
-            release_locked_value_exclusive(action.parm);
-            release_pending_rename(action.parm);
-            break;
-#endif
-          case Connection_handler::action_type::ACTION_RELEASE_VALUE_LOCK_SHARED:
-            CPLOG(2, "releasing shared value lock (%p)", action.parm);
-            release_locked_value_shared(action.parm);
-            break;
-          default:
-            throw Logic_exception("unexpected action type %d", int(action.op));
-          }
-        }
-
-        /* A process which cannot handle the top queue message due to
-         * lack of resource may throw resource_unavailable, which will
-         * leave the protocol::Message on the queue for later
-         * handling.
-         */
-        try {
-
-          /* collect ONE available messages ; don't collect them ALL, they just keep coming! */
-          if (const protocol::Message *p_msg = handler->peek_pending_msg()) {
-
-            idle = 0;
-            assert(p_msg);
-            /* "split" accepts responsibility for the *preceding* code. Not exactly intuitive. */
-            switch (p_msg->type_id()) {
-            case MSG_TYPE::IO_REQUEST:
-              process_message_IO_request(handler, static_cast<const protocol::Message_IO_request *>(p_msg));
-              break;
-            case MSG_TYPE::ADO_REQUEST:
-              process_ado_request(handler, static_cast<const protocol::Message_ado_request *>(p_msg));
-              break;
-            case MSG_TYPE::PUT_ADO_REQUEST:
-              process_put_ado_request(handler, static_cast<const protocol::Message_put_ado_request *>(p_msg));
-              break;
-            case MSG_TYPE::POOL_REQUEST:
-              process_message_pool_request(handler, static_cast<const protocol::Message_pool_request *>(p_msg));
-              break;
-            case MSG_TYPE::INFO_REQUEST:
-              process_info_request(handler, static_cast<const protocol::Message_INFO_request *>(p_msg), pr_);
-              break;
-            default:
-              throw General_exception("unrecognizable message type");
-            }
-            handler->free_buffer(handler->pop_pending_msg());
-          }
-        }
-        catch (const resource_unavailable &e) {
-          PWRN("%s: short of buffers in 'handler' processing: %s", __func__, e.what());
-        }
-        catch (const std::exception &e) {
-          PWRN("%s: exception in 'handler' processing: %s", __func__, e.what());
-          throw;
-        }
       }  // iteration of handlers
 
       /* handle messages send back from ADO */
       try {
-        if(ado_enabled())
-          process_messages_from_ado();
+        if(ado_enabled()) {
+          if (process_messages_from_ado())
+            idle = 0;
+          if (_parked_ado_count != 0)
+            service_parked_ado_requests();
+        }
       }
       catch (const resource_unavailable &e) {
         PWRN("short of buffers in 'ADO' processing: %s", e.what());
@@ -578,9 +489,12 @@ void Shard::main_loop(common::profiler &pr_)
 
       {
         /* handle tasks */
-        process_tasks(idle);
+        process_tasks(idle, _tasks);
       }
 
+      /* work done: the next ADO wait starts short again */
+      if (idle == 0) _ado_nap_us = IDLE_NAP_US;
+
       /* handle pending close sessions */
       assert(pending_close.size() < 1000);
 
@@ -591,6 +505,8 @@ void Shard::main_loop(common::profiler &pr_)
           CPLOG(2, "Shard: deleting handler (%p)", common::p_fmt(h));
 
           assert(h);
+          drop_parked_ado_requests(h);
+          drop_tasks(_tasks, h);
           delete h;
 
           CPLOG(2, "Shard: #remaining handlers (%lu)", _handlers.size());
@@ -601,6 +517,21 @@ void Shard::main_loop(common::profiler &pr_)
           }
         }
       }
+
+      /* stop spinning once idle for long enough */
+      if (idle_spin_expired(idle, idle_start) && !_handlers.empty()) {
+        try {
+          check_for_new_connections();
+        }
+        catch (const std::exception &e) {
+          PERR("Shard: cannot get new connection: %s", e.what());
+          _thread_exit = true;
+        }
+        if (ado_enabled() && !_outstanding_work.empty())
+          ado_idle_wait();
+        else
+          idle_wait(_handlers);
+      }
     }
   }
 
@@ -611,6 +542,363 @@ void Shard::main_loop(common::profiler &pr_)
   CPLOG(1, "Shard: shard (%p) exited", common::p_fmt(this));
 }
 
+bool Shard::idle_spin_expired(unsigned idle, std::chrono::steady_clock::time_point &idle_start) const
+{
+  /* reading the clock on every loop would be wasteful; sample it */
+  static constexpr unsigned IDLE_CLOCK_INTERVAL = 1024;
+
+  static const std::chrono::steady_clock::time_point EXPIRED{};
+
+  if (idle == 0) return false;
+  if (idle == 1) {
+    idle_start = std::chrono::steady_clock::now();
+    return false;
+  }
+  /* once expired, stay expired (until the next work) without reading the clock again */
+  if (idle_start == EXPIRED) return true;
+  if (idle % IDLE_CLOCK_INTERVAL != 0 ||
+      std::chrono::steady_clock::now() - idle_start < std::chrono::microseconds(_idle_spin_us))
+    return false;
+  idle_start = EXPIRED;
+  return true;
+}
+
+void Shard::idle_wait(const std::vector<Connection_handler *> &handlers)
+{
+  /* Block on the completion queues of all the sessions together, and on
+   * new connections. The wait is bounded so that work which arrives
+   * without a completion (cluster signals, sessions handed to a worker)
+   * is still seen.
+   */
+  try {
+    wait_for_activity(handlers, std::chrono::milliseconds(IDLE_WAIT_MS));
+  }
+  catch (const std::exception &e) {
+    /* a failing connection is detected and closed by its next tick */
+    CPLOG(2, "Shard: idle wait: %s", e.what());
+  }
+}
+
+void Shard::ado_idle_wait()
+{
+  /* While an ADO invocation is outstanding its completion, or a callback
+   * made by it, is the likeliest next event, so block on that ADO's
+   * doorbell. The sessions are not watched meanwhile, so the wait starts
+   * at a nap's length and doubles, up to IDLE_WAIT_MS, for as long as the
+   * shard stays idle: a prompt ADO is served promptly, and a slow one
+   * costs few wakeups.
+   */
+  auto request_record = request_key_to_record(*_outstanding_work.begin());
+  auto ado            = request_record ? _ado_pool_map.get_proxy(request_record->pool) : nullptr;
+  if (ado)
+    ado->wait_for_messages(_ado_nap_us);
+  else
+    usleep(_ado_nap_us);
+  _ado_nap_us = std::min(_ado_nap_us * 2, IDLE_WAIT_MS * 1000);
+}
+
+/**
+ * Tick a connection handler and process its queued messages, up to the
+ * per-handler budget. Returns true if the session is closing.
+ */
+bool Shard::service_handler(Connection_handler *handler, common::profiler &pr_, unsigned &idle)
+{
+  using namespace mcas::protocol;
+
+  Connection_handler::action_t action;
+  const auto budget_start = _handler_time_budget_us ? std::chrono::steady_clock::now()
+                                                    : std::chrono::steady_clock::time_point();
+
+  /* Service the handler for up to _handler_msg_budget messages (and
+   * _handler_time_budget_us, if set), so that a pipelining client can
+   * drain its queue rather than getting one message per loop.
+   */
+  bool closing = false;
+  for (unsigned budget = _handler_msg_budget; budget != 0; --budget) {
+    bool msg_done = false;
+
+    /* issue tick, unless we are stalling */
+    auto tick_response = handler->tick();
+
+    /* in worker mode, a store which is not thread safe is shared with the
+       other workers; shard tables are guarded separately (table_guard) */
+    auto g = store_guard();
+
+    if(tick_response == mcas::Connection_handler::TICK_RESPONSE_WAIT_SECURITY) {
+      /* first tick, complete initialization */
+      handler->configure_security(_security.ipaddr(),
+                                  _security.port(),
+                                  _security.cert_path(),
+                                  _security.key_path());
+    }
+    /* Close session, this will occur if the client shuts down (cleanly or
+     * not). Also close sessions in response to SIGINT */
+    else if ((tick_response == mcas::Connection_handler::TICK_RESPONSE_CLOSE) ||
+             (signals::sigint > 0)) {
+      idle = 0;
+
+      /* close all open pools belonging to session  */
+      CPLOG(1, "Shard: forcing pool closures");
+
+      /* iterate open pool handles, close them and associated ADO processes
+       */
+      auto& pool_set = handler->pool_manager().open_pool_set();
+
+      for (auto &p : pool_set) {
+        auto pool_id = p.first;
+
+        /* close ADO process on pool close */
+        if (ado_enabled()) {
+          {
+            /* decrement reference to ADO proxy, clean up
+               when zero */
+            auto ado_itf = get_ado_interface(pool_id);
+
+            CPLOG(2, "Shard: check for ADO close ref count=%u", ado_itf->ref_count());
+
+            if (ado_itf->ref_count() == 1) {
+              ado_itf->shutdown();
+              _ado_map.remove(ado_itf);
+
+              if (_i_kvstore->close_pool(pool_id) != S_OK)
+                throw Logic_exception("failed to close pool");
+            }
+
+            ado_itf->release_ref();
+          }
+
+          _ado_pool_map.release(pool_id);
+        }
+
+        CPLOG(2, "Shard: closed pool handle %lx for connection close request", pool_id);
+      }
+
+      CPLOG(1,"Shard: closing connection %p", common::p_fmt(handler));
+      closing = true;
+    } // TICK_RESPONSE_CLOSE
+
+    /* process ALL deferred actions */
+    int get_pending_iter = 0;
+    while (handler->get_pending_action(action)) {
+      idle = 0;
+      (void)get_pending_iter;
+      assert(get_pending_iter++ < 1000);
+
+      switch (action.op) {
+#if 0
+      case Connection_handler::action_type::ACTION_RELEASE_VALUE_LOCK_EXCLUSIVE:
+        CPLOG(2, "releasing esxclusive value lock (%p)", action.parm);
+        release_locked_value_exclusive(action.parm);
+        release_pending_rename(action.parm);
+        break;
+#endif
+      case Connection_handler::action_type::ACTION_RELEASE_VALUE_LOCK_SHARED:
+        CPLOG(2, "releasing shared value lock (%p)", action.parm);
+        release_locked_value_shared(action.parm);
+        break;
+      default:
+        throw Logic_exception("unexpected action type %d", int(action.op));
+      }
+    }
+
+    /* A process which cannot handle the top queue message due to
+     * lack of resource may throw resource_unavailable, which will
+     * leave the protocol::Message on the queue for later
+     * handling.
+     */
+    try {
+
+      /* collect ONE available message per round; the budget bounds the rounds */
+      if (const protocol::Message *p_msg = handler->peek_pending_msg()) {
+
+        idle = 0;
+        assert(p_msg);
+        /* "split" accepts responsibility for the *preceding* code. Not exactly intuitive. */
+        switch (p_msg->type_id()) {
+        case MSG_TYPE::IO_REQUEST:
+          process_message_IO_request(handler, static_cast<const protocol::Message_IO_request *>(p_msg));
+          break;
+        case MSG_TYPE::ADO_REQUEST:
+          process_ado_request(handler, static_cast<const protocol::Message_ado_request *>(p_msg));
+          break;
+        case MSG_TYPE::PUT_ADO_REQUEST:
+          process_put_ado_request(handler, static_cast<const protocol::Message_put_ado_request *>(p_msg));
+          break;
+        case MSG_TYPE::POOL_REQUEST:
+          process_message_pool_request(handler, static_cast<const protocol::Message_pool_request *>(p_msg));
+          break;
+        case MSG_TYPE::INFO_REQUEST:
+          process_info_request(handler, static_cast<const protocol::Message_INFO_request *>(p_msg), pr_);
+          break;
+        default:
+          throw General_exception("unrecognizable message type");
+        }
+        handler->free_buffer(handler->pop_pending_msg());
+        msg_done = true;
+      }
+    }
+    catch (const resource_unavailable &e) {
+      PWRN("%s: short of buffers in 'handler' processing: %s", __func__, e.what());
+    }
+    catch (const std::exception &e) {
+      PWRN("%s: exception in 'handler' processing: %s", __func__, e.what());
+      throw;
+    }
+
+    if (!msg_done || closing || tick_response != mcas::Connection_handler::TICK_RESPONSE_CONTINUE)
+      break;
+
+    if (_handler_time_budget_us &&
+        std::chrono::steady_clock::now() - budget_start >= std::chrono::microseconds(_handler_time_budget_us))
+      break;
+  }  // handler budget
+
+  return closing;
+}
+
+void Shard::start_workers(const std::string &worker_cores)
+{
+  if (worker_cores.empty()) return;
+
+  /* ADO responses and signals are sent from the shard thread, which would
+     race with a worker polling the same connection. Worker mode is
+     therefore refused, not emulated, when an ADO is configured. */
+  if (ado_enabled()) {
+    PWRN("Shard: %s ignored; worker mode is not supported with ADO", config::worker_cores);
+    return;
+  }
+
+  /* Workers call the store concurrently only if it allows that; otherwise
+     only the store calls are serialized, and the network work (polling,
+     receive, send) still runs in parallel. */
+  _serialize_store = _i_kvstore->thread_safety() != component::IKVStore::THREAD_MODEL_MULTI_PER_POOL;
+  if (_serialize_store)
+    PWRN("Shard: store is not multi-thread safe per pool; %s serializes store calls", config::worker_cores);
+
+  cpu_mask_t mask;
+  if (string_to_mask(worker_cores, mask) != S_OK || !mask.is_something_set())
+    throw Config_exception("bad %s value (%s)", config::worker_cores, worker_cores.c_str());
+
+  for (unsigned core = 0; core < CPU_SETSIZE; ++core) {
+    if (mask.check_core(core)) {
+      _workers.emplace_back(std::make_unique<worker_t>());
+      _workers.back()->core = core;
+    }
+  }
+
+  /* start threads only once the worker set is complete; it does not change after this */
+  for (auto &w : _workers) {
+    w->thread = std::thread(&Shard::worker_loop, this, w.get());
+  }
+
+  CPLOG(1, "Shard: started %zu workers (%s)", _workers.size(), worker_cores.c_str());
+}
+
+void Shard::stop_workers()
+{
+  _thread_exit = true;
+
+  for (auto &w : _workers) {
+    if (w->thread.joinable()) w->thread.join();
+  }
+}
+
+void Shard::worker_loop(worker_t *worker)
+{
+  std::ostringstream ss;
+  ss << "shard-" << _core << "-w" << worker->core;
+  pthread_setname_np(pthread_self(), ss.str().c_str());
+
+  cpu_mask_t mask;
+  mask.add_core(worker->core);
+  if (set_cpu_affinity_mask(mask) == -1) {
+    PLOG("%s: bad mask parameter", __FILE__);
+  }
+
+  static constexpr unsigned SESSIONS_EMPTY_USLEEP = 1000;
+
+  /* deferred tasks raised by this thread go to the worker's own list */
+  _current_worker = worker;
+
+  /* triggered profiling is a shard thread facility */
+  common::profiler pr(nullptr, false);
+  auto &handlers = worker->handlers;
+
+  std::chrono::steady_clock::time_point idle_start;
+
+  try {
+    for (unsigned idle = 0, tick = 0; _thread_exit == false; ++idle, ++tick) {
+
+      {
+        std::lock_guard<std::mutex> g(worker->incoming_lock);
+        handlers.insert(handlers.end(), worker->incoming.begin(), worker->incoming.end());
+        worker->incoming.clear();
+      }
+
+      if (handlers.empty()) {
+        usleep(SESSIONS_EMPTY_USLEEP);
+        continue;
+      }
+
+      std::vector<Connection_handler *> pending_close;
+
+      const auto handler_count = handlers.size();
+      for (std::size_t h = 0; h != handler_count; ++h) {
+        const auto handler = handlers[(tick + h) % handler_count];
+        if (service_handler(handler, pr, idle))
+          pending_close.push_back(handler);
+      }
+
+      _stats.client_count = boost::numeric_cast<uint16_t>(_worker_session_count.load());
+      process_tasks(idle, worker->tasks);
+
+      for (auto &h : pending_close) {
+        handlers.erase(std::remove(handlers.begin(), handlers.end(), h), handlers.end());
+        CPLOG(2, "Shard: worker %u deleting handler (%p)", worker->core, common::p_fmt(h));
+
+        drop_tasks(worker->tasks, h);
+        delete h;
+
+        if (--_worker_session_count == 0 && _forced_exit) {
+          CPLOG(1, "Shard: forcing exit..");
+          _thread_exit = true;
+        }
+      }
+
+      if (idle_spin_expired(idle, idle_start) && !handlers.empty())
+        idle_wait(handlers);
+    }
+  }
+  catch (const General_exception &e) {
+    PERR("Shard worker %u execution failed: %s.", worker->core, e.cause());
+    _thread_exit = true;
+  }
+  catch (const std::exception &e) {
+    PERR("Shard worker %u execution failed: %s.", worker->core, e.what());
+    _thread_exit = true;
+  }
+
+  /* release the sessions still owned by the worker, including any handed
+     over but not yet collected */
+  {
+    std::lock_guard<std::mutex> g(worker->incoming_lock);
+    handlers.insert(handlers.end(), worker->incoming.begin(), worker->incoming.end());
+    worker->incoming.clear();
+  }
+
+  for (auto t : worker->tasks) delete t;
+  worker->tasks.clear();
+
+  for (auto h : handlers) {
+    CPLOG(2, "Shard: worker %u deleting handler (%p) on exit", worker->core, common::p_fmt(h));
+    delete h;
+    --_worker_session_count;
+  }
+  handlers.clear();
+
+  _current_worker = nullptr;
+}
+
 void Shard::process_message_pool_request(Connection_handler *handler,
                                          const protocol::Message_pool_request *msg)
 {
@@ -619,8 +907,11 @@ void Shard::process_message_pool_request(Connection_handler *handler,
   // validate auth id
   assert(msg->op());
 
+  /* pool open/close/delete must not interleave across workers */
+  auto g = table_guard();
+
   /* allocate response buffer */
-  auto response_iob = handler->allocate_send();
+  auto response_iob = handler->allocate_send(sizeof(protocol::Message_pool_response));
   assert(response_iob);
   assert(response_iob->base());
   memset(response_iob->iov->iov_base, 0, response_iob->iov->iov_len);
@@ -874,6 +1165,7 @@ void Shard::add_locked_value_shared(const pool_t                         pool_id
                                     size_t                               target_len,
                                     memory_registered<Connection_base> &&mr)
 {
+  auto g = table_guard();
   auto it = _locked_values_shared.emplace(std::piecewise_construct, std::forward_as_tuple(target),
                                           std::forward_as_tuple(pool_id, key, target_len, std::move(mr)));
   ++it.first->second.count;
@@ -885,6 +1177,7 @@ void Shard::add_locked_value_exclusive(const pool_t                         pool
                                        size_t                               target_len,
                                        memory_registered<Connection_base> &&mr)
 {
+  auto g = table_guard();
   auto it = _locked_values_exclusive.emplace(std::piecewise_construct, std::forward_as_tuple(target),
                                              std::forward_as_tuple(pool_id, key, target_len, std::move(mr)));
   ++it.first->second.count;
@@ -892,6 +1185,7 @@ void Shard::add_locked_value_exclusive(const pool_t                         pool
 
 void Shard::release_locked_value_shared(const void *target)
 {
+  auto g = table_guard();
   auto i = _locked_values_shared.find(target); /* search by target address */
   if (i == _locked_values_shared.end())
     throw Logic_exception("%s: bad target; value never locked? (%p)", __func__, target);
@@ -908,6 +1202,7 @@ void Shard::release_locked_value_shared(const void *target)
 
 void Shard::release_locked_value_exclusive(const void *target)
 {
+  auto g = table_guard();
   auto i = _locked_values_exclusive.find(target); /* search by target address */
   if (i == _locked_values_exclusive.end())
     throw Logic_exception("%s bad target; value never locked? (%p)", __func__, target);
@@ -924,6 +1219,7 @@ void Shard::release_locked_value_exclusive(const void *target)
 
 void Shard::add_space_shared(const range<std::uint64_t> &range_, memory_registered<Connection_base> &&mr_)
 {
+  auto g = table_guard();
   auto i = _spaces_shared
     .emplace(std::piecewise_construct, std::forward_as_tuple(range_), std::forward_as_tuple(std::move(mr_)))
     .first;
@@ -935,6 +1231,7 @@ void Shard::add_space_shared(const range<std::uint64_t> &range_, memory_register
 
 void Shard::release_space_shared(const range<std::uint64_t> &range_)
 {
+  auto g = table_guard();
   auto i = _spaces_shared.find(range_); /* search by max offset */
   if (i == _spaces_shared.end()) {
     throw Logic_exception("%s: bad target; space never located? (%" PRIx64 ":%" PRIx64 ")", __func__, range_.first,
@@ -953,6 +1250,7 @@ void Shard::release_space_shared(const range<std::uint64_t> &range_)
 /* note, target address is used because it is unique for the shard */
 void Shard::add_pending_rename(const pool_t pool_id, const void *target, const std::string &from, const std::string &to)
 {
+  auto g = table_guard();
   CPLOG(2, "added pending rename %p %s->%s", target, from.c_str(), to.c_str());
 
   assert(_pending_renames.find(target) == _pending_renames.end());
@@ -999,7 +1297,10 @@ bool is_locked(status_t rc)
 void Shard::release_pending_rename(const void *target)
 {
   try {
-    auto info = _pending_renames.at(target);
+    const auto info = [this, target] {
+      auto g = table_guard();
+      return _pending_renames.at(target);
+    }();
 
     CPLOG(2, "renaming (%s) to (%s)", info.from.c_str(), info.to.c_str());
 
@@ -1023,7 +1324,10 @@ void Shard::release_pending_rename(const void *target)
     if (_i_kvstore->erase(info.pool, info.from) != S_OK)
       throw Logic_exception("%s erase failed", __func__);
 
-    _pending_renames.erase(target);
+    {
+      auto g = table_guard();
+      _pending_renames.erase(target);
+    }
 
     /* now make available in the index */
     add_index_key(info.pool, info.to);
@@ -1460,11 +1764,12 @@ void Shard::io_response_get(Connection_handler *handler, const protocol::Message
     if ( ! ado_signal_post_get() )
     {
       auto response = prepare_response(handler, iob, msg->request_id(), S_OK);
-      /* Maximum possible size for buffer */
-      std::size_t data_len = GET_DIRECT_THRESHOLD;
+      /* Maximum possible size for buffer: the response buffer starts small */
+      const std::size_t space = std::min(GET_DIRECT_THRESHOLD, iob->original_length() - response->base_message_size());
+      std::size_t data_len = space;
       status_t rc = _i_kvstore->get_direct(msg->pool_id(), k, response->data(), data_len);
        /* If got the whole value */
-      if ( rc == S_OK && data_len <= GET_DIRECT_THRESHOLD )
+      if ( rc == S_OK && data_len <= space )
       {
         /* value can fit in message buffer, copy */
         CPLOG(2, "Shard: performing memcpy for very small get");
@@ -1546,6 +1851,13 @@ void Shard::io_response_get(Connection_handler *handler, const protocol::Message
                      true /* special 'get' response */);
         }
         else {
+          const auto response_len = sizeof(protocol::Message_IO_response) + value_out.iov_len;
+          if ( iob->original_length() < response_len )
+          {
+            /* exchange the (unposted) small response buffer for one which holds the value */
+            handler->free_buffer(iob);
+            iob = handler->allocate_send(response_len);
+          }
           auto response = prepare_response(handler, iob, msg->request_id(), S_OK);
           response->copy_in_data(value_out.iov_base, value_out.iov_len);
           iob->set_length(response->msg_len());
@@ -1656,6 +1968,77 @@ void Shard::io_response_erase(Connection_handler *handler, const protocol::Messa
   respond(handler, iob, msg, status, __func__);
 }
 
+/////////////////////////////////////////////////////////////////////////////
+//   MULTI GET     //
+/////////////////////
+void Shard::io_response_multi_get(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob)
+{
+  CPLOG(2, "MULTI_GET: (%p) (request=%lu) count=%zu", common::p_fmt(this), msg->request_id(), msg->multi_record_count());
+
+  /* post-get ADO signalling is per-key and responds to the client itself */
+  if (ado_signal_post_get()) {
+    respond(handler, iob, msg, E_NOT_SUPPORTED, __func__);
+    return;
+  }
+
+  auto response = prepare_response(handler, iob, msg->request_id(), S_OK);
+  bool full     = false;
+
+  /* values are copied straight into the response; results stop at the
+     first one that no longer fits and the client re-issues the rest */
+  msg->for_each_multi_record([&](const uint8_t *key, size_t key_len, const uint8_t *, size_t) {
+    if (full) return;
+
+    std::string k(reinterpret_cast<const char *>(key), key_len);
+    size_t      value_len = response->multi_result_space(iob->length());
+    status_t    rc        = value_len ? _i_kvstore->get_direct(msg->pool_id(), k, response->multi_result_value(), value_len)
+                                      : E_INSUFFICIENT_BUFFER;
+    if (rc != S_OK) {
+      value_len = 0;
+      ++_stats.op_failed_request_count;
+    }
+
+    full = !response->append_multi_result(iob->length(), rc, value_len);
+    if (!full) ++_stats.op_get_count;
+  });
+
+  iob->set_length(response->msg_len());
+  handler->post_response(iob, response, __func__);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//   MULTI PUT     //
+/////////////////////
+void Shard::io_response_multi_put(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob)
+{
+  CPLOG(2, "MULTI_PUT: (%p) (request=%lu) count=%zu", common::p_fmt(this), msg->request_id(), msg->multi_record_count());
+
+  /* post-put ADO signalling is per-key and responds to the client itself */
+  if (ado_signal_post_put()) {
+    respond(handler, iob, msg, E_NOT_SUPPORTED, __func__);
+    return;
+  }
+
+  auto response = prepare_response(handler, iob, msg->request_id(), S_OK);
+
+  msg->for_each_multi_record([&](const uint8_t *key, size_t key_len, const uint8_t *value, size_t value_len) {
+    std::string k(reinterpret_cast<const char *>(key), key_len);
+    status_t    rc = _i_kvstore->put(msg->pool_id(), k, value, value_len, msg->flags());
+
+    if (rc == S_OK)
+      add_index_key(msg->pool_id(), k);
+    else
+      ++_stats.op_failed_request_count;
+
+    /* one fixed-size result per record always fits: records are larger */
+    response->append_multi_result(iob->length(), rc, 0);
+    ++_stats.op_put_count;
+  });
+
+  iob->set_length(response->msg_len());
+  handler->post_response(iob, response, __func__);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //   CONFIGURE     //
 /////////////////////
@@ -1665,12 +2048,32 @@ void Shard::io_response_configure(Connection_handler *handler, const protocol::M
   respond(handler, iob, msg, process_configure(msg), __func__);
 }
 
+namespace
+{
+/* Initial response buffer length for an IO op. Only locate and the multi
+ * ops build long responses in place; the rest are a bare header, or (GET)
+ * a header and a small value. A GET whose value turns out to be larger
+ * exchanges its buffer before copying the value in.
+ */
+std::size_t io_response_buffer_len(const protocol::OP_TYPE op)
+{
+  switch (op) {
+  case protocol::OP_LOCATE:
+  case protocol::OP_MULTI_GET:
+  case protocol::OP_MULTI_PUT:
+    return Buffer_manager<component::IFabric_memory_control>::BUFFER_LEN;
+  default:
+    return sizeof(protocol::Message_IO_response);
+  }
+}
+}  // namespace
+
 void Shard::process_message_IO_request(Connection_handler *handler, const protocol::Message_IO_request *msg)
   try {
     handler->msg_recv_log(msg, __func__);
     using namespace component;
 
-    const auto iob = handler->allocate_send();
+    const auto iob = handler->allocate_send(io_response_buffer_len(msg->op()));
     assert(iob);
 
     ++_stats.op_request_count;
@@ -1705,6 +2108,12 @@ void Shard::process_message_IO_request(Connection_handler *handler, const protoc
     case protocol::OP_ERASE:
       io_response_erase(handler, msg, iob);
       break;
+    case protocol::OP_MULTI_GET:
+      io_response_multi_get(handler, msg, iob);
+      break;
+    case protocol::OP_MULTI_PUT:
+      io_response_multi_put(handler, msg, iob);
+      break;
     case protocol::OP_CONFIGURE:
       io_response_configure(handler, msg, iob);
       break;
@@ -1933,13 +2342,16 @@ void Shard::process_info_request(Connection_handler *handler, const protocol::Me
 {
   handler->msg_recv_log(msg, __func__);
 
-  if (msg->type() == protocol::INFO_TYPE_FIND_KEY) {
-    CPLOG(1, "Shard: INFO request INFO_TYPE_FIND_KEY (%s)", msg->c_str());
+  if (msg->type() == protocol::INFO_TYPE_FIND_KEY || msg->type() == protocol::INFO_TYPE_FIND_KEYS) {
+    CPLOG(1, "Shard: INFO request INFO_TYPE_FIND_KEY%s (%s)",
+          msg->type() == protocol::INFO_TYPE_FIND_KEYS ? "S" : "", msg->c_str());
+
+    auto g = table_guard(); /* the index map is shared by the workers */
 
     if (_index_map == nullptr) { /* index does not exist */
       PLOG("Shard: cannot perform regex request, no index!! use "
            "configure('AddIndex::VolatileTree') or similar for dynamic loading ");
-      const auto                       iob      = handler->allocate_send();
+      const auto                       iob      = handler->allocate_send(sizeof(protocol::Message_INFO_response));
       protocol::Message_INFO_response *response = new (iob->base()) protocol::Message_INFO_response(handler->auth_id());
 
       response->set_status(E_INVAL);
@@ -1948,14 +2360,27 @@ void Shard::process_info_request(Connection_handler *handler, const protocol::Me
     }
 
     try {
-      add_task_list(new Key_find_task(msg->c_str(),
-                                      msg->offset,
-                                      handler,
-                                      _index_map->at(msg->pool_id()).get(),
-                                      debug_level()));
+      if (msg->type() == protocol::INFO_TYPE_FIND_KEYS) {
+        /* batched matches are bounded by count and by the response buffer */
+        const auto max_bytes = handler->IO_buffer_size() - sizeof(protocol::Message_INFO_response) - 1;
+        add_task_list(new Key_find_task(msg->c_str(),
+                                        msg->offset,
+                                        handler,
+                                        _index_map->at(msg->pool_id()).get(),
+                                        debug_level(),
+                                        msg->max_count ? msg->max_count : 1U,
+                                        max_bytes));
+      }
+      else {
+        add_task_list(new Key_find_task(msg->c_str(),
+                                        msg->offset,
+                                        handler,
+                                        _index_map->at(msg->pool_id()).get(),
+                                        debug_level()));
+      }
     }
     catch (...) {
-      const auto                       iob      = handler->allocate_send();
+      const auto                       iob      = handler->allocate_send(sizeof(protocol::Message_INFO_response));
       protocol::Message_INFO_response *response = new (iob->base()) protocol::Message_INFO_response(handler->auth_id());
 
       response->set_status(E_INVAL);
@@ -1973,7 +2398,7 @@ void Shard::process_info_request(Connection_handler *handler, const protocol::Me
 
   /* stats request handler */
   if (msg->type() == protocol::INFO_TYPE_GET_STATS) {
-    protocol::Message_stats *response = new (iob->base()) protocol::Message_stats(handler->auth_id(), _stats);
+    protocol::Message_stats *response = new (iob->base()) protocol::Message_stats(handler->auth_id(), _stats.snapshot());
     response->set_status(S_OK);
     iob->set_length(sizeof(protocol::Message_stats));
 
@@ -2050,15 +2475,19 @@ void Shard::process_info_request(Connection_handler *handler, const protocol::Me
   handler->post_send_buffer(iob, response, __func__);
 }
 
-void Shard::process_tasks(unsigned &idle)
+void Shard::process_tasks(unsigned &idle, task_list_t &tasks)
 {
  retry:
-  for (task_list_t::iterator i = _tasks.begin(); i != _tasks.end(); i++) {
+  for (task_list_t::iterator i = tasks.begin(); i != tasks.end(); i++) {
     auto t = *i;
     assert(t);
+
     idle = 0;
 
-    status_t s = t->do_work();
+    status_t s = [this, t] {
+      auto g = table_guard(); /* the index is shared by the workers */
+      return t->do_work();
+    }();
     if (s != component::IKVStore::S_MORE) {
       auto handler      = t->handler();
       auto response_iob = handler->allocate_send();
@@ -2067,29 +2496,46 @@ void Shard::process_tasks(unsigned &idle)
         new (response_iob->base()) protocol::Message_INFO_response(handler->auth_id());
 
       if (s == S_OK) {
-        response->set_value(response_iob->length(), t->get_result(), t->get_result_length(), t->matched_position());
-#if 0
-        response->offset = t->matched_position();
-#endif
+        if (auto matches = t->get_results()) {
+          for (const auto &m : *matches) {
+            if (!response->append_key(response_iob->length(), m.first, m.second))
+              throw Logic_exception("batched find results exceed response buffer");
+          }
+          response->set_next_offset(t->matched_position());
+        }
+        else {
+          response->set_value(response_iob->length(), t->get_result(), t->get_result_length(), t->matched_position());
+        }
         response->set_status(S_OK);
         response_iob->set_length(response->message_size());
       }
-      else if (s == E_FAIL) {
-        response->set_status(E_FAIL);
-        response_iob->set_length(response->base_message_size());
-      }
       else {
-        throw Logic_exception("unexpected task condition");
+        response->set_status(s);
+        response_iob->set_length(response->base_message_size());
       }
 
       handler->post_send_buffer(response_iob, response, __func__);
-      _tasks.erase(i);
+      delete t;
+      tasks.erase(i);
 
       goto retry;
     }
   }
 }
 
+void Shard::drop_tasks(task_list_t &tasks, const Connection_handler *handler)
+{
+  for (auto i = tasks.begin(); i != tasks.end();) {
+    if ((*i)->handler() == handler) {
+      delete *i;
+      i = tasks.erase(i);
+    }
+    else {
+      ++i;
+    }
+  }
+}
+
 void Shard::check_for_new_connections()
 {
   /* new connections are transferred from the connection handler
@@ -2101,7 +2547,17 @@ void Shard::check_for_new_connections()
     CPLOG(2, "Shard: processing new connection (%p) total %d",
           common::p_fmt(handler), connections);
     connections++;
-    _handlers.push_back(handler);
+
+    if (_workers.empty()) {
+      _handlers.push_back(handler);
+    }
+    else {
+      /* worker mode: hand the session to the next worker, round robin */
+      auto &worker = _workers[_next_worker++ % _workers.size()];
+      std::lock_guard<std::mutex> g(worker->incoming_lock);
+      worker->incoming.push_back(handler);
+      ++_worker_session_count;
+    }
   }
 }
 
@@ -2111,6 +2567,9 @@ status_t Shard::process_configure(const protocol::Message_IO_request *msg)
 
   std::string command(msg->cmd());
 
+  /* the index map is shared by the workers */
+  auto g = table_guard();
+
   /* dynamic loading of secondary index.  loading this
      way (as oppposed to via shard configuration) will
      cause a rebuild by iterating the key space in the main
@@ -31,9 +31,13 @@
 #include <common/string_view.h>
 #include <common/perf/tm_fwd.h>
 
+#include <atomic>
+#include <chrono>
 #include <csignal> /* sig_atomic_t */
+#include <deque>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <map>
 #include <set>
@@ -79,6 +83,12 @@ class Shard : public Shard_transport, private common::log_source {
   static constexpr const char *const _cname = "Shard";
   static constexpr const char *const flush_enable_key = "FLUSH_ENABLE";
 
+  /* idle policy: block on all sessions and new connections for at most
+     IDLE_WAIT_MS; while ADO work is outstanding, block on the ADO's
+     doorbell for a nap which doubles from IDLE_NAP_US up to IDLE_WAIT_MS */
+  static constexpr unsigned IDLE_WAIT_MS = 1;
+  static constexpr unsigned IDLE_NAP_US  = 50;
+
   using byte_span = common::byte_span;
 
  private:
@@ -138,6 +148,19 @@ class Shard : public Shard_transport, private common::log_source {
   using rename_map_t        = std::unordered_map<const void* , rename_info_t>;
   using task_list_t         = std::list<Shard_task* >;
 
+  /* A worker thread servicing a subset of the shard's connection handlers */
+  struct worker_t {
+    unsigned                          core;
+    std::mutex                        incoming_lock;
+    std::vector<Connection_handler *> incoming; /*< handed over by the shard thread, guarded by incoming_lock */
+    std::vector<Connection_handler *> handlers; /*< owned by the worker thread */
+    task_list_t                       tasks;    /*< deferred tasks for the worker's handlers */
+    std::thread                       thread;
+  };
+
+  /* the worker running on this thread; null on the shard thread */
+  static thread_local worker_t *_current_worker;
+
  public:
   using string_view = common::string_view;
 
@@ -174,6 +197,7 @@ class Shard : public Shard_transport, private common::log_source {
                     unsigned           debug_level,
                     const std::string  ado_cores,
                     float              ado_core_number,
+                    const std::string  worker_cores,
                     const char *       profile_main_loop,
                     bool               triggered_profile);
 
@@ -198,15 +222,31 @@ class Shard : public Shard_transport, private common::log_source {
   void release_pending_rename(const void *target);
 
   inline void add_target_keyname(const void *target, const std::string& skey) {
+    auto g = table_guard();
     _target_keyname_map[target] = skey;
   }
 
   inline std::string release_target_keyname(const void *target) {
+    auto g = table_guard();
     auto r = _target_keyname_map[target];
     _target_keyname_map.erase(target);
     return r;
   }
 
+  /* In worker mode, guards the shard tables (locked values, spaces,
+     renames, indexes) which the workers share. No-op otherwise. */
+  std::unique_lock<std::mutex> table_guard()
+  {
+    return _workers.empty() ? std::unique_lock<std::mutex>() : std::unique_lock<std::mutex>(_shard_lock);
+  }
+
+  /* In worker mode, serializes calls into a store which is not thread
+     safe. No-op otherwise. */
+  std::unique_lock<std::mutex> store_guard()
+  {
+    return _serialize_store ? std::unique_lock<std::mutex>(_store_lock) : std::unique_lock<std::mutex>();
+  }
+
 
   void initialize_components(const std::string &backend,
                              const std::string &mm_plugin,
@@ -219,13 +259,34 @@ class Shard : public Shard_transport, private common::log_source {
 
   void main_loop(common::profiler &);
 
+  bool service_handler(Connection_handler *handler, common::profiler &pr, unsigned &idle);
+
+  /* adaptive idle: spin for _idle_spin_us after the last work, then block */
+  bool idle_spin_expired(unsigned idle, std::chrono::steady_clock::time_point &idle_start) const;
+  void idle_wait(const std::vector<Connection_handler *> &handlers);
+  void ado_idle_wait();
+
+  /* worker mode: connection handlers partitioned across worker threads */
+  void start_workers(const std::string &worker_cores);
+  void stop_workers();
+  void worker_loop(worker_t *worker);
+
   /* message processing functions */
   void process_message_pool_request(Connection_handler *handler, const protocol::Message_pool_request *msg);
   void process_message_IO_request(Connection_handler *handler, const protocol::Message_IO_request *msg);
   void process_info_request(Connection_handler *handler, const protocol::Message_INFO_request *msg, common::profiler &pr);
   void process_ado_request(Connection_handler *handler, const protocol::Message_ado_request *msg);
+  status_t launch_ado_request(Connection_handler *handler, const protocol::Message_ado_request *msg);
+  bool park_ado_request(Connection_handler *handler, const protocol::Message_ado_request *msg);
+  void dispatch_parked_ado_requests(component::IKVStore::pool_t pool, const std::string &key);
+  void service_parked_ado_requests();
+  void drop_parked_ado_requests(const Connection_handler *handler);
   void process_put_ado_request(Connection_handler *handler, const protocol::Message_put_ado_request *msg);
-  void process_messages_from_ado();
+  bool process_messages_from_ado();
+  void process_ado_table_op(component::IADO_proxy *                     ado,
+                            Connection_handler *                        handler,
+                            const component::IADO_plugin::table_op_t &  op,
+                            component::IADO_plugin::table_op_result_t &out_result);
   status_t process_configure(const protocol::Message_IO_request *msg);
 
   /* response handling functions */
@@ -237,6 +298,8 @@ class Shard : public Shard_transport, private common::log_source {
   void io_response_put(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
   void io_response_get(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
   void io_response_erase(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
+  void io_response_multi_get(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
+  void io_response_multi_put(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
   void io_response_configure(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
   void io_response_locate(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
   void io_response_release(Connection_handler *handler, const protocol::Message_IO_request *msg, buffer_t *iob);
@@ -244,7 +307,8 @@ class Shard : public Shard_transport, private common::log_source {
 
   void close_all_ado();
 
-  void process_tasks(unsigned &idle);
+  void process_tasks(unsigned &idle, task_list_t &tasks);
+  static void drop_tasks(task_list_t &tasks, const Connection_handler *handler);
 
   void service_cluster_signals();
 
@@ -286,19 +350,22 @@ class Shard : public Shard_transport, private common::log_source {
 
   void add_index_key(const pool_t pool_id, const std::string &k)
   {
+    auto g = table_guard();
     auto index = lookup_index(pool_id);
     if (index) index->insert(k);
   }
 
   void remove_index_key(const pool_t pool_id, const std::string &k)
   {
+    auto g = table_guard();
     auto index = lookup_index(pool_id);
     if (index) index->erase(k);
   }
 
-  inline void add_task_list(Shard_task *task) { _tasks.push_back(task); }
+  /* tasks are kept by the thread which services the requesting handler */
+  inline void add_task_list(Shard_task *task) { (_current_worker ? _current_worker->tasks : _tasks).push_back(task); }
 
-  inline size_t session_count() const { return _handlers.size(); }
+  inline size_t session_count() const { return _workers.empty() ? _handlers.size() : _worker_session_count.load(); }
 
   struct sg_result {
     std::vector<Protocol::Message_IO_response::locate_element> sg_list;
@@ -328,22 +395,54 @@ class Shard : public Shard_transport, private common::log_source {
                                              component::IADO_proxy *&    ado,
                                              pool_desc_t &               desc);
 
-  /* per-shard statistics */
-  component::IMCAS::Shard_stats _stats alignas(8);
+  /* per-shard statistics; counters are updated by every worker */
+  struct shard_counters_t {
+    std::atomic<uint64_t> op_request_count{0};
+    std::atomic<uint64_t> op_put_count{0};
+    std::atomic<uint64_t> op_get_count{0};
+    std::atomic<uint64_t> op_put_direct_count{0};
+    std::atomic<uint64_t> op_get_direct_count{0};
+    std::atomic<uint64_t> op_get_twostage_count{0};
+    std::atomic<uint64_t> op_ado_count{0};
+    std::atomic<uint64_t> op_erase_count{0};
+    std::atomic<uint64_t> op_get_direct_offset_count{0};
+    std::atomic<uint64_t> op_failed_request_count{0};
+    std::atomic<uint64_t> last_op_count_snapshot{0};
+    std::atomic<uint16_t> client_count{0};
+
+    component::IMCAS::Shard_stats snapshot() const
+    {
+      component::IMCAS::Shard_stats s;
+      s.op_request_count           = op_request_count;
+      s.op_put_count               = op_put_count;
+      s.op_get_count               = op_get_count;
+      s.op_put_direct_count        = op_put_direct_count;
+      s.op_get_direct_count        = op_get_direct_count;
+      s.op_get_twostage_count      = op_get_twostage_count;
+      s.op_ado_count               = op_ado_count;
+      s.op_erase_count             = op_erase_count;
+      s.op_get_direct_offset_count = op_get_direct_offset_count;
+      s.op_failed_request_count    = op_failed_request_count;
+      s.last_op_count_snapshot     = last_op_count_snapshot;
+      s.client_count               = client_count;
+      return s;
+    }
+  } _stats;
 
   void dump_stats()
   {
+    const auto stats = _stats.snapshot();
     PINF("------------------------------------------------");
     PINF("| Shard Statistics                             |");
     PINF("------------------------------------------------");
-    PINF("PUT count          : %lu", _stats.op_put_count);
-    PINF("GET count          : %lu", _stats.op_get_count);
-    PINF("PUT_DIRECT count   : %lu", _stats.op_put_direct_count);
-    PINF("GET_DIRECT count   : %lu", _stats.op_get_direct_count);
-    PINF("GET 2-stage count  : %lu", _stats.op_get_twostage_count);
-    PINF("ERASE count        : %lu", _stats.op_erase_count);
-    PINF("ADO count          : %lu (enabled=%s)", _stats.op_ado_count, ado_enabled() ? "yes" : "no");
-    PINF("Failed count       : %lu", _stats.op_failed_request_count);
+    PINF("PUT count          : %lu", stats.op_put_count);
+    PINF("GET count          : %lu", stats.op_get_count);
+    PINF("PUT_DIRECT count   : %lu", stats.op_put_direct_count);
+    PINF("GET_DIRECT count   : %lu", stats.op_get_direct_count);
+    PINF("GET 2-stage count  : %lu", stats.op_get_twostage_count);
+    PINF("ERASE count        : %lu", stats.op_erase_count);
+    PINF("ADO count          : %lu (enabled=%s)", stats.op_ado_count, ado_enabled() ? "yes" : "no");
+    PINF("Failed count       : %lu", stats.op_failed_request_count);
     PINF("Session count      : %lu", session_count());
     PINF("------------------------------------------------");
   }
@@ -397,6 +496,23 @@ class Shard : public Shard_transport, private common::log_source {
 
   } _wr_allocator;
 
+  /* An ADO invocation waiting for its key to be unlocked. The client's
+     message buffer is released once processed, so the message is copied */
+  struct parked_ado_request_t {
+    Connection_handler *                  handler;
+    std::chrono::steady_clock::time_point expiry;
+    std::vector<char>                     msg;
+
+    const protocol::Message_ado_request *request() const
+    {
+      return reinterpret_cast<const protocol::Message_ado_request *>(msg.data());
+    }
+  };
+
+  /* per-key FIFOs of parked invocations, by (pool, key) */
+  using parked_ado_map_t =
+      std::map<std::pair<component::IKVStore::pool_t, std::string>, std::deque<parked_ado_request_t>>;
+
   using ado_pool_map_t =
       std::unordered_map<component::IKVStore::pool_t,
                          std::pair<component::IADO_proxy *, Connection_handler *>>;
@@ -414,10 +530,16 @@ class Shard : public Shard_transport, private common::log_source {
   const std::string                                 _net_addr;
   const unsigned int                                _port;
   std::unique_ptr<index_map_t>                      _index_map; /* depends on _i_kvstore therefore should be cleaned up first */
-  bool                                              _thread_exit;
+  std::atomic<bool>                                 _thread_exit; /*< read by worker threads */
   bool                                              _forced_exit;
   unsigned                                          _core;
   size_t                                            _max_message_size;
+  const unsigned                                    _handler_msg_budget;     /*< max messages per handler per loop */
+  const unsigned                                    _handler_time_budget_us; /*< max time per handler per loop (0: unlimited) */
+  const unsigned                                    _idle_spin_us;           /*< idle time before blocking */
+  const unsigned                                    _ado_spin_us;            /*< ADO process idle time before blocking */
+  const unsigned                                    _ado_lock_wait_ms;       /*< time an ADO invocation waits for a locked key */
+  const unsigned                                    _ado_threads;            /*< ADO process worker threads for invocations */
   component::Itf_ref<component::IKVStore>           _i_kvstore;
   component::Itf_ref<component::IADO_manager_proxy> _i_ado_mgr;    /*< null indicate non-ADO mode */
   Ado_pool_map                                      _ado_pool_map; /*< maps open pool handles to ADO proxy */
@@ -429,8 +551,17 @@ class Shard : public Shard_transport, private common::log_source {
   spaces_shared_map_t                               _spaces_shared;
   rename_map_t                                      _pending_renames;
   task_list_t                                       _tasks; /*< list of deferred tasks */
+  std::vector<std::unique_ptr<worker_t>>            _workers;
+  std::mutex                                        _shard_lock; /*< guards shard tables in worker mode */
+  std::mutex                                        _store_lock; /*< serializes a thread-unsafe store in worker mode */
+  bool                                              _serialize_store;
+  std::atomic<unsigned>                             _worker_session_count;
+  unsigned                                          _next_worker;
   std::set<work_request_key_t>                      _outstanding_work;
   std::vector<work_request_t *>                     _failed_async_requests;
+  parked_ado_map_t                                  _parked_ado_requests;
+  std::size_t                                       _parked_ado_count;
+  unsigned                                          _ado_nap_us; /*< current ADO doorbell wait (see ado_idle_wait) */
   const std::string                                 _ado_path;
   std::vector<std::string>                          _ado_plugins;
   std::map<std::string, std::string>                _ado_params;
@@ -100,6 +100,16 @@ status_t Shard::conditional_bootstrap_ado_process(component::IKVStore*        kv
         args.push_back(ss.str());
       }
 
+      /* add --spin_us option for the ADO process idle policy */
+      args.push_back("--spin_us");
+      args.push_back(std::to_string(_ado_spin_us));
+
+      /* add --threads option for ADO invocation worker threads */
+      if (_ado_threads > 1) {
+        args.push_back("--threads");
+        args.push_back(std::to_string(_ado_threads));
+      }
+
       /* add parameter passing ipaddr */
       std::string net_addr = _net_addr;
       args.push_back("--param");
@@ -366,8 +376,6 @@ void Shard::process_ado_request(Connection_handler* handler,
 
     handler->msg_recv_log(msg, __func__);
 
-    IADO_proxy* ado;
-
     const auto error_func = [&](status_t status, const char* message) {
       auto response_iob = handler->allocate_send();
       auto response     = new (response_iob->base())
@@ -464,66 +472,27 @@ void Shard::process_ado_request(Connection_handler* handler,
       return;  // end of ADO_FLAG_CREATE_ONLY condition
     }
 
-    /*  ADO should already be running */
-    ado = _ado_pool_map.get_proxy(msg->pool_id());
-    assert(ado);
-
-    /* get key-value pair */
-    IKVStore::key_t key_handle = IKVStore::KEY_NONE;
-    const char*     key_ptr    = nullptr;
-    auto            locktype   = IKVStore::STORE_LOCK_NONE;
-    status_t        s          = S_OK;
-
-    /* if this is associated with a key-value pair, we have to lock */
-    if (msg->key_len > 0) {
-      locktype = (msg->flags & IMCAS::ADO_FLAG_READ_ONLY)
-        ? IKVStore::STORE_LOCK_READ : IKVStore::STORE_LOCK_WRITE;
-
-      size_t alignment = 0;
-      s = _i_kvstore->lock(msg->pool_id(),
-                           msg->key(),
-                           locktype,
-                           value,
-                           value_len,
-                           alignment,
-                           key_handle,
-                           &key_ptr);
+    /* an invocation on a key for which others are already waiting joins
+       the back of the queue, so that waiters are dispatched in order */
+    const bool others_waiting =
+      msg->key_len > 0 && _parked_ado_count != 0 &&
+      _parked_ado_requests.count({msg->pool_id(), std::string(msg->key(), msg->get_key_len())}) != 0;
 
-      if (s < S_OK) {
+    const status_t s = others_waiting ? E_LOCKED : launch_ado_request(handler, msg);
+    if (s == E_LOCKED) {
+      if (!park_ado_request(handler, msg)) {
         std::stringstream ss;
         ss << "ADO!ALREADY_LOCKED(" << msg->key() << ")";
         error_func(E_LOCKED, ss.str().c_str());
         if (debug_level() > 1) PWRN("process_ado_request: key already locked");
-        return;
-      }
-
-      if (key_handle == IKVStore::KEY_NONE)
-        throw Logic_exception("lock gave KEY_NONE");
-
-      if ((s == S_OK_CREATED) &&
-          (msg->flags & IMCAS::ADO_FLAG_ZERO_NEW_VALUE)) {
-        CPLOG(2, "Shard_ado: new value memory is being zeroed.");
-        pmem_memset(value, 0, value_len, 0);
       }
-
-      CPLOG(2, "Shard_ado: locked KV pair (value=%p, value_len=%lu)", value, value_len);
     }
-
-    /* register outstanding work */
-    auto wr = _wr_allocator.allocate();
-    *wr     = {handler, msg->pool_id(), key_handle, key_ptr, msg->get_key_len(), locktype, msg->request_id(), msg->flags};
-
-    auto wr_key = reinterpret_cast<work_request_key_t>(wr); /* pointer to uint64_t */
-    _outstanding_work.insert(wr_key);                       /* save request by index on key-handle */
-
-    /* now send the work request */
-    if (ado->send_work_request(wr_key, key_ptr, msg->get_key_len(), value, value_len,
-                               nullptr, /* no payload */
-                               0, msg->request(), msg->request_len(), (s == S_OK_CREATED)) != S_OK)
-      throw General_exception("send_work_request failed");
-
-    CPLOG(2, "Shard_ado: sent work request (len=%lu, key=%lx, key_ptr=%p)",
-          msg->request_len(), wr_key, static_cast<const void*>(key_ptr));
+    else if (s != S_OK) {
+      std::stringstream ss;
+      ss << "ADO!LOCK_FAILED(" << msg->key() << ")";
+      error_func(s, ss.str().c_str());
+      if (debug_level() > 1) PWRN("process_ado_request: key lock failed (%d)", s);
+    }
 
     /* for "asynchronous" calls we don't send a message
        for "synchronous call" we don't send a response to the client
@@ -540,6 +509,207 @@ void Shard::process_ado_request(Connection_handler* handler,
   }
 }
 
+/**
+ * Lock the invocation's key (if any) and send the work request to the
+ * ADO. Returns E_LOCKED, having sent nothing, if the key is locked, or
+ * the store's error if the lock fails otherwise.
+ */
+status_t Shard::launch_ado_request(Connection_handler* handler,
+                                   const protocol::Message_ado_request* msg)
+{
+  using namespace component;
+
+  /*  ADO should already be running */
+  auto ado = _ado_pool_map.get_proxy(msg->pool_id());
+  if (!ado) throw General_exception("ADO is not running");
+
+  /* get key-value pair */
+  IKVStore::key_t key_handle = IKVStore::KEY_NONE;
+  const char*     key_ptr    = nullptr;
+  auto            locktype   = IKVStore::STORE_LOCK_NONE;
+  status_t        s          = S_OK;
+  void*           value      = nullptr;
+  size_t          value_len  = msg->ondemand_val_len;
+
+  /* if this is associated with a key-value pair, we have to lock */
+  if (msg->key_len > 0) {
+    locktype = (msg->flags & IMCAS::ADO_FLAG_READ_ONLY)
+      ? IKVStore::STORE_LOCK_READ : IKVStore::STORE_LOCK_WRITE;
+
+    size_t alignment = 0;
+    s = _i_kvstore->lock(msg->pool_id(),
+                         msg->key(),
+                         locktype,
+                         value,
+                         value_len,
+                         alignment,
+                         key_handle,
+                         &key_ptr);
+
+    if (s < S_OK)
+      return s;
+
+    if (key_handle == IKVStore::KEY_NONE)
+      throw Logic_exception("lock gave KEY_NONE");
+
+    if ((s == S_OK_CREATED) &&
+        (msg->flags & IMCAS::ADO_FLAG_ZERO_NEW_VALUE)) {
+      CPLOG(2, "Shard_ado: new value memory is being zeroed.");
+      pmem_memset(value, 0, value_len, 0);
+    }
+
+    CPLOG(2, "Shard_ado: locked KV pair (value=%p, value_len=%lu)", value, value_len);
+  }
+
+  /* a launch which fails must not leave the key locked */
+  const auto unlock_key = [&] () {
+    if (key_handle != IKVStore::KEY_NONE)
+      _i_kvstore->unlock(msg->pool_id(), key_handle);
+  };
+
+  /* register outstanding work */
+  work_request_t* wr;
+  try {
+    wr = _wr_allocator.allocate();
+  }
+  catch (const std::exception&) {
+    unlock_key();
+    throw;
+  }
+  *wr     = {handler, msg->pool_id(), key_handle, key_ptr, msg->get_key_len(), locktype, msg->request_id(), msg->flags};
+
+  auto wr_key = reinterpret_cast<work_request_key_t>(wr); /* pointer to uint64_t */
+  _outstanding_work.insert(wr_key);                       /* save request by index on key-handle */
+
+  /* now send the work request */
+  if (ado->send_work_request(wr_key, key_ptr, msg->get_key_len(), value, value_len,
+                             nullptr, /* no payload */
+                             0, msg->request(), msg->request_len(), (s == S_OK_CREATED)) != S_OK) {
+    _outstanding_work.erase(wr_key);
+    _wr_allocator.free_wr(wr);
+    unlock_key();
+    throw General_exception("send_work_request failed");
+  }
+
+  CPLOG(2, "Shard_ado: sent work request (len=%lu, key=%lx, key_ptr=%p)",
+        msg->request_len(), wr_key, static_cast<const void*>(key_ptr));
+
+  return S_OK;
+}
+
+/**
+ * Queue an invocation on a locked key until the key is unlocked or the
+ * lock wait (ado_lock_wait_ms) expires. Returns false if it cannot wait.
+ */
+bool Shard::park_ado_request(Connection_handler* handler,
+                             const protocol::Message_ado_request* msg)
+{
+  if (_ado_lock_wait_ms == 0 || _parked_ado_count >= PARKED_ADO_REQUEST_LIMIT)
+    return false;
+
+  auto p = reinterpret_cast<const char*>(msg);
+  auto& queue = _parked_ado_requests[{msg->pool_id(), std::string(msg->key(), msg->get_key_len())}];
+  queue.push_back({handler,
+                   std::chrono::steady_clock::now() + std::chrono::milliseconds(_ado_lock_wait_ms),
+                   std::vector<char>(p, p + msg->message_size())});
+  ++_parked_ado_count;
+
+  CPLOG(2, "Shard_ado: parked invocation on locked key (%.*s) queue=%lu",
+        int(msg->get_key_len()), msg->key(), queue.size());
+  return true;
+}
+
+/**
+ * Launch the invocations waiting on a key, in order, until one finds it
+ * still locked. Those whose wait has expired fail with E_LOCKED, and
+ * those which cannot be launched fail with the error.
+ */
+void Shard::dispatch_parked_ado_requests(component::IKVStore::pool_t pool, const std::string& key)
+{
+  auto it = _parked_ado_requests.find({pool, key});
+  if (it == _parked_ado_requests.end()) return;
+
+  auto& queue = it->second;
+  const auto now = std::chrono::steady_clock::now();
+
+  while (!queue.empty()) {
+    auto& parked = queue.front();
+    auto  msg    = parked.request();
+
+    if (parked.handler->client_connected()) {
+      status_t    s = E_FAIL;
+      std::string text;
+      try {
+        s = launch_ado_request(parked.handler, msg);
+      }
+      catch (const std::exception& e) {
+        PLOG("%s: exception %s", __func__, e.what());
+        text = "ADO!LAUNCH_FAILED(" + key + ")";
+      }
+
+      if (s == E_LOCKED) {
+        if (now < parked.expiry) break;
+
+        CPLOG(1, "%s: lock wait expired for key (%.*s)", __func__, int(msg->get_key_len()), msg->key());
+        text = "ADO!ALREADY_LOCKED(" + key + ")";
+      }
+      else if (s != S_OK && text.empty()) {
+        text = "ADO!LOCK_FAILED(" + key + ")";
+      }
+
+      /* the client waits for a response to every invocation which was not launched */
+      if (s != S_OK) {
+        auto response_iob = parked.handler->allocate_send();
+        auto response     = new (response_iob->base())
+          protocol::Message_ado_response(response_iob->length(), s, parked.handler->auth_id(), msg->request_id());
+        response->append_response(&text[0], uint32_t(text.size()), 0);
+        response_iob->set_length(response->message_size());
+        parked.handler->post_send_buffer(response_iob, response, __func__);
+      }
+    }
+
+    queue.pop_front();
+    --_parked_ado_count;
+  }
+
+  if (queue.empty()) _parked_ado_requests.erase(it);
+}
+
+/**
+ * Retry every key with waiting invocations. Work completions dispatch
+ * their own key at once; this covers locks released by other paths,
+ * and expiry.
+ */
+void Shard::service_parked_ado_requests()
+{
+  for (auto it = _parked_ado_requests.begin(); it != _parked_ado_requests.end();) {
+    auto next = std::next(it);
+    auto pool = it->first.first;
+    auto key  = it->first.second;
+    dispatch_parked_ado_requests(pool, key);
+    it = next;
+  }
+}
+
+/**
+ * Discard the waiting invocations of a closing session
+ */
+void Shard::drop_parked_ado_requests(const Connection_handler* handler)
+{
+  for (auto it = _parked_ado_requests.begin(); it != _parked_ado_requests.end();) {
+    auto& queue = it->second;
+    for (auto q = queue.begin(); q != queue.end();) {
+      if (q->handler == handler) {
+        q = queue.erase(q);
+        --_parked_ado_count;
+      }
+      else
+        ++q;
+    }
+    it = queue.empty() ? _parked_ado_requests.erase(it) : std::next(it);
+  }
+}
+
 void Shard::signal_ado_async_nolock(const char * tag,
                                     Connection_handler* handler,
                                     const uint64_t client_request_id,
@@ -697,14 +867,255 @@ void Shard::close_all_ado()
   }
 }
 
+/**
+ * Perform one table operation requested by the ADO process. The
+ * result is returned to the ADO by the caller, singly or as part of a
+ * batch.
+ *
+ */
+void Shard::process_ado_table_op(component::IADO_proxy*                    ado,
+                                 Connection_handler*                       handler,
+                                 const component::IADO_plugin::table_op_t& top,
+                                 component::IADO_plugin::table_op_result_t& out_result)
+{
+  using namespace component;
+
+  const uint64_t work_id        = top.work_id;
+  const auto&    key            = top.key;
+  size_t         value_len      = top.value_len;
+  const size_t   align_or_flags = top.align_or_flags;
+
+  out_result = IADO_plugin::table_op_result_t{E_FAIL, nullptr, 0, nullptr, nullptr};
+
+  switch (top.op) {
+  case ADO_op::CREATE: {
+    std::vector<uint64_t> val;
+
+    status_t s = _i_kvstore->get_attribute(ado->pool_id(), IKVStore::VALUE_LEN, val, &key);
+
+    if (s != IKVStore::E_KEY_NOT_FOUND) {
+      if (debug_level() > 3)
+        PWRN("Shard_ado: table op CREATE, key-value pair already "
+             "exists");
+
+      if (align_or_flags & IKVStore::FLAGS_CREATE_ONLY) {
+        out_result.status = E_ALREADY_EXISTS;
+        break;
+      }
+    }
+
+    goto open; /* stop compiler complaining about flow through*/
+  }
+  case ADO_op::OPEN:
+    open : {
+      CPLOG(2, "Shard_ado: received table op key create/open (%s, value_len=%lu)",
+            key.c_str(), value_len);
+
+      IKVStore::key_t key_handle;
+      void*           value = nullptr;
+      const char*     key_ptr;
+      size_t          alignment = 0;
+      bool invoke_completion_unlock = !(align_or_flags & IADO_plugin::FLAGS_ADO_LIFETIME_UNLOCK);
+
+      status_t rc = _i_kvstore->lock(ado->pool_id(), key, IKVStore::STORE_LOCK_WRITE, value, value_len,
+                                     alignment, key_handle, &key_ptr);
+
+      if (rc < S_OK || key_handle == nullptr) { /* to fix, store should return error code */
+        CPLOG(2, "Shard_ado: lock on key (%s, value_len=%lu) failed rc=%d",
+              key.c_str(), value_len, rc);
+
+        out_result.status = rc;
+      }
+      else {
+        CPLOG(2, "Shard_ado: locked KV pair (keyhandle=%p, value=%p, len=%lu) invoke_completion_unlock=%d",
+              static_cast<void*>(key_handle), value, value_len, invoke_completion_unlock);
+
+        add_index_key(ado->pool_id(), key);
+
+        /* auto-unlock means we add a deferred unlock that happens after
+           the ado invocation (identified by work_id) has completed. */
+        if (align_or_flags & IADO_plugin::FLAGS_NO_IMPLICIT_UNLOCK) {
+          CPLOG(2, "Shard_ado: locked (%s) without implicit unlock", key.c_str());
+        }
+        else if (invoke_completion_unlock) { /* unlock on ADO invoke completion */
+          status_t err = S_OK;
+          if (work_id == 0) {
+            err = E_INVAL;
+          }
+          else {
+            try {
+              ado->add_deferred_unlock(work_id, key_handle);
+            }
+            catch (const std::range_error&) {
+              PWRN("Shard_ado: too many locks");
+              err = E_MAX_REACHED;
+            }
+          }
+
+          /* nothing would release the lock, so do not keep it */
+          if (err != S_OK) {
+            _i_kvstore->unlock(ado->pool_id(), key_handle);
+            out_result.status = err;
+            break;
+          }
+        }
+        else { /* unlock at ADO process shutdown */
+          ado->add_life_unlock(key_handle);
+        }
+
+        assert(reinterpret_cast<uint64_t>(top.addr) <= 1);
+
+        out_result = IADO_plugin::table_op_result_t{S_OK, value, value_len, key_ptr, key_handle};
+      }
+    } break;
+  case ADO_op::ERASE: {
+    CPLOG(2, "Shard_ado: received table op erase");
+
+    out_result.status = _i_kvstore->erase(ado->pool_id(), key);
+    break;
+  }
+  case ADO_op::VALUE_RESIZE:
+    {
+      /* resize_value can only be performed on keys not already */
+      CPLOG(2, "Shard_ado: received table op resize value (work_id=%p)",
+            reinterpret_cast<const void*>(work_id));
+
+      auto work_item = _outstanding_work.find(work_id);
+
+      if (work_item == _outstanding_work.end()) {
+        out_result.status = E_INVAL;
+        break;
+      }
+
+      /* use the work id to get the key handle */
+      work_request_t* wr = request_key_to_record(work_id);
+      status_t        rc;
+
+      if (!wr) {
+        PWRN("unable to get request from work_id");
+        out_result.status = E_INVAL;
+        break;
+      }
+
+      /* see if this resize is targetting current ADO invoke key */
+      std::string target_key(wr->key_ptr, wr->key_len);
+      bool self_target = (target_key == key);
+      if (self_target) {
+        /* if it is, it will be write locked */
+        if(_i_kvstore->unlock(ado->pool_id(), wr->key_handle) != S_OK)
+          throw Logic_exception("unlocking target key-value for resize_value failed");
+      }
+
+
+      /* perform resize, which will need to take the lock */
+      void*  new_value      = nullptr;
+      size_t new_value_len  = 0;
+
+      rc = _i_kvstore->resize_value(ado->pool_id(),
+                                    key,
+                                    value_len,
+                                    align_or_flags);
+
+      /* if self target, then reapply the lock */
+      if (self_target) {
+        IKVStore::key_t new_key_handle;
+        size_t alignment = 0;
+        if(_i_kvstore->lock(ado->pool_id(),
+                            target_key,
+                            wr->lock_type,
+                            new_value,
+                            new_value_len,
+                            alignment,
+                            new_key_handle) != S_OK)
+          throw General_exception("relock of target key after value resize failed");
+        /* update key handle */
+        wr->key_handle = new_key_handle;
+      }
+      assert(new_value_len > 0);
+
+      out_result = IADO_plugin::table_op_result_t{rc, new_value, new_value_len, nullptr, nullptr};
+
+      CPLOG(1, "Shard_ado: resize_value response (%d) new_value_len=%lu", rc, new_value_len);
+
+      break;
+    }
+  case ADO_op::ALLOCATE_POOL_MEMORY: {
+
+    status_t rc;
+    assert(work_id == 0); /* work request is not needed */
+
+    CPLOG(2, "Shard_ado: calling allocate_pool_memory align_or_flags=%lu size=%lu",
+          align_or_flags, value_len);
+
+    /* provide memory PM and DRAM summary */
+    if (debug_level() > 0)
+      {
+        uint64_t     expected_obj_count = 0;
+        size_t       pool_size          = 0;
+        unsigned int pool_flags         = 0;
+
+        assert(handler);
+        handler->pool_manager().get_pool_info(ado->pool_id(), expected_obj_count, pool_size, pool_flags);
+
+        std::vector<uint64_t> pu_attr;
+        if(_i_kvstore->get_attribute(ado->pool_id(),
+                                     IKVStore::Attribute::PERCENT_USED, pu_attr) == S_OK) {
+          PLOG("Shard_ado: port(%u) '#memory' pool (%s) memory %lu%% used (%luMiB/%luMiB)",
+               _port,
+               ado->pool_name().c_str(),
+               pu_attr[0],
+               REDUCE_MB(pu_attr[0] == 0 ? 0 : pu_attr[0] * pool_size / 100),
+               REDUCE_MB(pool_size));
+        }
+
+        PLOG("Shard_ado: port(%u) '#memory' %s", _port, common::get_DRAM_usage().c_str());
+      }
+
+    void* out_addr = nullptr;
+    rc             = _i_kvstore->allocate_pool_memory(ado->pool_id(), value_len, align_or_flags, out_addr);
+
+    CPLOG(2, "Shard ado: allocated memory at %p from pool_id (%lx)", out_addr, ado->pool_id());
+    CPLOG(2, "Shard_ado: allocate_pool_memory align_or_flags=%lu rc=%d addr=%p",
+          align_or_flags, rc, out_addr);
+
+    out_result.status     = rc;
+    out_result.value_addr = out_addr;
+
+    break;
+  }
+  case ADO_op::FREE_POOL_MEMORY: {
+    assert(work_id == 0); /* work request is not needed */
+
+    if (value_len == 0) {
+      out_result.status = E_INVAL;
+      break;
+    }
+
+    status_t rc = _i_kvstore->free_pool_memory(ado->pool_id(), top.addr, value_len);
+    CPLOG(2, "Shard_ado : allocate_pool_memory free rc=%d", rc);
+
+    if (rc != S_OK) PWRN("Shard_ado: Table operation OP_FREE failed");
+
+    out_result.status = rc;
+
+    break;
+  }
+  default:
+    throw Logic_exception("unknown table op code");
+  }
+}
+
 /**
  * Handle messages coming back from the ADO process.
  *
+ * Returns true if any message was handled.
  */
-void Shard::process_messages_from_ado()
+bool Shard::process_messages_from_ado()
 {
   using namespace component;
 
+  bool active = false;
+
   /* iterate ADO process proxies */
   auto iter = _ado_pool_map.begin();
   while (iter != _ado_pool_map.end()) {
@@ -722,6 +1133,7 @@ void Shard::process_messages_from_ado()
     /* ADO work completion */
     /*---------------------*/
     while (ado->check_work_completions(request_key, response_status, response_buffers)) {
+      active = true;
 
       if (response_status > S_USER0 || response_status < E_ERROR_BASE)
         response_status = E_FAIL;
@@ -745,6 +1157,11 @@ void Shard::process_messages_from_ado()
 
       _outstanding_work.erase(work_item);
 
+      /* invocations waiting for the key are dispatched once it is unlocked */
+      std::string unlocked_key;
+      const bool  dispatch_parked = request_record->key_handle != IKVStore::KEY_NONE && _parked_ado_count != 0;
+      if (dispatch_parked) unlocked_key.assign(request_record->key_ptr, request_record->key_len);
+
       /* unlock the KV pair */
       if (request_record->key_handle != IKVStore::KEY_NONE) {
 
@@ -888,6 +1305,9 @@ void Shard::process_messages_from_ado()
         }
       }
 
+      if (dispatch_parked)
+        dispatch_parked_ado_requests(request_record->pool, unlocked_key);
+
       /* release request record */
       _wr_allocator.free_wr(request_record);
 
@@ -906,235 +1326,37 @@ void Shard::process_messages_from_ado()
     common::epoch_time_t t_begin = 0, t_end = 0;
     component::IKVStore::pool_iterator_t iterator   = nullptr;
     component::IKVStore::key_t           key_handle = nullptr;
+    IADO_plugin::table_op_vector_t       table_ops;
     Buffer_header*                       buffer;
 
     /* process callbacks from ADO */
     while (ado->recv_callback_buffer(buffer) == S_OK) {
+      active = true;
       /*-------------------------*/
       /* handle TABLE OPERATIONS */
       /*-------------------------*/
       if (ado->check_table_ops(buffer, work_id, op, key, value_len, align_or_flags, addr)) {
-        switch (op) {
-        case ADO_op::CREATE: {
-          std::vector<uint64_t> val;
-
-          status_t s = _i_kvstore->get_attribute(ado->pool_id(), IKVStore::VALUE_LEN, val, &key);
-
-          if (s != IKVStore::E_KEY_NOT_FOUND) {
-            if (debug_level() > 3)
-              PWRN("Shard_ado: table op CREATE, key-value pair already "
-                   "exists");
-
-            if (align_or_flags & IKVStore::FLAGS_CREATE_ONLY) {
-              if (ado->send_table_op_response(E_ALREADY_EXISTS, nullptr, 0, nullptr) != S_OK)
-                throw General_exception("send_table_op_response failed");
-              break;
-            }
-          }
-
-          goto open; /* stop compiler complaining about flow through*/
-        }
-        case ADO_op::OPEN:
-          open : {
-            CPLOG(2, "Shard_ado: received table op key create/open (%s, value_len=%lu)",
-                  key.c_str(), value_len);
-
-            IKVStore::key_t key_handle;
-            void*           value = nullptr;
-            const char*     key_ptr;
-            size_t          alignment = 0;
-            bool invoke_completion_unlock = !(align_or_flags & IADO_plugin::FLAGS_ADO_LIFETIME_UNLOCK);
-
-            status_t rc = _i_kvstore->lock(ado->pool_id(), key, IKVStore::STORE_LOCK_WRITE, value, value_len,
-                                           alignment, key_handle, &key_ptr);
-
-            if (rc < S_OK || key_handle == nullptr) { /* to fix, store should return error code */
-              CPLOG(2, "Shard_ado: lock on key (%s, value_len=%lu) failed rc=%d",
-                    key.c_str(), value_len, rc);
-
-              if (ado->send_table_op_response(rc) != S_OK)
-                throw General_exception("send_table_op_response failed");
-            }
-            else {
-              CPLOG(2, "Shard_ado: locked KV pair (keyhandle=%p, value=%p, len=%lu) invoke_completion_unlock=%d",
-                    static_cast<void*>(key_handle), value, value_len, invoke_completion_unlock);
-
-              add_index_key(ado->pool_id(), key);
-
-              /* auto-unlock means we add a deferred unlock that happens after
-                 the ado invocation (identified by work_id) has completed. */
-              if (align_or_flags & IADO_plugin::FLAGS_NO_IMPLICIT_UNLOCK) {
-                CPLOG(2, "Shard_ado: locked (%s) without implicit unlock", key.c_str());
-              }
-              else if (invoke_completion_unlock) { /* unlock on ADO invoke completion */
-                if (work_id == 0) {
-                  if (ado->send_table_op_response(E_INVAL) != S_OK)
-                    throw General_exception("send_table_op_response failed");
-                }
-                else {
-                  try {
-                    ado->add_deferred_unlock(work_id, key_handle);
-                  }
-                  catch (const std::range_error&) {
-                    PWRN("Shard_ado: too many locks");
-                    if (ado->send_table_op_response(E_MAX_REACHED) != S_OK)
-                      throw General_exception("send_table_op_response failed");
-                  }
-                }
-              }
-              else { /* unlock at ADO process shutdown */
-                ado->add_life_unlock(key_handle);
-              }
-
-              assert(reinterpret_cast<uint64_t>(addr) <= 1);
-
-              if (ado->send_table_op_response(S_OK, static_cast<void*>(value), value_len, key_ptr, key_handle) != S_OK)
-                throw General_exception("send_table_op_response failed");
-            }
-          } break;
-        case ADO_op::ERASE: {
-          CPLOG(2, "Shard_ado: received table op erase");
-
-          if (ado->send_table_op_response(_i_kvstore->erase(ado->pool_id(), key)) != S_OK)
-            throw General_exception("send_table_op_response failed");
-          break;
-        }
-        case ADO_op::VALUE_RESIZE:
-          {
-            /* resize_value can only be performed on keys not already */
-            CPLOG(2, "Shard_ado: received table op resize value (work_id=%p)",
-                  reinterpret_cast<const void*>(work_id));
-
-            auto work_item = _outstanding_work.find(work_id);
-
-            if (work_item == _outstanding_work.end()) {
-              if (ado->send_table_op_response(E_INVAL) != S_OK)
-                throw General_exception("send_table_op_response failed");
-              break;
-            }
-
-            /* use the work id to get the key handle */
-            work_request_t* wr = request_key_to_record(work_id);
-            status_t        rc;
-
-            if (!wr) {
-              PWRN("unable to get request from work_id");
-              if (ado->send_table_op_response(E_INVAL) != S_OK)
-                throw General_exception("send_table_op_response failed");
-              break;
-            }
-
-            /* see if this resize is targetting current ADO invoke key */
-            std::string target_key(wr->key_ptr, wr->key_len);
-            bool self_target = (target_key == key);
-            if (self_target) {
-              /* if it is, it will be write locked */
-              if(_i_kvstore->unlock(ado->pool_id(), wr->key_handle) != S_OK)
-                throw Logic_exception("unlocking target key-value for resize_value failed");
-            }
-
-
-            /* perform resize, which will need to take the lock */
-            void*  new_value      = nullptr;
-            size_t new_value_len  = 0;
-
-            rc = _i_kvstore->resize_value(ado->pool_id(),
-                                          key,
-                                          value_len,
-                                          align_or_flags);
-
-            /* if self target, then reapply the lock */
-            if (self_target) {
-              IKVStore::key_t new_key_handle;
-              size_t alignment = 0;
-              if(_i_kvstore->lock(ado->pool_id(),
-                                  target_key,
-                                  wr->lock_type,
-                                  new_value,
-                                  new_value_len,
-                                  alignment,
-                                  new_key_handle) != S_OK)
-                throw General_exception("relock of target key after value resize failed");
-              /* update key handle */
-              wr->key_handle = new_key_handle;
-            }
-            assert(new_value_len > 0);
-
-            if (ado->send_table_op_response(rc, new_value, new_value_len, nullptr) != S_OK)
-              throw General_exception("send_table_op_response failed");
-
-            CPLOG(1, "Shard_ado: resize_value response (%d) new_value_len=%lu", rc, new_value_len);
-
-            break;
-          }
-        case ADO_op::ALLOCATE_POOL_MEMORY: {
-
-          status_t rc;
-          assert(work_id == 0); /* work request is not needed */
-
-          CPLOG(2, "Shard_ado: calling allocate_pool_memory align_or_flags=%lu size=%lu",
-                align_or_flags, value_len);
-
-          /* provide memory PM and DRAM summary */
-          if (debug_level() > 0)
-            {
-              uint64_t     expected_obj_count = 0;
-              size_t       pool_size          = 0;
-              unsigned int pool_flags         = 0;
-
-              assert(handler);
-              handler->pool_manager().get_pool_info(ado->pool_id(), expected_obj_count, pool_size, pool_flags);
-
-              std::vector<uint64_t> pu_attr;
-              if(_i_kvstore->get_attribute(ado->pool_id(),
-                                           IKVStore::Attribute::PERCENT_USED, pu_attr) == S_OK) {
-                PLOG("Shard_ado: port(%u) '#memory' pool (%s) memory %lu%% used (%luMiB/%luMiB)",
-                     _port,
-                     ado->pool_name().c_str(),
-                     pu_attr[0],
-                     REDUCE_MB(pu_attr[0] == 0 ? 0 : pu_attr[0] * pool_size / 100),
-                     REDUCE_MB(pool_size));
-              }
-
-              PLOG("Shard_ado: port(%u) '#memory' %s", _port, common::get_DRAM_usage().c_str());
-            }
-
-          void* out_addr = nullptr;
-          rc             = _i_kvstore->allocate_pool_memory(ado->pool_id(), value_len, align_or_flags, out_addr);
-
-          CPLOG(2, "Shard ado: allocated memory at %p from pool_id (%lx)", out_addr, ado->pool_id());
-          CPLOG(2, "Shard_ado: allocate_pool_memory align_or_flags=%lu rc=%d addr=%p",
-                align_or_flags, rc, out_addr);
-
-          if (ado->send_table_op_response(rc, out_addr) != S_OK)
-            throw General_exception("send_table_op_response failed");
-
-          break;
-        }
-        case ADO_op::FREE_POOL_MEMORY: {
-          assert(work_id == 0); /* work request is not needed */
-
-          if (value_len == 0) {
-            if (ado->send_table_op_response(E_INVAL) != S_OK)
-              throw General_exception("send_table_op_response failed");
-
-            break;
-          }
-
-          status_t rc = _i_kvstore->free_pool_memory(ado->pool_id(), addr, value_len);
-          CPLOG(2, "Shard_ado : allocate_pool_memory free rc=%d", rc);
-
-          if (rc != S_OK) PWRN("Shard_ado: Table operation OP_FREE failed");
-
-          if (ado->send_table_op_response(rc) != S_OK)
-            throw General_exception("send_table_op_response failed");
-
-          break;
-        }
-        default:
-          throw Logic_exception("unknown table op code");
-        }
-        // end of if(check_table_ops..
+        IADO_plugin::table_op_result_t result;
+        process_ado_table_op(ado, handler,
+                             IADO_plugin::table_op_t{op, work_id, key, value_len, align_or_flags, addr},
+                             result);
+
+        if (ado->send_table_op_response(result.status, result.value_addr, result.value_len,
+                                        result.key_ptr, result.key_handle) != S_OK)
+          throw General_exception("send_table_op_response failed");
+      }
+      /*------------------------------*/
+      /* handle TABLE OPERATION BATCH */
+      /*------------------------------*/
+      else if (ado->check_table_op_batch(buffer, table_ops)) {
+        CPLOG(2, "Shard_ado: received table op batch (count=%lu)", table_ops.size());
+
+        IADO_plugin::table_op_result_vector_t results(table_ops.size());
+        for (size_t i = 0; i < table_ops.size(); i++)
+          process_ado_table_op(ado, handler, table_ops[i], results[i]);
+
+        if (ado->send_table_op_batch_response(results) != S_OK)
+          throw General_exception("send_table_op_batch_response failed");
       }
       /*--------------------------*/
       /* handle POOL INFO request */
@@ -1388,6 +1610,8 @@ void Shard::process_messages_from_ado()
       ado->free_callback_buffer(buffer);
     }
   }
+
+  return active;
 }
 
 }  // namespace mcas
@@ -1,6 +1,10 @@
 #ifndef __mcas_SERVER_TASK_H__
 #define __mcas_SERVER_TASK_H__
 
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace mcas
 {
 class Shard_task {
@@ -15,6 +19,11 @@ class Shard_task {
   virtual offset_t    matched_position() const  = 0;
   Connection_handler* handler() const { return _handler; }
 
+  using match_list_t = std::vector<std::pair<offset_t, std::string>>;
+
+  /* batched tasks return a list of results; nullptr for single-result tasks */
+  virtual const match_list_t* get_results() const { return nullptr; }
+
  protected:
   Connection_handler* _handler;
 };
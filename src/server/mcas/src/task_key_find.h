@@ -6,19 +6,23 @@
 #include <unistd.h>
 #include <string>
 
+#include "protocol.h"
 #include "task.h"
 
 namespace mcas
 {
 /**
  * Key search task.  We limit the number of hops we search so as to bound
- * the worst case execution time.
+ * the worst case execution time.  In batched mode (max_matches > 0) the
+ * task collects up to max_matches (position,key) pairs, bounded by
+ * max_bytes of response data, before completing.
  *
  */
 class Key_find_task : public Shard_task,
                       private common::log_source
 {
   static constexpr unsigned MAX_COMPARES_PER_WORK = 5;
+  static constexpr unsigned MAX_MATCHES_PER_WORK  = 32;
 
  public:
 #pragma GCC diagnostic push
@@ -27,16 +31,22 @@ class Key_find_task : public Shard_task,
                 const offset_t offset,
                 Connection_handler* handler,
                 gsl::not_null<component::IKVIndex*> index,
-                const unsigned debug_level)
+                const unsigned debug_level,
+                const unsigned max_matches = 0,
+                const size_t max_bytes = 0)
       : Shard_task(handler),
         log_source(debug_level),
         _offset(offset),
-        _index(index)
+        _index(index),
+        _max_matches(max_matches),
+        _max_bytes(max_bytes),
+        _bytes(0),
+        _matches{}
   {
     using namespace component;
     _index->add_ref();
 
-    CPLOG(1, "offset=%lu", offset);
+    CPLOG(1, "offset=%lu max_matches=%u", offset, max_matches);
     CPLOG(1,"expr: (%s)", expression.c_str());
 
     if (expression == "next:") {
@@ -55,6 +65,10 @@ class Key_find_task : public Shard_task,
       _type = IKVIndex::FIND_TYPE_PREFIX;
       _expr = expression.substr(7);
     }
+    else if (expression.substr(0, 7) == "substr:") {
+      _type = IKVIndex::FIND_TYPE_SUBSTRING;
+      _expr = expression.substr(7);
+    }
     else
       throw Logic_exception("unhandled expression");
 
@@ -68,6 +82,8 @@ class Key_find_task : public Shard_task,
   {
     using namespace component;
 
+    if (_max_matches > 0) return do_work_batch();
+
     status_t hr;
     try {
       hr = _index->find(_expr, _offset, _type, _offset, _out_key, MAX_COMPARES_PER_WORK);
@@ -82,7 +98,8 @@ class Key_find_task : public Shard_task,
       }
       else {
         _out_key.clear();
-        return hr;
+        /* scan ran off the end of the index: no (more) matches */
+        return hr == E_OUT_OF_BOUNDS ? E_FAIL : hr;
       }
     }
     catch (...) {
@@ -92,18 +109,66 @@ class Key_find_task : public Shard_task,
     throw Logic_exception("unexpected code path (hr=%d)", hr);
   }
 
+  const match_list_t* get_results() const override { return _max_matches > 0 ? &_matches : nullptr; }
+
   const void* get_result() const override { return _out_key.data(); }
 
   size_t get_result_length() const override { return _out_key.length(); }
 
+  /* position of match; in batched mode, position to resume a further search from */
   offset_t matched_position() const override { return _offset; }
 
  private:
+  status_t do_work_batch()
+  {
+    using namespace component;
+
+    try {
+      for (unsigned i = 0; i < MAX_MATCHES_PER_WORK; i++) {
+        offset_t    matched_pos = 0;
+        std::string key;
+        status_t    hr = _index->find(_expr, _offset, _type, matched_pos, key, MAX_COMPARES_PER_WORK);
+
+        if (hr == E_MAX_REACHED) {
+          _offset = matched_pos + 1;
+          return IKVStore::S_MORE;
+        }
+
+        if (hr != S_OK) { /* no further matches */
+          if (!_matches.empty()) return S_OK;
+          return hr == E_OUT_OF_BOUNDS ? E_FAIL : hr;
+        }
+
+        auto record_len = protocol::Message_INFO_response::key_record_size(key.size());
+        if (_bytes + record_len > _max_bytes) {
+          /* response full; resume from this match next time */
+          return _matches.empty() ? E_INSUFFICIENT_BUFFER : S_OK;
+        }
+
+        CPLOG(2, "matched: (%s) at %lu", key.c_str(), matched_pos);
+        _matches.emplace_back(matched_pos, std::move(key));
+        _bytes += record_len;
+        _offset = matched_pos + 1;
+
+        if (_matches.size() >= _max_matches) return S_OK;
+      }
+    }
+    catch (...) {
+      return E_FAIL;
+    }
+
+    return IKVStore::S_MORE;
+  }
+
   std::string                             _expr;
   std::string                             _out_key;
   component::IKVIndex::find_t             _type;
   offset_t                                _offset;
   component::Itf_ref<component::IKVIndex> _index;
+  const unsigned                          _max_matches;
+  const size_t                            _max_bytes;
+  size_t                                  _bytes;
+  match_list_t                            _matches;
 };
 
 }  // namespace mcas
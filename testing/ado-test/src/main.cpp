@@ -5,11 +5,13 @@
 #include <common/utils.h> /* KiB, MiB, GiB */
 #include <gtest/gtest.h>
 #include <stdio.h>
+#include <unistd.h> /* usleep */
 #include <boost/program_options.hpp>
 #include <chrono>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>
 
 /**
  * This test program works in collaboration with the 'testing' ADO plugin
@@ -56,7 +58,8 @@ Itf_ref<IMCAS> init(const std::string &server_hostname, int port)
                                              "None",
                                              g_options.device ? string_view(*g_options.device) : string_view(),
                                              g_options.src_addr ? string_view(*g_options.src_addr) : string_view(),
-                                             url.str()));
+                                             url.str(),
+                                             "{\"pipeline\" : true}" /* for PipelinedInvokeAdo */));
 
   if (!mcas) throw Logic_exception("unable to create MCAS client instance");
 
@@ -669,6 +672,289 @@ TEST_F(ADO_test, StressCallbacks)
   ASSERT_OK(mcas->delete_pool(poolname));
 }
 
+TEST_F(ADO_test, TableOps)
+{
+  const std::string poolname = "THIS_IS_A_TEST_POOL";
+  mcas->delete_pool(poolname);
+
+  auto pool = mcas->create_pool(poolname, MiB(1), /* size */
+                                0, /* flags */
+                                100, /* obj count */
+                                IMCAS::Addr{0xBB00000000});
+
+  ASSERT_FALSE(pool == IKVStore::POOL_ERROR);
+
+  std::vector<IMCAS::ADO_response> response;
+
+  ASSERT_OK(mcas->invoke_ado(pool,
+                             "TableOps",
+                             "RUN!TEST-TableOps",
+                             IMCAS::ADO_FLAG_CREATE_ON_DEMAND,
+                             response,
+                             KiB(4)));
+
+  ASSERT_OK(mcas->close_pool(pool));
+
+  ASSERT_OK(mcas->delete_pool(poolname));
+}
+
+TEST_F(ADO_test, TableOpsAsync)
+{
+  const std::string poolname = "THIS_IS_A_TEST_POOL";
+  mcas->delete_pool(poolname);
+
+  auto pool = mcas->create_pool(poolname, MiB(1), /* size */
+                                0, /* flags */
+                                100, /* obj count */
+                                IMCAS::Addr{0xBB00000000});
+
+  ASSERT_FALSE(pool == IKVStore::POOL_ERROR);
+
+  /* TableOps creates the keys which TableOpsAsync opens */
+  std::vector<IMCAS::ADO_response> response;
+
+  ASSERT_OK(mcas->invoke_ado(pool,
+                             "TableOps",
+                             "RUN!TEST-TableOps",
+                             IMCAS::ADO_FLAG_CREATE_ON_DEMAND,
+                             response,
+                             KiB(4)));
+
+  ASSERT_OK(mcas->invoke_ado(pool,
+                             "TableOpsAsync",
+                             "RUN!TEST-TableOpsAsync",
+                             IMCAS::ADO_FLAG_CREATE_ON_DEMAND,
+                             response,
+                             KiB(4)));
+
+  ASSERT_OK(mcas->close_pool(pool));
+
+  ASSERT_OK(mcas->delete_pool(poolname));
+}
+
+TEST_F(ADO_test, TableOpsWait)
+{
+  const std::string poolname = "THIS_IS_A_TEST_POOL";
+  mcas->delete_pool(poolname);
+
+  auto pool = mcas->create_pool(poolname, MiB(1), /* size */
+                                0, /* flags */
+                                100, /* obj count */
+                                IMCAS::Addr{0xBB00000000});
+
+  ASSERT_FALSE(pool == IKVStore::POOL_ERROR);
+
+  std::vector<IMCAS::ADO_response> response;
+
+  ASSERT_OK(mcas->invoke_ado(pool,
+                             "TableOpsWait",
+                             "RUN!TEST-TableOpsWait",
+                             IMCAS::ADO_FLAG_CREATE_ON_DEMAND,
+                             response,
+                             KiB(4)));
+
+  ASSERT_OK(mcas->close_pool(pool));
+
+  ASSERT_OK(mcas->delete_pool(poolname));
+}
+
+namespace
+{
+  /* wait for an asynchronous operation, returning its status */
+  status_t wait_async(IMCAS *m, IMCAS::async_handle_t &handle)
+  {
+    status_t s;
+    while ((s = m->check_async_completion(handle)) == E_BUSY)
+      usleep(1000);
+    return s;
+  }
+}
+
+TEST_F(ADO_test, ParkLockedKey)
+{
+  const std::string poolname = "THIS_IS_A_TEST_POOL";
+  const std::string key = "ParkLockedKey";
+  mcas->delete_pool(poolname);
+
+  auto pool = mcas->create_pool(poolname, MiB(1), /* size */
+                                0, /* flags */
+                                50, /* obj count */
+                                IMCAS::Addr{0xBB00000000});
+
+  ASSERT_FALSE(pool == IKVStore::POOL_ERROR);
+
+  /* hold the key locked for less than the lock wait (ado_lock_wait_ms, default 1s) */
+  std::vector<IMCAS::ADO_response> holder_response;
+  IMCAS::async_handle_t holder = IMCAS::ASYNC_HANDLE_INIT;
+  ASSERT_OK(mcas->async_invoke_ado(pool, key, "RUN!TEST-HoldKey 300",
+                                   IMCAS::ADO_FLAG_CREATE_ON_DEMAND, holder_response, holder, KiB(4)));
+  usleep(50000);
+
+  /* the second invocation waits for the key, and then runs */
+  std::vector<IMCAS::ADO_response> response;
+  const auto start = std::chrono::steady_clock::now();
+  ASSERT_OK(mcas->invoke_ado(pool, key, "RUN!TEST-HoldKey 0",
+                             IMCAS::ADO_FLAG_CREATE_ON_DEMAND, response, KiB(4)));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(150));
+
+  ASSERT_OK(wait_async(mcas.get(), holder));
+
+  ASSERT_OK(mcas->close_pool(pool));
+
+  ASSERT_OK(mcas->delete_pool(poolname));
+}
+
+TEST_F(ADO_test, ParkExpiry)
+{
+  const std::string poolname = "THIS_IS_A_TEST_POOL";
+  const std::string key = "ParkExpiry";
+  mcas->delete_pool(poolname);
+
+  auto pool = mcas->create_pool(poolname, MiB(1), /* size */
+                                0, /* flags */
+                                50, /* obj count */
+                                IMCAS::Addr{0xBB00000000});
+
+  ASSERT_FALSE(pool == IKVStore::POOL_ERROR);
+
+  /* hold the key locked for longer than the lock wait */
+  std::vector<IMCAS::ADO_response> holder_response;
+  IMCAS::async_handle_t holder = IMCAS::ASYNC_HANDLE_INIT;
+  ASSERT_OK(mcas->async_invoke_ado(pool, key, "RUN!TEST-HoldKey 3000",
+                                   IMCAS::ADO_FLAG_CREATE_ON_DEMAND, holder_response, holder, KiB(4)));
+  usleep(50000);
+
+  /* the second invocation waits for the lock wait, and then fails */
+  std::vector<IMCAS::ADO_response> response;
+  const auto start = std::chrono::steady_clock::now();
+  ASSERT_EQ(E_LOCKED, mcas->invoke_ado(pool, key, "RUN!TEST-HoldKey 0",
+                                       IMCAS::ADO_FLAG_CREATE_ON_DEMAND, response, KiB(4)));
+  const auto waited = std::chrono::steady_clock::now() - start;
+  EXPECT_GE(waited, std::chrono::milliseconds(900));
+  EXPECT_LT(waited, std::chrono::milliseconds(2500));
+
+  ASSERT_OK(wait_async(mcas.get(), holder));
+
+  ASSERT_OK(mcas->close_pool(pool));
+
+  ASSERT_OK(mcas->delete_pool(poolname));
+}
+
+TEST_F(ADO_test, ParkOverflow)
+{
+  /* PARKED_ADO_REQUEST_LIMIT in the server's mcas_config.h */
+  const unsigned park_limit = 1024;
+  /* each asynchronous invocation holds two of the client's buffers */
+  const unsigned per_connection = 24;
+  const unsigned connection_count = park_limit / per_connection + 2;
+  const unsigned total = connection_count * per_connection;
+
+  const std::string poolname = "THIS_IS_A_TEST_POOL";
+  const std::string key = "ParkOverflow";
+  mcas->delete_pool(poolname);
+
+  auto pool = mcas->create_pool(poolname, MiB(1), /* size */
+                                0, /* flags */
+                                50, /* obj count */
+                                IMCAS::Addr{0xBB00000000});
+
+  ASSERT_FALSE(pool == IKVStore::POOL_ERROR);
+
+  std::vector<Itf_ref<IMCAS>> clients;
+  std::vector<IMCAS::pool_t> pools;
+  for (unsigned c = 0; c != connection_count; c++) {
+    clients.emplace_back(init(g_options.server, g_options.port));
+    pools.push_back(clients.back()->open_pool(poolname));
+    ASSERT_FALSE(pools.back() == IKVStore::POOL_ERROR);
+  }
+
+  /* hold the key locked for less than the lock wait, so that parked invocations run */
+  std::vector<IMCAS::ADO_response> holder_response;
+  IMCAS::async_handle_t holder = IMCAS::ASYNC_HANDLE_INIT;
+  ASSERT_OK(mcas->async_invoke_ado(pool, key, "RUN!TEST-HoldKey 500",
+                                   IMCAS::ADO_FLAG_CREATE_ON_DEMAND, holder_response, holder, KiB(4)));
+  usleep(50000);
+
+  std::vector<std::vector<IMCAS::ADO_response>> responses(total);
+  std::vector<IMCAS::async_handle_t> handles(total);
+  for (unsigned i = 0; i != total; i++) {
+    const auto c = i % connection_count;
+    ASSERT_OK(clients[c]->async_invoke_ado(pools[c], key, "RUN!TEST-HoldKey 0",
+                                           IMCAS::ADO_FLAG_CREATE_ON_DEMAND, responses[i], handles[i], KiB(4)));
+  }
+
+  /* those beyond the limit fail at once; the others wait and run */
+  unsigned ok = 0;
+  unsigned locked = 0;
+  for (unsigned i = 0; i != total; i++) {
+    const auto s = wait_async(clients[i % connection_count].get(), handles[i]);
+    if (s == S_OK) ok++;
+    else if (s == E_LOCKED) locked++;
+  }
+  ASSERT_OK(wait_async(mcas.get(), holder));
+
+  EXPECT_EQ(total, ok + locked);
+  EXPECT_GE(locked, total - park_limit);
+  EXPECT_LT(0U, ok);
+
+  for (unsigned c = 0; c != connection_count; c++)
+    ASSERT_OK(clients[c]->close_pool(pools[c]));
+  clients.clear();
+
+  ASSERT_OK(mcas->close_pool(pool));
+
+  ASSERT_OK(mcas->delete_pool(poolname));
+}
+
+TEST_F(ADO_test, PipelinedInvokeAdo)
+{
+  /* PIPELINE_WINDOW in the server's mcas_config.h */
+  const unsigned pipeline_window = 8;
+  const unsigned thread_count = pipeline_window * 4;
+  const unsigned calls = 20;
+
+  const std::string poolname = "THIS_IS_A_TEST_POOL";
+  mcas->delete_pool(poolname);
+
+  auto pool = mcas->create_pool(poolname, MiB(1), /* size */
+                                0, /* flags */
+                                100, /* obj count */
+                                IMCAS::Addr{0xBB00000000});
+
+  ASSERT_FALSE(pool == IKVStore::POOL_ERROR);
+
+  /* More threads than the window share the connection. Half invoke on
+   * one key, slowly, so that they wait for it in the shard while the
+   * others, each on its own key, complete out of turn. Every caller must
+   * get its own response.
+   */
+  std::vector<unsigned> failed(thread_count, 0);
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t != thread_count; t++) {
+    threads.emplace_back([&failed, pool, t] () {
+        const bool hot = (t % 2 == 0);
+        const std::string key = hot ? "PipelineHot" : "Pipeline-" + std::to_string(t);
+        for (unsigned i = 0; i != calls; i++) {
+          const std::string token = "thread-" + std::to_string(t) + "-call-" + std::to_string(i);
+          std::vector<IMCAS::ADO_response> response;
+          const auto rc = mcas->invoke_ado(pool, key, std::string("RUN!TEST-Echo ") + (hot ? "2 " : "0 ") + token,
+                                           IMCAS::ADO_FLAG_CREATE_ON_DEMAND, response, KiB(4));
+          if (rc != S_OK || response.size() != 1 || response[0].str() != token)
+            failed[t]++;
+        }
+      });
+  }
+  for (auto &th : threads)
+    th.join();
+
+  for (unsigned t = 0; t != thread_count; t++)
+    EXPECT_EQ(0U, failed[t]) << "thread " << t;
+
+  ASSERT_OK(mcas->close_pool(pool));
+
+  ASSERT_OK(mcas->delete_pool(poolname));
+}
+
 TEST_F(ADO_test, PutSignal)
 {
   const std::string testname = "PutSignal";